@@ -19,6 +19,13 @@
 #define CRA_ALIST_PVAL(list, index)    ((list)->array + (index) * (list)->itemsize)
 
 typedef struct CraAList CraAList;
+
+typedef enum
+{
+    CRA_RADIX_KEY_UINT,  // 无符号整数
+    CRA_RADIX_KEY_INT,   // 有符号整数(补码)
+    CRA_RADIX_KEY_FLOAT, // float/double
+} CraRadixKey_e;
 struct CraAList
 {
     unsigned char *array;
@@ -71,6 +78,24 @@ cra_alist_pop_at(CraAList *list, size_t index, void *retval);
 // bool remove_back(CraAList *list)
 #define cra_alist_remove_back(list)      cra_alist_remove_at(list, (list)->count - 1)
 
+// 一次插入/弹出n个连续的元素，最多扩容一次，只移动一次数据
+CRA_API bool
+cra_alist_insert_range(CraAList *list, size_t index, void *vals, size_t n);
+// bool insert_range(CraAList *list, size_t index, T vals[n], size_t n)
+#define cra_alist_insert_range(list, index, vals, n)                                   \
+    (CRA_ALIST_CHECK_VAL(list, vals), cra_alist_insert_range(list, index, vals, n))
+// bool extend(CraAList *list, T vals[n], size_t n)
+#define cra_alist_extend(list, vals, n) cra_alist_insert_range(list, (list)->count, vals, n)
+
+// index + n超出范围时返回false，不删除任何元素
+CRA_API bool
+cra_alist_pop_range(CraAList *list, size_t index, size_t n, void *retvals);
+// bool pop_range(CraAList *list, size_t index, size_t n, out T retvals[n])
+#define cra_alist_pop_range(list, index, n, retvals)                                   \
+    (CRA_ALIST_CHECK_VAL(list, retvals), cra_alist_pop_range(list, index, n, retvals))
+// bool remove_range(CraAList *list, size_t index, size_t n)
+#define cra_alist_remove_range(list, index, n) (cra_alist_pop_range)(list, index, n, NULL)
+
 static inline void *
 cra_alist_get_ref(CraAList *list, size_t index)
 {
@@ -120,11 +145,24 @@ cra_alist_get_and_set(CraAList *list, size_t index, void *newval, void *retoldva
 CRA_API bool
 cra_alist_reverse(CraAList *list);
 
+// pdqsort，不稳定。最坏O(nlogn)，已有序/逆序/大量重复时接近O(n)
 CRA_API bool
 cra_alist_sort(struct CraAList *list, cra_cmp_fn compare);
 // bool sort(CraAList *list, int (*compare)(const T *, const T *))
 #define cra_alist_sort(list, compare) cra_alist_sort(list, (cra_cmp_fn)(compare))
 
+// LSD基数排序，稳定，不需要比较函数
+// 按元素中[key_offset, key_offset + key_size)处的整数/浮点数升序排序
+// key_size: 1/2/4/8(浮点数: 4/8)。需要一块与数组一样大的临时内存
+// 浮点数按位排序: -0.0在0.0之前，NaN按符号位排在两端
+CRA_API bool
+cra_alist_radix_sort(CraAList *list, CraRadixKey_e key_type, size_t key_offset, size_t key_size);
+// bool radix_sort(CraAList *list, CraRadixKey_e key_type)  元素本身就是key
+#define cra_alist_radix_sort(list, key_type) cra_alist_radix_sort(list, key_type, 0, (list)->itemsize)
+// bool radix_sort_by<T>(CraAList *list, CraRadixKey_e key_type, T, member)  按结构体T的member排序
+#define cra_alist_radix_sort_by(list, key_type, T, member)                                        \
+    (cra_alist_radix_sort)(list, key_type, offsetof(T, member), sizeof(((T *)0)->member))
+
 CRA_API bool
 cra_alist_add_sort(struct CraAList *list, cra_cmp_fn compare, void *val);
 // bool add_sort(CraAList *list, int (*compare)(const T *, const T *), T *val)
@@ -0,0 +1,177 @@
+/**
+ * @file cra_btree.h
+ * @author Cracal
+ * @brief 有序字典(B+树)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_BTREE_H__
+#define __CRA_BTREE_H__
+#include <stdalign.h>
+#include "cra_collects.h"
+#include "cra_ifs.h"
+
+// 每个节点key(+val)部分的目标字节数，节点越宽树越矮
+#define CRA_BTREE_NODE_BYTES 512
+// 每个节点最少/最多的key数
+#define CRA_BTREE_MIN_CAPACITY 4
+#define CRA_BTREE_MAX_CAPACITY 1024
+// 足够容纳任何可能的树高
+#define CRA_BTREE_MAX_HEIGHT 32
+
+#define CRA_BTREE_CHECK_KEY(tree, key) assert((tree)->key_size == sizeof(*(key)))
+#define CRA_BTREE_CHECK_VAL(tree, val) assert((tree)->val_size == sizeof(*(val)))
+
+typedef struct CraBTreeNode CraBTreeNode;
+typedef struct CraBTree     CraBTree;
+
+// 所有key-val都在叶子中，叶子按key的顺序双向链接
+// 节点内key连续存放(val在叶子中单独一段)，二分查找时只访问key
+struct CraBTree
+{
+    CraBTreeNode *root;
+    CraBTreeNode *first; // 最左的叶子
+    CraBTreeNode *last;  // 最右的叶子
+
+    ssize_t count;
+    ssize_t height; // 只有一个叶子时为1
+
+    unsigned int leaf_capacity;
+    unsigned int inner_capacity;
+
+    size_t key_size;
+    size_t val_size;
+    size_t leaf_keys_offset;
+    size_t leaf_vals_offset;
+    size_t leaf_size;
+    size_t inner_keys_offset;
+    size_t inner_size;
+
+    unsigned char *carry; // 分裂时向上传递的两个key
+
+    cra_cmp_fn compare_key;
+};
+
+CRA_API bool
+cra_btree_init(CraBTree  *tree,
+               size_t     key_size,
+               size_t     val_size,
+               size_t     key_align,
+               size_t     val_align,
+               cra_cmp_fn compare_key);
+// bool init<TKey, TVal>(CraBTree *tree, int (*compare)(const TKey *a, const TKey *b))
+#define cra_btree_init(TKey, TVal, tree, compare_key_fn)                                         \
+    cra_btree_init(tree, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), (cra_cmp_fn)(compare_key_fn))
+
+CRA_API void
+cra_btree_uninit(CraBTree *tree);
+
+CRA_API void
+cra_btree_clear(CraBTree *tree);
+
+CRA_API bool
+cra_btree_put_and_return_kv(CraBTree *tree, void *key, void *val, void *retoldkey, void *retoldval, bool add);
+// bool put_and_return_kv(CraBTree *tree, TKey *key, TVal *val, out TKey *retoldkey, out TVal *retoldval)
+#define cra_btree_put_and_return_kv(tree, key, val, retoldkey, retoldval)                                        \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_VAL(tree, val), CRA_BTREE_CHECK_KEY(tree, retoldkey),        \
+     CRA_BTREE_CHECK_VAL(tree, retoldval), cra_btree_put_and_return_kv(tree, key, val, retoldkey, retoldval, false))
+// bool put_and_return_v(CraBTree *tree, TKey *key, TVal *val, out TVal *retoldval)
+#define cra_btree_put_and_return_v(tree, key, val, retoldval)                                              \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_VAL(tree, val), CRA_BTREE_CHECK_VAL(tree, retoldval), \
+     (cra_btree_put_and_return_kv)(tree, key, val, NULL, retoldval, false))
+// bool put(CraBTree *tree, TKey *key, TVal *val)
+#define cra_btree_put(tree, key, val)                                  \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_VAL(tree, val),   \
+     (cra_btree_put_and_return_kv)(tree, key, val, NULL, NULL, false))
+// bool add(CraBTree *tree, TKey *key, TVal *val)
+#define cra_btree_add(tree, key, val)                                 \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_VAL(tree, val),  \
+     (cra_btree_put_and_return_kv)(tree, key, val, NULL, NULL, true))
+
+CRA_API bool
+cra_btree_pop_kv(CraBTree *tree, const void *key, void *retkey, void *retval);
+// bool pop_kv(CraBTree *tree, TKey *key, out TKey *retkey, out TVal *retval)
+#define cra_btree_pop_kv(tree, key, retkey, retval)                                                         \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_KEY(tree, retkey), CRA_BTREE_CHECK_VAL(tree, retval), \
+     cra_btree_pop_kv(tree, key, retkey, retval))
+// bool pop(CraBTree *tree, TKey *key, out TVal *retval)
+#define cra_btree_pop(tree, key, retval) \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_VAL(tree, retval), (cra_btree_pop_kv)(tree, key, NULL, retval))
+// bool remove(CraBTree *tree, TKey *key)
+#define cra_btree_remove(tree, key) (CRA_BTREE_CHECK_KEY(tree, key), (cra_btree_pop_kv)(tree, key, NULL, NULL))
+
+CRA_API void *
+cra_btree_get_ref(CraBTree *tree, const void *key);
+// TVal *get_ref(CraBTree *tree, TKey *key)
+#define cra_btree_get_ref(tree, key) (CRA_BTREE_CHECK_KEY(tree, key), cra_btree_get_ref(tree, key))
+
+static inline bool
+cra_btree_get(CraBTree *tree, const void *key, void *retval)
+{
+    void *pval = (cra_btree_get_ref)(tree, key);
+    if (pval && retval)
+        memcpy(retval, pval, tree->val_size);
+    return pval != NULL;
+}
+// bool get(CraBTree *tree, TKey *key, out TVal *retval)
+#define cra_btree_get(tree, key, retval) \
+    (CRA_BTREE_CHECK_KEY(tree, key), CRA_BTREE_CHECK_VAL(tree, retval), cra_btree_get(tree, key, retval))
+
+// 把it定位到第一个 >= key 的元素之前
+// 之后用cra_iterable_next(CRA_BTREE_ITERABLE_I, it, ...)向后、cra_iterable_prev向前遍历
+// 没有 >= key 的元素时返回false(it依然可以向前遍历)
+// 修改树之后it失效
+CRA_API bool
+cra_btree_lower_bound(CraBTree *tree, const void *key, CraIterator *it);
+// bool lower_bound(CraBTree *tree, TKey *key, out CraIterator *it)
+#define cra_btree_lower_bound(tree, key, it) (CRA_BTREE_CHECK_KEY(tree, key), cra_btree_lower_bound(tree, key, it))
+
+// 同lower_bound，定位到第一个 > key 的元素之前
+CRA_API bool
+cra_btree_upper_bound(CraBTree *tree, const void *key, CraIterator *it);
+// bool upper_bound(CraBTree *tree, TKey *key, out CraIterator *it)
+#define cra_btree_upper_bound(tree, key, it) (CRA_BTREE_CHECK_KEY(tree, key), cra_btree_upper_bound(tree, key, it))
+
+// 按key从小到大遍历[key_from, key_to)
+#define CRA_BTREE_FOREACH_RANGE(tree, key_from, key_to, val_name)                                       \
+    for (CraIterator val_name##_it = { 0 };                                                             \
+         val_name##_it.obj == NULL && ((cra_btree_lower_bound)(tree, key_from, &val_name##_it), true);) \
+        for (CraPair val_name = { 0 };                                                                  \
+             cra_iterable_next(CRA_BTREE_ITERABLE_I, &val_name##_it, &val_name) &&                      \
+             (tree)->compare_key(val_name.key_ref, key_to) < 0;)
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+typedef struct CraBTreeInitializableParam
+{
+    size_t     key_size;
+    size_t     val_size;
+    size_t     key_align;
+    size_t     val_align;
+    cra_cmp_fn compare_key;
+} CraBTreeInitializableParam;
+#define CRA_BTREE_INITIALIZABLE_PARAM_INIT(TKey, TVal, compare_key_fn)                     \
+    { sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), (cra_cmp_fn)(compare_key_fn) }
+#define CRA_BTREE_INITIALIZABLE_PARAM_DECL(var_name) CraBTreeInitializableParam var_name
+#define CRA_BTREE_INITIALIZABLE_PARAM_DEF(var_name, TKey, TVal, compare_key_fn) \
+    CRA_BTREE_INITIALIZABLE_PARAM_DECL(var_name) = CRA_BTREE_INITIALIZABLE_PARAM_INIT(TKey, TVal, compare_key_fn)
+
+CRA_API CRA_INITIALIZABLE_DEF(cra_g_btree_initializable_i);
+#define CRA_BTREE_INITIALIZABLE_I (&cra_g_btree_initializable_i)
+
+// appendable
+
+CRA_API CRA_APPENDABLE_DEF(cra_g_btree_appendable_i);
+#define CRA_BTREE_APPENDABLE_I (&cra_g_btree_appendable_i)
+
+// iterable
+
+CRA_API CRA_ITERABLE_DEF(cra_g_btree_iterable_i);
+#define CRA_BTREE_ITERABLE_I (&cra_g_btree_iterable_i)
+
+#endif
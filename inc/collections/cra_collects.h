@@ -74,6 +74,24 @@ cra_cmp_string_p(const char **a, const char **b)
     return cra_cmp_string(*a, *b);
 }
 
+// 不以'\0'结尾的字符串片段(中间不能有'\0')
+typedef struct CraStrSlice
+{
+    const char *str;
+    size_t      len;
+} CraStrSlice;
+
+// 比较字符串片段和以'\0'结尾的字符串
+// 可以作为字典(key是char *)的异构比较函数
+static inline int
+cra_cmp_str_slice_p(const CraStrSlice *a, const char **b)
+{
+    int ret = strncmp(a->str, *b, a->len);
+    if (ret != 0)
+        return ret;
+    return (*b)[a->len] == '\0' ? 0 : -1;
+}
+
 #undef CRA_CMP_FUNC
 
 #endif // end compare functions
@@ -158,6 +176,12 @@ cra_hash_double_p(const double *val)
     return cra_hash_double(*val);
 }
 
+// 任意字节序列的hash(wyhash)，使用与字符串hash相同的进程随机初始值
+// cra_hash_bytes(s, strlen(s)) == cra_hash_string1(s)
+CRA_API cra_hash_t
+cra_hash_bytes(const void *data, size_t len);
+
+// 字符串hash，1和2使用不同的初始值，结果相互独立
 CRA_API cra_hash_t
 cra_hash_string1(const char *val);
 
@@ -170,8 +194,47 @@ cra_hash_string1_p(const char **val);
 CRA_API cra_hash_t
 cra_hash_string2_p(const char **val);
 
+// 只hash前len个字符，对同样的内容结果与cra_hash_string1/2相同
+CRA_API cra_hash_t
+cra_hash_string1_n(const char *val, size_t len);
+
+CRA_API cra_hash_t
+cra_hash_string2_n(const char *val, size_t len);
+
+static inline cra_hash_t
+cra_hash_str_slice1_p(const CraStrSlice *val)
+{
+    return cra_hash_string1_n(val->str, val->len);
+}
+
+static inline cra_hash_t
+cra_hash_str_slice2_p(const CraStrSlice *val)
+{
+    return cra_hash_string2_n(val->str, val->len);
+}
+
 #undef CRA_HASH_FUNC
 
+// murmur3 fmix64，不管cra_uhash_t多宽都返回完整的64位结果
+static inline uint64_t
+cra_hash_mix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 对hash值做最终混合(murmur3 fmix64)
+// 整数的hash函数是恒等映射，用掩码(2的幂)取桶之前必须先混合
+static inline cra_uhash_t
+cra_hash_mix(cra_hash_t hash)
+{
+    return (cra_uhash_t)cra_hash_mix64((uint64_t)hash);
+}
+
 #endif // end hash functions
 
 #endif
\ No newline at end of file
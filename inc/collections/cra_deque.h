@@ -56,6 +56,12 @@ cra_deque_push_back(CraDeque *deque, void *val);
 // bool push_back(CraDeque *deque, T *val)
 #define cra_deque_push_back(deque, val)     (CRA_DEQUE_CHECK_VAL(deque, val), cra_deque_push_back(deque, val))
 
+// 一次在尾部添加n个元素，最多扩容一次，每块一次memcpy
+CRA_API bool
+cra_deque_push_back_n(CraDeque *deque, void *vals, size_t n);
+// bool push_back_n(CraDeque *deque, T vals[n], size_t n)
+#define cra_deque_push_back_n(deque, vals, n) (CRA_DEQUE_CHECK_VAL(deque, vals), cra_deque_push_back_n(deque, vals, n))
+
 CRA_API bool
 cra_deque_pop_at(CraDeque *deque, size_t index, void *retval);
 CRA_API bool
@@ -70,6 +76,15 @@ cra_deque_pop_back(CraDeque *deque, void *retval);
 // bool pop_back(CraDeque *deque, out T *retval)
 #define cra_deque_pop_back(deque, retval)  (CRA_DEQUE_CHECK_VAL(deque, retval), cra_deque_pop_back(deque, retval))
 
+// 一次弹出头部n个元素。元素个数不足n时返回false，不弹出任何元素
+CRA_API bool
+cra_deque_pop_front_n(CraDeque *deque, void *retvals, size_t n);
+// bool pop_front_n(CraDeque *deque, out T retvals[n], size_t n)
+#define cra_deque_pop_front_n(deque, retvals, n)                                     \
+    (CRA_DEQUE_CHECK_VAL(deque, retvals), cra_deque_pop_front_n(deque, retvals, n))
+// bool remove_front_n(CraDeque *deque, size_t n)
+#define cra_deque_remove_front_n(deque, n) (cra_deque_pop_front_n)(deque, NULL, n)
+
 // bool remove_at(CraDeque *deque, size_t index)
 #define cra_deque_remove_at(deque, index) (cra_deque_pop_at)(deque, index, NULL)
 // bool remove_left(CraDeque *deque)
@@ -22,16 +22,32 @@
 typedef struct CraDictEntry CraDictEntry;
 typedef struct CraDict      CraDict;
 
+typedef enum CraDictFlag_e
+{
+    CRA_DICT_FLAG_NONE = 0,       // 素数容量，hash取模得到桶
+    CRA_DICT_FLAG_POW2 = 1 << 0,  // 2的幂容量，hash混合后用掩码得到桶
+    CRA_DICT_FLAG_INCR = 1 << 1,  // 渐进式扩容，每次put/get/pop迁移少量旧桶
+    CRA_DICT_FLAG_SPLIT = 1 << 2, // val放在单独的数组中，查找时只访问紧凑的hash/next/key
+} CraDictFlag_e;
+
 struct CraDict
 {
-    ssize_t      *buckets;
-    CraDictEntry *entries;
+    ssize_t       *buckets;
+    CraDictEntry  *entries;
+    unsigned char *vals; // CRA_DICT_FLAG_SPLIT时vals[i]是entries[i]的val，否则为NULL
+
+    // 渐进式扩容时的旧桶, 没有在迁移时为NULL
+    ssize_t *old_buckets;
+    ssize_t  old_capacity;
+    ssize_t  rehash_idx; // 下一个要迁移的旧桶
 
     ssize_t next;
     ssize_t count;
     ssize_t capacity;
     ssize_t freelist;
 
+    unsigned int flags;
+
     size_t key_size;
     size_t val_size;
     size_t key_offset;
@@ -56,28 +72,32 @@ cra_dict_init_with_size(CraDict    *dict,
 #define cra_dict_init_with_size(TKey, TVal, dict, init_capacity, hash_key_fn, compare_key_fn)              \
     cra_dict_init_with_size(dict, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), init_capacity, \
                             (cra_hash_fn)(hash_key_fn), (cra_cmp_fn)(compare_key_fn))
-// bool init_with_size<TKey, TVal>(CraDict *dict, cra_hash_t (*hash)(const TKey *key),
+// bool init<TKey, TVal>(CraDict *dict, cra_hash_t (*hash)(const TKey *key),
 // int (*compare)(const TKey *a, const TKey *b))
 #define cra_dict_init(TKey, TVal, dict, hash_key_fn, compare_key_fn)                                  \
     cra_dict_init_with_size(TKey, TVal, dict, CRA_DICT_DEAFULT_CAPACITY, hash_key_fn, compare_key_fn)
 
+CRA_API bool
+cra_dict_init_with_flags(CraDict     *dict,
+                         size_t       key_size,
+                         size_t       val_size,
+                         size_t       key_align,
+                         size_t       val_align,
+                         size_t       init_capacity,
+                         unsigned int flags,
+                         cra_hash_fn  hash_key,
+                         cra_cmp_fn   compare_key);
+// bool init_with_flags<TKey, TVal>(CraDict *dict, size_t init_capacity, CraDictFlag_e flags,
+// cra_hash_t (*hash)(const TKey *key), int (*compare)(const TKey *a, const TKey *b))
+#define cra_dict_init_with_flags(TKey, TVal, dict, init_capacity, flags, hash_key_fn, compare_key_fn)              \
+    cra_dict_init_with_flags(dict, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), init_capacity, flags, \
+                             (cra_hash_fn)(hash_key_fn), (cra_cmp_fn)(compare_key_fn))
+
 CRA_API void
 cra_dict_uninit(CraDict *dict);
 
-static inline void
-cra_dict_clear(CraDict *dict)
-{
-    assert(dict);
-    assert(dict->buckets);
-    assert(dict->entries);
-    assert(dict->entry_size > 0 && dict->entry_size % 2 == 0);
-
-    if (dict->count > 0)
-        memset(dict->buckets, 0xff, dict->capacity * sizeof(ssize_t));
-    dict->freelist = -1;
-    dict->count = 0;
-    dict->next = 0;
-}
+CRA_API void
+cra_dict_clear(CraDict *dict);
 
 CRA_API bool
 cra_dict_reserve(CraDict *dict, ssize_t new_capacity);
@@ -101,6 +121,41 @@ cra_dict_put_and_return_kv(CraDict *dict, void *key, void *val, void *retoldkey,
     (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, val),   \
      (cra_dict_put_and_return_kv)(dict, key, val, NULL, NULL, true))
 
+// 调用者已经有key的hash时使用，省去再次调用hash_key
+// hash必须等于dict->hash_key(key)
+CRA_API bool
+cra_dict_put_and_return_kv_with_hash(CraDict   *dict,
+                                     void      *key,
+                                     cra_hash_t hash,
+                                     void      *val,
+                                     void      *retoldkey,
+                                     void      *retoldval,
+                                     bool       add);
+// bool put_and_return_kv_with_hash(CraDict *dict, TKey *key, cra_hash_t hash, TVal *val, out TKey *retoldkey,
+// out TVal *retoldval)
+#define cra_dict_put_and_return_kv_with_hash(dict, key, hash, val, retoldkey, retoldval)                          \
+    (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, val), CRA_DICT_CHECK_KEY(dict, retoldkey),            \
+     CRA_DICT_CHECK_VAL(dict, retoldval),                                                                         \
+     cra_dict_put_and_return_kv_with_hash(dict, key, hash, val, retoldkey, retoldval, false))
+// bool put_with_hash(CraDict *dict, TKey *key, cra_hash_t hash, TVal *val)
+#define cra_dict_put_with_hash(dict, key, hash, val)                                  \
+    (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, val),                    \
+     (cra_dict_put_and_return_kv_with_hash)(dict, key, hash, val, NULL, NULL, false))
+// bool add_with_hash(CraDict *dict, TKey *key, cra_hash_t hash, TVal *val)
+#define cra_dict_add_with_hash(dict, key, hash, val)                                 \
+    (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, val),                   \
+     (cra_dict_put_and_return_kv_with_hash)(dict, key, hash, val, NULL, NULL, true))
+
+// 批量put(可覆盖)，keys和vals是连续的n个key和n个val
+// 先计算整批key的hash并预取，比逐个put更少等待内存
+// 返回成功put的个数，小于n表示内存不足
+CRA_API size_t
+cra_dict_put_many(CraDict *dict, void *keys, void *vals, size_t n);
+// size_t put_many(CraDict *dict, TKey keys[], TVal vals[], size_t n)
+#define cra_dict_put_many(dict, keys, vals, n)                        \
+    (CRA_DICT_CHECK_KEY(dict, keys), CRA_DICT_CHECK_VAL(dict, vals),  \
+     cra_dict_put_many(dict, keys, vals, n))
+
 CRA_API bool
 cra_dict_pop_kv(CraDict *dict, const void *key, void *retkey, void *retval);
 // bool pop_kv(CraDict *dict, TKey *key, out TKey *retkey, out TVal *retval)
@@ -113,11 +168,35 @@ cra_dict_pop_kv(CraDict *dict, const void *key, void *retkey, void *retval);
 // bool remove(CraDict *dict, TKey *key)
 #define cra_dict_remove(dict, key) (CRA_DICT_CHECK_KEY(dict, key), (cra_dict_pop_kv)(dict, key, NULL, NULL))
 
+// hash必须等于dict->hash_key(key)
+CRA_API bool
+cra_dict_pop_kv_with_hash(CraDict *dict, const void *key, cra_hash_t hash, void *retkey, void *retval);
+// bool pop_kv_with_hash(CraDict *dict, TKey *key, cra_hash_t hash, out TKey *retkey, out TVal *retval)
+#define cra_dict_pop_kv_with_hash(dict, key, hash, retkey, retval)                                      \
+    (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_KEY(dict, retkey), CRA_DICT_CHECK_VAL(dict, retval), \
+     cra_dict_pop_kv_with_hash(dict, key, hash, retkey, retval))
+// bool pop_with_hash(CraDict *dict, TKey *key, cra_hash_t hash, out TVal *retval)
+#define cra_dict_pop_with_hash(dict, key, hash, retval)                   \
+    (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, retval),     \
+     (cra_dict_pop_kv_with_hash)(dict, key, hash, NULL, retval))
+// bool remove_with_hash(CraDict *dict, TKey *key, cra_hash_t hash)
+#define cra_dict_remove_with_hash(dict, key, hash) \
+    (CRA_DICT_CHECK_KEY(dict, key), (cra_dict_pop_kv_with_hash)(dict, key, hash, NULL, NULL))
+
 CRA_API void *
 cra_dict_get_ref(CraDict *dict, const void *key);
 // TVal *get_ref(CraDict *dict, TKey *key)
 #define cra_dict_get_ref(dict, key) (CRA_DICT_CHECK_KEY(dict, key), cra_dict_get_ref(dict, key))
 
+// 批量get_ref，retvals[i]为keys[i]对应val的引用，不存在时为NULL
+// 返回找到的个数
+// 引用在下一次修改字典前有效(渐进式扩容的字典不会因为查找而使引用失效)
+CRA_API size_t
+cra_dict_get_many(CraDict *dict, const void *keys, size_t n, void **retvals);
+// size_t get_many(CraDict *dict, TKey keys[], size_t n, out TVal *retvals[])
+#define cra_dict_get_many(dict, keys, n, retvals) \
+    (CRA_DICT_CHECK_KEY(dict, keys), cra_dict_get_many(dict, keys, n, (void **)(retvals)))
+
 static inline bool
 cra_dict_get(CraDict *dict, const void *key, void *retval)
 {
@@ -130,18 +209,165 @@ cra_dict_get(CraDict *dict, const void *key, void *retval)
 #define cra_dict_get(dict, key, retval)                                                                \
     (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, retval), cra_dict_get(dict, key, retval))
 
+// hash必须等于dict->hash_key(key)
+CRA_API void *
+cra_dict_get_ref_with_hash(CraDict *dict, const void *key, cra_hash_t hash);
+// TVal *get_ref_with_hash(CraDict *dict, TKey *key, cra_hash_t hash)
+#define cra_dict_get_ref_with_hash(dict, key, hash) \
+    (CRA_DICT_CHECK_KEY(dict, key), cra_dict_get_ref_with_hash(dict, key, hash))
+
+static inline bool
+cra_dict_get_with_hash(CraDict *dict, const void *key, cra_hash_t hash, void *retval)
+{
+    void *pval = (cra_dict_get_ref_with_hash)(dict, key, hash);
+    if (pval && retval)
+        memcpy(retval, pval, dict->val_size);
+    return pval != NULL;
+}
+// bool get_with_hash(CraDict *dict, TKey *key, cra_hash_t hash, out TVal *retval)
+#define cra_dict_get_with_hash(dict, key, hash, retval)                      \
+    (CRA_DICT_CHECK_KEY(dict, key), CRA_DICT_CHECK_VAL(dict, retval),        \
+     cra_dict_get_with_hash(dict, key, hash, retval))
+
+// 用另一种形式的key(如CraStrSlice)查找，不需要先构造出TKey
+// hash: 等价的TKey的hash，即dict->hash_key(&等价的TKey)
+// compare_key(key, 字典中的TKey)，相等时返回0
+CRA_API void *
+cra_dict_get_ref_as(CraDict *dict, const void *key, cra_hash_t hash, cra_cmp_fn compare_key);
+// TVal *get_ref_as(CraDict *dict, TForeignKey *key, cra_hash_t hash,
+// int (*compare)(const TForeignKey *key, const TKey *dict_key))
+#define cra_dict_get_ref_as(dict, key, hash, compare_key_fn) \
+    cra_dict_get_ref_as(dict, key, hash, (cra_cmp_fn)(compare_key_fn))
+
+static inline bool
+cra_dict_get_as(CraDict *dict, const void *key, cra_hash_t hash, cra_cmp_fn compare_key, void *retval)
+{
+    void *pval = (cra_dict_get_ref_as)(dict, key, hash, compare_key);
+    if (pval && retval)
+        memcpy(retval, pval, dict->val_size);
+    return pval != NULL;
+}
+// bool get_as(CraDict *dict, TForeignKey *key, cra_hash_t hash,
+// int (*compare)(const TForeignKey *key, const TKey *dict_key), out TVal *retval)
+#define cra_dict_get_as(dict, key, hash, compare_key_fn, retval) \
+    (CRA_DICT_CHECK_VAL(dict, retval), cra_dict_get_as(dict, key, hash, (cra_cmp_fn)(compare_key_fn), retval))
+
+// ====================================== 只读镜像 ======================================
+
+// 把字典冻结成文件镜像，其他进程mmap后直接查找，不需要反序列化
+// 镜像中只有下标和偏移，没有指针，映射到任何地址都可以用
+// 文件布局: CraDictImageHeader | buckets[capacity] | entries[count] | (vals[count])，各部分按缓存行对齐
+
+#define CRA_DICT_IMAGE_MAGIC   "CRADICT" // 含'\0'共8字节
+#define CRA_DICT_IMAGE_VERSION 1
+#define CRA_DICT_IMAGE_ENDIAN  0x01020304
+
+typedef struct CraDictImageHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t endian;    // 用于识别字节序不同的机器写出的镜像
+    uint32_t word_size; // sizeof(ssize_t)
+    uint32_t flags;     // 只保留CRA_DICT_FLAG_POW2和CRA_DICT_FLAG_SPLIT
+    uint64_t key_size;
+    uint64_t val_size;
+    uint64_t key_offset;
+    uint64_t val_offset;
+    uint64_t entry_size;
+    uint64_t count;
+    uint64_t capacity;
+    uint64_t buckets_offset; // 相对文件开头
+    uint64_t entries_offset; // 相对文件开头
+    uint64_t vals_offset;    // 相对文件开头，CRA_DICT_FLAG_SPLIT时才有
+    uint64_t image_size;
+} CraDictImageHeader;
+
+// 镜像的只读视图
+typedef struct CraDictView
+{
+    const void          *image;
+    size_t               image_size;
+    const ssize_t       *buckets;
+    const unsigned char *entries;
+    const unsigned char *vals; // 分离布局时才有
+
+    ssize_t      count;
+    ssize_t      capacity;
+    unsigned int flags;
+
+    size_t key_size;
+    size_t val_size;
+    size_t key_offset;
+    size_t val_offset;
+    size_t entry_size;
+
+    cra_hash_fn hash_key;
+    cra_cmp_fn  compare_key;
+} CraDictView;
+
+// key和val必须是定长的POD(不含指针)，hash_key的结果在不同进程间必须一致
+// (cra_hash_string*这类每个进程随机初始值的hash不能用)
+// 会覆盖path已有的文件，失败时删除写了一半的文件
+CRA_API bool
+cra_dict_freeze(CraDict *dict, const char *path);
+
+// hash_key和compare_key必须与冻结时字典使用的一致
+// 文件格式不对、key/val大小不一致或hash_key与镜像中的hash对不上时返回false
+CRA_API bool
+cra_dict_view_open(CraDictView *view,
+                   const char  *path,
+                   size_t       key_size,
+                   size_t       val_size,
+                   cra_hash_fn  hash_key,
+                   cra_cmp_fn   compare_key);
+// bool view_open<TKey, TVal>(CraDictView *view, const char *path, cra_hash_t (*hash)(const TKey *key),
+// int (*compare)(const TKey *a, const TKey *b))
+#define cra_dict_view_open(TKey, TVal, view, path, hash_key_fn, compare_key_fn)                 \
+    cra_dict_view_open(view, path, sizeof(TKey), sizeof(TVal), (cra_hash_fn)(hash_key_fn),      \
+                       (cra_cmp_fn)(compare_key_fn))
+
+// 解除映射，之后get_ref得到的引用都失效
+CRA_API void
+cra_dict_view_close(CraDictView *view);
+
+// 返回的引用指向只读映射，不能写入
+CRA_API const void *
+cra_dict_view_get_ref(CraDictView *view, const void *key);
+// const TVal *view_get_ref(CraDictView *view, TKey *key)
+#define cra_dict_view_get_ref(view, key) (CRA_DICT_CHECK_KEY(view, key), cra_dict_view_get_ref(view, key))
+
+// hash必须等于view->hash_key(key)
+CRA_API const void *
+cra_dict_view_get_ref_with_hash(CraDictView *view, const void *key, cra_hash_t hash);
+// const TVal *view_get_ref_with_hash(CraDictView *view, TKey *key, cra_hash_t hash)
+#define cra_dict_view_get_ref_with_hash(view, key, hash) \
+    (CRA_DICT_CHECK_KEY(view, key), cra_dict_view_get_ref_with_hash(view, key, hash))
+
+static inline bool
+cra_dict_view_get(CraDictView *view, const void *key, void *retval)
+{
+    const void *pval = (cra_dict_view_get_ref)(view, key);
+    if (pval && retval)
+        memcpy(retval, pval, view->val_size);
+    return pval != NULL;
+}
+// bool view_get(CraDictView *view, TKey *key, out TVal *retval)
+#define cra_dict_view_get(view, key, retval)                                                                \
+    (CRA_DICT_CHECK_KEY(view, key), CRA_DICT_CHECK_VAL(view, retval), cra_dict_view_get(view, key, retval))
+
 // ====================================== interfaces ======================================
 
 // initializable
 
 typedef struct CraDictInitializableParam
 {
-    size_t      key_size;
-    size_t      val_size;
-    size_t      key_align;
-    size_t      val_align;
-    cra_cmp_fn  compare_key;
-    cra_hash_fn hash_key;
+    size_t       key_size;
+    size_t       val_size;
+    size_t       key_align;
+    size_t       val_align;
+    cra_cmp_fn   compare_key;
+    cra_hash_fn  hash_key;
+    unsigned int flags; // CraDictFlag_e, 默认是CRA_DICT_FLAG_NONE
 } CraDictInitializableParam;
 #define CRA_DICT_INITIALIZABLE_PARAM_INIT(TKey, TVal, hash_key_fn, compare_key_fn) \
     {                                                                              \
@@ -150,7 +376,8 @@ typedef struct CraDictInitializableParam
         alignof(TKey),                                                             \
         alignof(TVal),                                                             \
         (cra_cmp_fn)(compare_key_fn),                                              \
-        (cra_hash_fn)(hash_key_fn)                                                 \
+        (cra_hash_fn)(hash_key_fn),                                                \
+        CRA_DICT_FLAG_NONE                                                         \
     }
 #define CRA_DICT_INITIALIZABLE_PARAM_DECL(var_name) CraDictInitializableParam var_name
 #define CRA_DICT_INITIALIZABLE_PARAM_DEF(var_name, TKey, TVal, hash_key_fn, compare_key_fn) \
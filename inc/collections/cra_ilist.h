@@ -0,0 +1,196 @@
+/**
+ * @file cra_ilist.h
+ * @author Cracal
+ * @brief 侵入式双向循环链表
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_ILIST_H__
+#define __CRA_ILIST_H__
+#include "cra_collects.h"
+#include "cra_ifs.h"
+
+typedef struct CraIListNode CraIListNode;
+typedef struct CraIList     CraIList;
+
+// 链接字段，嵌入到用户的结构体中
+// 添加/删除节点不申请内存，也不复制元素；一个节点同一时间只能在一个链表中
+struct CraIListNode
+{
+    CraIListNode *prev;
+    CraIListNode *next;
+};
+
+struct CraIList
+{
+    CraIListNode head; // 哨兵
+    size_t       count;
+    size_t       offset; // 节点在结构体中的偏移
+};
+
+// T *entry<T>(CraIListNode *node, T, member)  由节点得到所在的结构体
+#define CRA_ILIST_ENTRY(node, T, member) ((T *)((char *)(node) - offsetof(T, member)))
+
+// 哨兵的地址与链表有关，不能按值复制/交换CraIList。请使用cra_ilist_move
+static inline void
+cra_ilist_init(CraIList *list, size_t offset)
+{
+    assert(list);
+    list->head.prev = list->head.next = &list->head;
+    list->count = 0;
+    list->offset = offset;
+}
+// void init<T>(CraIList *list, member)
+#define cra_ilist_init(T, list, member) cra_ilist_init(list, offsetof(T, member))
+
+static inline void
+cra_ilist_node_init(CraIListNode *node)
+{
+    node->prev = node->next = NULL;
+}
+
+static inline bool
+cra_ilist_node_is_linked(CraIListNode *node)
+{
+    return node->next != NULL;
+}
+
+static inline bool
+cra_ilist_is_empty(CraIList *list)
+{
+    return list->count == 0;
+}
+
+// 把node链接到pos之后
+static inline void
+cra_ilist_insert_after(CraIList *list, CraIListNode *pos, CraIListNode *node)
+{
+    assert(list);
+    assert(pos && pos->next);
+    assert(node && !node->next);
+
+    node->prev = pos;
+    node->next = pos->next;
+    pos->next->prev = node;
+    pos->next = node;
+    ++list->count;
+}
+
+// 把node链接到pos之前
+static inline void
+cra_ilist_insert_before(CraIList *list, CraIListNode *pos, CraIListNode *node)
+{
+    assert(pos && pos->prev);
+    cra_ilist_insert_after(list, pos->prev, node);
+}
+
+static inline void
+cra_ilist_push_front(CraIList *list, CraIListNode *node)
+{
+    cra_ilist_insert_after(list, &list->head, node);
+}
+
+static inline void
+cra_ilist_push_back(CraIList *list, CraIListNode *node)
+{
+    cra_ilist_insert_after(list, list->head.prev, node);
+}
+
+// O(1)，node必须在list中
+static inline void
+cra_ilist_remove(CraIList *list, CraIListNode *node)
+{
+    assert(list && list->count > 0);
+    assert(node && node != &list->head);
+    assert(node->prev && node->next);
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = NULL;
+    --list->count;
+}
+
+// 链表为空时返回NULL
+static inline CraIListNode *
+cra_ilist_front(CraIList *list)
+{
+    return list->count > 0 ? list->head.next : NULL;
+}
+
+// 链表为空时返回NULL
+static inline CraIListNode *
+cra_ilist_back(CraIList *list)
+{
+    return list->count > 0 ? list->head.prev : NULL;
+}
+
+// node是最后一个节点时返回NULL
+static inline CraIListNode *
+cra_ilist_next(CraIList *list, CraIListNode *node)
+{
+    return node->next != &list->head ? node->next : NULL;
+}
+
+// node是第一个节点时返回NULL
+static inline CraIListNode *
+cra_ilist_prev(CraIList *list, CraIListNode *node)
+{
+    return node->prev != &list->head ? node->prev : NULL;
+}
+
+// 链表为空时返回NULL
+static inline CraIListNode *
+cra_ilist_pop_front(CraIList *list)
+{
+    CraIListNode *node = cra_ilist_front(list);
+    if (node)
+        cra_ilist_remove(list, node);
+    return node;
+}
+
+// 链表为空时返回NULL
+static inline CraIListNode *
+cra_ilist_pop_back(CraIList *list)
+{
+    CraIListNode *node = cra_ilist_back(list);
+    if (node)
+        cra_ilist_remove(list, node);
+    return node;
+}
+
+// 把src的所有节点移动到dst的尾部，O(1)
+static inline void
+cra_ilist_move(CraIList *dst, CraIList *src)
+{
+    assert(dst && src && dst != src);
+    assert(dst->offset == src->offset);
+
+    if (src->count == 0)
+        return;
+
+    src->head.next->prev = dst->head.prev;
+    dst->head.prev->next = src->head.next;
+    src->head.prev->next = &dst->head;
+    dst->head.prev = src->head.prev;
+    dst->count += src->count;
+
+    src->head.prev = src->head.next = &src->head;
+    src->count = 0;
+}
+
+// 断开所有节点，O(n)
+CRA_API void
+cra_ilist_clear(CraIList *list);
+
+// ====================================== interfaces ======================================
+
+// iterable
+// val_ref指向节点所在的结构体。迭代时可以删除当前节点
+
+CRA_API CRA_ITERABLE_DEF(cra_g_ilist_iterable_i);
+#define CRA_ILIST_ITERABLE_I (&cra_g_ilist_iterable_i)
+
+#endif
@@ -12,8 +12,12 @@
 #define __CRA_LLIST_H__
 #include "cra_collects.h"
 #include "cra_ifs.h"
+#include "cra_mempool.h"
 
 #define CRA_LLIST_CHECK_VAL(list, val) assert(sizeof(*(val)) == (list)->itemsize)
+// 节点大小，按指针大小对齐
+#define CRA_LLIST_NODE_SIZE(itemsize)                                                          \
+    ((sizeof(CraLListNode) + (itemsize) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
 
 typedef struct CraLListNode CraLListNode;
 typedef struct CraLList     CraLList;
@@ -32,6 +36,7 @@ struct CraLList
     CraLListNode *free_list;
     size_t        nfreelist;
     size_t        itemsize;
+    CraMemPool   *nodepool; // 共享的节点池。为NULL时每个节点单独申请内存
 };
 
 #if 1 // node operation
@@ -42,6 +47,14 @@ cra_llist_create_node(size_t itemsize);
 CRA_API void
 cra_llist_destroy_node(CraLListNode *node);
 
+// 从list的节点池申请节点(没有节点池时单独申请内存)
+CRA_API CraLListNode *
+cra_llist_new_node(CraLList *list);
+
+// 把节点还给list的节点池(没有节点池时释放内存)
+CRA_API void
+cra_llist_delete_node(CraLList *list, CraLListNode *node);
+
 static inline void
 cra_llist_link_node(CraLListNode *node, CraLListNode *prev)
 {
@@ -86,16 +99,22 @@ cra_llist_get_free_node(CraLList *list)
     }
     else
     {
-        return cra_llist_create_node(list->itemsize);
+        return cra_llist_new_node(list);
     }
 }
 
+// 有节点池时直接还给节点池，其他共享该池的链表也能使用
 static inline void
 cra_llist_put_free_node(CraLList *list, CraLListNode *node)
 {
     assert(list);
     assert(node);
 
+    if (list->nodepool)
+    {
+        cra_mempool_dealloc(list->nodepool, node);
+        return;
+    }
     node->next = list->free_list;
     list->free_list = node;
     ++list->nfreelist;
@@ -188,12 +207,29 @@ cra_llist_init_with_size(CraLList *list, size_t itemsize, size_t init_spare_node
 // bool init<T>(CraLList *list)
 #define cra_llist_init(T, list)                            cra_llist_init_with_size(T, list, 0)
 
+// 节点池
+// 多个链表可以共享同一个节点池，节点在池中连续存放，遍历时局部性更好
+// CraMemPool不是线程安全的，共享同一个节点池的链表只能在同一个线程中使用
+// 节点池必须在所有使用它的链表反初始化之后，用cra_mempool_uninit反初始化
+
+CRA_API bool
+cra_llist_nodepool_init(CraMemPool *pool, size_t itemsize, size_t nodes_per_slab);
+// bool nodepool_init<T>(CraMemPool *pool, size_t nodes_per_slab)
+#define cra_llist_nodepool_init(T, pool, nodes_per_slab) cra_llist_nodepool_init(pool, sizeof(T), nodes_per_slab)
+
+// 使用节点池的链表不缓存空闲节点，删除的节点直接还给节点池
+CRA_API bool
+cra_llist_init_with_pool(CraLList *list, size_t itemsize, CraMemPool *nodepool);
+// bool init_with_pool<T>(CraLList *list, CraMemPool *nodepool)
+#define cra_llist_init_with_pool(T, list, nodepool) cra_llist_init_with_pool(list, sizeof(T), nodepool)
+
 CRA_API void
 cra_llist_uninit(CraLList *list);
 
 CRA_API void
 cra_llist_clear(CraLList *list);
 
+// 使用节点池时什么都不做
 CRA_API bool
 cra_llist_reserve(CraLList *list, size_t nspare);
 
@@ -273,11 +309,19 @@ cra_llist_get_and_set(CraLList *list, size_t index, void *newval, void *retoldva
 CRA_API void
 cra_llist_reverse(CraLList *list);
 
+// 稳定的归并排序，只重新链接节点，不复制元素，额外内存O(1)
 CRA_API bool
 cra_llist_sort(CraLList *list, cra_cmp_fn compare);
 // bool sort(CraLList *list, int (*compare)(const T *, const T *))
 #define cra_llist_sort(list, compare) cra_llist_sort(list, (cra_cmp_fn)(compare))
 
+// 与sort结果相同，但先把节点指针收集到临时数组中排序，额外内存O(n)
+// 元素较大、节点分散在内存中时更快。临时内存申请失败时返回false，链表不变
+CRA_API bool
+cra_llist_sort_buffered(CraLList *list, cra_cmp_fn compare);
+// bool sort_buffered(CraLList *list, int (*compare)(const T *, const T *))
+#define cra_llist_sort_buffered(list, compare) cra_llist_sort_buffered(list, (cra_cmp_fn)(compare))
+
 CRA_API bool
 cra_llist_add_sort(CraLList *list, cra_cmp_fn compare, void *val);
 // bool add_sort(CraLList *list, int (*compare)(const T *, const T *), T *val)
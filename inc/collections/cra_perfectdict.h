@@ -0,0 +1,104 @@
+/**
+ * @file cra_perfectdict.h
+ * @author Cracal
+ * @brief 最小完美hash的只读字典
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_PERFECTDICT_H__
+#define __CRA_PERFECTDICT_H__
+#include <stdalign.h>
+#include "cra_collects.h"
+#include "cra_dict.h"
+#include "cra_ifs.h"
+
+#define CRA_PERFECTDICT_CHECK_KEY(dict, key) assert((dict)->key_size == sizeof(*(key)))
+#define CRA_PERFECTDICT_CHECK_VAL(dict, val) assert((dict)->val_size == sizeof(*(val)))
+
+typedef struct CraPerfectDict CraPerfectDict;
+
+// 构建后不能修改(val除外)
+// key先按hash分到桶，每个桶找一个pilot，使桶内所有key的位置(hash, pilot)都落在空的entry上
+// 查找: 一次读pilot，一次读entry，没有冲突链
+struct CraPerfectDict
+{
+    unsigned char *entries; // count个，每个位置恰好一个key
+    uint32_t      *pilots;  // nbuckets个
+
+    ssize_t count;
+    ssize_t nbuckets;
+
+    size_t key_size;
+    size_t val_size;
+    size_t key_offset;
+    size_t val_offset;
+    size_t entry_size;
+
+    cra_hash_fn hash_key;
+    cra_cmp_fn  compare_key;
+};
+
+// keys和vals是连续的n个key和n个val，keys[i]对应vals[i]
+// 不同的key的hash必须不同(有重复的key或hash冲突时返回false)
+CRA_API bool
+cra_perfectdict_init_from_arrays(CraPerfectDict *dict,
+                                 size_t          key_size,
+                                 size_t          val_size,
+                                 size_t          key_align,
+                                 size_t          val_align,
+                                 const void     *keys,
+                                 const void     *vals,
+                                 size_t          n,
+                                 cra_hash_fn     hash_key,
+                                 cra_cmp_fn      compare_key);
+// bool init_from_arrays<TKey, TVal>(CraPerfectDict *dict, TKey keys[], TVal vals[], size_t n,
+// cra_hash_t (*hash)(const TKey *key), int (*compare)(const TKey *a, const TKey *b))
+#define cra_perfectdict_init_from_arrays(TKey, TVal, dict, keys, vals, n, hash_key_fn, compare_key_fn)          \
+    (assert(sizeof(TKey) == sizeof(*(keys))), assert(sizeof(TVal) == sizeof(*(vals))),                       \
+     cra_perfectdict_init_from_arrays(dict, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), keys, vals, \
+                                      n, (cra_hash_fn)(hash_key_fn), (cra_cmp_fn)(compare_key_fn)))
+
+// 复制src的所有key-val，使用src的hash_key和compare_key
+// 字典中的key互不相同，但hash冲突时依然会返回false
+CRA_API bool
+cra_perfectdict_init_from_dict(CraPerfectDict *dict, CraDict *src);
+
+CRA_API void
+cra_perfectdict_uninit(CraPerfectDict *dict);
+
+CRA_API void *
+cra_perfectdict_get_ref(CraPerfectDict *dict, const void *key);
+// TVal *get_ref(CraPerfectDict *dict, TKey *key)
+#define cra_perfectdict_get_ref(dict, key) (CRA_PERFECTDICT_CHECK_KEY(dict, key), cra_perfectdict_get_ref(dict, key))
+
+// hash必须等于dict->hash_key(key)
+CRA_API void *
+cra_perfectdict_get_ref_with_hash(CraPerfectDict *dict, const void *key, cra_hash_t hash);
+// TVal *get_ref_with_hash(CraPerfectDict *dict, TKey *key, cra_hash_t hash)
+#define cra_perfectdict_get_ref_with_hash(dict, key, hash) \
+    (CRA_PERFECTDICT_CHECK_KEY(dict, key), cra_perfectdict_get_ref_with_hash(dict, key, hash))
+
+static inline bool
+cra_perfectdict_get(CraPerfectDict *dict, const void *key, void *retval)
+{
+    void *pval = (cra_perfectdict_get_ref)(dict, key);
+    if (pval && retval)
+        memcpy(retval, pval, dict->val_size);
+    return pval != NULL;
+}
+// bool get(CraPerfectDict *dict, TKey *key, out TVal *retval)
+#define cra_perfectdict_get(dict, key, retval)                                  \
+    (CRA_PERFECTDICT_CHECK_KEY(dict, key), CRA_PERFECTDICT_CHECK_VAL(dict, retval), \
+     cra_perfectdict_get(dict, key, retval))
+
+// ====================================== interfaces ======================================
+
+// iterable
+
+CRA_API CRA_ITERABLE_DEF(cra_g_perfectdict_iterable_i);
+#define CRA_PERFECTDICT_ITERABLE_I (&cra_g_perfectdict_iterable_i)
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * @file cra_ringdq.h
+ * @author Cracal
+ * @brief 环形双端队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_RINGDQ_H__
+#define __CRA_RINGDQ_H__
+#include "cra_collects.h"
+#include "cra_ifs.h"
+
+#define CRA_RINGDQ_DEFAULT_CAPACITY 8
+
+#define CRA_RINGDQ_CHECK_VAL(dq, val) assert(sizeof(*(val)) == (dq)->itemsize)
+#define CRA_RINGDQ_PVAL(dq, index)    ((dq)->array + (((dq)->head + (index)) & (dq)->mask) * (dq)->itemsize)
+
+typedef struct CraRingdq CraRingdq;
+
+// 元素存放在一块连续的环形数组中，容量是2的幂，下标用掩码计算
+// 随机访问只需一次计算，没有CraDeque的两级查找。扩容时容量翻倍，会复制(移动)元素
+// 元素很多(扩容代价太大)时请使用CraDeque
+struct CraRingdq
+{
+    unsigned char *array;
+    size_t         head; // 第一个元素在array中的位置
+    size_t         count;
+    size_t         capacity; // 2的幂
+    size_t         mask;     // capacity - 1
+    size_t         itemsize;
+};
+
+// 一段连续的元素
+typedef struct CraRingdqSpan
+{
+    void  *array;
+    size_t count;
+} CraRingdqSpan;
+
+// init_capacity: 向上取2的幂，不小于CRA_RINGDQ_DEFAULT_CAPACITY
+CRA_API bool
+cra_ringdq_init_with_size(CraRingdq *dq, size_t itemsize, size_t init_capacity);
+// bool init_with_size<T>(CraRingdq *dq, size_t init_capacity)
+#define cra_ringdq_init_with_size(T, dq, init_capacity) cra_ringdq_init_with_size(dq, sizeof(T), init_capacity)
+// bool init<T>(CraRingdq *dq)
+#define cra_ringdq_init(T, dq)                          cra_ringdq_init_with_size(T, dq, CRA_RINGDQ_DEFAULT_CAPACITY)
+
+CRA_API void
+cra_ringdq_uninit(CraRingdq *dq);
+
+static inline void
+cra_ringdq_clear(CraRingdq *dq)
+{
+    dq->head = 0;
+    dq->count = 0;
+}
+
+// 容量扩大/缩小到能放下max(new_capacity, count)个元素的2的幂
+CRA_API bool
+cra_ringdq_reserve(CraRingdq *dq, size_t new_capacity);
+
+// 移动index前后较少的一侧
+CRA_API bool
+cra_ringdq_insert(CraRingdq *dq, size_t index, void *val);
+CRA_API bool
+cra_ringdq_push_front(CraRingdq *dq, void *val);
+CRA_API bool
+cra_ringdq_push_back(CraRingdq *dq, void *val);
+// bool insert(CraRingdq *dq, size_t index, T *val)
+#define cra_ringdq_insert(dq, index, val) (CRA_RINGDQ_CHECK_VAL(dq, val), cra_ringdq_insert(dq, index, val))
+// bool push_front(CraRingdq *dq, T *val)
+#define cra_ringdq_push_front(dq, val)    (CRA_RINGDQ_CHECK_VAL(dq, val), cra_ringdq_push_front(dq, val))
+// bool push_back(CraRingdq *dq, T *val)
+#define cra_ringdq_push_back(dq, val)     (CRA_RINGDQ_CHECK_VAL(dq, val), cra_ringdq_push_back(dq, val))
+
+// 一次在尾部添加n个元素，最多扩容一次，最多两次memcpy
+CRA_API bool
+cra_ringdq_push_back_n(CraRingdq *dq, void *vals, size_t n);
+// bool push_back_n(CraRingdq *dq, T vals[n], size_t n)
+#define cra_ringdq_push_back_n(dq, vals, n) (CRA_RINGDQ_CHECK_VAL(dq, vals), cra_ringdq_push_back_n(dq, vals, n))
+
+CRA_API bool
+cra_ringdq_pop_at(CraRingdq *dq, size_t index, void *retval);
+CRA_API bool
+cra_ringdq_pop_front(CraRingdq *dq, void *retval);
+CRA_API bool
+cra_ringdq_pop_back(CraRingdq *dq, void *retval);
+// bool pop_at(CraRingdq *dq, size_t index, out T *retval)
+#define cra_ringdq_pop_at(dq, index, retval) (CRA_RINGDQ_CHECK_VAL(dq, retval), cra_ringdq_pop_at(dq, index, retval))
+// bool pop_front(CraRingdq *dq, out T *retval)
+#define cra_ringdq_pop_front(dq, retval)     (CRA_RINGDQ_CHECK_VAL(dq, retval), cra_ringdq_pop_front(dq, retval))
+// bool pop_back(CraRingdq *dq, out T *retval)
+#define cra_ringdq_pop_back(dq, retval)      (CRA_RINGDQ_CHECK_VAL(dq, retval), cra_ringdq_pop_back(dq, retval))
+
+// 一次弹出头部n个元素。元素个数不足n时返回false，不弹出任何元素
+CRA_API bool
+cra_ringdq_pop_front_n(CraRingdq *dq, void *retvals, size_t n);
+// bool pop_front_n(CraRingdq *dq, out T retvals[n], size_t n)
+#define cra_ringdq_pop_front_n(dq, retvals, n)                                   \
+    (CRA_RINGDQ_CHECK_VAL(dq, retvals), cra_ringdq_pop_front_n(dq, retvals, n))
+
+// bool remove_at(CraRingdq *dq, size_t index)
+#define cra_ringdq_remove_at(dq, index)  (cra_ringdq_pop_at)(dq, index, NULL)
+// bool remove_front(CraRingdq *dq)
+#define cra_ringdq_remove_front(dq)      (cra_ringdq_pop_front)(dq, NULL)
+// bool remove_back(CraRingdq *dq)
+#define cra_ringdq_remove_back(dq)       (cra_ringdq_pop_back)(dq, NULL)
+// bool remove_front_n(CraRingdq *dq, size_t n)
+#define cra_ringdq_remove_front_n(dq, n) (cra_ringdq_pop_front_n)(dq, NULL, n)
+
+static inline void *
+cra_ringdq_get_ref(CraRingdq *dq, size_t index)
+{
+    assert(dq);
+    assert(dq->array);
+
+    if (index >= dq->count)
+        return NULL;
+    return CRA_RINGDQ_PVAL(dq, index);
+}
+
+static inline bool
+cra_ringdq_get(CraRingdq *dq, size_t index, void *retval)
+{
+    void *pval = cra_ringdq_get_ref(dq, index);
+    if (pval && retval)
+        memcpy(retval, pval, dq->itemsize);
+    return pval != NULL;
+}
+// bool get(CraRingdq *dq, size_t index, out T *retval)
+#define cra_ringdq_get(dq, index, retval) (CRA_RINGDQ_CHECK_VAL(dq, retval), cra_ringdq_get(dq, index, retval))
+
+// bool peek_front(CraRingdq *dq, out T *retval)
+#define cra_ringdq_peek_front(dq, retval) cra_ringdq_get(dq, 0, retval)
+// T *peek_front_ref(CraRingdq *dq)
+#define cra_ringdq_peek_front_ref(dq)     cra_ringdq_get_ref(dq, 0)
+// bool peek_back(CraRingdq *dq, out T *retval)
+#define cra_ringdq_peek_back(dq, retval)  cra_ringdq_get(dq, (dq)->count - 1, retval)
+// T *peek_back_ref(CraRingdq *dq)
+#define cra_ringdq_peek_back_ref(dq)      cra_ringdq_get_ref(dq, (dq)->count - 1)
+
+static inline bool
+cra_ringdq_get_and_set(CraRingdq *dq, size_t index, void *newval, void *retoldval)
+{
+    assert(newval);
+
+    void *pval = cra_ringdq_get_ref(dq, index);
+    if (pval)
+    {
+        if (retoldval)
+            memcpy(retoldval, pval, dq->itemsize);
+        memcpy(pval, newval, dq->itemsize);
+    }
+    return pval != NULL;
+}
+// bool get_and_set(CraRingdq *dq, size_t index, T *newval, out T *retoldval)
+#define cra_ringdq_get_and_set(dq, index, newval, retoldval)                \
+    (CRA_RINGDQ_CHECK_VAL(dq, newval), CRA_RINGDQ_CHECK_VAL(dq, retoldval), \
+     cra_ringdq_get_and_set(dq, index, newval, retoldval))
+
+// bool set(CraRingdq *dq, size_t index, T *newval)
+#define cra_ringdq_set(dq, index, newval)                                              \
+    (CRA_RINGDQ_CHECK_VAL(dq, newval), (cra_ringdq_get_and_set)(dq, index, newval, NULL))
+
+// 头部最多n个元素所在的连续内存，最多两段，返回段数(0/1/2)
+// 可以直接在原处处理这些元素，处理完后用cra_ringdq_remove_front_n移除
+// 修改队列后spans失效
+static inline size_t
+cra_ringdq_peek_spans(CraRingdq *dq, size_t n, CraRingdqSpan spans[2])
+{
+    size_t first;
+
+    assert(dq);
+    assert(dq->array);
+    assert(spans);
+
+    if (n > dq->count)
+        n = dq->count;
+    if (n == 0)
+        return 0;
+
+    first = dq->capacity - dq->head;
+    spans[0].array = dq->array + dq->head * dq->itemsize;
+    if (n <= first)
+    {
+        spans[0].count = n;
+        return 1;
+    }
+    spans[0].count = first;
+    spans[1].array = dq->array;
+    spans[1].count = n - first;
+    return 2;
+}
+
+CRA_API bool
+cra_ringdq_reverse(CraRingdq *dq);
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+typedef struct CraRingdqInitializableParam
+{
+    size_t itemsize;
+} CraRingdqInitializableParam;
+#define CRA_RINGDQ_INITIALIZABLE_PARAM_INIT(T)        { sizeof(T) }
+#define CRA_RINGDQ_INITIALIZABLE_PARAM_DECL(var_name) CraRingdqInitializableParam var_name
+#define CRA_RINGDQ_INITIALIZABLE_PARAM_DEF(var_name, T)                                    \
+    CRA_RINGDQ_INITIALIZABLE_PARAM_DECL(var_name) = CRA_RINGDQ_INITIALIZABLE_PARAM_INIT(T)
+
+CRA_API CRA_INITIALIZABLE_DEF(cra_g_ringdq_initializable_i);
+#define CRA_RINGDQ_INITIALIZABLE_I (&cra_g_ringdq_initializable_i)
+
+// appendable
+
+CRA_API CRA_APPENDABLE_DEF(cra_g_ringdq_appendable_i);
+#define CRA_RINGDQ_APPENDABLE_I (&cra_g_ringdq_appendable_i)
+
+// iterable
+
+CRA_API CRA_ITERABLE_DEF(cra_g_ringdq_iterable_i);
+#define CRA_RINGDQ_ITERABLE_I (&cra_g_ringdq_iterable_i)
+
+#endif
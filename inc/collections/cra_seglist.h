@@ -0,0 +1,169 @@
+/**
+ * @file cra_seglist.h
+ * @author Cracal
+ * @brief 分段数组
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_SEGLIST_H__
+#define __CRA_SEGLIST_H__
+#include "cra_collects.h"
+#include "cra_ifs.h"
+
+// 默认每段的字节数
+#define CRA_SEGLIST_SEGMENT_BYTES 65536
+
+#define CRA_SEGLIST_CHECK_VAL(list, val) assert(sizeof(*(val)) == (list)->itemsize)
+#define CRA_SEGLIST_PVAL(list, index)                                                                  \
+    ((list)->segments[(index) >> (list)->seg_shift] + ((index) & (list)->seg_mask) * (list)->itemsize)
+
+typedef struct CraSegList CraSegList;
+
+// 元素存放在固定大小的段中，段的指针存放在目录中
+// 扩容时只添加新段(目录中的指针可能被realloc)，已有元素不会被复制，地址也不会改变
+// 注意: insert/pop_at会移动index之后的元素
+struct CraSegList
+{
+    unsigned char **segments; // 目录
+    size_t          nsegments;
+    size_t          dir_capacity;
+    size_t          count;
+    size_t          itemsize;
+    size_t          seg_items; // 每段的元素个数，2的幂
+    size_t          seg_mask;
+    unsigned int    seg_shift;
+};
+
+// seg_items: 每段的元素个数，向上取2的幂。为0时每段大约CRA_SEGLIST_SEGMENT_BYTES字节
+CRA_API bool
+cra_seglist_init_with_size(CraSegList *list, size_t itemsize, size_t seg_items);
+// bool init_with_size<T>(CraSegList *list, size_t seg_items)
+#define cra_seglist_init_with_size(T, list, seg_items) cra_seglist_init_with_size(list, sizeof(T), seg_items)
+// bool init<T>(CraSegList *list)
+#define cra_seglist_init(T, list)                      cra_seglist_init_with_size(T, list, 0)
+
+CRA_API void
+cra_seglist_uninit(CraSegList *list);
+
+// 不释放段
+static inline void
+cra_seglist_clear(CraSegList *list)
+{
+    list->count = 0;
+}
+
+static inline size_t
+cra_seglist_capacity(CraSegList *list)
+{
+    return list->nsegments * list->seg_items;
+}
+
+// 容量扩大/缩小到能放下max(new_capacity, count)个元素的段数
+CRA_API bool
+cra_seglist_reserve(CraSegList *list, size_t new_capacity);
+
+CRA_API bool
+cra_seglist_insert(CraSegList *list, size_t index, void *val);
+// bool insert(CraSegList *list, size_t index, T *val)
+#define cra_seglist_insert(list, index, val) (CRA_SEGLIST_CHECK_VAL(list, val), cra_seglist_insert(list, index, val))
+// bool prepend(CraSegList *list, T *val)
+#define cra_seglist_prepend(list, val)       cra_seglist_insert(list, 0, val)
+
+CRA_API bool
+cra_seglist_append(CraSegList *list, void *val);
+// bool append(CraSegList *list, T *val)
+#define cra_seglist_append(list, val) (CRA_SEGLIST_CHECK_VAL(list, val), cra_seglist_append(list, val))
+
+CRA_API bool
+cra_seglist_pop_at(CraSegList *list, size_t index, void *retval);
+// bool pop_at(CraSegList *list, size_t index, out T *retval)
+#define cra_seglist_pop_at(list, index, retval)                                      \
+    (CRA_SEGLIST_CHECK_VAL(list, retval), cra_seglist_pop_at(list, index, retval))
+// bool pop_front(CraSegList *list, out T *retval)
+#define cra_seglist_pop_front(list, retval) cra_seglist_pop_at(list, 0, retval)
+// bool pop_back(CraSegList *list, out T *retval)
+#define cra_seglist_pop_back(list, retval)  cra_seglist_pop_at(list, (list)->count - 1, retval)
+
+// bool remove_at(CraSegList *list, size_t index)
+#define cra_seglist_remove_at(list, index) (cra_seglist_pop_at)(list, index, NULL)
+// bool remove_front(CraSegList *list)
+#define cra_seglist_remove_front(list)     cra_seglist_remove_at(list, 0)
+// bool remove_back(CraSegList *list)
+#define cra_seglist_remove_back(list)      cra_seglist_remove_at(list, (list)->count - 1)
+
+static inline void *
+cra_seglist_get_ref(CraSegList *list, size_t index)
+{
+    assert(list);
+    assert(list->segments);
+    assert(list->itemsize > 0);
+
+    if (index >= list->count)
+        return NULL;
+    return CRA_SEGLIST_PVAL(list, index);
+}
+
+static inline bool
+cra_seglist_get(CraSegList *list, size_t index, void *retval)
+{
+    void *val = cra_seglist_get_ref(list, index);
+    if (val && retval)
+        memcpy(retval, val, list->itemsize);
+    return val != NULL;
+}
+// bool get(CraSegList *list, size_t index, out T *retval)
+#define cra_seglist_get(list, index, retval) (CRA_SEGLIST_CHECK_VAL(list, retval), cra_seglist_get(list, index, retval))
+
+static inline bool
+cra_seglist_get_and_set(CraSegList *list, size_t index, void *newval, void *retoldval)
+{
+    assert(newval);
+
+    void *pval = cra_seglist_get_ref(list, index);
+    if (pval)
+    {
+        if (retoldval)
+            memcpy(retoldval, pval, list->itemsize);
+        memcpy(pval, newval, list->itemsize);
+    }
+    return pval != NULL;
+}
+// bool get_and_set(CraSegList *list, size_t index, T *newval, out T *retoldval)
+#define cra_seglist_get_and_set(list, index, newval, retoldval)                   \
+    (CRA_SEGLIST_CHECK_VAL(list, newval), CRA_SEGLIST_CHECK_VAL(list, retoldval), \
+     cra_seglist_get_and_set(list, index, newval, retoldval))
+
+// bool set(CraSegList *list, size_t index, T *newval)
+#define cra_seglist_set(list, index, newval)                                                    \
+    (CRA_SEGLIST_CHECK_VAL(list, newval), (cra_seglist_get_and_set)(list, index, newval, NULL))
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+typedef struct CraSegListInitializableParam
+{
+    size_t itemsize;
+} CraSegListInitializableParam;
+#define CRA_SEGLIST_INITIALIZABLE_PARAM_INIT(T)        { sizeof(T) }
+#define CRA_SEGLIST_INITIALIZABLE_PARAM_DECL(var_name) CraSegListInitializableParam var_name
+#define CRA_SEGLIST_INITIALIZABLE_PARAM_DEF(var_name, T)                                     \
+    CRA_SEGLIST_INITIALIZABLE_PARAM_DECL(var_name) = CRA_SEGLIST_INITIALIZABLE_PARAM_INIT(T)
+
+CRA_API CRA_INITIALIZABLE_DEF(cra_g_seglist_initializable_i);
+#define CRA_SEGLIST_INITIALIZABLE_I (&cra_g_seglist_initializable_i)
+
+// appendable
+
+CRA_API CRA_APPENDABLE_DEF(cra_g_seglist_appendable_i);
+#define CRA_SEGLIST_APPENDABLE_I (&cra_g_seglist_appendable_i)
+
+// iterable
+
+CRA_API CRA_ITERABLE_DEF(cra_g_seglist_iterable_i);
+#define CRA_SEGLIST_ITERABLE_I (&cra_g_seglist_iterable_i)
+
+#endif
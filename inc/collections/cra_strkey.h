@@ -0,0 +1,86 @@
+/**
+ * @file cra_strkey.h
+ * @author Cracal
+ * @brief 带长度和hash的字符串key
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_STRKEY_H__
+#define __CRA_STRKEY_H__
+#include "cra_collects.h"
+
+// 内联存放的最大长度(不含'\0')
+#define CRA_STRKEY_INLINE_MAX 19
+
+typedef struct CraStrKey CraStrKey;
+
+// 64位下32字节，创建时算好hash
+// 长度 <= CRA_STRKEY_INLINE_MAX 时字符串直接存放在key中，否则small中存放指向堆内存的指针
+// 字典中比较key时先比较hash和长度，都相等时才memcmp
+struct CraStrKey
+{
+    cra_hash_t hash;
+    uint32_t   len;
+    char       small[CRA_STRKEY_INLINE_MAX + 1];
+};
+
+// 复制str的前len个字符(中间不能有'\0')
+// 长字符串申请内存失败时返回false
+CRA_API bool
+cra_strkey_init(CraStrKey *key, const char *str, size_t len);
+
+static inline bool
+cra_strkey_init_cstr(CraStrKey *key, const char *str)
+{
+    return cra_strkey_init(key, str, strlen(str));
+}
+
+// 只用于查找的临时key: 长字符串不复制，直接引用str
+// 不能放进字典，也不需要(不能)uninit
+CRA_API void
+cra_strkey_view(CraStrKey *key, const char *str, size_t len);
+
+static inline void
+cra_strkey_view_cstr(CraStrKey *key, const char *str)
+{
+    cra_strkey_view(key, str, strlen(str));
+}
+
+CRA_API void
+cra_strkey_uninit(CraStrKey *key);
+
+// 以'\0'结尾(view引用的str除外)
+static inline const char *
+cra_strkey_str(const CraStrKey *key)
+{
+    const char *str;
+    if (key->len <= CRA_STRKEY_INLINE_MAX)
+        return key->small;
+    memcpy((void *)&str, key->small, sizeof(str));
+    return str;
+}
+
+static inline cra_hash_t
+cra_hash_strkey_p(const CraStrKey *key)
+{
+    return key->hash;
+}
+
+// 只判断是否相等时很快
+// 注意: 顺序不是字典序(先按hash，再按长度)，不能用于排序显示
+static inline int
+cra_cmp_strkey_p(const CraStrKey *a, const CraStrKey *b)
+{
+    if (a->hash != b->hash)
+        return a->hash < b->hash ? -1 : 1;
+    if (a->len != b->len)
+        return a->len < b->len ? -1 : 1;
+    if (a->len <= CRA_STRKEY_INLINE_MAX)
+        return memcmp(a->small, b->small, a->len);
+    return memcmp(cra_strkey_str(a), cra_strkey_str(b), a->len);
+}
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file cra_swissdict.h
+ * @author Cracal
+ * @brief 开放寻址字典(SwissTable)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_SWISSDICT_H__
+#define __CRA_SWISSDICT_H__
+#include <stdalign.h>
+#include "cra_collects.h"
+#include "cra_ifs.h"
+
+#define CRA_SWISSDICT_DEFAULT_CAPACITY 16
+#define CRA_SWISSDICT_GROUP_WIDTH      16
+
+#define CRA_SWISSDICT_CHECK_KEY(dict, key) assert((dict)->key_size == sizeof(*(key)))
+#define CRA_SWISSDICT_CHECK_VAL(dict, val) assert((dict)->val_size == sizeof(*(val)))
+
+typedef struct CraSwissDict CraSwissDict;
+
+// 每个slot对应一个控制字节:
+//   EMPTY(-128) / DELETED(-2) / FULL(0 ~ 127, hash的低7位)
+// ctrl尾部额外镜像了前GROUP_WIDTH个字节, 以便从任意位置读取一整组
+struct CraSwissDict
+{
+    int8_t        *ctrl;
+    unsigned char *slots;
+
+    ssize_t count;
+    ssize_t capacity; // 2的幂
+    ssize_t growth_left;
+
+    size_t key_size;
+    size_t val_size;
+    size_t key_offset;
+    size_t val_offset;
+    size_t slot_size;
+
+    cra_hash_fn hash_key;
+    cra_cmp_fn  compare_key;
+};
+
+CRA_API bool
+cra_swissdict_init_with_size(CraSwissDict *dict,
+                             size_t        key_size,
+                             size_t        val_size,
+                             size_t        key_align,
+                             size_t        val_align,
+                             size_t        init_capacity,
+                             cra_hash_fn   hash_key,
+                             cra_cmp_fn    compare_key);
+// bool init_with_size<TKey, TVal>(CraSwissDict *dict, size_t init_capacity, cra_hash_t (*hash)(const TKey *key),
+// int (*compare)(const TKey *a, const TKey *b))
+#define cra_swissdict_init_with_size(TKey, TVal, dict, init_capacity, hash_key_fn, compare_key_fn)              \
+    cra_swissdict_init_with_size(dict, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), init_capacity, \
+                                 (cra_hash_fn)(hash_key_fn), (cra_cmp_fn)(compare_key_fn))
+// bool init<TKey, TVal>(CraSwissDict *dict, cra_hash_t (*hash)(const TKey *key),
+// int (*compare)(const TKey *a, const TKey *b))
+#define cra_swissdict_init(TKey, TVal, dict, hash_key_fn, compare_key_fn)                                       \
+    cra_swissdict_init_with_size(TKey, TVal, dict, CRA_SWISSDICT_DEFAULT_CAPACITY, hash_key_fn, compare_key_fn)
+
+CRA_API void
+cra_swissdict_uninit(CraSwissDict *dict);
+
+CRA_API void
+cra_swissdict_clear(CraSwissDict *dict);
+
+CRA_API bool
+cra_swissdict_reserve(CraSwissDict *dict, ssize_t new_capacity);
+
+CRA_API bool
+cra_swissdict_put_and_return_kv(CraSwissDict *dict, void *key, void *val, void *retoldkey, void *retoldval, bool add);
+// bool put_and_return_kv(CraSwissDict *dict, TKey *key, TVal *val, out TKey *retoldkey, out TVal *retoldval)
+#define cra_swissdict_put_and_return_kv(dict, key, val, retoldkey, retoldval)                                 \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_VAL(dict, val),                                  \
+     CRA_SWISSDICT_CHECK_KEY(dict, retoldkey), CRA_SWISSDICT_CHECK_VAL(dict, retoldval),                      \
+     cra_swissdict_put_and_return_kv(dict, key, val, retoldkey, retoldval, false))
+// bool put_and_return_v(CraSwissDict *dict, TKey *key, TVal *val, out TVal *retoldval)
+#define cra_swissdict_put_and_return_v(dict, key, val, retoldval)                                        \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_VAL(dict, val),                             \
+     CRA_SWISSDICT_CHECK_VAL(dict, retoldval),                                                           \
+     (cra_swissdict_put_and_return_kv)(dict, key, val, NULL, retoldval, false))
+// bool put(CraSwissDict *dict, TKey *key, TVal *val)
+#define cra_swissdict_put(dict, key, val)                                        \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_VAL(dict, val),     \
+     (cra_swissdict_put_and_return_kv)(dict, key, val, NULL, NULL, false))
+// bool add(CraSwissDict *dict, TKey *key, TVal *val)
+#define cra_swissdict_add(dict, key, val)                                       \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_VAL(dict, val),    \
+     (cra_swissdict_put_and_return_kv)(dict, key, val, NULL, NULL, true))
+
+CRA_API bool
+cra_swissdict_pop_kv(CraSwissDict *dict, const void *key, void *retkey, void *retval);
+// bool pop_kv(CraSwissDict *dict, TKey *key, out TKey *retkey, out TVal *retval)
+#define cra_swissdict_pop_kv(dict, key, retkey, retval)                                  \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_KEY(dict, retkey),          \
+     CRA_SWISSDICT_CHECK_VAL(dict, retval), cra_swissdict_pop_kv(dict, key, retkey, retval))
+// bool pop(CraSwissDict *dict, TKey *key, out TVal *retval)
+#define cra_swissdict_pop(dict, key, retval)                                      \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_VAL(dict, retval),   \
+     (cra_swissdict_pop_kv)(dict, key, NULL, retval))
+// bool remove(CraSwissDict *dict, TKey *key)
+#define cra_swissdict_remove(dict, key)                                           \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), (cra_swissdict_pop_kv)(dict, key, NULL, NULL))
+
+CRA_API void *
+cra_swissdict_get_ref(CraSwissDict *dict, const void *key);
+// TVal *get_ref(CraSwissDict *dict, TKey *key)
+#define cra_swissdict_get_ref(dict, key) (CRA_SWISSDICT_CHECK_KEY(dict, key), cra_swissdict_get_ref(dict, key))
+
+static inline bool
+cra_swissdict_get(CraSwissDict *dict, const void *key, void *retval)
+{
+    void *pval = (cra_swissdict_get_ref)(dict, key);
+    if (pval && retval)
+        memcpy(retval, pval, dict->val_size);
+    return pval != NULL;
+}
+// bool get(CraSwissDict *dict, TKey *key, out TVal *retval)
+#define cra_swissdict_get(dict, key, retval)                                     \
+    (CRA_SWISSDICT_CHECK_KEY(dict, key), CRA_SWISSDICT_CHECK_VAL(dict, retval),  \
+     cra_swissdict_get(dict, key, retval))
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+typedef struct CraSwissDictInitializableParam
+{
+    size_t      key_size;
+    size_t      val_size;
+    size_t      key_align;
+    size_t      val_align;
+    cra_cmp_fn  compare_key;
+    cra_hash_fn hash_key;
+} CraSwissDictInitializableParam;
+#define CRA_SWISSDICT_INITIALIZABLE_PARAM_INIT(TKey, TVal, hash_key_fn, compare_key_fn) \
+    {                                                                                   \
+        sizeof(TKey),                                                                   \
+        sizeof(TVal),                                                                   \
+        alignof(TKey),                                                                  \
+        alignof(TVal),                                                                  \
+        (cra_cmp_fn)(compare_key_fn),                                                   \
+        (cra_hash_fn)(hash_key_fn)                                                      \
+    }
+#define CRA_SWISSDICT_INITIALIZABLE_PARAM_DECL(var_name) CraSwissDictInitializableParam var_name
+#define CRA_SWISSDICT_INITIALIZABLE_PARAM_DEF(var_name, TKey, TVal, hash_key_fn, compare_key_fn) \
+    CRA_SWISSDICT_INITIALIZABLE_PARAM_DECL(var_name) =                                           \
+      CRA_SWISSDICT_INITIALIZABLE_PARAM_INIT(TKey, TVal, hash_key_fn, compare_key_fn)
+
+CRA_API CRA_INITIALIZABLE_DEF(cra_g_swissdict_initializable_i);
+#define CRA_SWISSDICT_INITIALIZABLE_I (&cra_g_swissdict_initializable_i)
+
+// appendable
+
+CRA_API CRA_APPENDABLE_DEF(cra_g_swissdict_appendable_i);
+#define CRA_SWISSDICT_APPENDABLE_I (&cra_g_swissdict_appendable_i)
+
+// iterable
+
+CRA_API CRA_ITERABLE_DEF(cra_g_swissdict_iterable_i);
+#define CRA_SWISSDICT_ITERABLE_I (&cra_g_swissdict_iterable_i)
+
+#endif
@@ -276,6 +276,13 @@ cra_atomic_flag_clear(cra_atomic_flag_t *p, CraMO_e mo)
     atomic_flag_clear_explicit(p, mo);
 }
 
+// memory fence
+static inline void
+cra_atomic_thread_fence(CraMO_e mo)
+{
+    atomic_thread_fence(mo);
+}
+
 #elif defined(CRA_USE___ATOMIC)
 
 // return *p
@@ -432,6 +439,13 @@ cra_atomic_flag_clear(cra_atomic_flag_t *p, CraMO_e mo)
     __atomic_clear(p, mo);
 }
 
+// memory fence
+static inline void
+cra_atomic_thread_fence(CraMO_e mo)
+{
+    __atomic_thread_fence(mo);
+}
+
 #elif defined(CRA_USE_INTERLOCKED)
 
 // return *p
@@ -652,6 +666,14 @@ cra_atomic_flag_clear(cra_atomic_flag_t *p, CraMO_e mo)
     InterlockedAnd8(p, 0);
 }
 
+// memory fence
+static inline void
+cra_atomic_thread_fence(CraMO_e mo)
+{
+    CRA_UNUSED(mo);
+    MemoryBarrier();
+}
+
 #elif defined(CRA_USE___SYNC)
 
 // return *p
@@ -872,6 +894,14 @@ cra_atomic_flag_clear(cra_atomic_flag_t *p, CraMO_e mo)
     __sync_lock_release(p);
 }
 
+// memory fence
+static inline void
+cra_atomic_thread_fence(CraMO_e mo)
+{
+    CRA_UNUSED(mo);
+    __sync_synchronize();
+}
+
 #endif
 
 // ========================== generic ==========================
@@ -159,8 +159,21 @@ cra_set_last_error(int err)
 
 #define CRA_BITS(x) (1 << (x))
 
+// 缓存行大小(x86_64)
+#define CRA_CACHELINE_SIZE 64
+
 #define CRA_UNUSED(p) (void)(p)
 
+// 软件预取(读, 放入所有级别的缓存)
+#if defined(CRA_COMPILER_GNUC)
+#define cra_prefetch(addr) __builtin_prefetch((addr), 0, 3)
+#elif defined(CRA_COMPILER_MSVC)
+#include <xmmintrin.h>
+#define cra_prefetch(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#else
+#define cra_prefetch(addr) CRA_UNUSED(addr)
+#endif
+
 #define CRA_MAX(a, b)          ((a) > (b) ? (a) : (b))
 #define CRA_MIN(a, b)          ((a) < (b) ? (a) : (b))
 #define CRA_CLAMP(v, max, min) ((v) > (max) ? (max) : ((v) < (min) ? (min) : (v)))
@@ -76,4 +76,12 @@ cra_basename(char *path);
 CRA_API char *
 cra_dirname(char *path);
 
+// 把整个文件只读映射到内存，retsize返回文件大小
+// 失败或文件为空时返回NULL
+CRA_API const void *
+cra_mmap_file_readonly(const char *path, size_t *retsize);
+
+CRA_API void
+cra_munmap_file(const void *addr, size_t size);
+
 #endif
\ No newline at end of file
@@ -110,6 +110,32 @@ __cra_memory_leak_report(void);
 #define cra_new(Type) (Type *)cra_alloc(Type)
 #define cra_delete    cra_dealloc
 
+// 多申请align - 1 + sizeof(void *)字节，返回对齐后的地址，原始指针存在它前面
+static inline void *
+__cra_aligned_setup(void *raw, size_t align)
+{
+    uintptr_t addr;
+
+    assert(align > 0 && (align & (align - 1)) == 0);
+    if (raw == NULL)
+        return NULL;
+    addr = ((uintptr_t)raw + sizeof(void *) + align - 1) & ~(uintptr_t)(align - 1);
+    ((void **)addr)[-1] = raw;
+    return (void *)addr;
+}
+
+// 按align(2的幂)对齐申请内存，用于超过max_align_t对齐要求的类型。只能用cra_aligned_free释放
+#define cra_aligned_malloc(size, align) __cra_aligned_setup(cra_malloc((size) + (align) - 1 + sizeof(void *)), align)
+
+// 与free(NULL)一样，ptr为NULL时什么也不做
+static inline void
+cra_aligned_free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+    cra_free(((void **)ptr)[-1]);
+}
+
 #define CRA_TEMP_NEW(name, size)        \
     char *name, name##_small[1024];     \
     if ((size) <= sizeof(name##_small)) \
@@ -15,9 +15,11 @@
 typedef struct CraMemPool
 {
     size_t   item_size;
+    size_t   item_stride; // 块中相邻对象的间距，至少能放下一个指针
     size_t   items_per_block;
-    CraAList blocks; // AList<BLOCK *>
-    CraAList stack;  // AList<ITEM *>
+    size_t   nfree;
+    void    *free_list; // 空闲对象链表，next指针存放在对象自身的内存中
+    CraAList blocks;    // AList<BLOCK *>
 } CraMemPool;
 
 CRA_API bool
@@ -30,6 +32,14 @@ cra_mempool_uninit(CraMemPool *pool);
 CRA_API void
 cra_mempool_uninit_no_check(CraMemPool *pool);
 
+// 所有对象都空闲时释放除第一块以外的内存块，否则什么都不做并返回false
+CRA_API bool
+cra_mempool_trim(CraMemPool *pool);
+
+// 释放所有对象都空闲的内存块，返回释放的块数
+CRA_API size_t
+cra_mempool_release_unused(CraMemPool *pool);
+
 CRA_API void *
 cra_mempool_alloc(CraMemPool *pool);
 
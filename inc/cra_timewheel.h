@@ -87,7 +87,11 @@ cra_timer_base_set_timeout(CraTimer_base *base, uint32_t timeout_ms)
 
 #endif // end timer
 
-typedef struct CraLList CraLList;
+typedef struct CraLList   CraLList;
+typedef struct CraMemPool CraMemPool;
+
+// 每个节点池内存块的节点数
+#define CRA_TIMEWHEEL_NODES_PER_SLAB 256
 
 struct CraTimewheel
 {
@@ -95,7 +99,7 @@ struct CraTimewheel
     uint32_t      current;
     uint32_t      wheel_size;
     CraLList     *wheel_buckets; // [CraLList<CraTimer_base *>]
-    CraLList     *freenodelist;  // CraLList<CraLListNode<CraTimer_base *> *>
+    CraMemPool   *nodepool;      // 所有层的槽共享的节点池
     CraTimewheel *upper_wheel;
 };
 
@@ -105,6 +109,7 @@ cra_timewheel_init(CraTimewheel *wheel, uint32_t tick_ms, uint32_t wheel_size);
 CRA_API void
 cra_timewheel_uninit(CraTimewheel *wheel);
 
+// 释放节点池中所有节点都空闲的内存块
 CRA_API void
 cra_timewheel_release_all_free_timers(CraTimewheel *wheel);
 
@@ -37,6 +37,12 @@ cra_bin_serialize_err(unsigned char *buf, size_t *len, CraSeriObject *obj, CraSe
 CRA_API bool
 cra_bin_deserialize_err(unsigned char *buf, size_t len, CraSeriObject *retobj, CraSerErr *err);
 
+// 字符串指针字段(char *)不再单独申请内存，而是指向intern中的驻留字符串
+// 相同内容的字段共享同一个指针，用户不能释放这些字段，它们在cra_intern_uninit之前一直有效
+CRA_API bool
+cra_bin_deserialize_with_intern(unsigned char *buf, size_t len, CraSeriObject *retobj, CraIntern *intern,
+                                CraSerErr *err);
+
 static inline bool
 cra_bin_serialize(unsigned char *buf, size_t *len, CraSeriObject *obj)
 {
@@ -16,6 +16,7 @@
 typedef struct CraSeriObject CraSeriObject;
 typedef struct CraTypeMeta   CraTypeMeta;
 typedef struct CraSerErr     CraSerErr;
+typedef struct CraIntern     CraIntern; // threads/cra_intern.h
 
 typedef enum
 {
@@ -287,6 +288,7 @@ struct CraSerializer
 #endif
     CraReleaseMgr release;
     CraSerErr     error;
+    CraIntern    *intern; // 非NULL时反序列化的字符串指针字段使用驻留字符串
 };
 
 static inline void
@@ -425,6 +427,7 @@ cra_serializer_init(CraSerializer *ser, char *buffer, size_t maxlen, bool format
     ser->buffer = buffer;
     ser->error.err = CRA_SER_ERR_OK;
     ser->error.msg[0] = '\0';
+    ser->intern = NULL;
     cra_release_mgr_init(&ser->release);
 }
 
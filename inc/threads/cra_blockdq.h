@@ -75,6 +75,18 @@ cra_blockdq_push_back(CraBlockdq *deque, void *val, void *retdrop);
 #define cra_blockdq_push_back(deque, val, retdrop)                                  \
     (CRA_BLOCKDQ_CHECK_VAL(deque, val), cra_blockdq_push_back(deque, val, retdrop))
 
+CRA_API bool
+cra_blockdq_try_push_back(CraBlockdq *deque, void *val);
+// bool try_push_back(CraBlockdq *deque, T *val)
+//
+// Never blocks or drops, whatever the full policy is.
+// returns:
+//      true:  val is pushed
+//      false: 1. failed to push val to deque
+//             2. deque is closed for enqueue
+//             3. deque is full
+#define cra_blockdq_try_push_back(deque, val) (CRA_BLOCKDQ_CHECK_VAL(deque, val), cra_blockdq_try_push_back(deque, val))
+
 CRA_API bool
 cra_blockdq_push_front(CraBlockdq *deque, void *val, void *retdrop);
 // bool push_front(CraBlockdq *deque, T *val, out T *retdrop)
@@ -89,6 +101,25 @@ cra_blockdq_push_front(CraBlockdq *deque, void *val, void *retdrop);
 #define cra_blockdq_push_front(deque, val, retdrop)                                  \
     (CRA_BLOCKDQ_CHECK_VAL(deque, val), cra_blockdq_push_front(deque, val, retdrop))
 
+CRA_API size_t
+cra_blockdq_push_back_n(CraBlockdq *deque, void *vals, size_t n, void *retdrops, size_t *retndrop);
+// size_t push_back_n(CraBlockdq *deque, T vals[n], size_t n, out T retdrops[n], out size_t *retndrop)
+//
+// Same as calling push_back n times, but the lock is taken once and waiters are signaled once.
+// With CRA_BLOCKDQ_FULL_WAIT, pushed items are signaled before waiting for free space.
+// retdrops:
+//      dropped values (at most n) if full policy is CRA_BLOCKDQ_FULL_DROP_NEWEST or CRA_BLOCKDQ_FULL_DROP_OLDEST.
+//      can be NULL.
+// retndrop:
+//      number of dropped values. can be NULL.
+// returns:
+//      number of values pushed, less than n if
+//             1. failed to push val to deque
+//             2. deque is closed for enqueue
+//             3. deque is full and full policy is CRA_BLOCKDQ_FULL_RETURN_FALSE
+#define cra_blockdq_push_back_n(deque, vals, n, retdrops, retndrop)                                  \
+    (CRA_BLOCKDQ_CHECK_VAL(deque, vals), cra_blockdq_push_back_n(deque, vals, n, retdrops, retndrop))
+
 CRA_API bool
 cra_blockdq_pop_back(CraBlockdq *deque, void *retval);
 // bool pop_back(CraBlockdq *deque, out T *retval)
@@ -100,4 +131,28 @@ cra_blockdq_pop_front(CraBlockdq *deque, void *retval);
 #define cra_blockdq_pop_front(deque, retval)                                     \
     (CRA_BLOCKDQ_CHECK_VAL(deque, retval), cra_blockdq_pop_front(deque, retval))
 
+CRA_API size_t
+cra_blockdq_pop_front_n(CraBlockdq *deque, void *retvals, size_t max, int timeout_ms);
+// size_t pop_front_n(CraBlockdq *deque, out T retvals[max], size_t max, int timeout_ms)
+//
+// Wait until deque is not empty, then pop up to max values with the lock taken once.
+// timeout_ms:
+//      < 0: wait forever
+//      = 0: do not wait
+// returns:
+//      number of values popped. 0 if timed out, or deque is closed for dequeue and empty
+#define cra_blockdq_pop_front_n(deque, retvals, max, timeout_ms)                                     \
+    (CRA_BLOCKDQ_CHECK_VAL(deque, retvals), cra_blockdq_pop_front_n(deque, retvals, max, timeout_ms))
+
+CRA_API size_t
+cra_blockdq_drain(CraBlockdq *deque, CraDeque *retdeque);
+// size_t drain(CraBlockdq *deque, out CraDeque<T> *retdeque)
+//
+// Take all values without waiting. The storage is swapped with retdeque,
+// so the lock is held in O(1) no matter how many values there are.
+// retdeque:
+//      an initialized, empty deque with the same itemsize. holds all values on return.
+// returns:
+//      number of values taken
+
 #endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+ * @file cra_cdict.h
+ * @author Cracal
+ * @brief 并发字典(分片+读写锁)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_CDICT_H__
+#define __CRA_CDICT_H__
+#include "collections/cra_dict.h"
+#include "cra_lock.h"
+
+#define CRA_CDICT_DEFAULT_SHARDS 64
+
+#define CRA_CDICT_CHECK_KEY(cdict, key) assert((cdict)->key_size == sizeof(*(key)))
+#define CRA_CDICT_CHECK_VAL(cdict, val) assert((cdict)->val_size == sizeof(*(val)))
+
+typedef struct CraCDictShard     CraCDictShard;
+typedef struct CraConcurrentDict CraConcurrentDict;
+
+// 每个分片独占缓存行，避免相邻分片的锁互相伪共享
+struct CraCDictShard
+{
+    alignas(CRA_CACHELINE_SIZE) cra_rwlock_t lock;
+    CraDict dict;
+};
+
+struct CraConcurrentDict
+{
+    CraCDictShard *shards;
+    size_t         nshards; // 2的幂
+    unsigned int   shard_shift;
+
+    size_t key_size;
+    size_t val_size;
+
+    cra_hash_fn hash_key;
+};
+
+// 在写锁内计算key对应的val
+// 返回false表示不插入
+typedef bool (*cra_cdict_compute_fn)(const void *key, void *retval, void *arg);
+
+CRA_API bool
+cra_cdict_init_with_size(CraConcurrentDict *cdict,
+                         size_t             key_size,
+                         size_t             val_size,
+                         size_t             key_align,
+                         size_t             val_align,
+                         size_t             init_capacity,
+                         size_t             nshards,
+                         cra_hash_fn        hash_key,
+                         cra_cmp_fn         compare_key);
+// bool init_with_size<TKey, TVal>(CraConcurrentDict *cdict, size_t init_capacity, size_t nshards,
+// cra_hash_t (*hash)(const TKey *key), int (*compare)(const TKey *a, const TKey *b))
+#define cra_cdict_init_with_size(TKey, TVal, cdict, init_capacity, nshards, hash_key_fn, compare_key_fn)              \
+    cra_cdict_init_with_size(cdict, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), init_capacity, nshards, \
+                             (cra_hash_fn)(hash_key_fn), (cra_cmp_fn)(compare_key_fn))
+// bool init<TKey, TVal>(CraConcurrentDict *cdict, cra_hash_t (*hash)(const TKey *key),
+// int (*compare)(const TKey *a, const TKey *b))
+#define cra_cdict_init(TKey, TVal, cdict, hash_key_fn, compare_key_fn)                                \
+    cra_cdict_init_with_size(TKey, TVal, cdict, CRA_DICT_DEAFULT_CAPACITY, CRA_CDICT_DEFAULT_SHARDS, \
+                             hash_key_fn, compare_key_fn)
+
+CRA_API void
+cra_cdict_uninit(CraConcurrentDict *cdict);
+
+CRA_API void
+cra_cdict_clear(CraConcurrentDict *cdict);
+
+// 各分片count之和，并发修改时只是一个近似值
+CRA_API ssize_t
+cra_cdict_count(CraConcurrentDict *cdict);
+
+CRA_API bool
+cra_cdict_put_and_return_kv(CraConcurrentDict *cdict,
+                            void              *key,
+                            void              *val,
+                            void              *retoldkey,
+                            void              *retoldval,
+                            bool               add);
+// bool put_and_return_kv(CraConcurrentDict *cdict, TKey *key, TVal *val, out TKey *retoldkey, out TVal *retoldval)
+#define cra_cdict_put_and_return_kv(cdict, key, val, retoldkey, retoldval)                                   \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, val), CRA_CDICT_CHECK_KEY(cdict, retoldkey), \
+     CRA_CDICT_CHECK_VAL(cdict, retoldval),                                                                  \
+     cra_cdict_put_and_return_kv(cdict, key, val, retoldkey, retoldval, false))
+// bool put_and_return_v(CraConcurrentDict *cdict, TKey *key, TVal *val, out TVal *retoldval)
+#define cra_cdict_put_and_return_v(cdict, key, val, retoldval)                                                \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, val), CRA_CDICT_CHECK_VAL(cdict, retoldval), \
+     (cra_cdict_put_and_return_kv)(cdict, key, val, NULL, retoldval, false))
+// bool put(CraConcurrentDict *cdict, TKey *key, TVal *val)
+#define cra_cdict_put(cdict, key, val)                                   \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, val),   \
+     (cra_cdict_put_and_return_kv)(cdict, key, val, NULL, NULL, false))
+// bool add(CraConcurrentDict *cdict, TKey *key, TVal *val)
+#define cra_cdict_add(cdict, key, val)                                  \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, val),  \
+     (cra_cdict_put_and_return_kv)(cdict, key, val, NULL, NULL, true))
+
+CRA_API bool
+cra_cdict_pop_kv(CraConcurrentDict *cdict, const void *key, void *retkey, void *retval);
+// bool pop_kv(CraConcurrentDict *cdict, TKey *key, out TKey *retkey, out TVal *retval)
+#define cra_cdict_pop_kv(cdict, key, retkey, retval)                                                         \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_KEY(cdict, retkey), CRA_CDICT_CHECK_VAL(cdict, retval), \
+     cra_cdict_pop_kv(cdict, key, retkey, retval))
+// bool pop(CraConcurrentDict *cdict, TKey *key, out TVal *retval)
+#define cra_cdict_pop(cdict, key, retval)                                      \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, retval),      \
+     (cra_cdict_pop_kv)(cdict, key, NULL, retval))
+// bool remove(CraConcurrentDict *cdict, TKey *key)
+#define cra_cdict_remove(cdict, key) (CRA_CDICT_CHECK_KEY(cdict, key), (cra_cdict_pop_kv)(cdict, key, NULL, NULL))
+
+// 不提供get_ref: 离开读锁后引用可能失效
+CRA_API bool
+cra_cdict_get(CraConcurrentDict *cdict, const void *key, void *retval);
+// bool get(CraConcurrentDict *cdict, TKey *key, out TVal *retval)
+#define cra_cdict_get(cdict, key, retval)                                                                     \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, retval), cra_cdict_get(cdict, key, retval))
+
+// key存在时返回已有的val；否则在写锁内调用compute计算val并插入
+// 同一个key的compute最多只会被调用一次(除非它返回false)
+// 返回false表示key不存在且compute返回false(或内存不足)
+CRA_API bool
+cra_cdict_compute_if_absent(CraConcurrentDict   *cdict,
+                            void                *key,
+                            void                *retval,
+                            cra_cdict_compute_fn compute,
+                            void                *arg);
+// bool compute_if_absent(CraConcurrentDict *cdict, TKey *key, out TVal *retval,
+// bool (*compute)(const TKey *key, out TVal *retval, void *arg), void *arg)
+#define cra_cdict_compute_if_absent(cdict, key, retval, compute_fn, arg)                        \
+    (CRA_CDICT_CHECK_KEY(cdict, key), CRA_CDICT_CHECK_VAL(cdict, retval),                       \
+     cra_cdict_compute_if_absent(cdict, key, retval, (cra_cdict_compute_fn)(compute_fn), arg))
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file cra_epoch.h
+ * @author Cracal
+ * @brief 基于纪元的内存回收(EBR)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_EPOCH_H__
+#define __CRA_EPOCH_H__
+#include <stdalign.h>
+#include "cra_assert.h"
+#include "cra_atomic.h"
+#include "cra_lock.h"
+
+#define CRA_EPOCH_NLISTS 3
+
+typedef struct CraEpoch        CraEpoch;
+typedef struct CraEpochRecord  CraEpochRecord;
+typedef struct CraEpochRetired CraEpochRetired;
+
+typedef void (*cra_epoch_free_fn)(void *ptr);
+
+// 每个读线程一个记录，独占缓存行
+// 读者只写自己的记录，不会写其他线程共享的缓存行
+struct CraEpochRecord
+{
+    alignas(CRA_CACHELINE_SIZE) cra_atomic_int64_t state; // 0: 不在临界区; (epoch << 1) | 1: 在临界区
+    cra_atomic_int32_t in_use;
+    int                nest; // 只有所属线程访问
+    CraEpoch          *domain;
+    CraEpochRecord    *next;
+};
+
+struct CraEpoch
+{
+    alignas(CRA_CACHELINE_SIZE) cra_atomic_int64_t epoch;
+    cra_atomic_ptr_t records; // CraEpochRecord链表，只增不减
+
+    cra_mutex_t      lock; // 保护retired
+    size_t           nretired;
+    CraEpochRetired *retired[CRA_EPOCH_NLISTS]; // 按retire时的纪元分组
+};
+
+CRA_API void
+cra_epoch_init(CraEpoch *epoch);
+
+// 调用时不能有读者在临界区内，会释放所有尚未回收的内存
+CRA_API void
+cra_epoch_uninit(CraEpoch *epoch);
+
+// 每个读线程在第一次进入临界区前注册，线程退出前注销
+CRA_API CraEpochRecord *
+cra_epoch_register(CraEpoch *epoch);
+
+// 不能在临界区内注销
+CRA_API void
+cra_epoch_unregister(CraEpochRecord *rec);
+
+// 进入临界区(可嵌套)
+// 临界区内读到的共享指针在退出临界区前不会被释放
+static inline void
+cra_epoch_enter(CraEpochRecord *rec)
+{
+    int64_t epoch;
+
+    assert(rec);
+    assert(rec->nest >= 0);
+
+    if (rec->nest++ > 0)
+        return;
+    epoch = cra_atomic_load64(&rec->domain->epoch, CRA_MO_ACQUIRE);
+    cra_atomic_store64(&rec->state, (epoch << 1) | 1, CRA_MO_RELAXED);
+    // 之后对共享数据的读不能重排到公告纪元之前
+    cra_atomic_thread_fence(CRA_MO_SEQ_CST);
+}
+
+// 退出临界区
+static inline void
+cra_epoch_exit(CraEpochRecord *rec)
+{
+    assert(rec);
+    assert(rec->nest > 0);
+
+    if (--rec->nest > 0)
+        return;
+    cra_atomic_store64(&rec->state, 0, CRA_MO_RELEASE);
+}
+
+// ptr必须已经从共享结构上摘除(新的读者不可能再读到它)
+// 等所有可能持有它的读者都退出临界区后调用free_fn(ptr)
+CRA_API void
+cra_epoch_retire(CraEpoch *epoch, void *ptr, cra_epoch_free_fn free_fn);
+
+// 尝试推进纪元并回收内存
+// 返回false表示有读者还停留在旧纪元
+CRA_API bool
+cra_epoch_try_advance(CraEpoch *epoch);
+
+// 阻塞到调用前retire的内存都被回收
+// 不能在临界区内调用
+CRA_API void
+cra_epoch_synchronize(CraEpoch *epoch);
+
+#endif
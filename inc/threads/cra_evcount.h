@@ -0,0 +1,110 @@
+/**
+ * @file cra_evcount.h
+ * @author Cracal
+ * @brief 事件计数(eventcount)，让无锁结构在条件不满足时挂起线程
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_EVCOUNT_H__
+#define __CRA_EVCOUNT_H__
+#include "cra_assert.h"
+#include "cra_atomic.h"
+#include "threads/cra_lock.h"
+
+// 用法:
+//
+//   等待方                                   通知方
+//   for (;;)                                 修改状态(如放入元素)
+//   {                                        cra_evcount_notify(ec, false);
+//       if (条件满足) break;
+//       key = cra_evcount_prepare_wait(ec);
+//       if (条件满足)
+//       {
+//           cra_evcount_cancel_wait(ec);
+//           break;
+//       }
+//       cra_evcount_wait(ec, key);
+//   }
+//
+// 没有等待者时，通知只有一次fence和一次原子读，不加锁
+typedef struct CraEvcount
+{
+    cra_atomic_int64_t epoch;    // 每次唤醒加一
+    cra_atomic_int32_t nwaiters; // 已prepare_wait还未返回的线程数
+    cra_mutex_t        mutex;
+    cra_cond_t         cond;
+} CraEvcount;
+
+static inline void
+cra_evcount_init(CraEvcount *ec)
+{
+    assert(ec);
+    cra_atomic_store64(&ec->epoch, 0, CRA_MO_RELAXED);
+    cra_atomic_store32(&ec->nwaiters, 0, CRA_MO_RELAXED);
+    cra_mutex_init(&ec->mutex);
+    cra_cond_init(&ec->cond);
+}
+
+static inline void
+cra_evcount_uninit(CraEvcount *ec)
+{
+    assert(ec);
+    assert(cra_atomic_load32(&ec->nwaiters, CRA_MO_RELAXED) == 0);
+    cra_cond_destroy(&ec->cond);
+    cra_mutex_destroy(&ec->mutex);
+}
+
+// 声明将要等待，返回之后传给wait的key
+// 之后必须再检查一次条件，然后调用wait或cancel_wait
+static inline int64_t
+cra_evcount_prepare_wait(CraEvcount *ec)
+{
+    int64_t key;
+
+    cra_atomic_inc32(&ec->nwaiters, CRA_MO_SEQ_CST);
+    key = cra_atomic_load64(&ec->epoch, CRA_MO_SEQ_CST);
+    // 之后对条件的检查不能重排到这之前
+    cra_atomic_thread_fence(CRA_MO_SEQ_CST);
+    return key;
+}
+
+static inline void
+cra_evcount_cancel_wait(CraEvcount *ec)
+{
+    cra_atomic_dec32(&ec->nwaiters, CRA_MO_RELAXED);
+}
+
+// 阻塞直到prepare_wait之后有过一次通知
+static inline void
+cra_evcount_wait(CraEvcount *ec, int64_t key)
+{
+    cra_mutex_lock(&ec->mutex);
+    while (cra_atomic_load64(&ec->epoch, CRA_MO_RELAXED) == key)
+        cra_cond_wait(&ec->cond, &ec->mutex);
+    cra_mutex_unlock(&ec->mutex);
+    cra_atomic_dec32(&ec->nwaiters, CRA_MO_RELAXED);
+}
+
+// 在修改状态之后调用
+// all为false时只唤醒一个等待者
+static inline void
+cra_evcount_notify(CraEvcount *ec, bool all)
+{
+    // 与prepare_wait配对: 要么这里看到等待者，要么等待者再检查时看到新状态
+    cra_atomic_thread_fence(CRA_MO_SEQ_CST);
+    if (cra_atomic_load32(&ec->nwaiters, CRA_MO_RELAXED) == 0)
+        return;
+
+    cra_mutex_lock(&ec->mutex);
+    cra_atomic_inc64(&ec->epoch, CRA_MO_RELAXED);
+    if (all)
+        cra_cond_broadcast(&ec->cond);
+    else
+        cra_cond_signal(&ec->cond);
+    cra_mutex_unlock(&ec->mutex);
+}
+
+#endif
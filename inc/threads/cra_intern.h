@@ -0,0 +1,90 @@
+/**
+ * @file cra_intern.h
+ * @author Cracal
+ * @brief 字符串驻留(线程安全)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_INTERN_H__
+#define __CRA_INTERN_H__
+#include <stdalign.h>
+#include "collections/cra_collects.h"
+#include "cra_lock.h"
+
+#define CRA_INTERN_DEFAULT_SHARDS 16
+// arena每块的大小，超过1/4块的字符串单独占一块
+#define CRA_INTERN_CHUNK_SIZE (64 * 1024)
+
+typedef struct CraInternSlot  CraInternSlot;
+typedef struct CraInternChunk CraInternChunk;
+typedef struct CraInternShard CraInternShard;
+typedef struct CraIntern      CraIntern;
+
+struct CraInternSlot
+{
+    cra_uhash_t hash;
+    const char *str; // NULL: 空
+};
+
+// 每个分片独占缓存行，避免相邻分片的锁互相伪共享
+struct CraInternShard
+{
+    alignas(CRA_CACHELINE_SIZE) cra_rwlock_t lock;
+    CraInternSlot  *slots; // 线性探测，容量是2的幂
+    size_t          capacity;
+    size_t          count;
+    CraInternChunk *chunks; // arena，只在uninit时释放
+};
+
+// 相同内容的字符串只保存一份，返回的指针在uninit之前一直有效
+// 同一个CraIntern返回的字符串可以直接用指针比较是否相等
+struct CraIntern
+{
+    CraInternShard *shards;
+    size_t          nshards; // 2的幂
+    unsigned int    shard_shift;
+};
+
+CRA_API bool
+cra_intern_init(CraIntern *intern, size_t nshards);
+
+// 之后所有驻留的字符串都失效
+CRA_API void
+cra_intern_uninit(CraIntern *intern);
+
+// 返回与str的前len个字节内容相同的驻留字符串(以'\0'结尾)
+// 内存分配失败时返回NULL
+CRA_API const char *
+cra_intern(CraIntern *intern, const char *str, size_t len);
+
+static inline const char *
+cra_intern_cstr(CraIntern *intern, const char *str)
+{
+    return cra_intern(intern, str, strlen(str));
+}
+
+// 驻留字符串的长度，不需要strlen
+static inline size_t
+cra_intern_len(const char *interned)
+{
+    return ((const size_t *)interned)[-1];
+}
+
+// 已驻留的字符串个数，并发修改时只是一个近似值
+CRA_API size_t
+cra_intern_count(CraIntern *intern);
+
+// 全局的CraIntern，第一次调用时初始化
+// 初始化失败时返回NULL
+CRA_API CraIntern *
+cra_intern_global(void);
+
+// 释放全局的CraIntern，之后所有全局驻留的字符串都失效
+// 再次调用cra_intern_global会重新初始化
+CRA_API void
+cra_intern_global_release(void);
+
+#endif
@@ -1,7 +1,7 @@
 /**
  * @file cra_lock.h
  * @author Cracal
- * @brief 互斥锁和条件变量
+ * @brief 互斥锁、条件变量和读写锁
  * @version 0.1 0.2
  * @date 2023-12-12
  *
@@ -93,4 +93,29 @@ cra_cond_wait_timeout(cra_cond_t *cond, cra_mutex_t *mtx, int timeout_ms)
 
 #endif
 
+// rwlock (C11没有读写锁)
+#if defined(CRA_COMPILER_MSVC)
+
+typedef SRWLOCK cra_rwlock_t;
+#define cra_rwlock_init             InitializeSRWLock
+#define cra_rwlock_destroy(prwlock) CRA_UNUSED(prwlock)
+#define cra_rwlock_rdlock           AcquireSRWLockShared
+#define cra_rwlock_wrlock           AcquireSRWLockExclusive
+#define cra_rwlock_rdunlock         ReleaseSRWLockShared
+#define cra_rwlock_wrunlock         ReleaseSRWLockExclusive
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_rwlock_t cra_rwlock_t;
+#define cra_rwlock_init(prwlock) (void)pthread_rwlock_init(prwlock, NULL)
+#define cra_rwlock_destroy       pthread_rwlock_destroy
+#define cra_rwlock_rdlock        (void)pthread_rwlock_rdlock
+#define cra_rwlock_wrlock        (void)pthread_rwlock_wrlock
+#define cra_rwlock_rdunlock      (void)pthread_rwlock_unlock
+#define cra_rwlock_wrunlock      (void)pthread_rwlock_unlock
+
+#endif
+
 #endif
\ No newline at end of file
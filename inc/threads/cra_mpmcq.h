@@ -0,0 +1,111 @@
+/**
+ * @file cra_mpmcq.h
+ * @author Cracal
+ * @brief 有界无锁多生产者多消费者队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_MPMCQ_H__
+#define __CRA_MPMCQ_H__
+#include <stdalign.h>
+#include "threads/cra_blockdq.h"
+#include "threads/cra_evcount.h"
+
+// 基于序号的环形数组(Vyukov)，容量是2的幂
+// push/pop各自只在一个原子变量上CAS，不加锁；队列空/满时可选地通过CraEvcount挂起
+// 满时的策略与关闭方式同CraBlockdq(CRA_BLOCKDQ_FULL_*、CRA_BLOCKDQ_CLOSE_*)
+
+#define CRA_MPMCQ_CHECK_VAL(que, val) assert(sizeof(*(val)) == (que)->itemsize)
+
+typedef struct CraMpmcq CraMpmcq;
+
+struct CraMpmcq
+{
+    alignas(CRA_CACHELINE_SIZE) cra_atomic_int64_t enqueue_pos;
+    alignas(CRA_CACHELINE_SIZE) cra_atomic_int64_t dequeue_pos;
+    alignas(CRA_CACHELINE_SIZE) unsigned char *cells; // { cra_atomic_int64_t seq; T val; }[capacity]
+    size_t             cellsize;
+    size_t             mask;
+    size_t             itemsize;
+    CraBlockdqFull_e   full_policy;
+    cra_atomic_int32_t closed; // CRA_BLOCKDQ_CLOSE_*
+    CraEvcount         not_empty;
+    CraEvcount         not_full;
+};
+
+// capacity: 向上取2的幂，至少为2
+CRA_API bool
+cra_mpmcq_init(CraMpmcq *que, size_t itemsize, size_t capacity, CraBlockdqFull_e full_policy);
+// bool init<T>(CraMpmcq *que, size_t capacity, CraBlockdqFull_e full_policy)
+#define cra_mpmcq_init(T, que, capacity, full_policy) cra_mpmcq_init(que, sizeof(T), capacity, full_policy)
+
+// 调用时不能有其他线程在使用队列
+CRA_API void
+cra_mpmcq_uninit(CraMpmcq *que);
+
+// how: CRA_BLOCKDQ_CLOSE_ENQUEUE/CRA_BLOCKDQ_CLOSE_DEQUEUE/CRA_BLOCKDQ_CLOSE_ALL
+// 唤醒所有被挂起的线程
+CRA_API void
+cra_mpmcq_shutdown(CraMpmcq *que, int how);
+
+static inline size_t
+cra_mpmcq_capacity(CraMpmcq *que)
+{
+    return que->mask + 1;
+}
+
+// 并发时只是近似值
+static inline size_t
+cra_mpmcq_count(CraMpmcq *que)
+{
+    int64_t head = cra_atomic_load64(&que->dequeue_pos, CRA_MO_RELAXED);
+    int64_t tail = cra_atomic_load64(&que->enqueue_pos, CRA_MO_RELAXED);
+    return tail > head ? (size_t)(tail - head) : 0;
+}
+
+CRA_API bool
+cra_mpmcq_try_push(CraMpmcq *que, void *val);
+// bool try_push(CraMpmcq *que, T *val)
+//
+// 不阻塞，不使用满时策略
+// returns:
+//      false: 队列已满或已关闭入队
+#define cra_mpmcq_try_push(que, val) (CRA_MPMCQ_CHECK_VAL(que, val), cra_mpmcq_try_push(que, val))
+
+CRA_API bool
+cra_mpmcq_push(CraMpmcq *que, void *val, void *retdrop);
+// bool push(CraMpmcq *que, T *val, out T *retdrop)
+//
+// 队列满时:
+//      CRA_BLOCKDQ_FULL_WAIT:         挂起直到有空位或关闭入队
+//      CRA_BLOCKDQ_FULL_DROP_OLDEST:  弹出最早的元素到retdrop，再放入val
+//      CRA_BLOCKDQ_FULL_DROP_NEWEST:  丢弃最新的元素，即val本身，复制到retdrop。
+//                                     队尾的元素可能正被消费者读取，无锁时不能像CraBlockdq那样替换它
+//      CRA_BLOCKDQ_FULL_RETURN_FALSE: 返回false
+// retdrop可以为NULL
+// returns:
+//      true:  val已入队(DROP_NEWEST时val被丢弃)
+//      false: 1. 已关闭入队
+//             2. 队列已满并且策略是CRA_BLOCKDQ_FULL_RETURN_FALSE
+#define cra_mpmcq_push(que, val, retdrop) (CRA_MPMCQ_CHECK_VAL(que, val), cra_mpmcq_push(que, val, retdrop))
+
+CRA_API bool
+cra_mpmcq_try_pop(CraMpmcq *que, void *retval);
+// bool try_pop(CraMpmcq *que, out T *retval)
+//
+// 不阻塞。队列为空时返回false。关闭出队后仍然可以取出剩余的元素
+#define cra_mpmcq_try_pop(que, retval) (CRA_MPMCQ_CHECK_VAL(que, retval), cra_mpmcq_try_pop(que, retval))
+
+CRA_API bool
+cra_mpmcq_pop(CraMpmcq *que, void *retval);
+// bool pop(CraMpmcq *que, out T *retval)
+//
+// 队列为空时挂起，直到有元素或关闭出队
+// returns:
+//      false: 已关闭出队并且队列为空
+#define cra_mpmcq_pop(que, retval) (CRA_MPMCQ_CHECK_VAL(que, retval), cra_mpmcq_pop(que, retval))
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file cra_parallel_sort.h
+ * @author Cracal
+ * @brief 并行排序
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_PARALLEL_SORT_H__
+#define __CRA_PARALLEL_SORT_H__
+#include "collections/cra_alist.h"
+#include "cra_thrdpool.h"
+
+// 元素个数小于此值时直接使用cra_alist_sort
+#define CRA_PARALLEL_SORT_THRESHOLD (1 << 16)
+
+// 在线程池上做并行样本排序(sample sort)，不稳定
+// 相同的输入总是得到相同的输出，与线程池的线程数无关
+// 调用线程也会参与排序，可以在线程池的任务中调用
+// helper只用不阻塞的方式提交，队列满时剩下的工作由调用线程完成，与线程池的满策略无关
+// 需要一块与数组一样大的临时内存，申请内存失败时返回false
+CRA_API bool
+cra_alist_parallel_sort(CraAList *list, cra_cmp_fn compare, CraThrdPool *pool);
+// bool parallel_sort(CraAList *list, int (*compare)(const T *, const T *), CraThrdPool *pool)
+#define cra_alist_parallel_sort(list, compare, pool) cra_alist_parallel_sort(list, (cra_cmp_fn)(compare), pool)
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * @file cra_rcudict.h
+ * @author Cracal
+ * @brief 读多写少的无锁读字典(RCU + 纪元回收)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_RCUDICT_H__
+#define __CRA_RCUDICT_H__
+#include "collections/cra_collects.h"
+#include "cra_epoch.h"
+
+#define CRA_RCUDICT_DEFAULT_CAPACITY 8
+
+#define CRA_RCUDICT_CHECK_KEY(dict, key) assert((dict)->key_size == sizeof(*(key)))
+#define CRA_RCUDICT_CHECK_VAL(dict, val) assert((dict)->val_size == sizeof(*(val)))
+
+typedef struct CraRcuDictNode  CraRcuDictNode;
+typedef struct CraRcuDictTable CraRcuDictTable;
+typedef struct CraRcuDict      CraRcuDict;
+
+// 节点发布后不再修改(next除外)，更新val时替换整个节点
+struct CraRcuDictNode
+{
+    cra_atomic_ptr_t next;
+    cra_hash_t       hash;
+    // key & val
+};
+
+// 扩容时整张表(连同节点)重建后一次性发布
+struct CraRcuDictTable
+{
+    size_t           capacity; // 2的幂
+    cra_atomic_ptr_t buckets[];
+};
+
+// 读者: 不加锁，只写自己的纪元记录
+// 写者: 互斥锁串行化，通过原子指针发布新节点/新表，旧的交给纪元回收
+struct CraRcuDict
+{
+    cra_atomic_ptr_t table; // CraRcuDictTable*
+
+    size_t key_size;
+    size_t val_size;
+    size_t key_offset;
+    size_t val_offset;
+    size_t node_size;
+
+    cra_hash_fn hash_key;
+    cra_cmp_fn  compare_key;
+
+    // 写者使用的字段和读者常读的字段分开在不同的缓存行
+    alignas(CRA_CACHELINE_SIZE) cra_mutex_t lock;
+    cra_atomic_int64_t count;
+
+    CraEpoch epoch;
+};
+
+CRA_API bool
+cra_rcudict_init_with_size(CraRcuDict *dict,
+                           size_t      key_size,
+                           size_t      val_size,
+                           size_t      key_align,
+                           size_t      val_align,
+                           size_t      init_capacity,
+                           cra_hash_fn hash_key,
+                           cra_cmp_fn  compare_key);
+// bool init_with_size<TKey, TVal>(CraRcuDict *dict, size_t init_capacity,
+// cra_hash_t (*hash)(const TKey *key), int (*compare)(const TKey *a, const TKey *b))
+#define cra_rcudict_init_with_size(TKey, TVal, dict, init_capacity, hash_key_fn, compare_key_fn)            \
+    cra_rcudict_init_with_size(dict, sizeof(TKey), sizeof(TVal), alignof(TKey), alignof(TVal), init_capacity, \
+                               (cra_hash_fn)(hash_key_fn), (cra_cmp_fn)(compare_key_fn))
+// bool init<TKey, TVal>(CraRcuDict *dict, cra_hash_t (*hash)(const TKey *key),
+// int (*compare)(const TKey *a, const TKey *b))
+#define cra_rcudict_init(TKey, TVal, dict, hash_key_fn, compare_key_fn) \
+    cra_rcudict_init_with_size(TKey, TVal, dict, CRA_RCUDICT_DEFAULT_CAPACITY, hash_key_fn, compare_key_fn)
+
+// 调用时不能有读者在临界区内
+CRA_API void
+cra_rcudict_uninit(CraRcuDict *dict);
+
+// 读线程在读之前注册，线程退出前注销
+static inline CraEpochRecord *
+cra_rcudict_register_reader(CraRcuDict *dict)
+{
+    return cra_epoch_register(&dict->epoch);
+}
+
+static inline void
+cra_rcudict_unregister_reader(CraRcuDict *dict, CraEpochRecord *reader)
+{
+    CRA_UNUSED(dict);
+    cra_epoch_unregister(reader);
+}
+
+// 进入读临界区(可嵌套)
+static inline void
+cra_rcudict_read_lock(CraEpochRecord *reader)
+{
+    cra_epoch_enter(reader);
+}
+
+// 退出读临界区，之后get_ref得到的引用失效
+static inline void
+cra_rcudict_read_unlock(CraEpochRecord *reader)
+{
+    cra_epoch_exit(reader);
+}
+
+static inline ssize_t
+cra_rcudict_count(CraRcuDict *dict)
+{
+    return (ssize_t)cra_atomic_load64(&dict->count, CRA_MO_RELAXED);
+}
+
+CRA_API void
+cra_rcudict_clear(CraRcuDict *dict);
+
+CRA_API bool
+cra_rcudict_put_and_return_kv(CraRcuDict *dict, void *key, void *val, void *retoldkey, void *retoldval, bool add);
+// bool put_and_return_kv(CraRcuDict *dict, TKey *key, TVal *val, out TKey *retoldkey, out TVal *retoldval)
+#define cra_rcudict_put_and_return_kv(dict, key, val, retoldkey, retoldval)                                        \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_VAL(dict, val), CRA_RCUDICT_CHECK_KEY(dict, retoldkey),    \
+     CRA_RCUDICT_CHECK_VAL(dict, retoldval), cra_rcudict_put_and_return_kv(dict, key, val, retoldkey, retoldval, false))
+// bool put_and_return_v(CraRcuDict *dict, TKey *key, TVal *val, out TVal *retoldval)
+#define cra_rcudict_put_and_return_v(dict, key, val, retoldval)                                                   \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_VAL(dict, val), CRA_RCUDICT_CHECK_VAL(dict, retoldval), \
+     (cra_rcudict_put_and_return_kv)(dict, key, val, NULL, retoldval, false))
+// bool put(CraRcuDict *dict, TKey *key, TVal *val)
+#define cra_rcudict_put(dict, key, val)                                     \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_VAL(dict, val),    \
+     (cra_rcudict_put_and_return_kv)(dict, key, val, NULL, NULL, false))
+// bool add(CraRcuDict *dict, TKey *key, TVal *val)
+#define cra_rcudict_add(dict, key, val)                                    \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_VAL(dict, val),   \
+     (cra_rcudict_put_and_return_kv)(dict, key, val, NULL, NULL, true))
+
+CRA_API bool
+cra_rcudict_pop_kv(CraRcuDict *dict, const void *key, void *retkey, void *retval);
+// bool pop_kv(CraRcuDict *dict, TKey *key, out TKey *retkey, out TVal *retval)
+#define cra_rcudict_pop_kv(dict, key, retkey, retval)                                                              \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_KEY(dict, retkey), CRA_RCUDICT_CHECK_VAL(dict, retval), \
+     cra_rcudict_pop_kv(dict, key, retkey, retval))
+// bool pop(CraRcuDict *dict, TKey *key, out TVal *retval)
+#define cra_rcudict_pop(dict, key, retval)                                      \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_VAL(dict, retval),     \
+     (cra_rcudict_pop_kv)(dict, key, NULL, retval))
+// bool remove(CraRcuDict *dict, TKey *key)
+#define cra_rcudict_remove(dict, key) \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), (cra_rcudict_pop_kv)(dict, key, NULL, NULL))
+
+// 必须在读临界区内调用，返回的引用在cra_rcudict_read_unlock前有效
+// 引用的val不会被修改(put会替换整个节点)，不要通过它写入
+CRA_API const void *
+cra_rcudict_get_ref(CraRcuDict *dict, const void *key);
+// const TVal *get_ref(CraRcuDict *dict, TKey *key)
+#define cra_rcudict_get_ref(dict, key) (CRA_RCUDICT_CHECK_KEY(dict, key), cra_rcudict_get_ref(dict, key))
+
+// 自动进入/退出读临界区
+CRA_API bool
+cra_rcudict_get(CraRcuDict *dict, CraEpochRecord *reader, const void *key, void *retval);
+// bool get(CraRcuDict *dict, CraEpochRecord *reader, TKey *key, out TVal *retval)
+#define cra_rcudict_get(dict, reader, key, retval)                                 \
+    (CRA_RCUDICT_CHECK_KEY(dict, key), CRA_RCUDICT_CHECK_VAL(dict, retval),        \
+     cra_rcudict_get(dict, reader, key, retval))
+
+#endif
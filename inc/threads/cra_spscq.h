@@ -0,0 +1,123 @@
+/**
+ * @file cra_spscq.h
+ * @author Cracal
+ * @brief 单生产者单消费者环形队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef __CRA_SPSCQ_H__
+#define __CRA_SPSCQ_H__
+#include <stdalign.h>
+#include "threads/cra_blockdq.h"
+#include "threads/cra_evcount.h"
+
+// 只能有一个线程入队、一个线程出队。不使用阻塞时入队/出队都是wait-free的
+// 生产者和消费者的下标各占一个缓存行，并缓存对方的下标，只有缓存的值不够用时才读对方的缓存行
+// 容量是2的幂
+
+#define CRA_SPSCQ_CHECK_VAL(que, val) assert(sizeof(*(val)) == (que)->itemsize)
+
+typedef struct CraSpscq CraSpscq;
+
+struct CraSpscq
+{
+    // 生产者
+    alignas(CRA_CACHELINE_SIZE) cra_atomic_int64_t tail;
+    int64_t cached_head;
+    // 消费者
+    alignas(CRA_CACHELINE_SIZE) cra_atomic_int64_t head;
+    int64_t cached_tail;
+    // 只读
+    alignas(CRA_CACHELINE_SIZE) unsigned char *array;
+    size_t             mask;
+    size_t             itemsize;
+    bool               blocking;
+    cra_atomic_int32_t closed; // CRA_BLOCKDQ_CLOSE_*
+    CraEvcount         not_empty;
+    CraEvcount         not_full;
+};
+
+// capacity: 向上取2的幂，至少为2
+// blocking: 为true时可以使用cra_spscq_push/cra_spscq_pop挂起等待，每次入队/出队会多一次fence
+CRA_API bool
+cra_spscq_init_with_size(CraSpscq *que, size_t itemsize, size_t capacity, bool blocking);
+// bool init_with_size<T>(CraSpscq *que, size_t capacity, bool blocking)
+#define cra_spscq_init_with_size(T, que, capacity, blocking) cra_spscq_init_with_size(que, sizeof(T), capacity, blocking)
+// bool init<T>(CraSpscq *que, size_t capacity)  不阻塞
+#define cra_spscq_init(T, que, capacity)                     cra_spscq_init_with_size(T, que, capacity, false)
+
+// 调用时生产者和消费者都不能在使用队列
+CRA_API void
+cra_spscq_uninit(CraSpscq *que);
+
+// how: CRA_BLOCKDQ_CLOSE_ENQUEUE/CRA_BLOCKDQ_CLOSE_DEQUEUE/CRA_BLOCKDQ_CLOSE_ALL
+// 唤醒被挂起的生产者/消费者
+CRA_API void
+cra_spscq_shutdown(CraSpscq *que, int how);
+
+static inline size_t
+cra_spscq_capacity(CraSpscq *que)
+{
+    return que->mask + 1;
+}
+
+// 生产者/消费者调用时是准确的下限/上限
+static inline size_t
+cra_spscq_count(CraSpscq *que)
+{
+    int64_t head = cra_atomic_load64(&que->head, CRA_MO_ACQUIRE);
+    int64_t tail = cra_atomic_load64(&que->tail, CRA_MO_ACQUIRE);
+    return (size_t)(tail - head);
+}
+
+// ================ 生产者 ================
+
+CRA_API size_t
+cra_spscq_push_n(CraSpscq *que, void *vals, size_t n);
+// size_t push_n(CraSpscq *que, T vals[n], size_t n)
+//
+// 不阻塞，放入尽可能多的元素(最多两次memcpy)
+// returns: 放入的个数。已关闭入队时返回0
+#define cra_spscq_push_n(que, vals, n) (CRA_SPSCQ_CHECK_VAL(que, vals), cra_spscq_push_n(que, vals, n))
+
+// bool try_push(CraSpscq *que, T *val)
+// 不阻塞。队列已满或已关闭入队时返回false
+#define cra_spscq_try_push(que, val) (cra_spscq_push_n(que, val, 1) == 1)
+
+CRA_API bool
+cra_spscq_push(CraSpscq *que, void *val);
+// bool push(CraSpscq *que, T *val)
+//
+// 队列满时挂起，直到有空位或关闭入队。需要以blocking初始化
+// returns:
+//      false: 已关闭入队
+#define cra_spscq_push(que, val) (CRA_SPSCQ_CHECK_VAL(que, val), cra_spscq_push(que, val))
+
+// ================ 消费者 ================
+
+CRA_API size_t
+cra_spscq_pop_n(CraSpscq *que, void *retvals, size_t n);
+// size_t pop_n(CraSpscq *que, out T retvals[n], size_t n)
+//
+// 不阻塞，取出尽可能多的元素(最多两次memcpy)
+// 关闭出队后仍然可以取出剩余的元素
+// returns: 取出的个数
+#define cra_spscq_pop_n(que, retvals, n) (CRA_SPSCQ_CHECK_VAL(que, retvals), cra_spscq_pop_n(que, retvals, n))
+
+// bool try_pop(CraSpscq *que, out T *retval)
+// 不阻塞。队列为空时返回false
+#define cra_spscq_try_pop(que, retval) (cra_spscq_pop_n(que, retval, 1) == 1)
+
+CRA_API bool
+cra_spscq_pop(CraSpscq *que, void *retval);
+// bool pop(CraSpscq *que, out T *retval)
+//
+// 队列为空时挂起，直到有元素或关闭出队。需要以blocking初始化
+// returns:
+//      false: 已关闭出队并且队列为空
+#define cra_spscq_pop(que, retval) (CRA_SPSCQ_CHECK_VAL(que, retval), cra_spscq_pop(que, retval))
+
+#endif
@@ -49,6 +49,10 @@ cra_thrdpool_add_task0(CraThrdPool *pool, void (*excute0)(void));
 CRA_API bool
 cra_thrdpool_add_task1(CraThrdPool *pool, void (*excute1)(void *), void *arg);
 
+// 不管满策略是什么，队列满时都不等待也不丢弃任务，直接返回false
+CRA_API bool
+cra_thrdpool_try_add_task1(CraThrdPool *pool, void (*excute1)(void *), void *arg);
+
 CRA_API bool
 cra_thrdpool_add_task2(CraThrdPool *pool, void (*excute2)(void *, void *), void *arg1, void *arg2);
 
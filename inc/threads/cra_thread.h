@@ -36,6 +36,8 @@ cra_thrd_join(cra_thrd_t th)
     return thrd_success == thrd_join(th, NULL);
 }
 
+#define cra_thrd_yield thrd_yield
+
 #elif defined(CRA_COMPILER_MSVC)
 
 typedef HANDLE                 cra_thrd_t;
@@ -60,6 +62,8 @@ cra_thrd_join(cra_thrd_t th)
     return false;
 }
 
+#define cra_thrd_yield() (void)SwitchToThread()
+
 #elif defined(CRA_COMPILER_GNUC)
 
 #include <pthread.h>
@@ -84,6 +88,9 @@ cra_thrd_join(cra_thrd_t th)
     return 0 == pthread_join(th, NULL);
 }
 
+#include <sched.h>
+#define cra_thrd_yield() (void)sched_yield()
+
 #endif
 
 typedef unsigned long cra_tid_t;
@@ -113,6 +113,62 @@ bool(cra_alist_pop_at)(CraAList *list, size_t index, void *retval)
     return true;
 }
 
+bool(cra_alist_insert_range)(CraAList *list, size_t index, void *vals, size_t n)
+{
+    size_t nmoving;
+    size_t new_capacity;
+
+    assert(list);
+    assert(list->array);
+    assert(list->itemsize > 0);
+    assert(vals || n == 0);
+
+    if (index > list->count)
+        return false;
+    if (n == 0)
+        return true;
+
+    // 只扩容一次
+    if (list->count + n > list->capacity)
+    {
+        new_capacity = list->capacity;
+        while (new_capacity < list->count + n)
+            new_capacity = CRA_ALIST_EXPEND(new_capacity);
+        if (!cra_alist_resize(list, new_capacity))
+            return false;
+    }
+
+    nmoving = list->count - index;
+    if (nmoving > 0)
+        memmove(CRA_ALIST_PVAL(list, index + n), CRA_ALIST_PVAL(list, index), nmoving * list->itemsize);
+    memcpy(CRA_ALIST_PVAL(list, index), vals, n * list->itemsize);
+    list->count += n;
+    return true;
+}
+
+bool(cra_alist_pop_range)(CraAList *list, size_t index, size_t n, void *retvals)
+{
+    size_t nmoving;
+
+    assert(list);
+    assert(list->array);
+    assert(list->itemsize > 0);
+
+    if (index > list->count || n > list->count - index)
+        return false;
+    if (n == 0)
+        return true;
+
+    if (retvals)
+        memcpy(retvals, CRA_ALIST_PVAL(list, index), n * list->itemsize);
+
+    nmoving = list->count - index - n;
+    if (nmoving > 0)
+        memmove(CRA_ALIST_PVAL(list, index), CRA_ALIST_PVAL(list, index + n), nmoving * list->itemsize);
+    list->count -= n;
+    return true;
+}
+
 bool
 cra_alist_reverse(CraAList *list)
 {
@@ -145,63 +201,456 @@ cra_alist_reverse(CraAList *list)
     return true;
 }
 
+// ====================================== sort ======================================
+
+// pdqsort(pattern-defeating quicksort):
+// 小区间用插入排序；选错pivot次数过多时退化为堆排序，保证O(nlogn)
+// 已有序/逆序/大量重复的输入接近O(n)
+#define CRA_ALIST_INSERTION_SORT_THRESHOLD     24
+#define CRA_ALIST_NINTHER_THRESHOLD            128
+#define CRA_ALIST_PARTIAL_INSERTION_SORT_LIMIT 8
+
+typedef struct
+{
+    unsigned char *array;
+    size_t         size;
+    cra_cmp_fn     compare;
+    unsigned char *pivot; // 一个元素大小的临时内存
+    unsigned char *temp;  // 一个元素大小的临时内存
+} CraAListSorter;
+
+#define CRA_SORTER_AT(s, i) ((s)->array + (i) * (s)->size)
+
+static inline void
+cra_sorter_copy(CraAListSorter *s, void *dst, const void *src)
+{
+    // 常见大小用定长memcpy，编译器会展开成mov
+    switch (s->size)
+    {
+        case 4:
+            memcpy(dst, src, 4);
+            break;
+        case 8:
+            memcpy(dst, src, 8);
+            break;
+        case 16:
+            memcpy(dst, src, 16);
+            break;
+        default:
+            memcpy(dst, src, s->size);
+            break;
+    }
+}
+
+static inline void
+cra_sorter_swap(CraAListSorter *s, size_t i, size_t j)
+{
+    cra_sorter_copy(s, s->temp, CRA_SORTER_AT(s, i));
+    cra_sorter_copy(s, CRA_SORTER_AT(s, i), CRA_SORTER_AT(s, j));
+    cra_sorter_copy(s, CRA_SORTER_AT(s, j), s->temp);
+}
+
+static inline bool
+cra_sorter_less(CraAListSorter *s, size_t i, size_t j)
+{
+    return s->compare(CRA_SORTER_AT(s, i), CRA_SORTER_AT(s, j)) < 0;
+}
+
+// 把i处的元素插入到[begin, i)中，返回移动的距离
+static inline size_t
+cra_sorter_insert_one(CraAListSorter *s, size_t begin, size_t i)
+{
+    size_t j = i;
+    cra_sorter_copy(s, s->temp, CRA_SORTER_AT(s, i));
+    do
+    {
+        cra_sorter_copy(s, CRA_SORTER_AT(s, j), CRA_SORTER_AT(s, j - 1));
+        --j;
+    } while (j > begin && s->compare(s->temp, CRA_SORTER_AT(s, j - 1)) < 0);
+    cra_sorter_copy(s, CRA_SORTER_AT(s, j), s->temp);
+    return i - j;
+}
+
+// 排序[begin, end)
+static void
+cra_sorter_insertion_sort(CraAListSorter *s, size_t begin, size_t end)
+{
+    for (size_t i = begin + 1; i < end; ++i)
+    {
+        if (cra_sorter_less(s, i, i - 1))
+            cra_sorter_insert_one(s, begin, i);
+    }
+}
+
+// 移动的元素过多时放弃，返回false(区间中的元素仍然完整)
+static bool
+cra_sorter_partial_insertion_sort(CraAListSorter *s, size_t begin, size_t end)
+{
+    size_t moved = 0;
+    for (size_t i = begin + 1; i < end; ++i)
+    {
+        if (!cra_sorter_less(s, i, i - 1))
+            continue;
+        moved += cra_sorter_insert_one(s, begin, i);
+        if (moved > CRA_ALIST_PARTIAL_INSERTION_SORT_LIMIT)
+            return false;
+    }
+    return true;
+}
+
+static void
+cra_sorter_sift_down(CraAListSorter *s, size_t base, size_t root, size_t n)
+{
+    size_t child;
+    while ((child = 2 * root + 1) < n)
+    {
+        if (child + 1 < n && cra_sorter_less(s, base + child, base + child + 1))
+            ++child;
+        if (!cra_sorter_less(s, base + root, base + child))
+            break;
+        cra_sorter_swap(s, base + root, base + child);
+        root = child;
+    }
+}
+
+static void
+cra_sorter_heap_sort(CraAListSorter *s, size_t begin, size_t end)
+{
+    size_t n = end - begin;
+    for (size_t i = n / 2; i-- > 0;)
+        cra_sorter_sift_down(s, begin, i, n);
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        cra_sorter_swap(s, begin, begin + i);
+        cra_sorter_sift_down(s, begin, 0, i);
+    }
+}
+
+static inline void
+cra_sorter_sort3(CraAListSorter *s, size_t a, size_t b, size_t c)
+{
+    if (cra_sorter_less(s, b, a))
+        cra_sorter_swap(s, a, b);
+    if (cra_sorter_less(s, c, b))
+        cra_sorter_swap(s, b, c);
+    if (cra_sorter_less(s, b, a))
+        cra_sorter_swap(s, a, b);
+}
+
+// pivot在begin处，小于pivot的放左边，大于等于的放右边
+// 返回pivot的最终位置；*already为true表示区间原本就已经分好了
 static size_t
-cra_alist_partition(CraAList *list, cra_cmp_fn compare, size_t begin, size_t end, char *temp)
+cra_sorter_partition_right(CraAListSorter *s, size_t begin, size_t end, bool *already)
 {
-    size_t left, right;
-    char  *array;
+    size_t first = begin, last = end, pos;
 
-    left = begin;
-    right = end;
-    array = (char *)list->array;
-    // temp = array[right]
-    memcpy(temp, array + right * list->itemsize, list->itemsize);
+    cra_sorter_copy(s, s->pivot, CRA_SORTER_AT(s, begin));
 
-    while (left < right)
+    // 三数取中保证end-1处有 >= pivot 的元素，不会越界
+    while (s->compare(CRA_SORTER_AT(s, ++first), s->pivot) < 0)
+        ;
+    if (first - 1 == begin)
+    {
+        while (first < last && !(s->compare(CRA_SORTER_AT(s, --last), s->pivot) < 0))
+            ;
+    }
+    else
     {
-        //                     array[left] <= temp
-        while (left < right && compare(array + left * list->itemsize, temp) <= 0)
-            left++;
-        // array[right] = array[left];
-        memcpy(array + right * list->itemsize, array + left * list->itemsize, list->itemsize);
-
-        //                     array[right] >= temp
-        while (left < right && compare(array + right * list->itemsize, temp) >= 0)
-            right--;
-        // array[left] = array[right];
-        memcpy(array + left * list->itemsize, array + right * list->itemsize, list->itemsize);
+        // (begin, first)中有 < pivot 的元素，不会越界
+        while (!(s->compare(CRA_SORTER_AT(s, --last), s->pivot) < 0))
+            ;
     }
-    assert(left == right);
-    // array[left] = temp;
-    memcpy(array + left * list->itemsize, temp, list->itemsize);
 
-    return left;
+    *already = first >= last;
+    while (first < last)
+    {
+        cra_sorter_swap(s, first, last);
+        while (s->compare(CRA_SORTER_AT(s, ++first), s->pivot) < 0)
+            ;
+        while (!(s->compare(CRA_SORTER_AT(s, --last), s->pivot) < 0))
+            ;
+    }
+
+    pos = first - 1;
+    cra_sorter_copy(s, CRA_SORTER_AT(s, begin), CRA_SORTER_AT(s, pos));
+    cra_sorter_copy(s, CRA_SORTER_AT(s, pos), s->pivot);
+    return pos;
+}
+
+// pivot等于左边相邻区间的元素时使用: 等于pivot的放左边，大于的放右边
+// 这样大量重复的元素一次就能排除
+static size_t
+cra_sorter_partition_left(CraAListSorter *s, size_t begin, size_t end)
+{
+    size_t first = begin, last = end;
+
+    cra_sorter_copy(s, s->pivot, CRA_SORTER_AT(s, begin));
+
+    while (s->compare(s->pivot, CRA_SORTER_AT(s, --last)) < 0)
+        ;
+    if (last + 1 == end)
+    {
+        while (first < last && !(s->compare(s->pivot, CRA_SORTER_AT(s, ++first)) < 0))
+            ;
+    }
+    else
+    {
+        while (!(s->compare(s->pivot, CRA_SORTER_AT(s, ++first)) < 0))
+            ;
+    }
+
+    while (first < last)
+    {
+        cra_sorter_swap(s, first, last);
+        while (s->compare(s->pivot, CRA_SORTER_AT(s, --last)) < 0)
+            ;
+        while (!(s->compare(s->pivot, CRA_SORTER_AT(s, ++first)) < 0))
+            ;
+    }
+
+    cra_sorter_copy(s, CRA_SORTER_AT(s, begin), CRA_SORTER_AT(s, last));
+    cra_sorter_copy(s, CRA_SORTER_AT(s, last), s->pivot);
+    return last;
 }
 
+// 只递归较小的一半，栈深度不超过O(logn)
 static void
-cra_alist_quick_sort(CraAList *list, cra_cmp_fn compare, size_t begin, size_t end, char *temp)
+cra_sorter_pdqsort(CraAListSorter *s, size_t begin, size_t end, int bad_allowed, bool leftmost)
 {
-    size_t middle = cra_alist_partition(list, compare, begin, end, temp);
-    if (middle > 0 && middle - 1 > begin)
-        cra_alist_quick_sort(list, compare, begin, middle - 1, temp);
-    if (middle < end && middle + 1 < end)
-        cra_alist_quick_sort(list, compare, middle + 1, end, temp);
+    bool   already;
+    size_t size, half, pos, lsize, rsize;
+
+    while (true)
+    {
+        size = end - begin;
+        if (size < CRA_ALIST_INSERTION_SORT_THRESHOLD)
+        {
+            cra_sorter_insertion_sort(s, begin, end);
+            return;
+        }
+
+        // 选pivot放到begin: 大区间用ninther(9数取中)
+        half = size / 2;
+        if (size > CRA_ALIST_NINTHER_THRESHOLD)
+        {
+            cra_sorter_sort3(s, begin, begin + half, end - 1);
+            cra_sorter_sort3(s, begin + 1, begin + (half - 1), end - 2);
+            cra_sorter_sort3(s, begin + 2, begin + (half + 1), end - 3);
+            cra_sorter_sort3(s, begin + (half - 1), begin + half, begin + (half + 1));
+            cra_sorter_swap(s, begin, begin + half);
+        }
+        else
+        {
+            cra_sorter_sort3(s, begin + half, begin, end - 1);
+        }
+
+        // 左边相邻的元素(上一次的pivot)不小于当前pivot，说明两者相等
+        if (!leftmost && !cra_sorter_less(s, begin - 1, begin))
+        {
+            begin = cra_sorter_partition_left(s, begin, end) + 1;
+            continue;
+        }
+
+        pos = cra_sorter_partition_right(s, begin, end, &already);
+        lsize = pos - begin;
+        rsize = end - (pos + 1);
+
+        if (lsize < size / 8 || rsize < size / 8)
+        {
+            // 分得很不平衡
+            if (--bad_allowed == 0)
+            {
+                cra_sorter_heap_sort(s, begin, end);
+                return;
+            }
+            // 打乱一些元素，破坏导致不平衡的模式
+            if (lsize >= CRA_ALIST_INSERTION_SORT_THRESHOLD)
+            {
+                cra_sorter_swap(s, begin, begin + lsize / 4);
+                cra_sorter_swap(s, pos - 1, pos - lsize / 4);
+                if (lsize > CRA_ALIST_NINTHER_THRESHOLD)
+                {
+                    cra_sorter_swap(s, begin + 1, begin + (lsize / 4 + 1));
+                    cra_sorter_swap(s, begin + 2, begin + (lsize / 4 + 2));
+                    cra_sorter_swap(s, pos - 2, pos - (lsize / 4 + 1));
+                    cra_sorter_swap(s, pos - 3, pos - (lsize / 4 + 2));
+                }
+            }
+            if (rsize >= CRA_ALIST_INSERTION_SORT_THRESHOLD)
+            {
+                cra_sorter_swap(s, pos + 1, pos + (1 + rsize / 4));
+                cra_sorter_swap(s, end - 1, end - rsize / 4);
+                if (rsize > CRA_ALIST_NINTHER_THRESHOLD)
+                {
+                    cra_sorter_swap(s, pos + 2, pos + (2 + rsize / 4));
+                    cra_sorter_swap(s, pos + 3, pos + (3 + rsize / 4));
+                    cra_sorter_swap(s, end - 2, end - (1 + rsize / 4));
+                    cra_sorter_swap(s, end - 3, end - (2 + rsize / 4));
+                }
+            }
+        }
+        else if (already && cra_sorter_partial_insertion_sort(s, begin, pos) &&
+                 cra_sorter_partial_insertion_sort(s, pos + 1, end))
+        {
+            // 看起来原本就有序，插入排序已经收尾
+            return;
+        }
+
+        if (lsize < rsize)
+        {
+            cra_sorter_pdqsort(s, begin, pos, bad_allowed, leftmost);
+            begin = pos + 1;
+            leftmost = false;
+        }
+        else
+        {
+            cra_sorter_pdqsort(s, pos + 1, end, bad_allowed, false);
+            end = pos;
+        }
+    }
 }
 
 bool(cra_alist_sort)(CraAList *list, cra_cmp_fn compare)
 {
+    int            bad_allowed;
+    CraAListSorter sorter;
+
     assert(list);
     assert(compare);
     assert(list->array);
     if (list->count > 1) // count(array) >= 2
     {
-        CRA_TEMP_NEW(temp, list->itemsize);
+        CRA_TEMP_NEW(temp, list->itemsize * 2);
         if (!temp)
             return false;
 
-        cra_alist_quick_sort(list, compare, 0, list->count - 1, temp);
+        sorter.array = list->array;
+        sorter.size = list->itemsize;
+        sorter.compare = compare;
+        sorter.pivot = (unsigned char *)temp;
+        sorter.temp = (unsigned char *)temp + list->itemsize;
+        // 最多允许log2(n)次不平衡的划分
+        for (bad_allowed = 1; ((size_t)1 << bad_allowed) < list->count; ++bad_allowed)
+            ;
+        cra_sorter_pdqsort(&sorter, 0, list->count, bad_allowed, true);
+
+        CRA_TEMP_DEL(temp, list->itemsize * 2);
+    }
+    return true;
+}
+
+// LSD基数排序: key转换成保序的无符号整数后按字节从低到高稳定地分配
+
+static inline uint64_t
+cra_alist_radix_key(const unsigned char *p, CraRadixKey_e key_type, size_t key_size)
+{
+    uint64_t u, sign;
+
+    switch (key_size)
+    {
+        case 1:
+            u = *p;
+            break;
+        case 2:
+        {
+            uint16_t v;
+            memcpy(&v, p, 2);
+            u = v;
+        }
+        break;
+        case 4:
+        {
+            uint32_t v;
+            memcpy(&v, p, 4);
+            u = v;
+        }
+        break;
+        default:
+            memcpy(&u, p, 8);
+            break;
+    }
+
+    sign = (uint64_t)1 << (key_size * 8 - 1);
+    switch (key_type)
+    {
+        case CRA_RADIX_KEY_INT:
+            // 翻转符号位: 负数排在前面
+            return u ^ sign;
+        case CRA_RADIX_KEY_FLOAT:
+            // 负数全部取反(绝对值大的在前)，正数置符号位
+            if (u & sign)
+                return ~u & (sign | (sign - 1));
+            return u | sign;
+        default:
+            return u;
+    }
+}
+
+bool(cra_alist_radix_sort)(CraAList *list, CraRadixKey_e key_type, size_t key_offset, size_t key_size)
+{
+    size_t         counts[8][256];
+    size_t         offsets[256];
+    size_t         n, size, sum;
+    uint64_t       key;
+    unsigned char *src, *dst, *swap;
+
+    assert(list);
+    assert(list->array);
+    assert(key_size == 1 || key_size == 2 || key_size == 4 || key_size == 8);
+    assert(key_type != CRA_RADIX_KEY_FLOAT || key_size == 4 || key_size == 8);
+    assert(key_offset + key_size <= list->itemsize);
+
+    n = list->count;
+    size = list->itemsize;
+    if (n < 2)
+        return true;
 
-        CRA_TEMP_DEL(temp, list->itemsize);
+    dst = cra_malloc(n * size);
+    if (!dst)
+        return false;
+
+    // 一次遍历统计所有字节的直方图
+    bzero(counts, sizeof(counts[0]) * key_size);
+    for (size_t i = 0; i < n; ++i)
+    {
+        key = cra_alist_radix_key(list->array + i * size + key_offset, key_type, key_size);
+        for (size_t d = 0; d < key_size; ++d)
+            ++counts[d][(key >> (d * 8)) & 0xff];
+    }
+
+    src = list->array;
+    for (size_t d = 0; d < key_size; ++d)
+    {
+        // 所有key的这个字节都相同，跳过
+        key = cra_alist_radix_key(src + key_offset, key_type, key_size);
+        if (counts[d][(key >> (d * 8)) & 0xff] == n)
+            continue;
+
+        sum = 0;
+        for (size_t b = 0; b < 256; ++b)
+        {
+            offsets[b] = sum;
+            sum += counts[d][b];
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            key = cra_alist_radix_key(src + i * size + key_offset, key_type, key_size);
+            memcpy(dst + offsets[(key >> (d * 8)) & 0xff]++ * size, src + i * size, size);
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    // 结果在临时内存中时复制回来
+    if (src != list->array)
+    {
+        memcpy(list->array, src, n * size);
+        cra_free(src);
+    }
+    else
+    {
+        cra_free(dst);
     }
     return true;
 }
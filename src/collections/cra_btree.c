@@ -0,0 +1,790 @@
+/**
+ * @file cra_btree.c
+ * @author Cracal
+ * @brief 有序字典(B+树)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "collections/cra_btree.h"
+#include "cra_malloc.h"
+
+#define CRA_BTREE_ALIGN_UP(n, a) (((n) + ((a) - 1)) & ~((a) - 1))
+
+struct CraBTreeNode
+{
+    unsigned int count; // key数
+    bool         leaf;
+};
+
+// 叶子: 头 | keys[leaf_capacity] | vals[leaf_capacity]
+typedef struct CraBTreeLeaf
+{
+    CraBTreeNode  base;
+    CraBTreeNode *prev;
+    CraBTreeNode *next;
+} CraBTreeLeaf;
+
+// 内部节点: 头 | children[inner_capacity + 1] | keys[inner_capacity]
+// children[i]中的key都 < keys[i] <= children[i + 1]中的key
+typedef struct CraBTreeInner
+{
+    CraBTreeNode  base;
+    CraBTreeNode *children[];
+} CraBTreeInner;
+
+#define CRA_BTREE_LEAF(node)  ((CraBTreeLeaf *)(node))
+#define CRA_BTREE_INNER(node) ((CraBTreeInner *)(node))
+
+#define CRA_BTREE_LKEY(tree, node, i) \
+    ((unsigned char *)(node) + (tree)->leaf_keys_offset + (size_t)(i) * (tree)->key_size)
+#define CRA_BTREE_LVAL(tree, node, i) \
+    ((unsigned char *)(node) + (tree)->leaf_vals_offset + (size_t)(i) * (tree)->val_size)
+#define CRA_BTREE_IKEY(tree, node, i) \
+    ((unsigned char *)(node) + (tree)->inner_keys_offset + (size_t)(i) * (tree)->key_size)
+#define CRA_BTREE_CHILD(node, i) (CRA_BTREE_INNER(node)->children[i])
+
+static inline unsigned int
+cra_btree_capacity_for(size_t bytes_per_key)
+{
+    size_t capacity = CRA_BTREE_NODE_BYTES / bytes_per_key;
+    return (unsigned int)CRA_MIN(CRA_MAX(capacity, CRA_BTREE_MIN_CAPACITY), CRA_BTREE_MAX_CAPACITY);
+}
+
+static inline CraBTreeNode *
+cra_btree_new_leaf(CraBTree *tree)
+{
+    CraBTreeNode *node = cra_malloc(tree->leaf_size);
+    if (node)
+    {
+        node->count = 0;
+        node->leaf = true;
+        CRA_BTREE_LEAF(node)->prev = NULL;
+        CRA_BTREE_LEAF(node)->next = NULL;
+    }
+    return node;
+}
+
+static inline CraBTreeNode *
+cra_btree_new_inner(CraBTree *tree)
+{
+    CraBTreeNode *node = cra_malloc(tree->inner_size);
+    if (node)
+    {
+        node->count = 0;
+        node->leaf = false;
+    }
+    return node;
+}
+
+// 在有序的keys[0, count)中二分查找
+// upper为false时返回第一个 >= key 的下标，为true时返回第一个 > key 的下标
+static inline unsigned int
+cra_btree_search(CraBTree *tree, unsigned char *keys, unsigned int count, const void *key, bool upper)
+{
+    int          cmp;
+    unsigned int mid;
+    unsigned int l = 0;
+    unsigned int r = count;
+
+    while (l < r)
+    {
+        mid = l + ((r - l) >> 1);
+        cmp = tree->compare_key(keys + (size_t)mid * tree->key_size, key);
+        if (cmp < 0 || (upper && cmp == 0))
+            l = mid + 1;
+        else
+            r = mid;
+    }
+    return l;
+}
+
+static inline unsigned int
+cra_btree_leaf_search(CraBTree *tree, CraBTreeNode *node, const void *key, bool upper)
+{
+    return cra_btree_search(tree, CRA_BTREE_LKEY(tree, node, 0), node->count, key, upper);
+}
+
+// key所在的子树
+static inline unsigned int
+cra_btree_inner_search(CraBTree *tree, CraBTreeNode *node, const void *key)
+{
+    return cra_btree_search(tree, CRA_BTREE_IKEY(tree, node, 0), node->count, key, true);
+}
+
+// 从根找到key所在的叶子，path/pidx记录经过的内部节点和所走的孩子下标
+static inline CraBTreeNode *
+cra_btree_descend(CraBTree *tree, const void *key, CraBTreeNode **path, unsigned int *pidx, ssize_t *retdepth)
+{
+    unsigned int  i;
+    ssize_t       depth = 0;
+    CraBTreeNode *node = tree->root;
+
+    while (!node->leaf)
+    {
+        i = cra_btree_inner_search(tree, node, key);
+        if (path)
+        {
+            assert(depth < CRA_BTREE_MAX_HEIGHT);
+            path[depth] = node;
+            pidx[depth] = i;
+        }
+        ++depth;
+        node = CRA_BTREE_CHILD(node, i);
+    }
+    if (retdepth)
+        *retdepth = depth;
+    return node;
+}
+
+static inline void
+cra_btree_leaf_insert(CraBTree *tree, CraBTreeNode *node, unsigned int pos, const void *key, const void *val)
+{
+    unsigned int n = node->count - pos;
+
+    assert(node->count < tree->leaf_capacity);
+
+    memmove(CRA_BTREE_LKEY(tree, node, pos + 1), CRA_BTREE_LKEY(tree, node, pos), n * tree->key_size);
+    memmove(CRA_BTREE_LVAL(tree, node, pos + 1), CRA_BTREE_LVAL(tree, node, pos), n * tree->val_size);
+    memcpy(CRA_BTREE_LKEY(tree, node, pos), key, tree->key_size);
+    memcpy(CRA_BTREE_LVAL(tree, node, pos), val, tree->val_size);
+    ++node->count;
+}
+
+static inline void
+cra_btree_leaf_remove(CraBTree *tree, CraBTreeNode *node, unsigned int pos)
+{
+    unsigned int n = node->count - pos - 1;
+
+    memmove(CRA_BTREE_LKEY(tree, node, pos), CRA_BTREE_LKEY(tree, node, pos + 1), n * tree->key_size);
+    memmove(CRA_BTREE_LVAL(tree, node, pos), CRA_BTREE_LVAL(tree, node, pos + 1), n * tree->val_size);
+    --node->count;
+}
+
+// 把src的[from, from + n)复制到dst的to处，dst与src是不同的叶子
+static inline void
+cra_btree_leaf_copy(CraBTree *tree, CraBTreeNode *dst, unsigned int to, CraBTreeNode *src, unsigned int from, size_t n)
+{
+    memcpy(CRA_BTREE_LKEY(tree, dst, to), CRA_BTREE_LKEY(tree, src, from), n * tree->key_size);
+    memcpy(CRA_BTREE_LVAL(tree, dst, to), CRA_BTREE_LVAL(tree, src, from), n * tree->val_size);
+}
+
+// 插入keys[pos]和children[pos + 1]
+static inline void
+cra_btree_inner_insert(CraBTree *tree, CraBTreeNode *node, unsigned int pos, const void *key, CraBTreeNode *child)
+{
+    unsigned int n = node->count - pos;
+
+    assert(node->count < tree->inner_capacity);
+
+    memmove(CRA_BTREE_IKEY(tree, node, pos + 1), CRA_BTREE_IKEY(tree, node, pos), n * tree->key_size);
+    memmove(&CRA_BTREE_CHILD(node, pos + 2), &CRA_BTREE_CHILD(node, pos + 1), n * sizeof(CraBTreeNode *));
+    memcpy(CRA_BTREE_IKEY(tree, node, pos), key, tree->key_size);
+    CRA_BTREE_CHILD(node, pos + 1) = child;
+    ++node->count;
+}
+
+// 删除keys[pos]和children[pos + 1]
+static inline void
+cra_btree_inner_remove(CraBTree *tree, CraBTreeNode *node, unsigned int pos)
+{
+    unsigned int n = node->count - pos - 1;
+
+    memmove(CRA_BTREE_IKEY(tree, node, pos), CRA_BTREE_IKEY(tree, node, pos + 1), n * tree->key_size);
+    memmove(&CRA_BTREE_CHILD(node, pos + 1), &CRA_BTREE_CHILD(node, pos + 2), n * sizeof(CraBTreeNode *));
+    --node->count;
+}
+
+// 满的叶子node分裂出right，并在pos处插入key-val
+static void
+cra_btree_leaf_split_insert(CraBTree     *tree,
+                            CraBTreeNode *node,
+                            CraBTreeNode *right,
+                            unsigned int  pos,
+                            const void   *key,
+                            const void   *val)
+{
+    CraBTreeNode *next;
+    unsigned int  cap = tree->leaf_capacity;
+    unsigned int  half = (cap + 1) / 2;
+
+    assert(node->count == cap);
+
+    if (pos < half)
+    {
+        cra_btree_leaf_copy(tree, right, 0, node, half - 1, cap - half + 1);
+        right->count = cap - half + 1;
+        node->count = half - 1;
+        cra_btree_leaf_insert(tree, node, pos, key, val);
+    }
+    else
+    {
+        cra_btree_leaf_copy(tree, right, 0, node, half, cap - half);
+        right->count = cap - half;
+        node->count = half;
+        cra_btree_leaf_insert(tree, right, pos - half, key, val);
+    }
+
+    next = CRA_BTREE_LEAF(node)->next;
+    CRA_BTREE_LEAF(right)->prev = node;
+    CRA_BTREE_LEAF(right)->next = next;
+    if (next)
+        CRA_BTREE_LEAF(next)->prev = right;
+    else
+        tree->last = right;
+    CRA_BTREE_LEAF(node)->next = right;
+}
+
+// 满的内部节点node分裂出right，并插入keys[pos] = key, children[pos + 1] = child
+// 中间的key移到upkey，由调用者插入父节点
+static void
+cra_btree_inner_split_insert(CraBTree      *tree,
+                             CraBTreeNode  *node,
+                             CraBTreeNode  *right,
+                             unsigned int   pos,
+                             const void    *key,
+                             CraBTreeNode  *child,
+                             unsigned char *upkey)
+{
+    unsigned int cap = tree->inner_capacity;
+    unsigned int mid = (cap + 1) / 2;
+
+    assert(node->count == cap);
+
+    if (pos < mid)
+    {
+        memcpy(upkey, CRA_BTREE_IKEY(tree, node, mid - 1), tree->key_size);
+        memcpy(CRA_BTREE_IKEY(tree, right, 0), CRA_BTREE_IKEY(tree, node, mid), (cap - mid) * tree->key_size);
+        memcpy(&CRA_BTREE_CHILD(right, 0), &CRA_BTREE_CHILD(node, mid), (cap - mid + 1) * sizeof(CraBTreeNode *));
+        right->count = cap - mid;
+        node->count = mid - 1;
+        cra_btree_inner_insert(tree, node, pos, key, child);
+    }
+    else if (pos == mid)
+    {
+        memcpy(upkey, key, tree->key_size);
+        memcpy(CRA_BTREE_IKEY(tree, right, 0), CRA_BTREE_IKEY(tree, node, mid), (cap - mid) * tree->key_size);
+        CRA_BTREE_CHILD(right, 0) = child;
+        memcpy(&CRA_BTREE_CHILD(right, 1), &CRA_BTREE_CHILD(node, mid + 1), (cap - mid) * sizeof(CraBTreeNode *));
+        right->count = cap - mid;
+        node->count = mid;
+    }
+    else
+    {
+        memcpy(upkey, CRA_BTREE_IKEY(tree, node, mid), tree->key_size);
+        memcpy(CRA_BTREE_IKEY(tree, right, 0), CRA_BTREE_IKEY(tree, node, mid + 1), (cap - mid - 1) * tree->key_size);
+        memcpy(&CRA_BTREE_CHILD(right, 0), &CRA_BTREE_CHILD(node, mid + 1), (cap - mid) * sizeof(CraBTreeNode *));
+        right->count = cap - mid - 1;
+        node->count = mid;
+        cra_btree_inner_insert(tree, right, pos - mid - 1, key, child);
+    }
+}
+
+// 释放以node为根的子树，keep除外
+static void
+cra_btree_free_subtree(CraBTreeNode *node, CraBTreeNode *keep)
+{
+    if (!node->leaf)
+    {
+        for (unsigned int i = 0; i <= node->count; ++i)
+            cra_btree_free_subtree(CRA_BTREE_CHILD(node, i), keep);
+    }
+    if (node != keep)
+        cra_free(node);
+}
+
+bool(cra_btree_init)(CraBTree  *tree,
+                     size_t     key_size,
+                     size_t     val_size,
+                     size_t     key_align,
+                     size_t     val_align,
+                     cra_cmp_fn compare_key)
+{
+    size_t offset;
+
+    assert(tree);
+    assert(key_size > 0);
+    assert(val_size > 0);
+    assert(key_align > 0);
+    assert(val_align > 0);
+    assert(key_size % key_align == 0);
+    assert(val_size % val_align == 0);
+    assert(compare_key);
+
+    tree->key_size = key_size;
+    tree->val_size = val_size;
+    tree->compare_key = compare_key;
+
+    tree->leaf_capacity = cra_btree_capacity_for(key_size + val_size);
+    offset = CRA_BTREE_ALIGN_UP(sizeof(CraBTreeLeaf), key_align);
+    tree->leaf_keys_offset = offset;
+    offset += tree->leaf_capacity * key_size;
+    offset = CRA_BTREE_ALIGN_UP(offset, val_align);
+    tree->leaf_vals_offset = offset;
+    tree->leaf_size = offset + tree->leaf_capacity * val_size;
+
+    tree->inner_capacity = cra_btree_capacity_for(key_size + sizeof(CraBTreeNode *));
+    offset = sizeof(CraBTreeInner) + (tree->inner_capacity + 1) * sizeof(CraBTreeNode *);
+    offset = CRA_BTREE_ALIGN_UP(offset, key_align);
+    tree->inner_keys_offset = offset;
+    tree->inner_size = offset + tree->inner_capacity * key_size;
+
+    tree->count = 0;
+    tree->height = 1;
+    tree->carry = cra_malloc(key_size * 2);
+    if (!tree->carry)
+        return false;
+    tree->root = cra_btree_new_leaf(tree);
+    if (!tree->root)
+    {
+        cra_free(tree->carry);
+        return false;
+    }
+    tree->first = tree->last = tree->root;
+    return true;
+}
+
+void
+cra_btree_uninit(CraBTree *tree)
+{
+    assert(tree);
+    assert(tree->root);
+
+    cra_btree_free_subtree(tree->root, NULL);
+    cra_free(tree->carry);
+    bzero(tree, sizeof(*tree));
+}
+
+void
+cra_btree_clear(CraBTree *tree)
+{
+    assert(tree);
+    assert(tree->root);
+
+    // 留下最左的叶子作为新的根
+    cra_btree_free_subtree(tree->root, tree->first);
+    tree->root = tree->last = tree->first;
+    tree->root->count = 0;
+    CRA_BTREE_LEAF(tree->root)->next = NULL;
+    tree->count = 0;
+    tree->height = 1;
+}
+
+bool(cra_btree_put_and_return_kv)(CraBTree *tree, void *key, void *val, void *retoldkey, void *retoldval, bool add)
+{
+    unsigned int   pos, i;
+    ssize_t        depth, k, nspare, s;
+    unsigned char *carry, *upkey, *tmp;
+    CraBTreeNode  *node, *child, *right;
+    CraBTreeNode  *path[CRA_BTREE_MAX_HEIGHT];
+    unsigned int   pidx[CRA_BTREE_MAX_HEIGHT];
+    CraBTreeNode  *spare[CRA_BTREE_MAX_HEIGHT + 1];
+
+    assert(tree);
+    assert(tree->root);
+    assert(key);
+    assert(val);
+
+    node = cra_btree_descend(tree, key, path, pidx, &depth);
+    pos = cra_btree_leaf_search(tree, node, key, false);
+    if (pos < node->count && tree->compare_key(CRA_BTREE_LKEY(tree, node, pos), key) == 0)
+    {
+        if (add)
+            return false;
+        if (retoldkey)
+            memcpy(retoldkey, CRA_BTREE_LKEY(tree, node, pos), tree->key_size);
+        if (retoldval)
+            memcpy(retoldval, CRA_BTREE_LVAL(tree, node, pos), tree->val_size);
+        memcpy(CRA_BTREE_LKEY(tree, node, pos), key, tree->key_size);
+        memcpy(CRA_BTREE_LVAL(tree, node, pos), val, tree->val_size);
+        return true;
+    }
+
+    if (node->count < tree->leaf_capacity)
+    {
+        cra_btree_leaf_insert(tree, node, pos, key, val);
+        ++tree->count;
+        return true;
+    }
+
+    // 先申请好分裂需要的所有节点，申请失败时树保持不变
+    nspare = 1;
+    for (k = depth; k > 0 && path[k - 1]->count == tree->inner_capacity; --k)
+        ++nspare;
+    if (k == 0)
+        ++nspare; // 根也要分裂
+    assert(nspare <= CRA_BTREE_MAX_HEIGHT + 1);
+    for (s = 0; s < nspare; ++s)
+    {
+        spare[s] = s == 0 ? cra_btree_new_leaf(tree) : cra_btree_new_inner(tree);
+        if (!spare[s])
+        {
+            while (--s >= 0)
+                cra_free(spare[s]);
+            return false;
+        }
+    }
+
+    cra_btree_leaf_split_insert(tree, node, spare[0], pos, key, val);
+    carry = tree->carry;
+    upkey = tree->carry + tree->key_size;
+    memcpy(carry, CRA_BTREE_LKEY(tree, spare[0], 0), tree->key_size);
+    child = spare[0];
+    s = 1;
+
+    while (depth > 0)
+    {
+        --depth;
+        node = path[depth];
+        i = pidx[depth];
+        if (node->count < tree->inner_capacity)
+        {
+            cra_btree_inner_insert(tree, node, i, carry, child);
+            assert(s == nspare);
+            ++tree->count;
+            return true;
+        }
+        right = spare[s++];
+        cra_btree_inner_split_insert(tree, node, right, i, carry, child, upkey);
+        tmp = carry;
+        carry = upkey;
+        upkey = tmp;
+        child = right;
+    }
+
+    // 根分裂，树高加1
+    node = spare[s++];
+    assert(s == nspare);
+    node->count = 1;
+    memcpy(CRA_BTREE_IKEY(tree, node, 0), carry, tree->key_size);
+    CRA_BTREE_CHILD(node, 0) = tree->root;
+    CRA_BTREE_CHILD(node, 1) = child;
+    tree->root = node;
+    ++tree->height;
+    ++tree->count;
+    return true;
+}
+
+// 把parent的children[i + 1]合并到children[i]
+static void
+cra_btree_merge(CraBTree *tree, CraBTreeNode *parent, unsigned int i)
+{
+    CraBTreeNode *left = CRA_BTREE_CHILD(parent, i);
+    CraBTreeNode *right = CRA_BTREE_CHILD(parent, i + 1);
+    CraBTreeNode *next;
+
+    if (left->leaf)
+    {
+        assert(left->count + right->count <= tree->leaf_capacity);
+        cra_btree_leaf_copy(tree, left, left->count, right, 0, right->count);
+        left->count += right->count;
+
+        next = CRA_BTREE_LEAF(right)->next;
+        CRA_BTREE_LEAF(left)->next = next;
+        if (next)
+            CRA_BTREE_LEAF(next)->prev = left;
+        else
+            tree->last = left;
+    }
+    else
+    {
+        // 父节点中的分隔key下移
+        assert(left->count + 1 + right->count <= tree->inner_capacity);
+        memcpy(CRA_BTREE_IKEY(tree, left, left->count), CRA_BTREE_IKEY(tree, parent, i), tree->key_size);
+        memcpy(CRA_BTREE_IKEY(tree, left, left->count + 1), CRA_BTREE_IKEY(tree, right, 0),
+               right->count * tree->key_size);
+        memcpy(&CRA_BTREE_CHILD(left, left->count + 1), &CRA_BTREE_CHILD(right, 0),
+               (right->count + 1) * sizeof(CraBTreeNode *));
+        left->count += 1 + right->count;
+    }
+
+    cra_btree_inner_remove(tree, parent, i);
+    cra_free(right);
+}
+
+// parent的children[i]不足半满，从兄弟借一个或与兄弟合并
+static void
+cra_btree_fix_leaf(CraBTree *tree, CraBTreeNode *parent, unsigned int i)
+{
+    CraBTreeNode *node = CRA_BTREE_CHILD(parent, i);
+    CraBTreeNode *left = i > 0 ? CRA_BTREE_CHILD(parent, i - 1) : NULL;
+    CraBTreeNode *right = i < parent->count ? CRA_BTREE_CHILD(parent, i + 1) : NULL;
+    unsigned int  min = tree->leaf_capacity / 2;
+
+    if (left && left->count > min)
+    {
+        cra_btree_leaf_insert(tree, node, 0, CRA_BTREE_LKEY(tree, left, left->count - 1),
+                              CRA_BTREE_LVAL(tree, left, left->count - 1));
+        --left->count;
+        memcpy(CRA_BTREE_IKEY(tree, parent, i - 1), CRA_BTREE_LKEY(tree, node, 0), tree->key_size);
+    }
+    else if (right && right->count > min)
+    {
+        cra_btree_leaf_insert(tree, node, node->count, CRA_BTREE_LKEY(tree, right, 0), CRA_BTREE_LVAL(tree, right, 0));
+        cra_btree_leaf_remove(tree, right, 0);
+        memcpy(CRA_BTREE_IKEY(tree, parent, i), CRA_BTREE_LKEY(tree, right, 0), tree->key_size);
+    }
+    else
+    {
+        cra_btree_merge(tree, parent, left ? i - 1 : i);
+    }
+}
+
+static void
+cra_btree_fix_inner(CraBTree *tree, CraBTreeNode *parent, unsigned int i)
+{
+    CraBTreeNode *node = CRA_BTREE_CHILD(parent, i);
+    CraBTreeNode *left = i > 0 ? CRA_BTREE_CHILD(parent, i - 1) : NULL;
+    CraBTreeNode *right = i < parent->count ? CRA_BTREE_CHILD(parent, i + 1) : NULL;
+    unsigned int  min = tree->inner_capacity / 2;
+
+    if (left && left->count > min)
+    {
+        // 经父节点向右旋转
+        memmove(CRA_BTREE_IKEY(tree, node, 1), CRA_BTREE_IKEY(tree, node, 0), node->count * tree->key_size);
+        memmove(&CRA_BTREE_CHILD(node, 1), &CRA_BTREE_CHILD(node, 0), (node->count + 1) * sizeof(CraBTreeNode *));
+        memcpy(CRA_BTREE_IKEY(tree, node, 0), CRA_BTREE_IKEY(tree, parent, i - 1), tree->key_size);
+        CRA_BTREE_CHILD(node, 0) = CRA_BTREE_CHILD(left, left->count);
+        ++node->count;
+        memcpy(CRA_BTREE_IKEY(tree, parent, i - 1), CRA_BTREE_IKEY(tree, left, left->count - 1), tree->key_size);
+        --left->count;
+    }
+    else if (right && right->count > min)
+    {
+        // 经父节点向左旋转
+        memcpy(CRA_BTREE_IKEY(tree, node, node->count), CRA_BTREE_IKEY(tree, parent, i), tree->key_size);
+        CRA_BTREE_CHILD(node, node->count + 1) = CRA_BTREE_CHILD(right, 0);
+        ++node->count;
+        memcpy(CRA_BTREE_IKEY(tree, parent, i), CRA_BTREE_IKEY(tree, right, 0), tree->key_size);
+        memmove(CRA_BTREE_IKEY(tree, right, 0), CRA_BTREE_IKEY(tree, right, 1), (right->count - 1) * tree->key_size);
+        memmove(&CRA_BTREE_CHILD(right, 0), &CRA_BTREE_CHILD(right, 1), right->count * sizeof(CraBTreeNode *));
+        --right->count;
+    }
+    else
+    {
+        cra_btree_merge(tree, parent, left ? i - 1 : i);
+    }
+}
+
+bool(cra_btree_pop_kv)(CraBTree *tree, const void *key, void *retkey, void *retval)
+{
+    unsigned int  pos, min;
+    ssize_t       depth;
+    CraBTreeNode *node, *root;
+    CraBTreeNode *path[CRA_BTREE_MAX_HEIGHT];
+    unsigned int  pidx[CRA_BTREE_MAX_HEIGHT];
+
+    assert(tree);
+    assert(tree->root);
+    assert(key);
+
+    node = cra_btree_descend(tree, key, path, pidx, &depth);
+    pos = cra_btree_leaf_search(tree, node, key, false);
+    if (pos >= node->count || tree->compare_key(CRA_BTREE_LKEY(tree, node, pos), key) != 0)
+        return false;
+
+    if (retkey)
+        memcpy(retkey, CRA_BTREE_LKEY(tree, node, pos), tree->key_size);
+    if (retval)
+        memcpy(retval, CRA_BTREE_LVAL(tree, node, pos), tree->val_size);
+    cra_btree_leaf_remove(tree, node, pos);
+    --tree->count;
+
+    // 自底向上修复不足半满的节点(根除外)
+    while (depth > 0)
+    {
+        min = node->leaf ? tree->leaf_capacity / 2 : tree->inner_capacity / 2;
+        if (node->count >= min)
+            break;
+        --depth;
+        if (node->leaf)
+            cra_btree_fix_leaf(tree, path[depth], pidx[depth]);
+        else
+            cra_btree_fix_inner(tree, path[depth], pidx[depth]);
+        node = path[depth];
+    }
+
+    // 根只剩一个孩子时树高减1
+    root = tree->root;
+    if (!root->leaf && root->count == 0)
+    {
+        tree->root = CRA_BTREE_CHILD(root, 0);
+        cra_free(root);
+        --tree->height;
+    }
+    return true;
+}
+
+void *(cra_btree_get_ref)(CraBTree * tree, const void *key)
+{
+    unsigned int  pos;
+    CraBTreeNode *node;
+
+    assert(tree);
+    assert(tree->root);
+    assert(key);
+
+    node = cra_btree_descend(tree, key, NULL, NULL, NULL);
+    pos = cra_btree_leaf_search(tree, node, key, false);
+    if (pos >= node->count || tree->compare_key(CRA_BTREE_LKEY(tree, node, pos), key) != 0)
+        return NULL;
+    return CRA_BTREE_LVAL(tree, node, pos);
+}
+
+static bool
+cra_btree_bound(CraBTree *tree, const void *key, CraIterator *it, bool upper)
+{
+    unsigned int  pos;
+    CraBTreeNode *node;
+
+    assert(tree);
+    assert(tree->root);
+    assert(key);
+    assert(it);
+
+    node = cra_btree_descend(tree, key, NULL, NULL, NULL);
+    pos = cra_btree_leaf_search(tree, node, key, upper);
+
+    it->obj = tree;
+    it->ic1.cur = node;
+    it->ic2.idx = pos;
+    // 叶子中没有时是下一个叶子的第一个(非根的叶子不会是空的)
+    return pos < node->count || CRA_BTREE_LEAF(node)->next != NULL;
+}
+
+bool(cra_btree_lower_bound)(CraBTree *tree, const void *key, CraIterator *it)
+{
+    return cra_btree_bound(tree, key, it, false);
+}
+
+bool(cra_btree_upper_bound)(CraBTree *tree, const void *key, CraIterator *it)
+{
+    return cra_btree_bound(tree, key, it, true);
+}
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+static CRA_INITIALIZABLE_INIT_FN(cra_btree_initializable_init)
+{
+    CraBTree                   *tree = (CraBTree *)obj;
+    CraBTreeInitializableParam *param = (CraBTreeInitializableParam *)params;
+
+    CRA_UNUSED(length);
+    assert(tree);
+    assert(param);
+
+    return (cra_btree_init)(tree, param->key_size, param->val_size, param->key_align, param->val_align,
+                            param->compare_key);
+}
+
+CRA_INITIALIZABLE_DEF(cra_g_btree_initializable_i) = {
+    .init = cra_btree_initializable_init,
+    .uninit = (CRA_INITIALIZABLE_UNINIT_FN((*)))cra_btree_uninit,
+};
+
+// appendable
+
+static CRA_APPENDABLE_APPEND_FN(cra_btree_appendable_append)
+{
+    assert(obj);
+    assert(val);
+    assert(val->key_ref);
+    assert(val->val_ref);
+
+    CraBTree *tree = (CraBTree *)obj;
+    return (cra_btree_put_and_return_kv)(tree, val->key_ref, val->val_ref, NULL, NULL, true);
+}
+
+CRA_APPENDABLE_DEF(cra_g_btree_appendable_i) = {
+    .append = cra_btree_appendable_append,
+};
+
+// iterable
+// ic1.cur: 当前叶子, ic2.idx: next要返回的下标
+
+static CRA_ITERABLE_INIT_FN(cra_btree_iterable_init)
+{
+    CraBTree *tree = (CraBTree *)obj;
+
+    assert(it);
+    assert(tree);
+    assert(tree->root);
+
+    if (retcnt)
+        *retcnt = (size_t)tree->count;
+
+    it->obj = obj;
+    it->ic1.cur = reverse ? tree->last : tree->first;
+    it->ic2.idx = reverse ? tree->last->count : 0;
+
+    return tree->count > 0;
+}
+
+static CRA_ITERABLE_NEXT_FN(cra_btree_iterable_next)
+{
+    CraBTree     *tree;
+    CraBTreeNode *node;
+    size_t        idx;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    tree = (CraBTree *)it->obj;
+    node = (CraBTreeNode *)it->ic1.cur;
+    idx = it->ic2.idx;
+
+    while (idx >= node->count)
+    {
+        if (!CRA_BTREE_LEAF(node)->next)
+            return false;
+        node = CRA_BTREE_LEAF(node)->next;
+        idx = 0;
+    }
+
+    val->key_ref = CRA_BTREE_LKEY(tree, node, idx);
+    val->val_ref = CRA_BTREE_LVAL(tree, node, idx);
+    it->ic1.cur = node;
+    it->ic2.idx = idx + 1;
+    return true;
+}
+
+static CRA_ITERABLE_PREV_FN(cra_btree_iterable_prev)
+{
+    CraBTree     *tree;
+    CraBTreeNode *node;
+    size_t        idx;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    tree = (CraBTree *)it->obj;
+    node = (CraBTreeNode *)it->ic1.cur;
+    idx = it->ic2.idx;
+
+    while (idx == 0)
+    {
+        if (!CRA_BTREE_LEAF(node)->prev)
+            return false;
+        node = CRA_BTREE_LEAF(node)->prev;
+        idx = node->count;
+    }
+
+    --idx;
+    val->key_ref = CRA_BTREE_LKEY(tree, node, idx);
+    val->val_ref = CRA_BTREE_LVAL(tree, node, idx);
+    it->ic1.cur = node;
+    it->ic2.idx = idx;
+    return true;
+}
+
+CRA_ITERABLE_DEF(cra_g_btree_iterable_i) = {
+    .init = cra_btree_iterable_init,
+    .next = cra_btree_iterable_next,
+    .prev = cra_btree_iterable_prev,
+};
@@ -69,15 +69,154 @@ cra_get_init_hash(void)
 #define cra_get_init_hash() 13747
 #endif
 
-// BKDR hash function
+// wyhash(final4)
+// 每步读8字节，长字符串每轮处理48字节(三路独立的64x64->128乘法)
+// 按本机字节序读取，hash值只在本进程内有效
+
+#define CRA_WY_SECRET0 0x2d358dccaa6c78a5ULL
+#define CRA_WY_SECRET1 0x8bb84b93962eacc9ULL
+#define CRA_WY_SECRET2 0x4b33a62ed433d4a3ULL
+#define CRA_WY_SECRET3 0x4d5a2da51de1aa47ULL
+// cra_hash_string2使用的另一个初始值，使它与cra_hash_string1相互独立
+#define CRA_WY_SEED2 0x9e3779b97f4a7c15ULL
+
+#if defined(CRA_COMPILER_MSVC) && defined(CRA_ARCH_X86_64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
+
+static inline void
+cra_wy_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(CRA_COMPILER_MSVC) && defined(CRA_ARCH_X86_64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t
+cra_wy_mix(uint64_t a, uint64_t b)
+{
+    cra_wy_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t
+cra_wy_r8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t
+cra_wy_r4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 1~3字节
+static inline uint64_t
+cra_wy_r3(const uint8_t *p, size_t k)
+{
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+static uint64_t
+cra_wyhash(const void *data, size_t len, uint64_t seed)
+{
+    uint64_t       a, b;
+    const uint8_t *p = (const uint8_t *)data;
+
+    seed ^= cra_wy_mix(seed ^ CRA_WY_SECRET0, CRA_WY_SECRET1);
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (cra_wy_r4(p) << 32) | cra_wy_r4(p + ((len >> 3) << 2));
+            b = (cra_wy_r4(p + len - 4) << 32) | cra_wy_r4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = cra_wy_r3(p, len);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = cra_wy_mix(cra_wy_r8(p) ^ CRA_WY_SECRET1, cra_wy_r8(p + 8) ^ seed);
+                see1 = cra_wy_mix(cra_wy_r8(p + 16) ^ CRA_WY_SECRET2, cra_wy_r8(p + 24) ^ see1);
+                see2 = cra_wy_mix(cra_wy_r8(p + 32) ^ CRA_WY_SECRET3, cra_wy_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = cra_wy_mix(cra_wy_r8(p) ^ CRA_WY_SECRET1, cra_wy_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // 最后16字节(可能与前面重叠)
+        a = cra_wy_r8(p + i - 16);
+        b = cra_wy_r8(p + i - 8);
+    }
+    a ^= CRA_WY_SECRET1;
+    b ^= seed;
+    cra_wy_mum(&a, &b);
+    return cra_wy_mix(a ^ CRA_WY_SECRET0 ^ len, b ^ CRA_WY_SECRET1);
+}
+
+static inline cra_hash_t
+cra_hash_bytes_with_seed(const void *data, size_t len, uint64_t seed)
+{
+    cra_hash_t hash = (cra_hash_t)cra_wyhash(data, len, seed);
+    return hash == -1 ? -2 : hash;
+}
+
+cra_hash_t
+cra_hash_bytes(const void *data, size_t len)
+{
+    assert(data || len == 0);
+    return cra_hash_bytes_with_seed(data, len, (uint64_t)cra_get_init_hash());
+}
+
+// 遇到'\0'或len个字符时结束
+static inline size_t
+cra_str_nlen(const char *val, size_t len)
+{
+    const char *end = (const char *)memchr(val, '\0', len);
+    return end ? (size_t)(end - val) : len;
+}
+
 cra_hash_t
 cra_hash_string1(const char *val)
 {
-    cra_hash_t hash = cra_get_init_hash();
-    cra_hash_t seed = 131;
-    while (*val)
-        hash = hash * seed + (*val++);
-    return hash == -1 ? -2 : hash;
+    return cra_hash_bytes_with_seed(val, strlen(val), (uint64_t)cra_get_init_hash());
 }
 
 cra_hash_t
@@ -86,19 +225,16 @@ cra_hash_string1_p(const char **val)
     return cra_hash_string1(*val);
 }
 
-// AP hash function
+cra_hash_t
+cra_hash_string1_n(const char *val, size_t len)
+{
+    return cra_hash_bytes_with_seed(val, cra_str_nlen(val, len), (uint64_t)cra_get_init_hash());
+}
+
 cra_hash_t
 cra_hash_string2(const char *val)
 {
-    cra_hash_t hash = cra_get_init_hash();
-    for (size_t i = 0; *val; ++i)
-    {
-        if ((i & 1) == 0)
-            hash ^= ((hash << 7) ^ (*val++) ^ (hash >> 3));
-        else
-            hash ^= (~((hash << 11) ^ (*val++) ^ (hash >> 5)));
-    }
-    return hash == -1 ? -2 : hash;
+    return cra_hash_bytes_with_seed(val, strlen(val), (uint64_t)cra_get_init_hash() ^ CRA_WY_SEED2);
 }
 
 cra_hash_t
@@ -106,3 +242,9 @@ cra_hash_string2_p(const char **val)
 {
     return cra_hash_string2(*val);
 }
+
+cra_hash_t
+cra_hash_string2_n(const char *val, size_t len)
+{
+    return cra_hash_bytes_with_seed(val, cra_str_nlen(val, len), (uint64_t)cra_get_init_hash() ^ CRA_WY_SEED2);
+}
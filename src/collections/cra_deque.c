@@ -53,23 +53,27 @@ cra_deque_get_next_pow2(size_t n)
 static inline bool
 cra_deque_expand_array(CraDeque *deque, size_t new_capacity)
 {
+    size_t          nused;
     unsigned char **new_array;
 
+    assert(new_capacity > deque->narray);
+
     new_array = cra_malloc(new_capacity * sizeof(deque->array[0]));
     if (!new_array)
         return false;
     bzero(new_array, new_capacity * sizeof(deque->array[0]));
 
-    // move blocks to new array
+    // move blocks to new array (including unused blocks)
+    nused = ((deque->rear - deque->front) & (deque->narray - 1)) + 1;
     for (size_t i = 0, j = deque->front; i < deque->narray; ++i)
     {
-        assert(deque->array[j]);
+        assert(i >= nused || deque->count == 0 || deque->array[j]);
         new_array[i] = deque->array[j];
         j = (j + 1) & (deque->narray - 1);
     }
     // update front & rear
     deque->front = 0;
-    deque->rear = deque->narray - 1;
+    deque->rear = nused - 1;
 
     cra_free(deque->array);
     deque->array = new_array;
@@ -377,6 +381,66 @@ bool(cra_deque_push_back)(CraDeque *deque, void *val)
     return true;
 }
 
+bool(cra_deque_push_back_n)(CraDeque *deque, void *vals, size_t n)
+{
+    size_t         nfree, nblocks, nused;
+    size_t         k, j, m, rest;
+    unsigned char *src;
+
+    assert(deque);
+    assert(deque->array);
+    assert(vals || n == 0);
+
+    if (n == 0)
+        return true;
+
+    // 尾块之后还需要的块数
+    nfree = CRA_DEQUE_ITEM_COUNT - 1 - deque->rindex;
+    nblocks = n > nfree ? (n - nfree + CRA_DEQUE_ITEM_COUNT - 1) >> CRA_DEQUE_ITEM_SHIFT : 0;
+    nused = ((deque->rear - deque->front) & (deque->narray - 1)) + 1;
+    if (nused + nblocks > deque->narray)
+    {
+        if (!cra_deque_expand_array(deque, cra_deque_get_next_pow2(nused + nblocks)))
+            return false;
+    }
+
+    // 先申请好所有的块，失败时队列保持不变
+    k = deque->rear;
+    for (size_t i = 0; i <= nblocks; ++i)
+    {
+        if (!deque->array[k])
+        {
+            deque->array[k] = cra_malloc(deque->itemsize * CRA_DEQUE_ITEM_COUNT);
+            if (!deque->array[k])
+                return false;
+        }
+        k = (k + 1) & (deque->narray - 1);
+    }
+
+    // 每块一次memcpy
+    src = (unsigned char *)vals;
+    rest = n;
+    k = deque->rear;
+    j = deque->rindex + 1;
+    while (rest > 0)
+    {
+        if (j == CRA_DEQUE_ITEM_COUNT)
+        {
+            k = (k + 1) & (deque->narray - 1);
+            j = 0;
+        }
+        m = CRA_MIN(CRA_DEQUE_ITEM_COUNT - j, rest);
+        memcpy(CRA_DEQUE_ARRAY_PVAL(deque, deque->array[k], j), src, m * deque->itemsize);
+        src += m * deque->itemsize;
+        rest -= m;
+        j += m;
+    }
+    deque->rear = k;
+    deque->rindex = j - 1;
+    deque->count += n;
+    return true;
+}
+
 bool(cra_deque_pop_at)(CraDeque *deque, size_t index, void *retval)
 {
     size_t idx;
@@ -457,6 +521,52 @@ bool(cra_deque_pop_back)(CraDeque *deque, void *retval)
     return true;
 }
 
+bool(cra_deque_pop_front_n)(CraDeque *deque, void *retvals, size_t n)
+{
+    size_t         idx;
+    size_t         k, j, m, rest;
+    unsigned char *dst;
+
+    assert(deque);
+    assert(deque->array);
+
+    if (n > deque->count)
+        return false;
+    if (n == 0)
+        return true;
+
+    if (retvals)
+    {
+        // 每块一次memcpy
+        dst = (unsigned char *)retvals;
+        rest = n;
+        k = deque->front;
+        j = deque->lindex;
+        while (rest > 0)
+        {
+            m = CRA_MIN(CRA_DEQUE_ITEM_COUNT - j, rest);
+            memcpy(dst, CRA_DEQUE_ARRAY_PVAL(deque, deque->array[k], j), m * deque->itemsize);
+            dst += m * deque->itemsize;
+            rest -= m;
+            k = (k + 1) & (deque->narray - 1);
+            j = 0;
+        }
+    }
+
+    deque->count -= n;
+    if (deque->count == 0)
+    {
+        CRA_DEQUE_EMPTY_INDEX(deque);
+    }
+    else
+    {
+        idx = deque->lindex + n;
+        deque->front = (deque->front + (idx >> CRA_DEQUE_ITEM_SHIFT)) & (deque->narray - 1);
+        deque->lindex = idx & CRA_DEQUE_ITEM_MASK;
+    }
+    return true;
+}
+
 void *(cra_deque_get_ref)(CraDeque * deque, size_t index)
 {
     size_t iblock, iitem;
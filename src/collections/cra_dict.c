@@ -10,6 +10,7 @@
  */
 #include "collections/cra_dict.h"
 #include "cra_malloc.h"
+#include "cra_futils.h"
 
 #define CRA_DICT_MAX_CHAIN_LENGTH 16
 
@@ -21,9 +22,27 @@
     ((CraDictEntry *)((unsigned char *)(entries) + (index) * (dict)->entry_size))
 #define CRA_DICT_PENTRY(dict, index) CRA_DICT_PENTRY0(dict, (dict)->entries, index)
 #define CRA_DICT_PKEY(dict, entry)   ((void *)((unsigned char *)(entry) + (dict)->key_offset))
-#define CRA_DICT_PVAL(dict, entry)   ((void *)((unsigned char *)(entry) + (dict)->val_offset))
+// 分离布局时val在vals数组中，与entry下标相同
+#define CRA_DICT_PVAL(dict, entry, index)                                      \
+    (CRA_DICT_IS_SPLIT(dict) ? (void *)((dict)->vals + (size_t)(index) * (dict)->val_size) \
+                             : (void *)((unsigned char *)(entry) + (dict)->val_offset))
 
-#define CRA_DICT_BUCKET(hash, capacity) (((hash) & CRA_HASH_MAX) % (capacity))
+#define CRA_DICT_IS_POW2(dict) (!!((dict)->flags & CRA_DICT_FLAG_POW2))
+#define CRA_DICT_IS_INCR(dict) (!!((dict)->flags & CRA_DICT_FLAG_INCR))
+#define CRA_DICT_IS_SPLIT(dict) (!!((dict)->flags & CRA_DICT_FLAG_SPLIT))
+
+// 渐进式扩容时，每次操作最多迁移的非空旧桶数
+#define CRA_DICT_REHASH_STEP 4
+
+// 批量操作每批的key数，批内的内存访问互相重叠
+#define CRA_DICT_BATCH_SIZE 16
+
+// 桶中保存(链表头entry下标 + 1)，0表示空桶，这样新桶数组可以直接用calloc得到
+#define CRA_DICT_HEAD(buckets, bucket)            ((buckets)[bucket] - 1)
+#define CRA_DICT_SET_HEAD(buckets, bucket, index) ((buckets)[bucket] = (index) + 1)
+
+#define CRA_DICT_BUCKET(hash, capacity)      (((hash) & CRA_HASH_MAX) % (capacity))
+#define CRA_DICT_BUCKET_POW2(hash, capacity) (cra_hash_mix(hash) & ((capacity) - 1))
 
 struct CraDictEntry
 {
@@ -113,6 +132,29 @@ cra_dict_next_prime(ssize_t n)
     return prime_table[l];
 }
 
+static inline ssize_t
+cra_dict_next_pow2(ssize_t n)
+{
+    ssize_t c = 8;
+    while (c < n)
+        c <<= 1;
+    return c;
+}
+
+static inline ssize_t
+cra_dict_next_capacity(CraDict *dict, ssize_t n)
+{
+    return CRA_DICT_IS_POW2(dict) ? cra_dict_next_pow2(n) : cra_dict_next_prime(n);
+}
+
+static inline ssize_t
+cra_dict_bucket(CraDict *dict, cra_hash_t hash, ssize_t capacity)
+{
+    if (CRA_DICT_IS_POW2(dict))
+        return (ssize_t)CRA_DICT_BUCKET_POW2(hash, capacity);
+    return CRA_DICT_BUCKET(hash, capacity);
+}
+
 bool(cra_dict_init_with_size)(CraDict    *dict,
                               size_t      key_size,
                               size_t      val_size,
@@ -121,9 +163,22 @@ bool(cra_dict_init_with_size)(CraDict    *dict,
                               size_t      init_capacity,
                               cra_hash_fn hash_key,
                               cra_cmp_fn  compare_key)
+{
+    return (cra_dict_init_with_flags)(dict, key_size, val_size, key_align, val_align, init_capacity,
+                                      CRA_DICT_FLAG_NONE, hash_key, compare_key);
+}
+
+bool(cra_dict_init_with_flags)(CraDict     *dict,
+                               size_t       key_size,
+                               size_t       val_size,
+                               size_t       key_align,
+                               size_t       val_align,
+                               size_t       init_capacity,
+                               unsigned int flags,
+                               cra_hash_fn  hash_key,
+                               cra_cmp_fn   compare_key)
 {
     size_t offset;
-    size_t buckets_size;
     size_t entries_size;
 
     assert(dict);
@@ -142,9 +197,17 @@ bool(cra_dict_init_with_size)(CraDict    *dict,
     dict->key_offset = offset;
     offset += key_size;
 
-    offset = CRA_DICT_ALIGN_UP(offset, val_align);
-    dict->val_offset = offset;
-    offset += val_size;
+    if (flags & CRA_DICT_FLAG_SPLIT)
+    {
+        // val在单独的数组中，val_size总是val_align的整数倍
+        dict->val_offset = 0;
+    }
+    else
+    {
+        offset = CRA_DICT_ALIGN_UP(offset, val_align);
+        dict->val_offset = offset;
+        offset += val_size;
+    }
 
     dict->entry_size = CRA_DICT_ALIGN_UP(offset, alignof(CraDictEntry));
     dict->key_size = key_size;
@@ -156,12 +219,15 @@ bool(cra_dict_init_with_size)(CraDict    *dict,
     dict->next = 0;
     dict->count = 0;
     dict->freelist = -1;
-    dict->capacity = cra_dict_next_prime(init_capacity);
+    dict->flags = flags;
+    dict->old_buckets = NULL;
+    dict->old_capacity = 0;
+    dict->rehash_idx = 0;
+    dict->capacity = cra_dict_next_capacity(dict, init_capacity);
 
-    buckets_size = dict->capacity * sizeof(ssize_t);
     entries_size = CRA_DICT_USABLE_FRACTION(dict->capacity) * dict->entry_size;
 
-    dict->buckets = cra_malloc(buckets_size);
+    dict->buckets = cra_calloc(dict->capacity, sizeof(ssize_t));
     if (!dict->buckets)
         return false;
 
@@ -172,7 +238,17 @@ bool(cra_dict_init_with_size)(CraDict    *dict,
         return false;
     }
 
-    memset(dict->buckets, 0xff, buckets_size);
+    dict->vals = NULL;
+    if (CRA_DICT_IS_SPLIT(dict))
+    {
+        dict->vals = cra_malloc(CRA_DICT_USABLE_FRACTION(dict->capacity) * dict->val_size);
+        if (!dict->vals)
+        {
+            cra_free(dict->buckets);
+            cra_free(dict->entries);
+            return false;
+        }
+    }
 
     return true;
 }
@@ -184,48 +260,255 @@ cra_dict_uninit(CraDict *dict)
 
     cra_free(dict->buckets);
     cra_free(dict->entries);
+    if (dict->vals)
+        cra_free(dict->vals);
+    if (dict->old_buckets)
+        cra_free(dict->old_buckets);
     bzero(dict, sizeof(*dict));
 }
 
+static inline void
+cra_dict_rehash_done(CraDict *dict)
+{
+    cra_free(dict->old_buckets);
+    dict->old_buckets = NULL;
+    dict->old_capacity = 0;
+    dict->rehash_idx = 0;
+}
+
+// 把一个旧桶的链迁移到新桶
+static inline void
+cra_dict_rehash_bucket(CraDict *dict, ssize_t old_bucket)
+{
+    ssize_t       bucket;
+    CraDictEntry *entry;
+
+    for (ssize_t i = CRA_DICT_HEAD(dict->old_buckets, old_bucket), next; i >= 0; i = next)
+    {
+        entry = CRA_DICT_PENTRY(dict, i);
+        next = entry->next;
+
+        bucket = cra_dict_bucket(dict, entry->hash, dict->capacity);
+        entry->next = CRA_DICT_HEAD(dict->buckets, bucket);
+        CRA_DICT_SET_HEAD(dict->buckets, bucket, i);
+    }
+    CRA_DICT_SET_HEAD(dict->old_buckets, old_bucket, -1);
+}
+
+// 迁移最多n个非空旧桶(最多访问n * 10个空桶)
+static void
+cra_dict_rehash_step(CraDict *dict, ssize_t n)
+{
+    ssize_t empty_visits = n * 10;
+
+    assert(dict->old_buckets);
+
+    while (n > 0 && dict->rehash_idx < dict->old_capacity)
+    {
+        if (CRA_DICT_HEAD(dict->old_buckets, dict->rehash_idx) >= 0)
+        {
+            cra_dict_rehash_bucket(dict, dict->rehash_idx);
+            --n;
+        }
+        else if (--empty_visits == 0)
+        {
+            ++dict->rehash_idx;
+            break;
+        }
+        ++dict->rehash_idx;
+    }
+
+    if (dict->rehash_idx >= dict->old_capacity)
+        cra_dict_rehash_done(dict);
+}
+
+static void
+cra_dict_rehash_finish(CraDict *dict)
+{
+    for (; dict->rehash_idx < dict->old_capacity; ++dict->rehash_idx)
+    {
+        if (CRA_DICT_HEAD(dict->old_buckets, dict->rehash_idx) >= 0)
+            cra_dict_rehash_bucket(dict, dict->rehash_idx);
+    }
+    cra_dict_rehash_done(dict);
+}
+
+// 渐进式扩容: entries原地扩大(下标不变)，只申请新桶，旧桶在之后的操作中逐步迁移
+static bool
+cra_dict_grow_incr(CraDict *dict)
+{
+    ssize_t        new_capacity;
+    ssize_t       *new_buckets;
+    CraDictEntry  *new_entries;
+    unsigned char *new_vals;
+
+    if (dict->old_buckets)
+        cra_dict_rehash_finish(dict);
+
+    new_capacity = cra_dict_next_capacity(dict, dict->capacity + 1);
+
+    new_entries = cra_realloc(dict->entries, CRA_DICT_USABLE_FRACTION(new_capacity) * dict->entry_size);
+    if (!new_entries)
+        return false;
+    dict->entries = new_entries;
+    if (dict->vals)
+    {
+        new_vals = cra_realloc(dict->vals, CRA_DICT_USABLE_FRACTION(new_capacity) * dict->val_size);
+        if (!new_vals)
+            return false;
+        dict->vals = new_vals;
+    }
+
+    // 不逐个初始化新桶，避免扩容时一次性写满整个桶数组
+    new_buckets = cra_calloc(new_capacity, sizeof(ssize_t));
+    if (!new_buckets)
+        return false;
+
+    dict->old_buckets = dict->buckets;
+    dict->old_capacity = dict->capacity;
+    dict->rehash_idx = 0;
+    dict->buckets = new_buckets;
+    dict->capacity = new_capacity;
+    return true;
+}
+
+// 在链中查找key，返回entry下标，没找到返回-1
+// compare_key(key, 字典中的key)，查找异构key时不是dict->compare_key
+static inline ssize_t
+cra_dict_find_in_chain(CraDict    *dict,
+                       ssize_t     head,
+                       const void *key,
+                       cra_hash_t  hash,
+                       cra_cmp_fn  compare_key,
+                       ssize_t    *retlast,
+                       size_t     *retchainlen)
+{
+    CraDictEntry *entry;
+    ssize_t       last = -1;
+    size_t        chain_len = 0;
+
+    for (ssize_t i = head; i >= 0;)
+    {
+        entry = CRA_DICT_PENTRY(dict, i);
+        if (entry->hash == hash && compare_key(key, CRA_DICT_PKEY(dict, entry)) == 0)
+        {
+            if (retlast)
+                *retlast = last;
+            return i;
+        }
+        last = i;
+        i = entry->next;
+        ++chain_len;
+    }
+    if (retchainlen)
+        *retchainlen = chain_len;
+    return -1;
+}
+
+// 查找key，返回entry下标，没找到返回-1
+// retbuckets: key所在的桶数组(新桶或未迁移的旧桶)
+static inline ssize_t
+cra_dict_find(CraDict    *dict,
+              const void *key,
+              cra_hash_t  hash,
+              cra_cmp_fn  compare_key,
+              ssize_t   **retbuckets,
+              ssize_t    *retbucket,
+              ssize_t    *retlast,
+              size_t     *retchainlen)
+{
+    ssize_t bucket, index;
+
+    bucket = cra_dict_bucket(dict, hash, dict->capacity);
+    index = cra_dict_find_in_chain(dict, CRA_DICT_HEAD(dict->buckets, bucket), key, hash, compare_key, retlast,
+                                   retchainlen);
+    if (retbuckets)
+    {
+        *retbuckets = dict->buckets;
+        *retbucket = bucket;
+    }
+    if (index >= 0 || !dict->old_buckets)
+        return index;
+
+    bucket = cra_dict_bucket(dict, hash, dict->old_capacity);
+    if (bucket < dict->rehash_idx)
+        return -1;
+    index = cra_dict_find_in_chain(dict, CRA_DICT_HEAD(dict->old_buckets, bucket), key, hash, compare_key, retlast,
+                                   NULL);
+    if (index >= 0 && retbuckets)
+    {
+        *retbuckets = dict->old_buckets;
+        *retbucket = bucket;
+    }
+    return index;
+}
+
+void
+cra_dict_clear(CraDict *dict)
+{
+    assert(dict);
+    assert(dict->buckets);
+    assert(dict->entries);
+    assert(dict->entry_size > 0 && dict->entry_size % 2 == 0);
+
+    if (dict->old_buckets)
+        cra_dict_rehash_done(dict);
+    if (dict->count > 0)
+        bzero(dict->buckets, dict->capacity * sizeof(ssize_t));
+    dict->freelist = -1;
+    dict->count = 0;
+    dict->next = 0;
+}
+
 bool
 cra_dict_reserve(CraDict *dict, ssize_t new_capacity)
 {
-    ssize_t       new_bucket;
-    ssize_t      *new_buckets;
-    CraDictEntry *new_entries;
-    CraDictEntry *entry1, *entry2;
-    size_t        new_buckets_size;
-    size_t        new_entries_size;
+    ssize_t        new_bucket;
+    ssize_t       *new_buckets;
+    CraDictEntry  *new_entries;
+    CraDictEntry  *entry1, *entry2;
+    unsigned char *new_vals;
+    size_t         new_nentries;
 
     assert(dict);
     assert(dict->buckets);
     assert(dict->entries);
     assert(dict->entry_size > 0 && dict->entry_size % 2 == 0);
 
+    if (dict->old_buckets)
+        cra_dict_rehash_finish(dict);
+
     if (new_capacity < dict->count)
     {
-        new_capacity = cra_dict_next_prime(dict->count);
-        new_buckets_size = new_capacity * sizeof(ssize_t);
-        new_entries_size = new_capacity * dict->entry_size;
+        new_capacity = cra_dict_next_capacity(dict, dict->count);
+        new_nentries = new_capacity;
     }
     else
     {
-        new_capacity = cra_dict_next_prime(new_capacity);
-        new_buckets_size = new_capacity * sizeof(ssize_t);
-        new_entries_size = CRA_DICT_USABLE_FRACTION(new_capacity) * dict->entry_size;
+        new_capacity = cra_dict_next_capacity(dict, new_capacity);
+        new_nentries = CRA_DICT_USABLE_FRACTION(new_capacity);
     }
 
-    new_buckets = cra_malloc(new_buckets_size);
+    new_buckets = cra_calloc(new_capacity, sizeof(ssize_t));
     if (!new_buckets)
         return false;
-    new_entries = cra_malloc(new_entries_size);
+    new_entries = cra_malloc(new_nentries * dict->entry_size);
     if (!new_entries)
     {
-        cra_free(new_entries);
+        cra_free(new_buckets);
         return false;
     }
-
-    memset(new_buckets, 0xff, new_buckets_size);
+    new_vals = NULL;
+    if (dict->vals)
+    {
+        new_vals = cra_malloc(new_nentries * dict->val_size);
+        if (!new_vals)
+        {
+            cra_free(new_buckets);
+            cra_free(new_entries);
+            return false;
+        }
+    }
 
     for (ssize_t i = 0, j = 0; i < dict->next; ++i)
     {
@@ -234,10 +517,12 @@ cra_dict_reserve(CraDict *dict, ssize_t new_capacity)
         {
             entry2 = CRA_DICT_PENTRY0(dict, new_entries, j);
             memcpy(entry2, entry1, dict->entry_size);
+            if (new_vals)
+                memcpy(new_vals + j * dict->val_size, dict->vals + i * dict->val_size, dict->val_size);
 
-            new_bucket = CRA_DICT_BUCKET(entry2->hash, new_capacity);
-            entry2->next = new_buckets[new_bucket];
-            new_buckets[new_bucket] = j;
+            new_bucket = cra_dict_bucket(dict, entry2->hash, new_capacity);
+            entry2->next = CRA_DICT_HEAD(new_buckets, new_bucket);
+            CRA_DICT_SET_HEAD(new_buckets, new_bucket, j);
 
             ++j;
         }
@@ -245,59 +530,66 @@ cra_dict_reserve(CraDict *dict, ssize_t new_capacity)
 
     cra_free(dict->buckets);
     cra_free(dict->entries);
+    if (dict->vals)
+        cra_free(dict->vals);
     dict->buckets = new_buckets;
     dict->entries = new_entries;
+    dict->vals = new_vals;
     dict->capacity = new_capacity;
     dict->next = dict->count;
     dict->freelist = -1;
     return true;
 }
 
-bool(cra_dict_put_and_return_kv)(CraDict *dict, void *key, void *val, void *retoldkey, void *retoldval, bool add)
+// put的主体，hash已经算好，渐进式迁移由调用者负责
+static bool
+cra_dict_put_hashed(CraDict    *dict,
+                    void       *key,
+                    void       *val,
+                    cra_hash_t  hash,
+                    void       *retoldkey,
+                    void       *retoldval,
+                    bool        add)
 {
-    cra_hash_t    hash;
     CraDictEntry *entry;
     ssize_t       bucket, index;
     size_t        chain_len;
 
-    assert(key);
-    assert(val);
-    assert(dict);
-    assert(dict->buckets);
-    assert(dict->entries);
-
-    hash = dict->hash_key(key);
-    bucket = CRA_DICT_BUCKET(hash, dict->capacity);
-
     chain_len = 0;
-    for (ssize_t i = dict->buckets[bucket]; i >= 0;)
+    index = cra_dict_find(dict, key, hash, dict->compare_key, NULL, NULL, NULL, &chain_len);
+    if (index >= 0)
     {
-        entry = CRA_DICT_PENTRY(dict, i);
-        if (entry->hash == hash && dict->compare_key(key, CRA_DICT_PKEY(dict, entry)) == 0)
-        {
-            if (add)
-                return false;
+        if (add)
+            return false;
 
-            if (retoldkey)
-                memcpy(retoldkey, CRA_DICT_PKEY(dict, entry), dict->key_size);
-            if (retoldval)
-                memcpy(retoldval, CRA_DICT_PVAL(dict, entry), dict->val_size);
+        entry = CRA_DICT_PENTRY(dict, index);
+        if (retoldkey)
+            memcpy(retoldkey, CRA_DICT_PKEY(dict, entry), dict->key_size);
+        if (retoldval)
+            memcpy(retoldval, CRA_DICT_PVAL(dict, entry, index), dict->val_size);
 
-            memcpy(CRA_DICT_PKEY(dict, entry), key, dict->key_size);
-            memcpy(CRA_DICT_PVAL(dict, entry), val, dict->val_size);
+        memcpy(CRA_DICT_PKEY(dict, entry), key, dict->key_size);
+        memcpy(CRA_DICT_PVAL(dict, entry, index), val, dict->val_size);
 
-            return true;
-        }
-        i = entry->next;
-        ++chain_len;
+        return true;
     }
 
-    if (chain_len > CRA_DICT_MAX_CHAIN_LENGTH || dict->next >= CRA_DICT_USABLE_FRACTION(dict->capacity))
+    if (CRA_DICT_IS_INCR(dict))
+    {
+        // 迁移期间链长只会缩短，不因链长触发扩容
+        if (dict->next >= CRA_DICT_USABLE_FRACTION(dict->capacity) ||
+            (chain_len > CRA_DICT_MAX_CHAIN_LENGTH && !dict->old_buckets))
+        {
+            if (!cra_dict_grow_incr(dict))
+                return false;
+        }
+    }
+    else if (chain_len > CRA_DICT_MAX_CHAIN_LENGTH || dict->next >= CRA_DICT_USABLE_FRACTION(dict->capacity))
     {
         if (!cra_dict_reserve(dict, dict->capacity + 1))
             return false;
-        bucket = CRA_DICT_BUCKET(hash, dict->capacity);
     }
+    bucket = cra_dict_bucket(dict, hash, dict->capacity);
 
     if (dict->freelist >= 0)
     {
@@ -313,92 +605,474 @@ bool(cra_dict_put_and_return_kv)(CraDict *dict, void *key, void *val, void *reto
     }
 
     entry->hash = hash;
-    entry->next = dict->buckets[bucket];
-    dict->buckets[bucket] = index;
+    entry->next = CRA_DICT_HEAD(dict->buckets, bucket);
+    CRA_DICT_SET_HEAD(dict->buckets, bucket, index);
     memcpy(CRA_DICT_PKEY(dict, entry), key, dict->key_size);
-    memcpy(CRA_DICT_PVAL(dict, entry), val, dict->val_size);
+    memcpy(CRA_DICT_PVAL(dict, entry, index), val, dict->val_size);
 
     ++dict->count;
 
     return true;
 }
 
+bool(cra_dict_put_and_return_kv)(CraDict *dict, void *key, void *val, void *retoldkey, void *retoldval, bool add)
+{
+    assert(key);
+    assert(dict);
+
+    return (cra_dict_put_and_return_kv_with_hash)(dict, key, dict->hash_key(key), val, retoldkey, retoldval, add);
+}
+
+bool(cra_dict_put_and_return_kv_with_hash)(CraDict   *dict,
+                                           void      *key,
+                                           cra_hash_t hash,
+                                           void      *val,
+                                           void      *retoldkey,
+                                           void      *retoldval,
+                                           bool       add)
+{
+    assert(key);
+    assert(val);
+    assert(dict);
+    assert(dict->buckets);
+    assert(dict->entries);
+    assert(hash == dict->hash_key(key));
+
+    if (dict->old_buckets)
+        cra_dict_rehash_step(dict, CRA_DICT_REHASH_STEP);
+
+    return cra_dict_put_hashed(dict, key, val, hash, retoldkey, retoldval, add);
+}
+
+// 批量操作的第一、二阶段: 算出整批key的hash并预取桶，再读桶预取链头entry
+// 这样n个key的缓存未命中是重叠的，而不是逐个等待
+static inline void
+cra_dict_prefetch_batch(CraDict *dict, const unsigned char *keys, size_t n, cra_hash_t *hashes, ssize_t *heads)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+    {
+        hashes[i] = dict->hash_key(keys + i * dict->key_size);
+        heads[i] = cra_dict_bucket(dict, hashes[i], dict->capacity);
+        cra_prefetch(&dict->buckets[heads[i]]);
+    }
+    for (i = 0; i < n; ++i)
+    {
+        heads[i] = CRA_DICT_HEAD(dict->buckets, heads[i]);
+        if (heads[i] >= 0)
+            cra_prefetch(CRA_DICT_PENTRY(dict, heads[i]));
+    }
+}
+
+size_t(cra_dict_put_many)(CraDict *dict, void *keys, void *vals, size_t n)
+{
+    size_t         i, j, m;
+    unsigned char *pkey, *pval;
+    cra_hash_t     hashes[CRA_DICT_BATCH_SIZE];
+    ssize_t        heads[CRA_DICT_BATCH_SIZE];
+
+    assert(dict);
+    assert(dict->buckets);
+    assert(dict->entries);
+    assert(n == 0 || (keys && vals));
+
+    // 先一次扩容到位，避免批量插入过程中多次rehash
+    // 渐进式扩容的字典不这样做，以免一次停顿太久
+    if (!CRA_DICT_IS_INCR(dict) && dict->next + (ssize_t)n > CRA_DICT_USABLE_FRACTION(dict->capacity))
+        cra_dict_reserve(dict, (dict->count + (ssize_t)n) * 100 / 72 + 1);
+
+    for (i = 0; i < n; i += m)
+    {
+        m = CRA_MIN(n - i, CRA_DICT_BATCH_SIZE);
+        pkey = (unsigned char *)keys + i * dict->key_size;
+        pval = (unsigned char *)vals + i * dict->val_size;
+
+        // 迁移进度和逐个操作时一样
+        if (dict->old_buckets)
+            cra_dict_rehash_step(dict, CRA_DICT_REHASH_STEP * (ssize_t)m);
+
+        cra_dict_prefetch_batch(dict, pkey, m, hashes, heads);
+        for (j = 0; j < m; ++j)
+        {
+            if (!cra_dict_put_hashed(dict, pkey + j * dict->key_size, pval + j * dict->val_size, hashes[j], NULL,
+                                     NULL, false))
+                return i + j;
+        }
+    }
+    return n;
+}
+
 bool(cra_dict_pop_kv)(CraDict *dict, const void *key, void *retkey, void *retval)
 {
-    cra_hash_t    hash;
+    assert(key);
+    assert(dict);
+
+    return (cra_dict_pop_kv_with_hash)(dict, key, dict->hash_key(key), retkey, retval);
+}
+
+bool(cra_dict_pop_kv_with_hash)(CraDict *dict, const void *key, cra_hash_t hash, void *retkey, void *retval)
+{
     CraDictEntry *entry;
+    ssize_t      *buckets;
     ssize_t       bucket, last, index;
 
     assert(key);
     assert(dict);
     assert(dict->buckets);
     assert(dict->entries);
+    assert(hash == dict->hash_key(key));
+
+    if (dict->old_buckets)
+        cra_dict_rehash_step(dict, CRA_DICT_REHASH_STEP);
+
+    index = cra_dict_find(dict, key, hash, dict->compare_key, &buckets, &bucket, &last, NULL);
+    if (index < 0)
+        return false;
+
+    entry = CRA_DICT_PENTRY(dict, index);
+    if (retkey)
+        memcpy(retkey, CRA_DICT_PKEY(dict, entry), dict->key_size);
+    if (retval)
+        memcpy(retval, CRA_DICT_PVAL(dict, entry, index), dict->val_size);
 
-    hash = dict->hash_key(key);
-    bucket = CRA_DICT_BUCKET(hash, dict->capacity);
+    if (last >= 0)
+        CRA_DICT_PENTRY(dict, last)->next = entry->next;
+    else
+        CRA_DICT_SET_HEAD(buckets, bucket, entry->next);
+
+    entry->hash = -1;
+    entry->next = dict->freelist;
+    dict->freelist = index;
 
-    last = -1;
-    for (ssize_t i = dict->buckets[bucket]; i >= 0;)
+    if (--dict->count == 0)
     {
-        entry = CRA_DICT_PENTRY(dict, i);
-        if (entry->hash == hash && dict->compare_key(key, CRA_DICT_PKEY(dict, entry)) == 0)
-        {
-            if (retkey)
-                memcpy(retkey, CRA_DICT_PKEY(dict, entry), dict->key_size);
-            if (retval)
-                memcpy(retval, CRA_DICT_PVAL(dict, entry), dict->val_size);
+        dict->freelist = -1;
+        dict->next = 0;
+    }
 
-            index = dict->buckets[bucket];
+    return true;
+}
 
-            if (last >= 0)
-                CRA_DICT_PENTRY(dict, last)->next = entry->next;
-            else
-                dict->buckets[bucket] = entry->next;
+void *(cra_dict_get_ref)(CraDict * dict, const void *key)
+{
+    assert(key);
+    assert(dict);
+
+    return (cra_dict_get_ref_as)(dict, key, dict->hash_key(key), dict->compare_key);
+}
+
+void *(cra_dict_get_ref_with_hash)(CraDict * dict, const void *key, cra_hash_t hash)
+{
+    assert(key);
+    assert(dict);
+    assert(hash == dict->hash_key(key));
+
+    return (cra_dict_get_ref_as)(dict, key, hash, dict->compare_key);
+}
+
+void *(cra_dict_get_ref_as)(CraDict * dict, const void *key, cra_hash_t hash, cra_cmp_fn compare_key)
+{
+    ssize_t index;
+
+    assert(key);
+    assert(dict);
+    assert(dict->buckets);
+    assert(dict->entries);
+    assert(compare_key);
+
+    if (dict->old_buckets)
+        cra_dict_rehash_step(dict, CRA_DICT_REHASH_STEP);
+
+    index = cra_dict_find(dict, key, hash, compare_key, NULL, NULL, NULL, NULL);
+    if (index < 0)
+        return NULL;
+    return CRA_DICT_PVAL(dict, CRA_DICT_PENTRY(dict, index), index);
+}
+
+size_t(cra_dict_get_many)(CraDict *dict, const void *keys, size_t n, void **retvals)
+{
+    size_t               i, j, m, found;
+    ssize_t              index;
+    const unsigned char *pkey;
+    cra_hash_t           hashes[CRA_DICT_BATCH_SIZE];
+    ssize_t              heads[CRA_DICT_BATCH_SIZE];
+
+    assert(dict);
+    assert(dict->buckets);
+    assert(dict->entries);
+    assert(n == 0 || (keys && retvals));
+
+    found = 0;
+    for (i = 0; i < n; i += m)
+    {
+        m = CRA_MIN(n - i, CRA_DICT_BATCH_SIZE);
+        pkey = (const unsigned char *)keys + i * dict->key_size;
+
+        // 迁移进度和逐个操作时一样
+        if (dict->old_buckets)
+            cra_dict_rehash_step(dict, CRA_DICT_REHASH_STEP * (ssize_t)m);
 
-            entry->hash = -1;
-            entry->next = dict->freelist;
-            dict->freelist = index;
+        cra_dict_prefetch_batch(dict, pkey, m, hashes, heads);
+        for (j = 0; j < m; ++j)
+        {
+            // 迁移中还要查旧桶，走完整的查找
+            if (dict->old_buckets)
+                index = cra_dict_find(dict, pkey + j * dict->key_size, hashes[j], dict->compare_key, NULL, NULL, NULL,
+                                      NULL);
+            else
+                index = cra_dict_find_in_chain(dict, heads[j], pkey + j * dict->key_size, hashes[j], dict->compare_key,
+                                               NULL, NULL);
 
-            if (--dict->count == 0)
+            if (index >= 0)
             {
-                dict->freelist = -1;
-                dict->next = 0;
+                retvals[i + j] = CRA_DICT_PVAL(dict, CRA_DICT_PENTRY(dict, index), index);
+                ++found;
+            }
+            else
+            {
+                retvals[i + j] = NULL;
             }
-
-            return true;
         }
-
-        last = i;
-        i = entry->next;
     }
+    return found;
+}
 
-    return false;
+// ====================================== 只读镜像 ======================================
+
+#define CRA_DICT_IMAGE_ALIGN 64
+
+static bool
+cra_dict_write_zeros(FILE *fp, size_t n)
+{
+    static const unsigned char zeros[CRA_DICT_IMAGE_ALIGN] = { 0 };
+    assert(n <= sizeof(zeros));
+    return n == 0 || fwrite(zeros, 1, n, fp) == n;
 }
 
-void *(cra_dict_get_ref)(CraDict * dict, const void *key)
+bool
+cra_dict_freeze(CraDict *dict, const char *path)
 {
-    cra_hash_t    hash;
-    CraDictEntry *entry;
-    ssize_t       bucket;
+    FILE              *fp;
+    ssize_t            bucket;
+    ssize_t           *buckets, *nexts;
+    CraDictEntry      *entry, *copy;
+    CraDictImageHeader header;
+    size_t             buckets_end, entries_end;
+    bool               ok;
 
-    assert(key);
     assert(dict);
     assert(dict->buckets);
     assert(dict->entries);
+    assert(path);
+
+    // 镜像中的链表按新下标(去掉空洞后)重建，渐进式扩容中的旧桶不需要迁移完
+    buckets = cra_calloc(dict->capacity, sizeof(ssize_t));
+    nexts = cra_malloc(sizeof(ssize_t) * (dict->count + 1));
+    copy = cra_malloc(dict->entry_size);
+    if (!buckets || !nexts || !copy)
+    {
+        ok = false;
+        goto end;
+    }
+    for (ssize_t i = 0, j = 0; i < dict->next; ++i)
+    {
+        entry = CRA_DICT_PENTRY(dict, i);
+        if (entry->hash != -1)
+        {
+            bucket = cra_dict_bucket(dict, entry->hash, dict->capacity);
+            nexts[j] = CRA_DICT_HEAD(buckets, bucket);
+            CRA_DICT_SET_HEAD(buckets, bucket, j);
+            ++j;
+        }
+    }
 
-    hash = dict->hash_key(key);
-    bucket = CRA_DICT_BUCKET(hash, dict->capacity);
+    bzero(&header, sizeof(header));
+    memcpy(header.magic, CRA_DICT_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = CRA_DICT_IMAGE_VERSION;
+    header.endian = CRA_DICT_IMAGE_ENDIAN;
+    header.word_size = sizeof(ssize_t);
+    header.flags = dict->flags & (CRA_DICT_FLAG_POW2 | CRA_DICT_FLAG_SPLIT);
+    header.key_size = dict->key_size;
+    header.val_size = dict->val_size;
+    header.key_offset = dict->key_offset;
+    header.val_offset = dict->val_offset;
+    header.entry_size = dict->entry_size;
+    header.count = dict->count;
+    header.capacity = dict->capacity;
+    header.buckets_offset = CRA_DICT_ALIGN_UP(sizeof(header), CRA_DICT_IMAGE_ALIGN);
+    buckets_end = header.buckets_offset + dict->capacity * sizeof(ssize_t);
+    header.entries_offset = CRA_DICT_ALIGN_UP(buckets_end, CRA_DICT_IMAGE_ALIGN);
+    entries_end = header.entries_offset + dict->count * dict->entry_size;
+    if (dict->vals)
+    {
+        header.vals_offset = CRA_DICT_ALIGN_UP(entries_end, CRA_DICT_IMAGE_ALIGN);
+        header.image_size = header.vals_offset + dict->count * dict->val_size;
+    }
+    else
+    {
+        header.image_size = entries_end;
+    }
 
-    for (ssize_t i = dict->buckets[bucket]; i >= 0;)
+    fp = fopen(path, "wb");
+    if (!fp)
+    {
+        ok = false;
+        goto end;
+    }
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         cra_dict_write_zeros(fp, header.buckets_offset - sizeof(header)) &&
+         fwrite(buckets, sizeof(ssize_t), dict->capacity, fp) == (size_t)dict->capacity &&
+         cra_dict_write_zeros(fp, header.entries_offset - buckets_end);
+    for (ssize_t i = 0, j = 0; ok && i < dict->next; ++i)
     {
         entry = CRA_DICT_PENTRY(dict, i);
-        if (entry->hash == hash && dict->compare_key(key, CRA_DICT_PKEY(dict, entry)) == 0)
+        if (entry->hash != -1)
         {
-            return CRA_DICT_PVAL(dict, entry);
+            memcpy(copy, entry, dict->entry_size);
+            copy->next = nexts[j++];
+            ok = fwrite(copy, dict->entry_size, 1, fp) == 1;
+        }
+    }
+    if (ok && dict->vals)
+    {
+        ok = cra_dict_write_zeros(fp, header.vals_offset - entries_end);
+        for (ssize_t i = 0; ok && i < dict->next; ++i)
+        {
+            if (CRA_DICT_PENTRY(dict, i)->hash != -1)
+                ok = fwrite(dict->vals + i * dict->val_size, dict->val_size, 1, fp) == 1;
         }
-        i = entry->next;
     }
+    if (fclose(fp) != 0)
+        ok = false;
+    if (!ok)
+        remove(path);
+
+end:
+    if (buckets)
+        cra_free(buckets);
+    if (nexts)
+        cra_free(nexts);
+    if (copy)
+        cra_free(copy);
+    return ok;
+}
+
+bool(cra_dict_view_open)(CraDictView *view,
+                         const char  *path,
+                         size_t       key_size,
+                         size_t       val_size,
+                         cra_hash_fn  hash_key,
+                         cra_cmp_fn   compare_key)
+{
+    const void               *image;
+    size_t                    image_size;
+    const CraDictImageHeader *header;
+    const CraDictEntry       *entry;
+    uint64_t                  entries_end;
+
+    assert(view);
+    assert(path);
+    assert(key_size > 0);
+    assert(val_size > 0);
+    assert(hash_key);
+    assert(compare_key);
+
+    image = cra_mmap_file_readonly(path, &image_size);
+    if (!image)
+        return false;
+
+    // 只校验头部和各区域的边界，不逐个检查链表下标，镜像应来自可信的cra_dict_freeze
+    header = (const CraDictImageHeader *)image;
+    if (image_size < sizeof(*header) || memcmp(header->magic, CRA_DICT_IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CRA_DICT_IMAGE_VERSION || header->endian != CRA_DICT_IMAGE_ENDIAN ||
+        header->word_size != sizeof(ssize_t) || header->image_size != image_size ||
+        header->key_size != key_size || header->val_size != val_size ||
+        header->entry_size < sizeof(CraDictEntry) || header->key_offset + key_size > header->entry_size ||
+        header->capacity == 0 || header->buckets_offset + header->capacity * sizeof(ssize_t) > header->entries_offset)
+        goto fail;
+    entries_end = header->entries_offset + header->count * header->entry_size;
+    if (header->flags & CRA_DICT_FLAG_SPLIT)
+    {
+        if (entries_end > header->vals_offset || header->vals_offset + header->count * val_size != image_size)
+            goto fail;
+    }
+    else if (header->val_offset + val_size > header->entry_size || entries_end != image_size)
+    {
+        goto fail;
+    }
+
+    view->image = image;
+    view->image_size = image_size;
+    view->buckets = (const ssize_t *)((const unsigned char *)image + header->buckets_offset);
+    view->entries = (const unsigned char *)image + header->entries_offset;
+    view->vals = (header->flags & CRA_DICT_FLAG_SPLIT) ? (const unsigned char *)image + header->vals_offset : NULL;
+    view->count = (ssize_t)header->count;
+    view->capacity = (ssize_t)header->capacity;
+    view->flags = header->flags;
+    view->key_size = key_size;
+    view->val_size = val_size;
+    view->key_offset = header->key_offset;
+    view->val_offset = header->val_offset;
+    view->entry_size = header->entry_size;
+    view->hash_key = hash_key;
+    view->compare_key = compare_key;
+
+    // 抽查一个entry，发现hash_key与冻结时不一致
+    if (view->count > 0)
+    {
+        entry = CRA_DICT_PENTRY0(view, view->entries, view->count - 1);
+        if (hash_key(CRA_DICT_PKEY(view, entry)) != entry->hash)
+            goto fail;
+    }
+    return true;
 
+fail:
+    cra_munmap_file(image, image_size);
+    return false;
+}
+
+void
+cra_dict_view_close(CraDictView *view)
+{
+    assert(view);
+    assert(view->image);
+
+    cra_munmap_file(view->image, view->image_size);
+    view->image = NULL;
+    view->buckets = NULL;
+    view->entries = NULL;
+}
+
+const void *(cra_dict_view_get_ref)(CraDictView * view, const void *key)
+{
+    assert(key);
+    assert(view);
+
+    return (cra_dict_view_get_ref_with_hash)(view, key, view->hash_key(key));
+}
+
+const void *(cra_dict_view_get_ref_with_hash)(CraDictView * view, const void *key, cra_hash_t hash)
+{
+    ssize_t             bucket;
+    const CraDictEntry *entry;
+
+    assert(key);
+    assert(view);
+    assert(view->image);
+    assert(hash == view->hash_key(key));
+
+    if (CRA_DICT_IS_POW2(view))
+        bucket = (ssize_t)CRA_DICT_BUCKET_POW2(hash, view->capacity);
+    else
+        bucket = CRA_DICT_BUCKET(hash, view->capacity);
+
+    for (ssize_t i = CRA_DICT_HEAD(view->buckets, bucket); i >= 0; i = entry->next)
+    {
+        entry = CRA_DICT_PENTRY0(view, view->entries, i);
+        if (entry->hash == hash && view->compare_key(key, CRA_DICT_PKEY(view, entry)) == 0)
+            return CRA_DICT_PVAL(view, entry, i);
+    }
     return NULL;
 }
 
@@ -414,8 +1088,8 @@ static CRA_INITIALIZABLE_INIT_FN(cra_dict_initializable_init)
     assert(dict);
     assert(param);
 
-    return (cra_dict_init_with_size)(dict, param->key_size, param->val_size, param->key_align, param->val_align, length,
-                                     param->hash_key, param->compare_key);
+    return (cra_dict_init_with_flags)(dict, param->key_size, param->val_size, param->key_align, param->val_align,
+                                      length, param->flags, param->hash_key, param->compare_key);
 }
 
 CRA_INITIALIZABLE_DEF(cra_g_dict_initializable_i) = {
@@ -479,7 +1153,7 @@ static CRA_ITERABLE_NEXT_FN(cra_dict_iterable_next)
         if (entry->hash != -1)
         {
             val->key_ref = CRA_DICT_PKEY(dict, entry);
-            val->val_ref = CRA_DICT_PVAL(dict, entry);
+            val->val_ref = CRA_DICT_PVAL(dict, entry, it->ic1.idx - 1);
             return true;
         }
     }
@@ -503,7 +1177,7 @@ static CRA_ITERABLE_PREV_FN(cra_dict_iterable_prev)
         if (entry->hash != -1)
         {
             val->key_ref = CRA_DICT_PKEY(dict, entry);
-            val->val_ref = CRA_DICT_PVAL(dict, entry);
+            val->val_ref = CRA_DICT_PVAL(dict, entry, it->ic1.idx);
             return true;
         }
     }
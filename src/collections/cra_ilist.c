@@ -0,0 +1,89 @@
+/**
+ * @file cra_ilist.c
+ * @author Cracal
+ * @brief 侵入式双向循环链表
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_ilist.h"
+
+#define CRA_ILIST_OBJ(list, node) ((unsigned char *)(node) - (list)->offset)
+
+void
+cra_ilist_clear(CraIList *list)
+{
+    assert(list);
+
+    while (cra_ilist_pop_front(list))
+        ;
+}
+
+// ====================================== interfaces ======================================
+
+// iterable
+
+static CRA_ITERABLE_INIT_FN(cra_ilist_iterable_init)
+{
+    CraIList *list = (CraIList *)obj;
+
+    assert(it);
+    assert(list);
+
+    if (retcnt)
+        *retcnt = list->count;
+
+    it->obj = list;
+    it->ic1.cur = reverse ? cra_ilist_back(list) : cra_ilist_front(list);
+    return list->count > 0;
+}
+
+static CRA_ITERABLE_NEXT_FN(cra_ilist_iterable_next)
+{
+    CraIList     *list;
+    CraIListNode *curr;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    list = (CraIList *)it->obj;
+    curr = (CraIListNode *)it->ic1.cur;
+
+    if (!curr)
+        return false;
+
+    // 先取下一个，允许删除当前节点
+    it->ic1.cur = cra_ilist_next(list, curr);
+    val->val_ref = CRA_ILIST_OBJ(list, curr);
+    return true;
+}
+
+static CRA_ITERABLE_PREV_FN(cra_ilist_iterable_prev)
+{
+    CraIList     *list;
+    CraIListNode *curr;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    list = (CraIList *)it->obj;
+    curr = (CraIListNode *)it->ic1.cur;
+
+    if (!curr)
+        return false;
+
+    // 先取上一个，允许删除当前节点
+    it->ic1.cur = cra_ilist_prev(list, curr);
+    val->val_ref = CRA_ILIST_OBJ(list, curr);
+    return true;
+}
+
+CRA_ITERABLE_DEF(cra_g_ilist_iterable_i) = {
+    .init = cra_ilist_iterable_init,
+    .next = cra_ilist_iterable_next,
+    .prev = cra_ilist_iterable_prev,
+};
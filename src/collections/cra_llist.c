@@ -28,6 +28,51 @@ cra_llist_destroy_node(CraLListNode *node)
     CRA_LLIST_DESTROY_NODE(node);
 }
 
+CraLListNode *
+cra_llist_new_node(CraLList *list)
+{
+    assert(list);
+    assert(list->itemsize > 0);
+
+    if (list->nodepool)
+        return (CraLListNode *)cra_mempool_alloc(list->nodepool);
+    return CRA_LLIST_CREATE_NODE(list->itemsize);
+}
+
+void
+cra_llist_delete_node(CraLList *list, CraLListNode *node)
+{
+    assert(list);
+    assert(node);
+
+    if (list->nodepool)
+        cra_mempool_dealloc(list->nodepool, node);
+    else
+        CRA_LLIST_DESTROY_NODE(node);
+}
+
+bool(cra_llist_nodepool_init)(CraMemPool *pool, size_t itemsize, size_t nodes_per_slab)
+{
+    assert(pool);
+    assert(itemsize > 0);
+    assert(nodes_per_slab > 0);
+
+    return cra_mempool_init(pool, CRA_LLIST_NODE_SIZE(itemsize), nodes_per_slab, 1);
+}
+
+bool(cra_llist_init_with_pool)(CraLList *list, size_t itemsize, CraMemPool *nodepool)
+{
+    assert(list);
+    assert(itemsize > 0);
+    assert(nodepool);
+    assert(nodepool->item_size >= CRA_LLIST_NODE_SIZE(itemsize));
+
+    bzero(list, sizeof(*list));
+    list->itemsize = itemsize;
+    list->nodepool = nodepool;
+    return true;
+}
+
 bool(cra_llist_init_with_size)(CraLList *list, size_t itemsize, size_t init_spare_node)
 {
     assert(list);
@@ -71,17 +116,21 @@ cra_llist_uninit(CraLList *list)
         {
             temp = curr;
             curr = temp->next;
-            CRA_LLIST_DESTROY_NODE(temp);
+            cra_llist_delete_node(list, temp);
         }
     }
 
-    // destroy free list nodes
-    curr = list->free_list;
-    while (curr)
+    // destroy free list nodes（有节点池时节点直接还给池，free list为空）
+    assert(!list->nodepool || !list->free_list);
+    if (!list->nodepool)
     {
-        temp = curr;
-        curr = temp->next;
-        CRA_LLIST_DESTROY_NODE(temp);
+        curr = list->free_list;
+        while (curr)
+        {
+            temp = curr;
+            curr = temp->next;
+            CRA_LLIST_DESTROY_NODE(temp);
+        }
     }
 
     bzero(list, sizeof(*list));
@@ -93,13 +142,29 @@ cra_llist_clear(CraLList *list)
     assert(list);
     assert(list->itemsize > 0);
 
-    if (list->head)
+    if (!list->head)
+        return;
+
+    assert(list->count > 0);
+    assert(list->head->prev);
+    assert(list->head->next);
+    assert(list->head->prev->next == list->head);
+
+    if (list->nodepool)
     {
-        assert(list->count > 0);
-        assert(list->head->prev);
-        assert(list->head->next);
-        assert(list->head->prev->next == list->head);
+        // 还给节点池
+        CraLListNode *curr, *temp;
 
+        list->head->prev->next = NULL;
+        for (curr = list->head; curr; curr = temp)
+        {
+            temp = curr->next;
+            cra_mempool_dealloc(list->nodepool, curr);
+        }
+        list->head = NULL;
+    }
+    else
+    {
         list->head->prev->next = list->free_list;
         list->nfreelist += list->count;
         list->free_list = list->head;
@@ -117,6 +182,9 @@ cra_llist_reserve(CraLList *list, size_t nspare)
     assert(list);
     assert(list->itemsize > 0);
 
+    if (list->nodepool)
+        return true;
+
     if (list->nfreelist < nspare)
     {
         needed = nspare - list->nfreelist;
@@ -199,63 +267,362 @@ cra_llist_reverse(CraLList *list)
     list->head = curr->next;
 }
 
-static CraLListNode *
-cra_llist_partition(CraLList *list, cra_cmp_fn compare, CraLListNode *begin, CraLListNode *end, CraLListNode *temp)
+// 初始有序段的最小长度
+#define CRA_LLIST_SORT_MIN_RUN 32
+
+// 有序段：以NULL结尾，段内的prev指针都是正确的(第一个节点的prev除外)
+typedef struct
 {
-    CraLListNode *left, *right;
-    left = begin;
-    right = end;
-    // temp.val = list[left].val
-    memcpy(temp->val, right->val, list->itemsize);
+    CraLListNode *head;
+    CraLListNode *tail;
+} CraLListRun;
+
+// 合并两个有序段，相等时a在前(a中的元素原本在b之前)
+// 合并时顺便设置prev指针，排序后不需要再遍历一遍恢复
+static CraLListRun
+cra_llist_merge(CraLListRun a, CraLListRun b, cra_cmp_fn compare)
+{
+    CraLListNode  head;
+    CraLListNode *tail = &head;
+    CraLListNode *x = a.head, *y = b.head;
 
-    while (left != right)
+    // a整体不大于b，或b整体小于a：直接首尾相接
+    if (compare(a.tail->val, b.head->val) <= 0)
+    {
+        a.tail->next = b.head;
+        b.head->prev = a.tail;
+        return (CraLListRun){ a.head, b.tail };
+    }
+    if (compare(b.tail->val, a.head->val) < 0)
     {
-        //                      list[left].val <= temp.val;
-        while (left != right && compare(left->val, temp->val) <= 0)
-            left = left->next;
-        // list[right].val = list[left].val
-        memcpy(right->val, left->val, list->itemsize);
-
-        //                      list[right].val >= temp.val;
-        while (left != right && compare(right->val, temp->val) >= 0)
-            right = right->prev;
-        // list[left].val = list[right].val
-        memcpy(left->val, right->val, list->itemsize);
+        b.tail->next = a.head;
+        a.head->prev = b.tail;
+        return (CraLListRun){ b.head, a.tail };
     }
-    // list[left].val = temp.val
-    memcpy(left->val, temp->val, list->itemsize);
 
-    return left;
+    // 节点分散在内存中，提前预取下一个节点以掩盖缓存未命中
+    while (x && y)
+    {
+        cra_prefetch(x->next);
+        cra_prefetch(y->next);
+        if (compare(x->val, y->val) <= 0)
+        {
+            tail->next = x;
+            x->prev = tail;
+            tail = x;
+            x = x->next;
+        }
+        else
+        {
+            tail->next = y;
+            y->prev = tail;
+            tail = y;
+            y = y->next;
+        }
+    }
+    if (x)
+    {
+        tail->next = x;
+        x->prev = tail;
+        tail = a.tail;
+    }
+    else
+    {
+        tail->next = y;
+        y->prev = tail;
+        tail = b.tail;
+    }
+    head.next->prev = NULL;
+    return (CraLListRun){ head.next, tail };
 }
 
+// 从first开始取出一段有序的节点，*rest返回剩下的节点
+// 先顺着已有的非递减(或严格递减，就地翻转)部分延伸，不足MIN_RUN个时用插入排序补足
+// 这些节点在链表中相邻，通常在内存中也相邻，整理时不会频繁缓存未命中
+static CraLListRun
+cra_llist_take_run(CraLListNode *first, CraLListNode **rest, cra_cmp_fn compare)
+{
+    size_t        n;
+    CraLListNode *curr, *next, *pos;
+    CraLListRun   run = { first, first };
+
+    first->prev = NULL;
+    curr = first->next;
+    n = 1;
+    if (curr && compare(first->val, curr->val) > 0)
+    {
+        // 严格递减才翻转，相等的元素不会被调换顺序
+        do
+        {
+            next = curr->next;
+            curr->next = run.head;
+            run.head->prev = curr;
+            run.head = curr;
+            curr = next;
+            n++;
+        } while (curr && compare(run.head->val, curr->val) > 0);
+        run.head->prev = NULL;
+    }
+    else
+    {
+        // 原链表中的prev指针已经正确
+        for (; curr && compare(run.tail->val, curr->val) <= 0; n++)
+        {
+            run.tail = curr;
+            curr = curr->next;
+        }
+    }
+
+    for (; curr && n < CRA_LLIST_SORT_MIN_RUN; n++)
+    {
+        next = curr->next;
+        // 从尾部往前找最后一个不大于它的节点，插在它后面，保证稳定
+        for (pos = run.tail; pos && compare(pos->val, curr->val) > 0; pos = pos->prev)
+            ;
+        if (!pos)
+        {
+            curr->prev = NULL;
+            curr->next = run.head;
+            run.head->prev = curr;
+            run.head = curr;
+        }
+        else
+        {
+            curr->prev = pos;
+            curr->next = pos == run.tail ? NULL : pos->next;
+            if (pos == run.tail)
+                run.tail = curr;
+            else
+                pos->next->prev = curr;
+            pos->next = curr;
+        }
+        curr = next;
+    }
+    run.tail->next = NULL;
+    *rest = curr;
+    return run;
+}
+
+// 自底向上的归并排序，只修改指针，不复制元素，额外内存O(1)
+// 先把相邻的节点整理成有序段，bins[i]为空或存放约2^i个有序段，像二进制计数器一样逐段加入并进位合并，
+// 合并总是发生在刚访问过的节点上，比逐层翻倍的做法对缓存更友好
+// 已有序或逆序的输入会形成很长的有序段，只需一次遍历
+// 链表已断开成以NULL结尾的单链表，返回排好序且prev指针正确的段
+static CraLListRun
+cra_llist_merge_sort(CraLListNode *first, cra_cmp_fn compare)
+{
+    size_t      i, nbins;
+    CraLListRun carry;
+    CraLListRun bins[sizeof(size_t) * 8] = { 0 };
+
+    nbins = 0;
+    while (first)
+    {
+        carry = cra_llist_take_run(first, &first, compare);
+        // 高位的bin中是更早的节点，放在左边以保证稳定
+        for (i = 0; bins[i].head; i++)
+        {
+            carry = cra_llist_merge(bins[i], carry, compare);
+            bins[i].head = NULL;
+        }
+        bins[i] = carry;
+        if (i >= nbins)
+            nbins = i + 1;
+    }
+
+    carry.head = NULL;
+    for (i = 0; i < nbins; i++)
+    {
+        if (bins[i].head)
+            carry = carry.head ? cra_llist_merge(bins[i], carry, compare) : bins[i];
+    }
+    return carry;
+}
+
+// 块内排序时一块节点占用的内存上限
+#define CRA_LLIST_SORT_BLOCK_BYTES (256 * 1024)
+// 预取距离：归并时提前访问的节点数
+#define CRA_LLIST_SORT_PREFETCH 16
+
+// 对节点指针数组做稳定的插入排序
+static void
+cra_llist_insertion_sort_nodes(CraLListNode **nodes, size_t n, cra_cmp_fn compare)
+{
+    size_t        i, j;
+    CraLListNode *node;
+
+    for (i = 1; i < n; i++)
+    {
+        node = nodes[i];
+        for (j = i; j > 0 && compare(nodes[j - 1]->val, node->val) > 0; j--)
+            nodes[j] = nodes[j - 1];
+        nodes[j] = node;
+    }
+}
+
+// 把src[lo, mid)和src[mid, hi)合并到dst[lo, hi)，相等时左边在前
+// 指针数组中后面要比较的节点是已知的，提前预取以掩盖节点分散带来的缓存未命中
+static void
+cra_llist_merge_nodes(CraLListNode **src, CraLListNode **dst, size_t lo, size_t mid, size_t hi, cra_cmp_fn compare)
+{
+    size_t i = lo, j = mid, k = lo;
+
+    // 两段已经有序相接，直接复制
+    if (compare(src[mid - 1]->val, src[mid]->val) <= 0)
+    {
+        memcpy(dst + lo, src + lo, (hi - lo) * sizeof(CraLListNode *));
+        return;
+    }
+    while (i < mid && j < hi)
+    {
+        if (i + CRA_LLIST_SORT_PREFETCH < mid)
+            cra_prefetch(src[i + CRA_LLIST_SORT_PREFETCH]->val);
+        if (j + CRA_LLIST_SORT_PREFETCH < hi)
+            cra_prefetch(src[j + CRA_LLIST_SORT_PREFETCH]->val);
+        if (compare(src[i]->val, src[j]->val) <= 0)
+            dst[k++] = src[i++];
+        else
+            dst[k++] = src[j++];
+    }
+    while (i < mid)
+        dst[k++] = src[i++];
+    while (j < hi)
+        dst[k++] = src[j++];
+}
+
+// 一趟归并：把[begin, end)中长为width的相邻有序段两两合并到dst
 static void
-cra_llist_quick_sort(CraLList *list, cra_cmp_fn compare, CraLListNode *begin, CraLListNode *end, CraLListNode *temp)
+cra_llist_merge_pass(CraLListNode **src, CraLListNode **dst, size_t begin, size_t end, size_t width, cra_cmp_fn compare)
+{
+    size_t lo, mid, hi;
+
+    for (lo = begin; lo < end; lo += 2 * width)
+    {
+        mid = CRA_MIN(lo + width, end);
+        hi = CRA_MIN(lo + 2 * width, end);
+        if (mid < hi)
+            cra_llist_merge_nodes(src, dst, lo, mid, hi, compare);
+        else
+            memcpy(dst + lo, src + lo, (hi - lo) * sizeof(CraLListNode *));
+    }
+}
+
+// 对节点指针数组排序后一次性重新链接。只修改指针，不复制元素，额外内存O(n)
+// 返回false表示临时内存分配失败
+static bool
+cra_llist_sort_by_array(CraLList *list, cra_cmp_fn compare)
 {
-    CraLListNode *middle = cra_llist_partition(list, compare, begin, end, temp);
-    assert(middle);
-    if (begin != middle && begin != middle->prev)
-        cra_llist_quick_sort(list, compare, begin, middle->prev, temp);
-    if (middle != end && middle->next != end)
-        cra_llist_quick_sort(list, compare, middle->next, end, temp);
+    size_t         i, n, lo, hi, width, block, npass;
+    bool           sorted;
+    CraLListNode  *curr;
+    CraLListNode **buf, **nodes, **temp, **src, **dst, **swap;
+
+    n = list->count;
+    buf = (CraLListNode **)cra_malloc(sizeof(CraLListNode *) * n * 2);
+    if (!buf)
+        return false;
+    nodes = buf;
+    temp = buf + n;
+
+    // 收集节点，顺便检查是否已经有序
+    sorted = true;
+    curr = list->head;
+    for (i = 0; i < n; i++)
+    {
+        nodes[i] = curr;
+        curr = curr->next;
+        cra_prefetch(curr->next);
+        if (sorted && i > 0 && compare(nodes[i - 1]->val, nodes[i]->val) > 0)
+            sorted = false;
+    }
+    if (sorted)
+        goto end;
+
+    // 链表中相邻的节点通常在内存中也相邻。先把每block个节点在块内排好，
+    // 块的大小能放进缓存，块内的归并不会频繁缓存未命中，之后只剩跨块的归并
+    block = CRA_LLIST_SORT_MIN_RUN;
+    while (block < n && block * 2 * CRA_LLIST_NODE_SIZE(list->itemsize) <= CRA_LLIST_SORT_BLOCK_BYTES)
+        block *= 2;
+    npass = 0;
+    for (lo = 0; lo < n; lo += block)
+    {
+        hi = CRA_MIN(lo + block, n);
+        for (i = lo; i < hi; i += CRA_LLIST_SORT_MIN_RUN)
+            cra_llist_insertion_sort_nodes(nodes + i, CRA_MIN(CRA_LLIST_SORT_MIN_RUN, hi - i), compare);
+        // 每块都做相同趟数，结果都落在同一个数组中
+        src = nodes;
+        dst = temp;
+        npass = 0;
+        for (width = CRA_LLIST_SORT_MIN_RUN; width < block; width *= 2, npass++)
+        {
+            cra_llist_merge_pass(src, dst, lo, hi, width, compare);
+            swap = src;
+            src = dst;
+            dst = swap;
+        }
+    }
+    if (npass % 2 == 1)
+    {
+        swap = nodes;
+        nodes = temp;
+        temp = swap;
+    }
+    // 跨块的归并，在nodes和temp之间来回
+    for (width = block; width < n; width *= 2)
+    {
+        cra_llist_merge_pass(nodes, temp, 0, n, width, compare);
+        swap = nodes;
+        nodes = temp;
+        temp = swap;
+    }
+
+    // 重新连成环
+    for (i = 0; i < n; i++)
+    {
+        if (i + CRA_LLIST_SORT_PREFETCH < n)
+            cra_prefetch(nodes[i + CRA_LLIST_SORT_PREFETCH]);
+        nodes[i]->prev = nodes[i == 0 ? n - 1 : i - 1];
+        nodes[i]->next = nodes[i == n - 1 ? 0 : i + 1];
+    }
+    list->head = nodes[0];
+
+end:
+    cra_free(buf);
+    return true;
 }
 
 bool(cra_llist_sort)(CraLList *list, cra_cmp_fn compare)
 {
+    CraLListRun run;
+
     assert(list);
     assert(compare);
     assert(list->itemsize > 0);
 
     if (list->count > 1) // count(list) >= 2
     {
-        CraLListNode *temp = cra_llist_get_free_node(list);
-        if (!temp)
-            return false;
-        cra_llist_quick_sort(list, compare, list->head, list->head->prev, temp);
-        cra_llist_put_free_node(list, temp);
+        // 断开环
+        list->head->prev->next = NULL;
+        run = cra_llist_merge_sort(list->head, compare);
+        // 重新连成环
+        run.tail->next = run.head;
+        run.head->prev = run.tail;
+        list->head = run.head;
     }
     return true;
 }
 
+bool(cra_llist_sort_buffered)(CraLList *list, cra_cmp_fn compare)
+{
+    assert(list);
+    assert(compare);
+    assert(list->itemsize > 0);
+
+    if (list->count > 1) // count(list) >= 2
+        return cra_llist_sort_by_array(list, compare);
+    return true;
+}
+
 bool(cra_llist_add_sort)(CraLList *list, cra_cmp_fn compare, void *val)
 {
     size_t        index;
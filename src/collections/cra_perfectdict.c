@@ -0,0 +1,449 @@
+/**
+ * @file cra_perfectdict.c
+ * @author Cracal
+ * @brief 最小完美hash的只读字典
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "collections/cra_perfectdict.h"
+#include "cra_malloc.h"
+
+// 平均每个桶的key数，越大pilots越小，但构建越慢
+#define CRA_PERFECTDICT_BUCKET_LOAD 4
+
+#define CRA_PERFECTDICT_PILOT_MUL 0x9e3779b97f4a7c15ULL
+
+#define CRA_PERFECTDICT_ALIGN_UP(n, a) (((n) + ((a) - 1)) & ~((a) - 1))
+
+// entry: cra_uhash_t(混合后的hash) | key | val
+#define CRA_PERFECTDICT_PENTRY(dict, index) ((dict)->entries + (size_t)(index) * (dict)->entry_size)
+#define CRA_PERFECTDICT_PHASH(entry)        ((cra_uhash_t *)(entry))
+#define CRA_PERFECTDICT_PKEY(dict, entry)   ((void *)((entry) + (dict)->key_offset))
+#define CRA_PERFECTDICT_PVAL(dict, entry)   ((void *)((entry) + (dict)->val_offset))
+
+#define CRA_PERFECTDICT_TAKEN(bits, i)     (!!((bits)[(i) >> 6] & (1ULL << ((i) & 63))))
+#define CRA_PERFECTDICT_SET_TAKEN(bits, i) ((bits)[(i) >> 6] |= (1ULL << ((i) & 63)))
+
+// 把x均匀映射到[0, n)，比取模快
+static inline uint32_t
+cra_perfectdict_range(uint32_t x, uint32_t n)
+{
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+// 桶用混合后hash的低32位
+static inline uint32_t
+cra_perfectdict_bucket(CraPerfectDict *dict, cra_uhash_t hash)
+{
+    return cra_perfectdict_range((uint32_t)hash, (uint32_t)dict->nbuckets);
+}
+
+// 位置由整个hash和pilot再混合一次得到，同一个桶里hash不同的key在不同pilot下的位置互相独立
+// 在64位整数上混合，取与桶不同的高32位。cra_uhash_t在32位平台上只有32位，不能直接移位
+static inline uint32_t
+cra_perfectdict_position(CraPerfectDict *dict, cra_uhash_t hash, uint32_t pilot)
+{
+    uint64_t h = cra_hash_mix64((uint64_t)hash ^ (pilot * CRA_PERFECTDICT_PILOT_MUL));
+    return cra_perfectdict_range((uint32_t)(h >> 32), (uint32_t)dict->count);
+}
+
+static void
+cra_perfectdict_init(CraPerfectDict *dict,
+                     size_t          key_size,
+                     size_t          val_size,
+                     size_t          key_align,
+                     size_t          val_align,
+                     cra_hash_fn     hash_key,
+                     cra_cmp_fn      compare_key)
+{
+    size_t offset;
+
+    assert(dict);
+    assert(key_size > 0);
+    assert(val_size > 0);
+    assert(key_align > 0);
+    assert(val_align > 0);
+    assert(key_size % key_align == 0);
+    assert(val_size % val_align == 0);
+    assert(hash_key);
+    assert(compare_key);
+
+    offset = sizeof(cra_uhash_t);
+    offset = CRA_PERFECTDICT_ALIGN_UP(offset, key_align);
+    dict->key_offset = offset;
+    offset += key_size;
+
+    offset = CRA_PERFECTDICT_ALIGN_UP(offset, val_align);
+    dict->val_offset = offset;
+    offset += val_size;
+
+    dict->entry_size = CRA_PERFECTDICT_ALIGN_UP(offset, CRA_MAX(alignof(cra_uhash_t), CRA_MAX(key_align, val_align)));
+    dict->key_size = key_size;
+    dict->val_size = val_size;
+
+    dict->hash_key = hash_key;
+    dict->compare_key = compare_key;
+
+    dict->entries = NULL;
+    dict->pilots = NULL;
+    dict->count = 0;
+    dict->nbuckets = 0;
+}
+
+// 给每个桶找pilot，成功时pilots[b]都已填好
+// order: 按桶分组后的key下标，starts[b] ~ starts[b + 1]是桶b的key
+static bool
+cra_perfectdict_search_pilots(CraPerfectDict *dict, cra_uhash_t *hashes, uint32_t *order, uint32_t *starts)
+{
+    bool      ok;
+    uint32_t  b, k, j, size, max_size, pilot;
+    uint32_t *sizes, *buckets, *positions;
+    uint64_t *taken;
+
+    // 桶按大小从大到小处理，大桶在表还空的时候更容易放下
+    max_size = 0;
+    for (b = 0; b < (uint32_t)dict->nbuckets; ++b)
+        max_size = CRA_MAX(max_size, starts[b + 1] - starts[b]);
+
+    sizes = cra_calloc(max_size + 2, sizeof(uint32_t));
+    buckets = cra_malloc(sizeof(uint32_t) * dict->nbuckets);
+    positions = cra_malloc(sizeof(uint32_t) * (max_size + 1));
+    taken = cra_calloc((dict->count + 63) / 64, sizeof(uint64_t));
+    if (!sizes || !buckets || !positions || !taken)
+    {
+        ok = false;
+        goto end;
+    }
+    for (b = 0; b < (uint32_t)dict->nbuckets; ++b)
+        ++sizes[max_size - (starts[b + 1] - starts[b]) + 1];
+    for (size = 1; size <= max_size + 1; ++size)
+        sizes[size] += sizes[size - 1];
+    for (b = 0; b < (uint32_t)dict->nbuckets; ++b)
+        buckets[sizes[max_size - (starts[b + 1] - starts[b])]++] = b;
+
+    ok = true;
+    for (uint32_t i = 0; ok && i < (uint32_t)dict->nbuckets; ++i)
+    {
+        b = buckets[i];
+        size = starts[b + 1] - starts[b];
+        if (size == 0)
+            break; // 之后都是空桶，pilot为0
+
+        for (pilot = 0;; ++pilot)
+        {
+            for (k = 0; k < size; ++k)
+            {
+                positions[k] = cra_perfectdict_position(dict, hashes[order[starts[b] + k]], pilot);
+                if (CRA_PERFECTDICT_TAKEN(taken, positions[k]))
+                    break;
+                // 同一个桶里的key也不能互相冲突
+                for (j = 0; j < k && positions[j] != positions[k]; ++j)
+                    ;
+                if (j < k)
+                    break;
+            }
+            if (k == size)
+            {
+                for (k = 0; k < size; ++k)
+                    CRA_PERFECTDICT_SET_TAKEN(taken, positions[k]);
+                dict->pilots[b] = pilot;
+                break;
+            }
+            if (pilot == UINT32_MAX)
+            {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+end:
+    if (sizes)
+        cra_free(sizes);
+    if (buckets)
+        cra_free(buckets);
+    if (positions)
+        cra_free(positions);
+    if (taken)
+        cra_free(taken);
+    return ok;
+}
+
+// keys[i]/vals[i]指向第i个key/val
+static bool
+cra_perfectdict_build(CraPerfectDict *dict, const void **keys, const void **vals, size_t n)
+{
+    bool           ok;
+    uint32_t       b, pos;
+    uint32_t      *order, *starts;
+    cra_uhash_t   *hashes;
+    unsigned char *entry;
+
+    if (n == 0)
+        return true;
+    if (n > UINT32_MAX)
+        return false;
+
+    dict->count = (ssize_t)n;
+    dict->nbuckets = (ssize_t)((n + CRA_PERFECTDICT_BUCKET_LOAD - 1) / CRA_PERFECTDICT_BUCKET_LOAD);
+
+    hashes = cra_malloc(sizeof(cra_uhash_t) * n);
+    order = cra_malloc(sizeof(uint32_t) * n);
+    starts = cra_calloc(dict->nbuckets + 1, sizeof(uint32_t));
+    dict->pilots = cra_calloc(dict->nbuckets, sizeof(uint32_t));
+    dict->entries = cra_malloc(n * dict->entry_size);
+    if (!hashes || !order || !starts || !dict->pilots || !dict->entries)
+    {
+        ok = false;
+        goto end;
+    }
+
+    // 按桶分组(计数排序)
+    for (size_t i = 0; i < n; ++i)
+    {
+        hashes[i] = cra_hash_mix(dict->hash_key(keys[i]));
+        ++starts[cra_perfectdict_bucket(dict, hashes[i]) + 1];
+    }
+    for (b = 0; b < (uint32_t)dict->nbuckets; ++b)
+        starts[b + 1] += starts[b];
+    for (size_t i = 0; i < n; ++i)
+        order[starts[cra_perfectdict_bucket(dict, hashes[i])]++] = (uint32_t)i;
+    for (b = (uint32_t)dict->nbuckets; b > 0; --b)
+        starts[b] = starts[b - 1];
+    starts[0] = 0;
+
+    // hash相同的key在任何pilot下位置都相同，永远放不下
+    ok = true;
+    for (b = 0; ok && b < (uint32_t)dict->nbuckets; ++b)
+    {
+        for (uint32_t i = starts[b]; ok && i < starts[b + 1]; ++i)
+        {
+            for (uint32_t j = starts[b]; ok && j < i; ++j)
+                ok = hashes[order[i]] != hashes[order[j]];
+        }
+    }
+    if (!ok || !cra_perfectdict_search_pilots(dict, hashes, order, starts))
+    {
+        ok = false;
+        goto end;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        pos = cra_perfectdict_position(dict, hashes[i], dict->pilots[cra_perfectdict_bucket(dict, hashes[i])]);
+        entry = CRA_PERFECTDICT_PENTRY(dict, pos);
+        *CRA_PERFECTDICT_PHASH(entry) = hashes[i];
+        memcpy(CRA_PERFECTDICT_PKEY(dict, entry), keys[i], dict->key_size);
+        memcpy(CRA_PERFECTDICT_PVAL(dict, entry), vals[i], dict->val_size);
+    }
+
+end:
+    if (hashes)
+        cra_free(hashes);
+    if (order)
+        cra_free(order);
+    if (starts)
+        cra_free(starts);
+    if (!ok)
+        cra_perfectdict_uninit(dict);
+    return ok;
+}
+
+bool(cra_perfectdict_init_from_arrays)(CraPerfectDict *dict,
+                                       size_t          key_size,
+                                       size_t          val_size,
+                                       size_t          key_align,
+                                       size_t          val_align,
+                                       const void     *keys,
+                                       const void     *vals,
+                                       size_t          n,
+                                       cra_hash_fn     hash_key,
+                                       cra_cmp_fn      compare_key)
+{
+    bool         ok;
+    const void **pkeys, **pvals;
+
+    assert(n == 0 || (keys && vals));
+
+    cra_perfectdict_init(dict, key_size, val_size, key_align, val_align, hash_key, compare_key);
+    if (n == 0)
+        return true;
+
+    pkeys = cra_malloc(sizeof(void *) * n);
+    pvals = cra_malloc(sizeof(void *) * n);
+    if (!pkeys || !pvals)
+    {
+        ok = false;
+        goto end;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        pkeys[i] = (const unsigned char *)keys + i * key_size;
+        pvals[i] = (const unsigned char *)vals + i * val_size;
+    }
+    ok = cra_perfectdict_build(dict, pkeys, pvals, n);
+
+end:
+    if (pkeys)
+        cra_free(pkeys);
+    if (pvals)
+        cra_free(pvals);
+    return ok;
+}
+
+// 类型的大小总是其对齐的整数倍，由大小得到的对齐不会比实际的小
+static inline size_t
+cra_perfectdict_align_of_size(size_t size)
+{
+    return CRA_MIN(size & (~size + 1), alignof(max_align_t));
+}
+
+bool
+cra_perfectdict_init_from_dict(CraPerfectDict *dict, CraDict *src)
+{
+    bool         ok;
+    size_t       n;
+    const void **pkeys, **pvals;
+
+    assert(src);
+
+    cra_perfectdict_init(dict, src->key_size, src->val_size, cra_perfectdict_align_of_size(src->key_size),
+                         cra_perfectdict_align_of_size(src->val_size), src->hash_key, src->compare_key);
+    if (src->count == 0)
+        return true;
+
+    pkeys = cra_malloc(sizeof(void *) * src->count);
+    pvals = cra_malloc(sizeof(void *) * src->count);
+    if (!pkeys || !pvals)
+    {
+        ok = false;
+        goto end;
+    }
+    n = 0;
+    CRA_FOREACH(CRA_DICT_ITERABLE_I, src, kv)
+    {
+        pkeys[n] = kv.key_ref;
+        pvals[n] = kv.val_ref;
+        ++n;
+    }
+    assert(n == (size_t)src->count);
+    ok = cra_perfectdict_build(dict, pkeys, pvals, n);
+
+end:
+    if (pkeys)
+        cra_free(pkeys);
+    if (pvals)
+        cra_free(pvals);
+    return ok;
+}
+
+void
+cra_perfectdict_uninit(CraPerfectDict *dict)
+{
+    assert(dict);
+
+    if (dict->entries)
+        cra_free(dict->entries);
+    if (dict->pilots)
+        cra_free(dict->pilots);
+    dict->entries = NULL;
+    dict->pilots = NULL;
+    dict->count = 0;
+    dict->nbuckets = 0;
+}
+
+void *(cra_perfectdict_get_ref)(CraPerfectDict * dict, const void *key)
+{
+    assert(key);
+    assert(dict);
+
+    return (cra_perfectdict_get_ref_with_hash)(dict, key, dict->hash_key(key));
+}
+
+void *(cra_perfectdict_get_ref_with_hash)(CraPerfectDict * dict, const void *key, cra_hash_t hash)
+{
+    cra_uhash_t    h;
+    uint32_t       pos;
+    unsigned char *entry;
+
+    assert(key);
+    assert(dict);
+    assert(hash == dict->hash_key(key));
+
+    if (dict->count == 0)
+        return NULL;
+
+    h = cra_hash_mix(hash);
+    pos = cra_perfectdict_position(dict, h, dict->pilots[cra_perfectdict_bucket(dict, h)]);
+    entry = CRA_PERFECTDICT_PENTRY(dict, pos);
+    if (*CRA_PERFECTDICT_PHASH(entry) != h || dict->compare_key(key, CRA_PERFECTDICT_PKEY(dict, entry)) != 0)
+        return NULL;
+    return CRA_PERFECTDICT_PVAL(dict, entry);
+}
+
+// ====================================== interfaces ======================================
+
+// iterable
+
+static CRA_ITERABLE_INIT_FN(cra_perfectdict_iterable_init)
+{
+    CraPerfectDict *dict = (CraPerfectDict *)obj;
+
+    assert(it);
+    assert(dict);
+
+    if (retcnt)
+        *retcnt = (size_t)dict->count;
+
+    it->obj = obj;
+    it->ic1.idx = reverse ? (size_t)dict->count : 0;
+
+    return dict->count > 0;
+}
+
+static CRA_ITERABLE_NEXT_FN(cra_perfectdict_iterable_next)
+{
+    CraPerfectDict *dict;
+    unsigned char  *entry;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    dict = (CraPerfectDict *)it->obj;
+    if ((ssize_t)it->ic1.idx >= dict->count)
+        return false;
+
+    entry = CRA_PERFECTDICT_PENTRY(dict, it->ic1.idx++);
+    val->key_ref = CRA_PERFECTDICT_PKEY(dict, entry);
+    val->val_ref = CRA_PERFECTDICT_PVAL(dict, entry);
+    return true;
+}
+
+static CRA_ITERABLE_PREV_FN(cra_perfectdict_iterable_prev)
+{
+    CraPerfectDict *dict;
+    unsigned char  *entry;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    dict = (CraPerfectDict *)it->obj;
+    if (it->ic1.idx == 0)
+        return false;
+
+    entry = CRA_PERFECTDICT_PENTRY(dict, --it->ic1.idx);
+    val->key_ref = CRA_PERFECTDICT_PKEY(dict, entry);
+    val->val_ref = CRA_PERFECTDICT_PVAL(dict, entry);
+    return true;
+}
+
+CRA_ITERABLE_DEF(cra_g_perfectdict_iterable_i) = {
+    .init = cra_perfectdict_iterable_init,
+    .next = cra_perfectdict_iterable_next,
+    .prev = cra_perfectdict_iterable_prev,
+};
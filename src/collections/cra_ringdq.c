@@ -0,0 +1,429 @@
+/**
+ * @file cra_ringdq.c
+ * @author Cracal
+ * @brief 环形双端队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_ringdq.h"
+#include "cra_malloc.h"
+
+#define CRA_RINGDQ_AT(dq, pos) ((dq)->array + (pos) * (dq)->itemsize)
+
+static inline size_t
+cra_ringdq_get_next_pow2(size_t n)
+{
+    size_t cap = CRA_RINGDQ_DEFAULT_CAPACITY;
+    while (cap < n)
+        cap <<= 1;
+    return cap;
+}
+
+bool(cra_ringdq_init_with_size)(CraRingdq *dq, size_t itemsize, size_t init_capacity)
+{
+    assert(dq);
+    assert(itemsize > 0);
+
+    init_capacity = cra_ringdq_get_next_pow2(init_capacity);
+    dq->array = cra_malloc(init_capacity * itemsize);
+    if (!dq->array)
+        return false;
+
+    dq->head = 0;
+    dq->count = 0;
+    dq->capacity = init_capacity;
+    dq->mask = init_capacity - 1;
+    dq->itemsize = itemsize;
+    return true;
+}
+
+void(cra_ringdq_uninit)(CraRingdq *dq)
+{
+    assert(dq);
+    assert(dq->array);
+
+    cra_free(dq->array);
+    bzero(dq, sizeof(*dq));
+}
+
+// 把元素复制到新数组的[0, count)
+static bool
+cra_ringdq_relayout(CraRingdq *dq, size_t new_capacity)
+{
+    size_t         first;
+    unsigned char *new_array;
+
+    assert(new_capacity >= dq->count);
+
+    new_array = cra_malloc(new_capacity * dq->itemsize);
+    if (!new_array)
+        return false;
+
+    first = CRA_MIN(dq->count, dq->capacity - dq->head);
+    memcpy(new_array, CRA_RINGDQ_AT(dq, dq->head), first * dq->itemsize);
+    memcpy(new_array + first * dq->itemsize, dq->array, (dq->count - first) * dq->itemsize);
+
+    cra_free(dq->array);
+    dq->array = new_array;
+    dq->head = 0;
+    dq->capacity = new_capacity;
+    dq->mask = new_capacity - 1;
+    return true;
+}
+
+// 扩容到能放下need个元素
+// realloc后把绕回到数组头部的元素移动到旧容量之后
+static bool
+cra_ringdq_grow(CraRingdq *dq, size_t need)
+{
+    size_t         old_capacity, new_capacity, wrapped;
+    unsigned char *new_array;
+
+    if (need <= dq->capacity)
+        return true;
+
+    new_capacity = dq->capacity;
+    while (new_capacity < need)
+        new_capacity <<= 1;
+
+    new_array = cra_realloc(dq->array, new_capacity * dq->itemsize);
+    if (!new_array)
+        return false;
+
+    old_capacity = dq->capacity;
+    dq->array = new_array;
+    dq->capacity = new_capacity;
+    dq->mask = new_capacity - 1;
+
+    if (dq->head + dq->count > old_capacity)
+    {
+        // new_capacity >= 2 * old_capacity，放得下
+        wrapped = dq->head + dq->count - old_capacity;
+        memcpy(CRA_RINGDQ_AT(dq, old_capacity), dq->array, wrapped * dq->itemsize);
+    }
+    return true;
+}
+
+bool
+cra_ringdq_reserve(CraRingdq *dq, size_t new_capacity)
+{
+    assert(dq);
+    assert(dq->array);
+
+    if (new_capacity < dq->count)
+        new_capacity = dq->count;
+    new_capacity = cra_ringdq_get_next_pow2(new_capacity);
+    if (new_capacity == dq->capacity)
+        return true;
+    return cra_ringdq_relayout(dq, new_capacity);
+}
+
+// 把逻辑下标[src, src + n)的元素移动到[dst, dst + n)，可以重叠
+// 按物理上连续的片段memmove
+static void
+cra_ringdq_move(CraRingdq *dq, size_t dst, size_t src, size_t n)
+{
+    size_t ps, pd, len;
+
+    if (dst < src)
+    {
+        // 向前移动，从头开始
+        while (n > 0)
+        {
+            ps = (dq->head + src) & dq->mask;
+            pd = (dq->head + dst) & dq->mask;
+            len = CRA_MIN(n, CRA_MIN(dq->capacity - ps, dq->capacity - pd));
+            memmove(CRA_RINGDQ_AT(dq, pd), CRA_RINGDQ_AT(dq, ps), len * dq->itemsize);
+            src += len;
+            dst += len;
+            n -= len;
+        }
+    }
+    else if (dst > src)
+    {
+        // 向后移动，从尾开始
+        while (n > 0)
+        {
+            ps = ((dq->head + src + n - 1) & dq->mask) + 1;
+            pd = ((dq->head + dst + n - 1) & dq->mask) + 1;
+            len = CRA_MIN(n, CRA_MIN(ps, pd));
+            memmove(CRA_RINGDQ_AT(dq, pd - len), CRA_RINGDQ_AT(dq, ps - len), len * dq->itemsize);
+            n -= len;
+        }
+    }
+}
+
+bool(cra_ringdq_insert)(CraRingdq *dq, size_t index, void *val)
+{
+    assert(dq);
+    assert(dq->array);
+    assert(val);
+
+    if (index > dq->count)
+        return false;
+    if (!cra_ringdq_grow(dq, dq->count + 1))
+        return false;
+
+    if (index < dq->count >> 1)
+    {
+        // [0, index)向前移动一位
+        dq->head = (dq->head - 1) & dq->mask;
+        ++dq->count;
+        cra_ringdq_move(dq, 0, 1, index);
+    }
+    else
+    {
+        // [index, count)向后移动一位
+        ++dq->count;
+        cra_ringdq_move(dq, index + 1, index, dq->count - 1 - index);
+    }
+    memcpy(CRA_RINGDQ_PVAL(dq, index), val, dq->itemsize);
+    return true;
+}
+
+bool(cra_ringdq_push_front)(CraRingdq *dq, void *val)
+{
+    assert(dq);
+    assert(dq->array);
+    assert(val);
+
+    if (dq->count == dq->capacity && !cra_ringdq_grow(dq, dq->count + 1))
+        return false;
+    dq->head = (dq->head - 1) & dq->mask;
+    ++dq->count;
+    memcpy(CRA_RINGDQ_AT(dq, dq->head), val, dq->itemsize);
+    return true;
+}
+
+bool(cra_ringdq_push_back)(CraRingdq *dq, void *val)
+{
+    assert(dq);
+    assert(dq->array);
+    assert(val);
+
+    if (dq->count == dq->capacity && !cra_ringdq_grow(dq, dq->count + 1))
+        return false;
+    memcpy(CRA_RINGDQ_PVAL(dq, dq->count), val, dq->itemsize);
+    ++dq->count;
+    return true;
+}
+
+bool(cra_ringdq_push_back_n)(CraRingdq *dq, void *vals, size_t n)
+{
+    size_t pos, first;
+
+    assert(dq);
+    assert(dq->array);
+    assert(vals || n == 0);
+
+    if (n == 0)
+        return true;
+    if (!cra_ringdq_grow(dq, dq->count + n))
+        return false;
+
+    pos = (dq->head + dq->count) & dq->mask;
+    first = CRA_MIN(n, dq->capacity - pos);
+    memcpy(CRA_RINGDQ_AT(dq, pos), vals, first * dq->itemsize);
+    memcpy(dq->array, (unsigned char *)vals + first * dq->itemsize, (n - first) * dq->itemsize);
+    dq->count += n;
+    return true;
+}
+
+bool(cra_ringdq_pop_at)(CraRingdq *dq, size_t index, void *retval)
+{
+    assert(dq);
+    assert(dq->array);
+
+    if (index >= dq->count)
+        return false;
+
+    if (retval)
+        memcpy(retval, CRA_RINGDQ_PVAL(dq, index), dq->itemsize);
+
+    if (index < dq->count >> 1)
+    {
+        // [0, index)向后移动一位
+        cra_ringdq_move(dq, 1, 0, index);
+        dq->head = (dq->head + 1) & dq->mask;
+    }
+    else
+    {
+        // [index + 1, count)向前移动一位
+        cra_ringdq_move(dq, index, index + 1, dq->count - 1 - index);
+    }
+    --dq->count;
+    return true;
+}
+
+bool(cra_ringdq_pop_front)(CraRingdq *dq, void *retval)
+{
+    assert(dq);
+    assert(dq->array);
+
+    if (dq->count == 0)
+        return false;
+
+    if (retval)
+        memcpy(retval, CRA_RINGDQ_AT(dq, dq->head), dq->itemsize);
+    dq->head = (dq->head + 1) & dq->mask;
+    --dq->count;
+    return true;
+}
+
+bool(cra_ringdq_pop_back)(CraRingdq *dq, void *retval)
+{
+    assert(dq);
+    assert(dq->array);
+
+    if (dq->count == 0)
+        return false;
+
+    --dq->count;
+    if (retval)
+        memcpy(retval, CRA_RINGDQ_PVAL(dq, dq->count), dq->itemsize);
+    return true;
+}
+
+bool(cra_ringdq_pop_front_n)(CraRingdq *dq, void *retvals, size_t n)
+{
+    size_t first;
+
+    assert(dq);
+    assert(dq->array);
+
+    if (n > dq->count)
+        return false;
+    if (n == 0)
+        return true;
+
+    if (retvals)
+    {
+        first = CRA_MIN(n, dq->capacity - dq->head);
+        memcpy(retvals, CRA_RINGDQ_AT(dq, dq->head), first * dq->itemsize);
+        memcpy((unsigned char *)retvals + first * dq->itemsize, dq->array, (n - first) * dq->itemsize);
+    }
+    dq->head = (dq->head + n) & dq->mask;
+    dq->count -= n;
+    return true;
+}
+
+bool
+cra_ringdq_reverse(CraRingdq *dq)
+{
+    size_t begin, end;
+
+    assert(dq);
+    assert(dq->array);
+
+    if (dq->count < 2)
+        return true;
+
+    CRA_TEMP_NEW(temp, dq->itemsize);
+    if (!temp)
+        return false;
+
+    begin = 0;
+    end = dq->count - 1;
+    while (begin < end)
+    {
+        memcpy(temp, CRA_RINGDQ_PVAL(dq, begin), dq->itemsize);
+        memcpy(CRA_RINGDQ_PVAL(dq, begin), CRA_RINGDQ_PVAL(dq, end), dq->itemsize);
+        memcpy(CRA_RINGDQ_PVAL(dq, end), temp, dq->itemsize);
+        begin++;
+        end--;
+    }
+
+    CRA_TEMP_DEL(temp, dq->itemsize);
+    return true;
+}
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+static CRA_INITIALIZABLE_INIT_FN(cra_ringdq_initializable_init)
+{
+    assert(obj);
+    assert(params);
+    CraRingdq                   *dq = (CraRingdq *)obj;
+    CraRingdqInitializableParam *param = (CraRingdqInitializableParam *)params;
+    return (cra_ringdq_init_with_size)(dq, param->itemsize, length);
+}
+
+CRA_INITIALIZABLE_DEF(cra_g_ringdq_initializable_i) = {
+    .init = cra_ringdq_initializable_init,
+    .uninit = (CRA_INITIALIZABLE_UNINIT_FN((*)))cra_ringdq_uninit,
+};
+
+// appendable
+
+static CRA_APPENDABLE_APPEND_FN(cra_ringdq_appendable_append)
+{
+    assert(obj);
+    assert(val);
+    assert(val->val_ref);
+    return (cra_ringdq_push_back)((CraRingdq *)obj, val->val_ref);
+}
+
+CRA_APPENDABLE_DEF(cra_g_ringdq_appendable_i) = {
+    .append = cra_ringdq_appendable_append,
+};
+
+// iterable
+
+static CRA_ITERABLE_INIT_FN(cra_ringdq_iterable_init)
+{
+    assert(it);
+    assert(obj);
+
+    CraRingdq *dq = (CraRingdq *)obj;
+
+    if (retcnt)
+        *retcnt = dq->count;
+
+    it->ic1.idx = reverse ? dq->count : 0;
+    it->obj = obj;
+
+    return dq->count > 0;
+}
+
+static CRA_ITERABLE_NEXT_FN(cra_ringdq_iterable_next)
+{
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    CraRingdq *dq = (CraRingdq *)it->obj;
+    if (it->ic1.idx < dq->count)
+    {
+        val->val_ref = CRA_RINGDQ_PVAL(dq, it->ic1.idx);
+        ++it->ic1.idx;
+        return true;
+    }
+    return false;
+}
+
+static CRA_ITERABLE_PREV_FN(cra_ringdq_iterable_prev)
+{
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    CraRingdq *dq = (CraRingdq *)it->obj;
+    if (it->ic1.idx > 0)
+    {
+        --it->ic1.idx;
+        val->val_ref = CRA_RINGDQ_PVAL(dq, it->ic1.idx);
+        return true;
+    }
+    return false;
+}
+
+CRA_ITERABLE_DEF(cra_g_ringdq_iterable_i) = {
+    .init = cra_ringdq_iterable_init,
+    .next = cra_ringdq_iterable_next,
+    .prev = cra_ringdq_iterable_prev,
+};
@@ -0,0 +1,269 @@
+/**
+ * @file cra_seglist.c
+ * @author Cracal
+ * @brief 分段数组
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_seglist.h"
+#include "cra_malloc.h"
+
+#define CRA_SEGLIST_DIR_INIT_CAPACITY 8
+
+#define CRA_SEGLIST_SEG(list, seg, i) ((list)->segments[seg] + (i) * (list)->itemsize)
+
+bool(cra_seglist_init_with_size)(CraSegList *list, size_t itemsize, size_t seg_items)
+{
+    size_t       n;
+    unsigned int shift;
+
+    assert(list);
+    assert(itemsize > 0);
+
+    if (seg_items == 0)
+        seg_items = CRA_MAX(CRA_SEGLIST_SEGMENT_BYTES / itemsize, 1);
+    for (n = 1, shift = 0; n < seg_items; n <<= 1, ++shift)
+        ;
+
+    list->segments = cra_malloc(sizeof(unsigned char *) * CRA_SEGLIST_DIR_INIT_CAPACITY);
+    if (!list->segments)
+        return false;
+
+    list->nsegments = 0;
+    list->dir_capacity = CRA_SEGLIST_DIR_INIT_CAPACITY;
+    list->count = 0;
+    list->itemsize = itemsize;
+    list->seg_items = n;
+    list->seg_mask = n - 1;
+    list->seg_shift = shift;
+    return true;
+}
+
+void(cra_seglist_uninit)(CraSegList *list)
+{
+    assert(list);
+    assert(list->segments);
+
+    for (size_t i = 0; i < list->nsegments; ++i)
+        cra_free(list->segments[i]);
+    cra_free(list->segments);
+    bzero(list, sizeof(*list));
+}
+
+// 添加一个段，只有目录会被realloc
+static bool
+cra_seglist_add_segment(CraSegList *list)
+{
+    unsigned char  *seg;
+    unsigned char **dir;
+
+    if (list->nsegments == list->dir_capacity)
+    {
+        dir = cra_realloc(list->segments, sizeof(unsigned char *) * list->dir_capacity * 2);
+        if (!dir)
+            return false;
+        list->segments = dir;
+        list->dir_capacity *= 2;
+    }
+
+    seg = cra_malloc(list->seg_items * list->itemsize);
+    if (!seg)
+        return false;
+    list->segments[list->nsegments++] = seg;
+    return true;
+}
+
+bool
+cra_seglist_reserve(CraSegList *list, size_t new_capacity)
+{
+    size_t nsegments;
+
+    assert(list);
+    assert(list->segments);
+
+    if (new_capacity < list->count)
+        new_capacity = list->count;
+    nsegments = (new_capacity + list->seg_mask) >> list->seg_shift;
+
+    while (list->nsegments < nsegments)
+    {
+        if (!cra_seglist_add_segment(list))
+            return false;
+    }
+    while (list->nsegments > nsegments)
+        cra_free(list->segments[--list->nsegments]);
+    return true;
+}
+
+bool(cra_seglist_append)(CraSegList *list, void *val)
+{
+    assert(list);
+    assert(list->segments);
+    assert(val);
+
+    if (list->count == cra_seglist_capacity(list) && !cra_seglist_add_segment(list))
+        return false;
+    memcpy(CRA_SEGLIST_PVAL(list, list->count), val, list->itemsize);
+    ++list->count;
+    return true;
+}
+
+bool(cra_seglist_insert)(CraSegList *list, size_t index, void *val)
+{
+    size_t seg, hole, first_seg, first;
+
+    assert(list);
+    assert(list->segments);
+    assert(val);
+
+    if (index > list->count)
+        return false;
+    if (index == list->count)
+        return (cra_seglist_append)(list, val);
+
+    if (list->count == cra_seglist_capacity(list) && !cra_seglist_add_segment(list))
+        return false;
+
+    // 从最后往前，每段内后移一个元素，再把前一段的最后一个元素移到本段开头
+    seg = list->count >> list->seg_shift;
+    hole = list->count & list->seg_mask;
+    first_seg = index >> list->seg_shift;
+    first = index & list->seg_mask;
+    for (; seg > first_seg; --seg, hole = list->seg_mask)
+    {
+        memmove(CRA_SEGLIST_SEG(list, seg, 1), CRA_SEGLIST_SEG(list, seg, 0), hole * list->itemsize);
+        memcpy(CRA_SEGLIST_SEG(list, seg, 0), CRA_SEGLIST_SEG(list, seg - 1, list->seg_mask), list->itemsize);
+    }
+    memmove(CRA_SEGLIST_SEG(list, seg, first + 1), CRA_SEGLIST_SEG(list, seg, first),
+            (hole - first) * list->itemsize);
+    memcpy(CRA_SEGLIST_SEG(list, seg, first), val, list->itemsize);
+    ++list->count;
+    return true;
+}
+
+bool(cra_seglist_pop_at)(CraSegList *list, size_t index, void *retval)
+{
+    size_t seg, hole, last_seg, last;
+
+    assert(list);
+    assert(list->segments);
+
+    if (index >= list->count)
+        return false;
+
+    if (retval)
+        memcpy(retval, CRA_SEGLIST_PVAL(list, index), list->itemsize);
+
+    // 从index往后，每段内前移一个元素，再把后一段的第一个元素移到本段末尾
+    seg = index >> list->seg_shift;
+    hole = index & list->seg_mask;
+    last_seg = (list->count - 1) >> list->seg_shift;
+    last = (list->count - 1) & list->seg_mask;
+    for (; seg < last_seg; ++seg, hole = 0)
+    {
+        memmove(CRA_SEGLIST_SEG(list, seg, hole), CRA_SEGLIST_SEG(list, seg, hole + 1),
+                (list->seg_mask - hole) * list->itemsize);
+        memcpy(CRA_SEGLIST_SEG(list, seg, list->seg_mask), CRA_SEGLIST_SEG(list, seg + 1, 0), list->itemsize);
+    }
+    memmove(CRA_SEGLIST_SEG(list, seg, hole), CRA_SEGLIST_SEG(list, seg, hole + 1), (last - hole) * list->itemsize);
+    --list->count;
+    return true;
+}
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+static CRA_INITIALIZABLE_INIT_FN(cra_seglist_initializable_init)
+{
+    assert(obj);
+    assert(params);
+    CraSegList                   *list = (CraSegList *)obj;
+    CraSegListInitializableParam *param = (CraSegListInitializableParam *)params;
+    if (!(cra_seglist_init_with_size)(list, param->itemsize, 0))
+        return false;
+    if (length > 0 && !cra_seglist_reserve(list, length))
+    {
+        (cra_seglist_uninit)(list);
+        return false;
+    }
+    return true;
+}
+
+CRA_INITIALIZABLE_DEF(cra_g_seglist_initializable_i) = {
+    .init = cra_seglist_initializable_init,
+    .uninit = (CRA_INITIALIZABLE_UNINIT_FN((*)))cra_seglist_uninit,
+};
+
+// appendable
+
+static CRA_APPENDABLE_APPEND_FN(cra_seglist_appendable_append)
+{
+    assert(obj);
+    assert(val);
+    assert(val->val_ref);
+    return (cra_seglist_append)((CraSegList *)obj, val->val_ref);
+}
+
+CRA_APPENDABLE_DEF(cra_g_seglist_appendable_i) = {
+    .append = cra_seglist_appendable_append,
+};
+
+// iterable
+
+static CRA_ITERABLE_INIT_FN(cra_seglist_iterable_init)
+{
+    assert(it);
+    assert(obj);
+
+    CraSegList *list = (CraSegList *)obj;
+
+    if (retcnt)
+        *retcnt = list->count;
+
+    it->ic1.idx = reverse ? list->count : 0;
+    it->obj = obj;
+
+    return list->count > 0;
+}
+
+static CRA_ITERABLE_NEXT_FN(cra_seglist_iterable_next)
+{
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    CraSegList *list = (CraSegList *)it->obj;
+    if (it->ic1.idx < list->count)
+    {
+        val->val_ref = CRA_SEGLIST_PVAL(list, it->ic1.idx);
+        ++it->ic1.idx;
+        return true;
+    }
+    return false;
+}
+
+static CRA_ITERABLE_PREV_FN(cra_seglist_iterable_prev)
+{
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    CraSegList *list = (CraSegList *)it->obj;
+    if (it->ic1.idx > 0)
+    {
+        --it->ic1.idx;
+        val->val_ref = CRA_SEGLIST_PVAL(list, it->ic1.idx);
+        return true;
+    }
+    return false;
+}
+
+CRA_ITERABLE_DEF(cra_g_seglist_iterable_i) = {
+    .init = cra_seglist_iterable_init,
+    .next = cra_seglist_iterable_next,
+    .prev = cra_seglist_iterable_prev,
+};
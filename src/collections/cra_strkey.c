@@ -0,0 +1,69 @@
+/**
+ * @file cra_strkey.c
+ * @author Cracal
+ * @brief 带长度和hash的字符串key
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "collections/cra_strkey.h"
+#include "cra_malloc.h"
+
+bool
+cra_strkey_init(CraStrKey *key, const char *str, size_t len)
+{
+    char *copy;
+
+    assert(key);
+    assert(str || len == 0);
+    assert(len <= UINT32_MAX);
+
+    key->hash = cra_hash_bytes(str, len);
+    key->len = (uint32_t)len;
+    if (len <= CRA_STRKEY_INLINE_MAX)
+    {
+        memcpy(key->small, str, len);
+        key->small[len] = '\0';
+        return true;
+    }
+
+    copy = cra_malloc(len + 1);
+    if (!copy)
+        return false;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    memcpy(key->small, (void *)&copy, sizeof(copy));
+    return true;
+}
+
+void
+cra_strkey_view(CraStrKey *key, const char *str, size_t len)
+{
+    assert(key);
+    assert(str || len == 0);
+    assert(len <= UINT32_MAX);
+
+    key->hash = cra_hash_bytes(str, len);
+    key->len = (uint32_t)len;
+    if (len <= CRA_STRKEY_INLINE_MAX)
+    {
+        memcpy(key->small, str, len);
+        key->small[len] = '\0';
+    }
+    else
+    {
+        memcpy(key->small, (void *)&str, sizeof(str));
+    }
+}
+
+void
+cra_strkey_uninit(CraStrKey *key)
+{
+    assert(key);
+
+    if (key->len > CRA_STRKEY_INLINE_MAX)
+        cra_free((void *)cra_strkey_str(key));
+    bzero(key, sizeof(*key));
+}
@@ -0,0 +1,570 @@
+/**
+ * @file cra_swissdict.c
+ * @author Cracal
+ * @brief 开放寻址字典(SwissTable)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "collections/cra_swissdict.h"
+#include "cra_malloc.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CRA_SWISSDICT_SSE2
+#endif
+#ifdef CRA_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+#define CRA_SWISSDICT_EMPTY    ((int8_t)-128)
+#define CRA_SWISSDICT_DELETED  ((int8_t)-2)
+#define CRA_SWISSDICT_SENTINEL ((int8_t)-1)
+
+#define CRA_SWISSDICT_H1(hash) ((hash) >> 7)
+#define CRA_SWISSDICT_H2(hash) ((int8_t)((hash) & 0x7f))
+
+// 最大装载因子 7/8
+#define CRA_SWISSDICT_MAX_LOAD(capacity) ((capacity) - ((capacity) >> 3))
+
+#define CRA_SWISSDICT_ALIGN_UP(n, a) (((n) + ((a) - 1)) & ~((a) - 1))
+
+#define CRA_SWISSDICT_PSLOT0(dict, slots, index) ((slots) + (size_t)(index) * (dict)->slot_size)
+#define CRA_SWISSDICT_PSLOT(dict, index)         CRA_SWISSDICT_PSLOT0(dict, (dict)->slots, index)
+#define CRA_SWISSDICT_PKEY(dict, slot)           ((void *)((slot) + (dict)->key_offset))
+#define CRA_SWISSDICT_PVAL(dict, slot)           ((void *)((slot) + (dict)->val_offset))
+
+static inline unsigned int
+cra_swissdict_ctz(uint32_t mask)
+{
+    assert(mask != 0);
+#ifdef CRA_COMPILER_MSVC
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (unsigned int)idx;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned int
+cra_swissdict_clz16(uint32_t mask)
+{
+    assert(mask != 0 && mask <= 0xffff);
+#ifdef CRA_COMPILER_MSVC
+    unsigned long idx;
+    _BitScanReverse(&idx, mask);
+    return 15 - (unsigned int)idx;
+#else
+    return (unsigned int)__builtin_clz(mask) - 16;
+#endif
+}
+
+#if 1 // group
+
+#ifdef CRA_SWISSDICT_SSE2
+
+// 组内控制字节等于h2的位掩码
+static inline uint32_t
+cra_swissdict_group_match(const int8_t *group, int8_t h2)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+}
+
+// 组内EMPTY的位掩码
+static inline uint32_t
+cra_swissdict_group_match_empty(const int8_t *group)
+{
+    return cra_swissdict_group_match(group, CRA_SWISSDICT_EMPTY);
+}
+
+// 组内EMPTY或DELETED的位掩码
+static inline uint32_t
+cra_swissdict_group_match_empty_or_deleted(const int8_t *group)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(CRA_SWISSDICT_SENTINEL), ctrl));
+}
+
+#else
+
+static inline uint32_t
+cra_swissdict_group_match(const int8_t *group, int8_t h2)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < CRA_SWISSDICT_GROUP_WIDTH; ++i)
+        mask |= (uint32_t)(group[i] == h2) << i;
+    return mask;
+}
+
+static inline uint32_t
+cra_swissdict_group_match_empty(const int8_t *group)
+{
+    return cra_swissdict_group_match(group, CRA_SWISSDICT_EMPTY);
+}
+
+static inline uint32_t
+cra_swissdict_group_match_empty_or_deleted(const int8_t *group)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < CRA_SWISSDICT_GROUP_WIDTH; ++i)
+        mask |= (uint32_t)(group[i] < CRA_SWISSDICT_SENTINEL) << i;
+    return mask;
+}
+
+#endif
+
+#endif // end group
+
+static inline void
+cra_swissdict_set_ctrl(int8_t *ctrl, size_t capacity, size_t index, int8_t h)
+{
+    ctrl[index] = h;
+    if (index < CRA_SWISSDICT_GROUP_WIDTH)
+        ctrl[capacity + index] = h; // 镜像
+}
+
+static inline size_t
+cra_swissdict_capacity_for(size_t n)
+{
+    size_t c = CRA_SWISSDICT_DEFAULT_CAPACITY;
+    while (c < n)
+        c <<= 1;
+    return c;
+}
+
+// 返回第一个EMPTY或DELETED的slot
+static inline size_t
+cra_swissdict_find_insert_slot(const int8_t *ctrl, size_t capacity, cra_uhash_t hash)
+{
+    uint32_t mask;
+    size_t   step = 0;
+    size_t   pos = CRA_SWISSDICT_H1(hash) & (capacity - 1);
+
+    while (true)
+    {
+        mask = cra_swissdict_group_match_empty_or_deleted(ctrl + pos);
+        if (mask)
+            return (pos + cra_swissdict_ctz(mask)) & (capacity - 1);
+        // 三角数探测, 2的幂容量时可以遍历所有组
+        step += CRA_SWISSDICT_GROUP_WIDTH;
+        pos = (pos + step) & (capacity - 1);
+    }
+}
+
+static inline ssize_t
+cra_swissdict_find(CraSwissDict *dict, const void *key, cra_uhash_t hash)
+{
+    uint32_t       mask;
+    size_t         index;
+    unsigned char *slot;
+    size_t         step = 0;
+    size_t         capmask = (size_t)dict->capacity - 1;
+    size_t         pos = CRA_SWISSDICT_H1(hash) & capmask;
+    int8_t         h2 = CRA_SWISSDICT_H2(hash);
+
+    while (true)
+    {
+        const int8_t *group = dict->ctrl + pos;
+
+        mask = cra_swissdict_group_match(group, h2);
+        while (mask)
+        {
+            index = (pos + cra_swissdict_ctz(mask)) & capmask;
+            slot = CRA_SWISSDICT_PSLOT(dict, index);
+            if (dict->compare_key(key, CRA_SWISSDICT_PKEY(dict, slot)) == 0)
+                return (ssize_t)index;
+            mask &= mask - 1;
+        }
+        // 组内有EMPTY, 说明key不存在
+        if (cra_swissdict_group_match_empty(group))
+            return -1;
+
+        step += CRA_SWISSDICT_GROUP_WIDTH;
+        pos = (pos + step) & capmask;
+    }
+}
+
+static bool
+cra_swissdict_resize(CraSwissDict *dict, size_t new_capacity)
+{
+    int8_t        *new_ctrl;
+    unsigned char *new_slots;
+    unsigned char *slot;
+    cra_uhash_t    hash;
+    size_t         index;
+
+    assert(new_capacity >= CRA_SWISSDICT_DEFAULT_CAPACITY);
+    assert((new_capacity & (new_capacity - 1)) == 0);
+    assert(CRA_SWISSDICT_MAX_LOAD(new_capacity) >= (size_t)dict->count);
+
+    new_ctrl = cra_malloc(new_capacity + CRA_SWISSDICT_GROUP_WIDTH);
+    if (!new_ctrl)
+        return false;
+    new_slots = cra_malloc(new_capacity * dict->slot_size);
+    if (!new_slots)
+    {
+        cra_free(new_ctrl);
+        return false;
+    }
+    memset(new_ctrl, CRA_SWISSDICT_EMPTY, new_capacity + CRA_SWISSDICT_GROUP_WIDTH);
+
+    for (ssize_t i = 0; i < dict->capacity; ++i)
+    {
+        if (dict->ctrl[i] < 0)
+            continue;
+
+        slot = CRA_SWISSDICT_PSLOT(dict, i);
+        hash = cra_hash_mix(dict->hash_key(CRA_SWISSDICT_PKEY(dict, slot)));
+        index = cra_swissdict_find_insert_slot(new_ctrl, new_capacity, hash);
+        cra_swissdict_set_ctrl(new_ctrl, new_capacity, index, CRA_SWISSDICT_H2(hash));
+        memcpy(CRA_SWISSDICT_PSLOT0(dict, new_slots, index), slot, dict->slot_size);
+    }
+
+    cra_free(dict->ctrl);
+    cra_free(dict->slots);
+    dict->ctrl = new_ctrl;
+    dict->slots = new_slots;
+    dict->capacity = (ssize_t)new_capacity;
+    dict->growth_left = (ssize_t)CRA_SWISSDICT_MAX_LOAD(new_capacity) - dict->count;
+    return true;
+}
+
+static inline void
+cra_swissdict_erase(CraSwissDict *dict, size_t index)
+{
+    size_t   capmask = (size_t)dict->capacity - 1;
+    size_t   index_before = (index - CRA_SWISSDICT_GROUP_WIDTH) & capmask;
+    uint32_t empty_after = cra_swissdict_group_match_empty(dict->ctrl + index);
+    uint32_t empty_before = cra_swissdict_group_match_empty(dict->ctrl + index_before);
+
+    // 包含该slot的任意一组都有EMPTY, 则没有探测序列越过过它, 可以直接置为EMPTY
+    if (empty_before && empty_after &&
+        cra_swissdict_ctz(empty_after) + cra_swissdict_clz16(empty_before) < CRA_SWISSDICT_GROUP_WIDTH)
+    {
+        cra_swissdict_set_ctrl(dict->ctrl, (size_t)dict->capacity, index, CRA_SWISSDICT_EMPTY);
+        ++dict->growth_left;
+    }
+    else
+    {
+        cra_swissdict_set_ctrl(dict->ctrl, (size_t)dict->capacity, index, CRA_SWISSDICT_DELETED);
+    }
+    --dict->count;
+
+    // 删空后清除所有DELETED, 避免之后的查找因没有EMPTY而探测整个表
+    if (dict->count == 0 && dict->growth_left != (ssize_t)CRA_SWISSDICT_MAX_LOAD(dict->capacity))
+    {
+        memset(dict->ctrl, CRA_SWISSDICT_EMPTY, dict->capacity + CRA_SWISSDICT_GROUP_WIDTH);
+        dict->growth_left = (ssize_t)CRA_SWISSDICT_MAX_LOAD(dict->capacity);
+    }
+}
+
+bool(cra_swissdict_init_with_size)(CraSwissDict *dict,
+                                   size_t        key_size,
+                                   size_t        val_size,
+                                   size_t        key_align,
+                                   size_t        val_align,
+                                   size_t        init_capacity,
+                                   cra_hash_fn   hash_key,
+                                   cra_cmp_fn    compare_key)
+{
+    size_t offset;
+    size_t capacity;
+
+    assert(dict);
+    assert(key_size > 0);
+    assert(val_size > 0);
+    assert(key_align > 0);
+    assert(val_align > 0);
+    assert(key_size % key_align == 0);
+    assert(val_size % val_align == 0);
+    assert(compare_key);
+    assert(hash_key);
+
+    offset = 0;
+    dict->key_offset = offset;
+    offset += key_size;
+
+    offset = CRA_SWISSDICT_ALIGN_UP(offset, val_align);
+    dict->val_offset = offset;
+    offset += val_size;
+
+    dict->slot_size = CRA_SWISSDICT_ALIGN_UP(offset, CRA_MAX(key_align, val_align));
+    dict->key_size = key_size;
+    dict->val_size = val_size;
+
+    dict->hash_key = hash_key;
+    dict->compare_key = compare_key;
+
+    capacity = cra_swissdict_capacity_for(init_capacity);
+    dict->count = 0;
+    dict->capacity = (ssize_t)capacity;
+    dict->growth_left = (ssize_t)CRA_SWISSDICT_MAX_LOAD(capacity);
+
+    dict->ctrl = cra_malloc(capacity + CRA_SWISSDICT_GROUP_WIDTH);
+    if (!dict->ctrl)
+        return false;
+    dict->slots = cra_malloc(capacity * dict->slot_size);
+    if (!dict->slots)
+    {
+        cra_free(dict->ctrl);
+        return false;
+    }
+    memset(dict->ctrl, CRA_SWISSDICT_EMPTY, capacity + CRA_SWISSDICT_GROUP_WIDTH);
+
+    return true;
+}
+
+void
+cra_swissdict_uninit(CraSwissDict *dict)
+{
+    assert(dict);
+
+    cra_free(dict->ctrl);
+    cra_free(dict->slots);
+    bzero(dict, sizeof(*dict));
+}
+
+void
+cra_swissdict_clear(CraSwissDict *dict)
+{
+    assert(dict);
+    assert(dict->ctrl);
+    assert(dict->slots);
+
+    if (dict->count > 0 || dict->growth_left != (ssize_t)CRA_SWISSDICT_MAX_LOAD(dict->capacity))
+        memset(dict->ctrl, CRA_SWISSDICT_EMPTY, dict->capacity + CRA_SWISSDICT_GROUP_WIDTH);
+    dict->count = 0;
+    dict->growth_left = (ssize_t)CRA_SWISSDICT_MAX_LOAD(dict->capacity);
+}
+
+bool
+cra_swissdict_reserve(CraSwissDict *dict, ssize_t new_capacity)
+{
+    size_t capacity;
+
+    assert(dict);
+    assert(dict->ctrl);
+    assert(dict->slots);
+
+    capacity = cra_swissdict_capacity_for(new_capacity > 0 ? (size_t)new_capacity : 0);
+    while (CRA_SWISSDICT_MAX_LOAD(capacity) < (size_t)dict->count)
+        capacity <<= 1;
+    return cra_swissdict_resize(dict, capacity);
+}
+
+bool(cra_swissdict_put_and_return_kv)(CraSwissDict *dict,
+                                      void         *key,
+                                      void         *val,
+                                      void         *retoldkey,
+                                      void         *retoldval,
+                                      bool          add)
+{
+    cra_uhash_t    hash;
+    ssize_t        found;
+    size_t         index;
+    unsigned char *slot;
+
+    assert(key);
+    assert(val);
+    assert(dict);
+    assert(dict->ctrl);
+    assert(dict->slots);
+
+    hash = cra_hash_mix(dict->hash_key(key));
+
+    found = cra_swissdict_find(dict, key, hash);
+    if (found >= 0)
+    {
+        if (add)
+            return false;
+
+        slot = CRA_SWISSDICT_PSLOT(dict, found);
+        if (retoldkey)
+            memcpy(retoldkey, CRA_SWISSDICT_PKEY(dict, slot), dict->key_size);
+        if (retoldval)
+            memcpy(retoldval, CRA_SWISSDICT_PVAL(dict, slot), dict->val_size);
+
+        memcpy(CRA_SWISSDICT_PKEY(dict, slot), key, dict->key_size);
+        memcpy(CRA_SWISSDICT_PVAL(dict, slot), val, dict->val_size);
+        return true;
+    }
+
+    index = cra_swissdict_find_insert_slot(dict->ctrl, (size_t)dict->capacity, hash);
+    if (dict->growth_left == 0 && dict->ctrl[index] == CRA_SWISSDICT_EMPTY)
+    {
+        // DELETED过多时原地重建, 否则扩容
+        size_t new_capacity = (size_t)dict->capacity;
+        if ((size_t)dict->count * 32 > new_capacity * 25)
+            new_capacity <<= 1;
+        if (!cra_swissdict_resize(dict, new_capacity))
+            return false;
+        index = cra_swissdict_find_insert_slot(dict->ctrl, (size_t)dict->capacity, hash);
+    }
+
+    if (dict->ctrl[index] == CRA_SWISSDICT_EMPTY)
+        --dict->growth_left;
+    cra_swissdict_set_ctrl(dict->ctrl, (size_t)dict->capacity, index, CRA_SWISSDICT_H2(hash));
+
+    slot = CRA_SWISSDICT_PSLOT(dict, index);
+    memcpy(CRA_SWISSDICT_PKEY(dict, slot), key, dict->key_size);
+    memcpy(CRA_SWISSDICT_PVAL(dict, slot), val, dict->val_size);
+
+    ++dict->count;
+    return true;
+}
+
+bool(cra_swissdict_pop_kv)(CraSwissDict *dict, const void *key, void *retkey, void *retval)
+{
+    ssize_t        found;
+    unsigned char *slot;
+
+    assert(key);
+    assert(dict);
+    assert(dict->ctrl);
+    assert(dict->slots);
+
+    found = cra_swissdict_find(dict, key, cra_hash_mix(dict->hash_key(key)));
+    if (found < 0)
+        return false;
+
+    slot = CRA_SWISSDICT_PSLOT(dict, found);
+    if (retkey)
+        memcpy(retkey, CRA_SWISSDICT_PKEY(dict, slot), dict->key_size);
+    if (retval)
+        memcpy(retval, CRA_SWISSDICT_PVAL(dict, slot), dict->val_size);
+
+    cra_swissdict_erase(dict, (size_t)found);
+    return true;
+}
+
+void *(cra_swissdict_get_ref)(CraSwissDict * dict, const void *key)
+{
+    ssize_t found;
+
+    assert(key);
+    assert(dict);
+    assert(dict->ctrl);
+    assert(dict->slots);
+
+    found = cra_swissdict_find(dict, key, cra_hash_mix(dict->hash_key(key)));
+    if (found < 0)
+        return NULL;
+    return CRA_SWISSDICT_PVAL(dict, CRA_SWISSDICT_PSLOT(dict, found));
+}
+
+// ====================================== interfaces ======================================
+
+// initializable
+
+static CRA_INITIALIZABLE_INIT_FN(cra_swissdict_initializable_init)
+{
+    CraSwissDict                   *dict = (CraSwissDict *)obj;
+    CraSwissDictInitializableParam *param = (CraSwissDictInitializableParam *)params;
+
+    assert(dict);
+    assert(param);
+
+    return (cra_swissdict_init_with_size)(dict, param->key_size, param->val_size, param->key_align, param->val_align,
+                                          length, param->hash_key, param->compare_key);
+}
+
+CRA_INITIALIZABLE_DEF(cra_g_swissdict_initializable_i) = {
+    .init = cra_swissdict_initializable_init,
+    .uninit = (CRA_INITIALIZABLE_UNINIT_FN((*)))cra_swissdict_uninit,
+};
+
+// appendable
+
+static CRA_APPENDABLE_APPEND_FN(cra_swissdict_appendable_append)
+{
+    assert(obj);
+    assert(val);
+    assert(val->key_ref);
+    assert(val->val_ref);
+
+    CraSwissDict *dict = (CraSwissDict *)obj;
+    return (cra_swissdict_put_and_return_kv)(dict, val->key_ref, val->val_ref, NULL, NULL, true);
+}
+
+CRA_APPENDABLE_DEF(cra_g_swissdict_appendable_i) = {
+    .append = cra_swissdict_appendable_append,
+};
+
+// iterable
+
+static CRA_ITERABLE_INIT_FN(cra_swissdict_iterable_init)
+{
+    CraSwissDict *dict = (CraSwissDict *)obj;
+
+    assert(it);
+    assert(dict);
+    assert(dict->ctrl);
+    assert(dict->slots);
+
+    if (retcnt)
+        *retcnt = (size_t)dict->count;
+
+    it->obj = obj;
+    it->ic1.idx = reverse ? (size_t)dict->capacity : 0;
+
+    return dict->count > 0;
+}
+
+static CRA_ITERABLE_NEXT_FN(cra_swissdict_iterable_next)
+{
+    CraSwissDict  *dict;
+    unsigned char *slot;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    dict = (CraSwissDict *)it->obj;
+
+    while ((ssize_t)it->ic1.idx < dict->capacity)
+    {
+        if (dict->ctrl[it->ic1.idx] >= 0)
+        {
+            slot = CRA_SWISSDICT_PSLOT(dict, it->ic1.idx++);
+            val->key_ref = CRA_SWISSDICT_PKEY(dict, slot);
+            val->val_ref = CRA_SWISSDICT_PVAL(dict, slot);
+            return true;
+        }
+        ++it->ic1.idx;
+    }
+    return false;
+}
+
+static CRA_ITERABLE_PREV_FN(cra_swissdict_iterable_prev)
+{
+    CraSwissDict  *dict;
+    unsigned char *slot;
+
+    assert(it);
+    assert(val);
+    assert(it->obj);
+
+    dict = (CraSwissDict *)it->obj;
+
+    while (it->ic1.idx > 0)
+    {
+        if (dict->ctrl[--it->ic1.idx] >= 0)
+        {
+            slot = CRA_SWISSDICT_PSLOT(dict, it->ic1.idx);
+            val->key_ref = CRA_SWISSDICT_PKEY(dict, slot);
+            val->val_ref = CRA_SWISSDICT_PVAL(dict, slot);
+            return true;
+        }
+    }
+    return false;
+}
+
+CRA_ITERABLE_DEF(cra_g_swissdict_iterable_i) = {
+    .init = cra_swissdict_iterable_init,
+    .next = cra_swissdict_iterable_next,
+    .prev = cra_swissdict_iterable_prev,
+};
@@ -1,4 +1,9 @@
 #include "cra_futils.h"
+#include "cra_assert.h"
+#ifndef CRA_OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 #define IS_SLASH(c) CRA_IS_PATH_SEP(c)
 #define IS_ZERO(c)  (c == '\0')
@@ -161,4 +166,81 @@ cra_dirname(char *path)
         return ".";
 
     return path;
-}
\ No newline at end of file
+}
+#ifdef CRA_OS_WIN
+
+const void *
+cra_mmap_file_readonly(const char *path, size_t *retsize)
+{
+    HANDLE        hfile, hmap;
+    LARGE_INTEGER size;
+    void         *addr;
+
+    assert(path);
+    assert(retsize);
+
+    hfile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE)
+        return NULL;
+    if (!GetFileSizeEx(hfile, &size) || size.QuadPart <= 0)
+    {
+        CloseHandle(hfile);
+        return NULL;
+    }
+    hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hfile);
+    if (!hmap)
+        return NULL;
+    // 映射视图会保持文件映射对象存活
+    addr = MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hmap);
+    if (!addr)
+        return NULL;
+    *retsize = (size_t)size.QuadPart;
+    return addr;
+}
+
+void
+cra_munmap_file(const void *addr, size_t size)
+{
+    CRA_UNUSED(size);
+    if (addr)
+        UnmapViewOfFile(addr);
+}
+
+#else
+
+const void *
+cra_mmap_file_readonly(const char *path, size_t *retsize)
+{
+    int         fd;
+    struct stat st;
+    void       *addr;
+
+    assert(path);
+    assert(retsize);
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return NULL;
+    if (fstat(fd, &st) == -1 || st.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return NULL;
+    *retsize = (size_t)st.st_size;
+    return addr;
+}
+
+void
+cra_munmap_file(const void *addr, size_t size)
+{
+    if (addr)
+        munmap((void *)addr, size);
+}
+
+#endif
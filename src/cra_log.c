@@ -17,13 +17,14 @@
 #include "threads/cra_lock.h"
 #include "threads/cra_thread.h"
 #include "collections/cra_alist.h"
-#include "collections/cra_llist.h"
+#include "collections/cra_ilist.h"
 
 typedef struct CraLogOutputAsync CraLogOutputAsync;
 typedef struct CraLogBuf         CraLogBuf;
 
 struct CraLogBuf
 {
+    CraIListNode node;
     CraLogger   *log;
     unsigned int len;
     char         buf[CRA_LOG_BUF_SIZE];
@@ -39,8 +40,8 @@ struct CraLogOutputAsync
     cra_cond_t        condi;
     cra_mutex_t       mutex;
     CraAList          loggers;  // AList<CraLogger *>
-    CraLList         *buffers1; // LList<CraLogBuf *>
-    CraLList         *buffers2; // LList<CraLogBuf *>
+    CraIList          buffers1; // IList<CraLogBuf>
+    CraIList          buffers2; // IList<CraLogBuf>
     CraAList          buf_pool; // AList<CraLogBuf *>
 };
 
@@ -103,6 +104,7 @@ cra_log_output_async_get_buf(void)
     {
         buf->len = 0;
         buf->log = NULL;
+        cra_ilist_node_init(&buf->node);
     }
 
     return buf;
@@ -214,15 +216,16 @@ cra_log_output_async_write_to_file(CraLogBuf *buf)
 
 static CRA_THRD_FUNC(cra_log_output_async_thread)
 {
-    CraLogBuf *buf;
-    CraLogger *logger;
+    CraLogBuf    *buf;
+    CraLogger    *logger;
+    CraIListNode *node;
 
     CRA_UNUSED(arg);
 
     while (s_log_async.running)
     {
         cra_mutex_lock(&s_log_async.mutex);
-        while (s_log_async.buffers1->count == 0 && s_log_async.running)
+        while (s_log_async.buffers1.count == 0 && s_log_async.running)
         {
             cra_cond_wait_timeout(&s_log_async.condi, &s_log_async.mutex, CRA_LOG_OUTPUT_INTERVAL);
 
@@ -233,17 +236,18 @@ static CRA_THRD_FUNC(cra_log_output_async_thread)
 
                 cra_log_ref(logger);
                 logger->buffer->log = logger;
-                cra_llist_append(s_log_async.buffers1, &logger->buffer);
+                cra_ilist_push_back(&s_log_async.buffers1, &logger->buffer->node);
                 logger->buffer = cra_log_output_async_get_buf();
             }
         }
 
-        cra_swap_ptr((void **)&s_log_async.buffers1, (void **)&s_log_async.buffers2);
+        cra_ilist_move(&s_log_async.buffers2, &s_log_async.buffers1);
 
         cra_mutex_unlock(&s_log_async.mutex);
 
-        while (cra_llist_pop_front(s_log_async.buffers2, &buf))
+        while ((node = cra_ilist_pop_front(&s_log_async.buffers2)))
         {
+            buf = CRA_ILIST_ENTRY(node, CraLogBuf, node);
             cra_log_output_async_write_to_file(buf);
             cra_log_unref(buf->log);
 
@@ -253,8 +257,9 @@ static CRA_THRD_FUNC(cra_log_output_async_thread)
         }
     }
 
-    while (cra_llist_pop_front(s_log_async.buffers1, &buf))
+    while ((node = cra_ilist_pop_front(&s_log_async.buffers1)))
     {
+        buf = CRA_ILIST_ENTRY(node, CraLogBuf, node);
         cra_log_output_async_write_to_file(buf);
         cra_log_unref(buf->log);
 
@@ -282,19 +287,8 @@ cra_log_output_async_init(void)
         exit(EXIT_FAILURE);
     }
 
-    s_log_async.buffers1 = cra_alloc(CraLList);
-    s_log_async.buffers2 = cra_alloc(CraLList);
-    if (!s_log_async.buffers1 || !s_log_async.buffers2)
-    {
-        fprintf(stderr, "Logger: failed to create buffers.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    if (!cra_llist_init(CraLogBuf *, s_log_async.buffers1) || !cra_llist_init(CraLogBuf *, s_log_async.buffers2))
-    {
-        fprintf(stderr, "Logger: failed to init buffers.\n");
-        exit(EXIT_FAILURE);
-    }
+    cra_ilist_init(CraLogBuf, &s_log_async.buffers1, node);
+    cra_ilist_init(CraLogBuf, &s_log_async.buffers2, node);
 
     if (!cra_alist_init(CraLogBuf *, &s_log_async.buf_pool))
     {
@@ -327,8 +321,8 @@ cra_log_output_async_uninit(void)
     assert(!s_log_async.running);
     assert(s_log_async.initialized);
     assert(s_log_async.loggers.count == 0);
-    assert(s_log_async.buffers1->count == 0);
-    assert(s_log_async.buffers2->count == 0);
+    assert(s_log_async.buffers1.count == 0);
+    assert(s_log_async.buffers2.count == 0);
 
     s_log_async.initialized = false;
     s_log_async.alloc_buf_cnt = 0;
@@ -338,11 +332,6 @@ cra_log_output_async_uninit(void)
 
     cra_alist_uninit(&s_log_async.loggers);
 
-    cra_llist_uninit(s_log_async.buffers1);
-    cra_llist_uninit(s_log_async.buffers2);
-    cra_dealloc(s_log_async.buffers1);
-    cra_dealloc(s_log_async.buffers2);
-
     CraLogBuf *buf;
     while (cra_alist_pop_back(&s_log_async.buf_pool, &buf))
     {
@@ -384,7 +373,7 @@ cra_log_output_async_append(CraLogger *logger, const char *msg, int len)
     {
         cra_log_ref(logger);
         logger->buffer->log = logger;
-        cra_llist_append(s_log_async.buffers1, &logger->buffer);
+        cra_ilist_push_back(&s_log_async.buffers1, &logger->buffer->node);
         cra_cond_signal(&s_log_async.condi);
         goto get_new_buf;
     }
@@ -449,7 +438,7 @@ cra_log_output_async_del_logger(CraLogger *logger)
         {
             cra_log_ref(logger);
             logger->buffer->log = logger;
-            cra_llist_append(s_log_async.buffers1, &logger->buffer);
+            cra_ilist_push_back(&s_log_async.buffers1, &logger->buffer->node);
             cra_cond_signal(&s_log_async.condi);
         }
         else
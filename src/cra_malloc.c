@@ -8,6 +8,8 @@
  * @copyright Copyright (c) 2024
  *
  */
+#include <stdalign.h>
+#include <stddef.h>
 #include "cra_malloc.h"
 #include "cra_atomic.h"
 
@@ -34,27 +36,58 @@ struct CraMallocData
 struct CraMallocCB
 {
     CraMallocCB *next;
+    CraMallocCB *prev; // 双向链表，free时O(1)摘除
+    unsigned int magic;
     size_t       size;
     char        *file;
     int          line;
-    char         block[];
+    // 与malloc的返回值一样按max_align_t对齐，否则64位原子变量可能跨缓存行
+    alignas(max_align_t) char block[];
 };
 
 static CraMallocData s_mdata = { 0 };
 
+// 头部的magic标记块是否还在使用，用来检查重复释放
+#define CRA_MALLOC_MAGIC_ALIVE 0x4352414d
+#define CRA_MALLOC_MAGIC_FREED 0x66726565
+
+#define CRA_MALLOC_CB_OF(ptr) ((CraMallocCB *)((char *)(ptr) - offsetof(CraMallocCB, block)))
+
 #define CRA_MALLOC_LOCK()   while (cra_atomic_flag_test_and_set(&s_mdata.mem_lock, CRA_MO_ACQUIRE))
 #define CRA_MALLOC_UNLOCK() cra_atomic_flag_clear(&s_mdata.mem_lock, CRA_MO_RELEASE)
 
+// 以下两个函数要在加锁后调用
+static inline void
+__cra_malloc_link_block(CraMallocCB *node)
+{
+    node->prev = NULL;
+    node->next = s_mdata.mem_list;
+    if (s_mdata.mem_list)
+        s_mdata.mem_list->prev = node;
+    s_mdata.mem_list = node;
+}
+
+static inline void
+__cra_malloc_unlink_block(CraMallocCB *node)
+{
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        s_mdata.mem_list = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+}
+
 static inline void
 __cra_malloc_set_block(CraMallocCB *node, size_t size, char *file, int line)
 {
+    node->magic = CRA_MALLOC_MAGIC_ALIVE;
     node->size = size;
     node->line = line;
     node->file = file;
 
     CRA_MALLOC_LOCK();
-    node->next = s_mdata.mem_list;
-    s_mdata.mem_list = node;
+    __cra_malloc_link_block(node);
     CRA_MALLOC_UNLOCK();
 }
 
@@ -87,36 +120,33 @@ __cra_realloc_dbg(void *ptr, size_t newsize, char *file, int line)
     void        *ret;
     size_t       diff;
     CraMallocCB *curr;
-    CraMallocCB *last;
     CraMallocCB *node;
 
     CRA_UNUSED(file);
     CRA_UNUSED(line);
 
-    ret = NULL;
-
-    CRA_MALLOC_LOCK();
-
-    for (last = NULL, curr = s_mdata.mem_list; curr != NULL; last = curr, curr = curr->next)
-    {
-        if (curr->block == ptr)
-            break;
-    }
-
-    assert_always(curr != NULL);
+    curr = CRA_MALLOC_CB_OF(ptr);
+    assert_always(curr->magic == CRA_MALLOC_MAGIC_ALIVE);
 
     diff = newsize - curr->size;
 
+    CRA_MALLOC_LOCK();
+
+    __cra_malloc_unlink_block(curr);
     node = (CraMallocCB *)__cra_realloc(curr, sizeof(CraMallocCB) + newsize);
     if (node != NULL)
     {
         node->size = newsize;
-        if (last != NULL)
-            last->next = node;
-        else
-            s_mdata.mem_list = node;
+        __cra_malloc_link_block(node);
         ret = node->block;
     }
+    else
+    {
+        // realloc失败时原来的块不变
+        __cra_malloc_link_block(curr);
+        ret = NULL;
+        diff = 0;
+    }
 
     CRA_MALLOC_UNLOCK();
 
@@ -129,35 +159,21 @@ void
 __cra_free_dbg(void *ptr)
 {
     size_t       size;
-    CraMallocCB *last, *curr;
-
-    last = NULL;
-    CRA_MALLOC_LOCK();
-    curr = s_mdata.mem_list;
-    while (curr != NULL)
-    {
-        if (curr->block == ptr)
-        {
-            if (last == NULL)
-                s_mdata.mem_list = curr->next;
-            else
-                last->next = curr->next;
-
-            size = curr->size;
-            __cra_free(curr);
+    CraMallocCB *curr;
 
-            CRA_MALLOC_UNLOCK();
+    curr = CRA_MALLOC_CB_OF(ptr);
+    assert_always(curr->magic == CRA_MALLOC_MAGIC_ALIVE && "double free");
 
-            cra_atomic_inc(&s_mdata.nfree, CRA_MO_RELAXED);
-            cra_atomic_add(&s_mdata.free_bytes, size, CRA_MO_RELAXED);
-            return;
-        }
-        last = curr;
-        curr = curr->next;
-    }
+    CRA_MALLOC_LOCK();
+    __cra_malloc_unlink_block(curr);
     CRA_MALLOC_UNLOCK();
 
-    assert_always(false && "double free");
+    size = curr->size;
+    curr->magic = CRA_MALLOC_MAGIC_FREED;
+    __cra_free(curr);
+
+    cra_atomic_inc(&s_mdata.nfree, CRA_MO_RELAXED);
+    cra_atomic_add(&s_mdata.free_bytes, size, CRA_MO_RELAXED);
 }
 
 void
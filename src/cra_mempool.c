@@ -2,24 +2,51 @@
 #include "cra_assert.h"
 #include "cra_malloc.h"
 
+// 对象的next指针存放在对象内存的开头，对象不一定按指针对齐，用memcpy读写
+static inline void *
+cra_mempool_item_next(void *item)
+{
+    void *next;
+    memcpy(&next, item, sizeof(next));
+    return next;
+}
+
+static inline void
+cra_mempool_item_set_next(void *item, void *next)
+{
+    memcpy(item, &next, sizeof(next));
+}
+
+// 把块中的对象按地址从低到高串到空闲链表头部，alloc时连续申请的对象在内存中相邻
+static void
+cra_mempool_push_block_items(CraMemPool *pool, char *block)
+{
+    char *item;
+
+    for (size_t j = pool->items_per_block; j-- > 0;)
+    {
+        item = block + (j * pool->item_stride);
+        cra_mempool_item_set_next(item, pool->free_list);
+        pool->free_list = item;
+    }
+    pool->nfree += pool->items_per_block;
+}
+
 static bool
 cra_mempool_make_block(CraMemPool *pool)
 {
     char *block;
-    char *item;
 
     // alloc & zero memory
-    block = (char *)cra_calloc(pool->items_per_block, pool->item_size);
+    block = (char *)cra_calloc(pool->items_per_block, pool->item_stride);
     if (block == NULL)
         return false;
     if (!cra_alist_append(&pool->blocks, &block))
-        return false;
-    for (size_t j = 0; j < pool->items_per_block; ++j)
     {
-        item = block + (j * pool->item_size);
-        if (!cra_alist_append(&pool->stack, &item))
-            return false;
+        cra_free(block);
+        return false;
     }
+    cra_mempool_push_block_items(pool, block);
     return true;
 }
 
@@ -32,11 +59,12 @@ cra_mempool_init(CraMemPool *pool, size_t item_size, size_t items_per_block, siz
     assert(items_per_block > 0);
 
     pool->item_size = item_size;
+    pool->item_stride = CRA_MAX(item_size, sizeof(void *));
     pool->items_per_block = items_per_block;
+    pool->nfree = 0;
+    pool->free_list = NULL;
     if (!cra_alist_init_with_size(void *, &pool->blocks, init_block))
         return false;
-    if (!cra_alist_init_with_size(void *, &pool->stack, init_block *items_per_block))
-        return false;
 
     for (size_t i = 0; i < init_block; ++i)
         if (!cra_mempool_make_block(pool))
@@ -59,38 +87,145 @@ cra_mempool_uninit_no_check(CraMemPool *pool)
         cra_free(block);
     }
     cra_alist_uninit(&pool->blocks);
-    cra_alist_uninit(&pool->stack);
+    pool->free_list = NULL;
+    pool->nfree = 0;
 }
 
 void
 cra_mempool_uninit(CraMemPool *pool)
 {
     size_t nmax;
-    size_t nstack;
 
     assert(pool);
 
-    nstack = pool->stack.count;
     nmax = pool->blocks.count * pool->items_per_block;
-    if (nstack != nmax)
+    if (pool->nfree != nmax)
     {
-        fprintf(stderr, "mempool_uninit() error: %zu items are actively being used.", nmax - nstack);
+        fprintf(stderr, "mempool_uninit() error: %zu items are actively being used.", nmax - pool->nfree);
         exit(EXIT_FAILURE);
     }
 
     cra_mempool_uninit_no_check(pool);
 }
 
-void *
-cra_mempool_alloc(CraMemPool *pool)
+bool
+cra_mempool_trim(CraMemPool *pool)
 {
+    char *block;
+
     assert(pool);
-    void *ret = NULL;
-    if (!cra_alist_pop_back(&pool->stack, &ret))
+
+    if (pool->nfree != pool->blocks.count * pool->items_per_block)
+        return false;
+
+    // 只保留第一块
+    while (pool->blocks.count > 1)
     {
-        if (cra_mempool_make_block(pool))
-            cra_alist_pop_back(&pool->stack, &ret);
+        cra_alist_pop_back(&pool->blocks, &block);
+        cra_free(block);
     }
+    pool->free_list = NULL;
+    pool->nfree = 0;
+    if (cra_alist_get(&pool->blocks, 0, &block))
+        cra_mempool_push_block_items(pool, block);
+    return true;
+}
+
+// 在按地址升序排列的块中查找item所在的块
+static size_t
+cra_mempool_find_block(char **blocks, size_t nblocks, size_t block_bytes, char *item)
+{
+    size_t lo = 0, hi = nblocks, mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if ((uintptr_t)item < (uintptr_t)blocks[mid])
+            hi = mid;
+        else if ((uintptr_t)item >= (uintptr_t)blocks[mid] + block_bytes)
+            lo = mid + 1;
+        else
+            return mid;
+    }
+    assert_always(false && "item does not belong to this pool");
+    return nblocks;
+}
+
+size_t
+cra_mempool_release_unused(CraMemPool *pool)
+{
+    char  **blocks;
+    size_t *nfrees;
+    size_t  nblocks, nreleased, block_bytes, idx, keep;
+    void   *item, *next, *tail;
+
+    assert(pool);
+
+    if (pool->nfree < pool->items_per_block)
+        return 0;
+
+    // 块按地址排序后二分查找空闲对象所在的块，统计每块的空闲对象数
+    if (!cra_alist_radix_sort(&pool->blocks, CRA_RADIX_KEY_UINT))
+        return 0;
+    blocks = (char **)pool->blocks.array;
+    nblocks = pool->blocks.count;
+    nfrees = (size_t *)cra_calloc(nblocks, sizeof(size_t));
+    if (!nfrees)
+        return 0;
+    block_bytes = pool->items_per_block * pool->item_stride;
+    for (item = pool->free_list; item; item = cra_mempool_item_next(item))
+        nfrees[cra_mempool_find_block(blocks, nblocks, block_bytes, (char *)item)]++;
+
+    // 从空闲链表中摘掉全空闲块中的对象，其余对象保持原有顺序
+    tail = NULL;
+    for (item = pool->free_list; item; item = next)
+    {
+        next = cra_mempool_item_next(item);
+        idx = cra_mempool_find_block(blocks, nblocks, block_bytes, (char *)item);
+        if (nfrees[idx] == pool->items_per_block)
+            continue;
+        if (tail)
+            cra_mempool_item_set_next(tail, item);
+        else
+            pool->free_list = item;
+        tail = item;
+    }
+    if (tail)
+        cra_mempool_item_set_next(tail, NULL);
+    else
+        pool->free_list = NULL;
+
+    // 释放全空闲的块
+    keep = 0;
+    for (size_t i = 0; i < nblocks; ++i)
+    {
+        if (nfrees[i] == pool->items_per_block)
+            cra_free(blocks[i]);
+        else
+            blocks[keep++] = blocks[i];
+    }
+    nreleased = nblocks - keep;
+    pool->blocks.count = keep;
+    pool->nfree -= nreleased * pool->items_per_block;
+
+    cra_free(nfrees);
+    return nreleased;
+}
+
+void *
+cra_mempool_alloc(CraMemPool *pool)
+{
+    void *ret;
+
+    assert(pool);
+
+    if (!pool->free_list && !cra_mempool_make_block(pool))
+        return NULL;
+    ret = pool->free_list;
+    pool->free_list = cra_mempool_item_next(ret);
+    pool->nfree--;
+    // 清掉链表指针，首次alloc的对象内容全为0
+    bzero(ret, sizeof(void *));
     return ret;
 }
 
@@ -99,5 +234,7 @@ cra_mempool_dealloc(CraMemPool *pool, void *ptr)
 {
     assert(pool);
     assert(ptr);
-    cra_alist_append(&pool->stack, &ptr);
+    cra_mempool_item_set_next(ptr, pool->free_list);
+    pool->free_list = ptr;
+    pool->nfree++;
 }
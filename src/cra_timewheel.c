@@ -2,58 +2,31 @@
 #include "collections/cra_llist.h"
 #include "cra_malloc.h"
 
-#if 1 // free node list
+#if 1 // node pool
 
-static inline CraLList *
-cra_freenodelist_new(void)
+static inline CraMemPool *
+cra_timewheel_nodepool_new(void)
 {
-    CraLList *list = cra_alloc(CraLList);
-    if (!list)
+    CraMemPool *pool = cra_alloc(CraMemPool);
+    if (!pool)
         return NULL;
-    if (!cra_llist_init(CraLListNode *, list))
+    if (!cra_llist_nodepool_init(CraTimer_base *, pool, CRA_TIMEWHEEL_NODES_PER_SLAB))
     {
-        cra_dealloc(list);
+        cra_dealloc(pool);
         return NULL;
     }
-    return list;
+    return pool;
 }
 
 static inline void
-cra_freenodelist_delete(CraLList *list)
+cra_timewheel_nodepool_delete(CraMemPool *pool)
 {
-    assert(list);
-    cra_llist_uninit(list);
-    cra_dealloc(list);
+    assert(pool);
+    cra_mempool_uninit(pool);
+    cra_dealloc(pool);
 }
 
-static inline CraLListNode *
-cra_freenodelist_get(CraLList *list)
-{
-    assert(list);
-    CraLListNode *node;
-    if (list->count > 0)
-    {
-        node = list->head;
-        cra_llist_remove_node(list, node, false);
-    }
-    else
-    {
-        node = cra_llist_create_node(list->itemsize);
-    }
-    return node;
-}
-
-static inline void
-cra_freenodelist_put(CraLList *list, CraLListNode *node)
-{
-    assert(list);
-    assert(node);
-
-    // bzero(node->val, sizeof(CraTimer_base *));
-    cra_llist_insert_node(list, 0, node);
-}
-
-#endif // end free node list
+#endif // end node pool
 
 void
 cra_timer_base_init(CraTimer_base    *base,
@@ -77,7 +50,7 @@ cra_timer_base_init(CraTimer_base    *base,
 #define CRA_TIMER_IN_NODE(node) (*(CraTimer_base **)(node)->val)
 
 static bool
-__cra_timewheel_init(CraTimewheel *wheel, uint32_t tick_ms, uint32_t wheel_size, CraLList *freenodelist)
+__cra_timewheel_init(CraTimewheel *wheel, uint32_t tick_ms, uint32_t wheel_size, CraMemPool *nodepool)
 {
     wheel->wheel_buckets = (CraLList *)cra_calloc(wheel_size, sizeof(CraLList));
     if (!wheel->wheel_buckets)
@@ -86,7 +59,7 @@ __cra_timewheel_init(CraTimewheel *wheel, uint32_t tick_ms, uint32_t wheel_size,
     wheel->tick_ms = tick_ms;
     wheel->current = 0;
     wheel->wheel_size = wheel_size;
-    wheel->freenodelist = freenodelist;
+    wheel->nodepool = nodepool;
     wheel->upper_wheel = NULL;
     return true;
 }
@@ -99,7 +72,7 @@ cra_timewheel_add_node_to(CraTimewheel *wheel, CraLListNode *timernode, uint32_t
     CraLList *list = &wheel->wheel_buckets[bucket];
     if (list->itemsize == 0)
     {
-        if (!cra_llist_init(CraTimer_base *, list))
+        if (!cra_llist_init_with_pool(CraTimer_base *, list, wheel->nodepool))
             return false;
     }
     return cra_llist_insert_node(list, 0, timernode);
@@ -117,7 +90,7 @@ cra_timewheel_add_node(CraTimewheel *wheel, CraLListNode *timernode)
             if (!wheel->upper_wheel)
                 return false;
             if (!__cra_timewheel_init(wheel->upper_wheel, wheel->tick_ms * wheel->wheel_size, wheel->wheel_size,
-                                      wheel->freenodelist))
+                                      wheel->nodepool))
             {
                 cra_dealloc(wheel->upper_wheel);
                 wheel->upper_wheel = NULL;
@@ -158,7 +131,7 @@ cra_timewheel_tick_inner(CraTimewheel *wheel, CraTimewheel *lower_wheel)
         release_timer:
             if (timer->on_remove_timer)
                 timer->on_remove_timer(timer);
-            cra_freenodelist_put(wheel->freenodelist, curr);
+            cra_mempool_dealloc(wheel->nodepool, curr);
             continue;
         }
 
@@ -202,24 +175,26 @@ cra_timewheel_init(CraTimewheel *wheel, uint32_t tick_ms, uint32_t wheel_size)
     assert(tick_ms > 0);
     assert(wheel_size > 0);
 
-    CraLList *freenodelist = cra_freenodelist_new();
-    if (!freenodelist)
+    CraMemPool *nodepool = cra_timewheel_nodepool_new();
+    if (!nodepool)
+        return false;
+    if (!__cra_timewheel_init(wheel, tick_ms, wheel_size, nodepool))
+    {
+        cra_timewheel_nodepool_delete(nodepool);
         return false;
-    return __cra_timewheel_init(wheel, tick_ms, wheel_size, freenodelist);
+    }
+    return true;
 }
 
-void
-cra_timewheel_uninit(CraTimewheel *wheel)
+// 节点都还给节点池，节点池由最底层的时间轮释放
+static void
+__cra_timewheel_uninit(CraTimewheel *wheel)
 {
     CraLList *list;
 
-    assert(wheel);
-    assert(wheel->freenodelist);
-    assert(wheel->wheel_buckets);
-
     if (wheel->upper_wheel)
     {
-        cra_timewheel_uninit(wheel->upper_wheel);
+        __cra_timewheel_uninit(wheel->upper_wheel);
         cra_dealloc(wheel->upper_wheel);
     }
     for (uint32_t i = 0; i < wheel->wheel_size; ++i)
@@ -238,27 +213,27 @@ cra_timewheel_uninit(CraTimewheel *wheel)
             cra_llist_uninit(list);
         }
     }
-    if (!wheel->upper_wheel)
-        cra_freenodelist_delete(wheel->freenodelist);
     cra_free(wheel->wheel_buckets);
 }
 
 void
-cra_timewheel_release_all_free_timers(CraTimewheel *wheel)
+cra_timewheel_uninit(CraTimewheel *wheel)
 {
-    CraLListNode *node;
-
     assert(wheel);
-    assert(wheel->freenodelist);
+    assert(wheel->nodepool);
+    assert(wheel->wheel_buckets);
 
-    while (wheel->freenodelist->head)
-    {
-        node = wheel->freenodelist->head;
-        cra_llist_remove_node(wheel->freenodelist, node, false);
-        cra_dealloc(node);
-    }
+    __cra_timewheel_uninit(wheel);
+    cra_timewheel_nodepool_delete(wheel->nodepool);
+}
+
+void
+cra_timewheel_release_all_free_timers(CraTimewheel *wheel)
+{
+    assert(wheel);
+    assert(wheel->nodepool);
 
-    assert(wheel->freenodelist->count == 0);
+    cra_mempool_release_unused(wheel->nodepool);
 }
 
 bool
@@ -267,12 +242,13 @@ cra_timewheel_add(CraTimewheel *wheel, CraTimer_base *timer)
     assert(wheel);
     assert(timer);
 
-    CraLListNode *node = cra_freenodelist_get(wheel->freenodelist);
+    CraLListNode *node = (CraLListNode *)cra_mempool_alloc(wheel->nodepool);
     if (node)
     {
         CRA_TIMER_IN_NODE(node) = timer;
         if (cra_timewheel_add_node(wheel, node))
             return true;
+        cra_mempool_dealloc(wheel->nodepool, node);
     }
     return false;
 }
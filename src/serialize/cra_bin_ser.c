@@ -14,6 +14,7 @@
 #include "serialize/cra_bin_ser.h"
 #include "cra_endian.h"
 #include "cra_malloc.h"
+#include "threads/cra_intern.h"
 
 #if CRA_IS_BIG_ENDIAN
 #define CRA_SER_SWAP16 CRA_BSWAP_UINT16
@@ -304,7 +305,21 @@ __cra_bin_read_string(CraSerializer *ser, void *retval, uint64_t *retlen, const
     else
         CRA_BIN_CHECK_LENGTH(ser, meta, "Bytes length", len, CRA_BIN_MAX_BYTES_LENGTH);
 
-    if (meta->is_ptr)
+    if (meta->is_ptr && ser->intern && meta->type == CRA_TYPE_STRING)
+    {
+        // 直接从buffer驻留，不申请内存
+        const char    *str;
+        unsigned char *buf = (unsigned char *)"";
+        if (len > 0)
+        {
+            CRA_SERIALIZER_ENSURE(ser, buf, len);
+        }
+        str = cra_intern(ser->intern, (char *)buf, len);
+        CRA_SEIALIZER_CHECK_MEMORY(ser, meta, str);
+        *(const char **)retval = str;
+        return true;
+    }
+    else if (meta->is_ptr)
     {
         // alloc
         retval = *(void **)retval = cra_malloc(len + 1);
@@ -1142,6 +1157,13 @@ cra_bin_serialize_err(unsigned char *buf, size_t *len, CraSeriObject *obj, CraSe
 
 bool
 cra_bin_deserialize_err(unsigned char *buf, size_t len, CraSeriObject *retobj, CraSerErr *err)
+{
+    return cra_bin_deserialize_with_intern(buf, len, retobj, NULL, err);
+}
+
+bool
+cra_bin_deserialize_with_intern(unsigned char *buf, size_t len, CraSeriObject *retobj, CraIntern *intern,
+                                CraSerErr *err)
 {
     assert(buf);
     assert(len > 0);
@@ -1152,6 +1174,7 @@ cra_bin_deserialize_err(unsigned char *buf, size_t len, CraSeriObject *retobj, C
     CraSerializer ser;
 
     cra_serializer_init(&ser, buf, len, false);
+    ser.intern = intern;
     ret = cra_bin_read_value(&ser, retobj->objptr, retobj->meta);
     cra_serializer_check_err(ser, err, ret);
     cra_serializer_uninit(&ser, ret);
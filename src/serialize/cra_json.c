@@ -12,6 +12,7 @@
 #include "serialize/cra_serialize.h"
 #include "serialize/cra_json.h"
 #include "cra_malloc.h"
+#include "threads/cra_intern.h"
 #include <float.h>
 #include <math.h>
 
@@ -219,7 +220,7 @@ cra_json_write_string(CraSerializer *ser, void *val, const CraTypeMeta *meta)
 static bool
 cra_json_read_string(CraSerializer *ser, void *retval, const CraTypeMeta *meta)
 {
-    char  *buf, *str;
+    char  *buf, *str, *tmp = NULL;
     size_t l, len, length, max_length;
 
     CRA_SERIALIZER_ENSURE_(ser, buf, sizeof("\"\""), sizeof("\"\""));
@@ -247,7 +248,22 @@ cra_json_read_string(CraSerializer *ser, void *retval, const CraTypeMeta *meta)
 
     // get string length
     l = len = (size_t)(str - buf) - length;
-    if (meta->is_ptr)
+    if (meta->is_ptr && ser->intern)
+    {
+        if (length == 0)
+        {
+            // 没有特殊字符时直接从buffer驻留
+            const char *s = cra_intern(ser->intern, buf, len);
+            CRA_SEIALIZER_CHECK_MEMORY(ser, meta, s);
+            *(const char **)retval = s;
+            goto ok;
+        }
+        // 有特殊字符时先解码到临时内存
+        max_length = len + sizeof("");
+        str = tmp = (char *)cra_malloc(max_length);
+        CRA_SEIALIZER_CHECK_MEMORY(ser, meta, str);
+    }
+    else if (meta->is_ptr)
     {
         max_length = len + sizeof("");
         str = *(char **)retval = (char *)cra_malloc(max_length);
@@ -267,6 +283,8 @@ cra_json_read_string(CraSerializer *ser, void *retval, const CraTypeMeta *meta)
         if (max_length <= len)
         {
         too_small:
+            if (tmp)
+                cra_free(tmp);
             CRA_SERIALIZER_ERROR(ser, meta, CRA_SER_ERR_TOO_SMALL, "string size too small(%zu < %zu)", meta->size,
                                  l + 1);
             return false;
@@ -365,11 +383,20 @@ cra_json_read_string(CraSerializer *ser, void *retval, const CraTypeMeta *meta)
     }
 
     *str = '\0';
+    if (tmp)
+    {
+        const char *s = cra_intern(ser->intern, tmp, (size_t)(str - tmp));
+        cra_free(tmp);
+        CRA_SEIALIZER_CHECK_MEMORY(ser, meta, s);
+        *(const char **)retval = s;
+    }
 ok:
     ser->index += len + sizeof("\"\"") - 1;
     return true;
 
 fail:
+    if (tmp)
+        cra_free(tmp);
     CRA_SERIALIZER_ERROR(ser, meta, CRA_SER_ERR_INVALID_VAL, "invalid string value");
     return false;
 }
@@ -1701,6 +1728,12 @@ cra_json_stringify_err(char *buf, size_t *len, bool format, CraSeriObject *obj,
 
 CRA_API bool
 cra_json_parse_err(char *buf, size_t len, CraSeriObject *retobj, CraSerErr *err)
+{
+    return cra_json_parse_with_intern(buf, len, retobj, NULL, err);
+}
+
+bool
+cra_json_parse_with_intern(char *buf, size_t len, CraSeriObject *retobj, CraIntern *intern, CraSerErr *err)
 {
     assert(buf);
     assert(len > 0);
@@ -1719,6 +1752,7 @@ cra_json_parse_err(char *buf, size_t len, CraSeriObject *retobj, CraSerErr *err)
     }
 
     cra_serializer_init(&ser, buf, len, false);
+    ser.intern = intern;
     cra_json_skip_whitespaces(&ser);
     ret = cra_json_read_value(&ser, retobj->objptr, retobj->meta);
     cra_serializer_check_err(ser, err, ret);
@@ -9,6 +9,7 @@
  *
  */
 #include "threads/cra_blockdq.h"
+#include "cra_time.h"
 
 bool(cra_blockdq_init_with_size)(CraBlockdq      *deque,
                                  size_t           itemsize,
@@ -106,6 +107,22 @@ end:
     return ret;
 }
 
+bool(cra_blockdq_try_push_back)(CraBlockdq *deque, void *val)
+{
+    bool ret = false;
+
+    assert(val);
+    assert(deque);
+
+    cra_mutex_lock(&deque->mutex);
+    if (!deque->en_colsed && deque->deque.count < deque->max_capacity &&
+        (ret = (cra_deque_push_back)(&deque->deque, val)))
+        cra_cond_signal(&deque->not_empty);
+    cra_mutex_unlock(&deque->mutex);
+
+    return ret;
+}
+
 bool(cra_blockdq_push_front)(CraBlockdq *deque, void *val, void *retdrop)
 {
     bool ret = false;
@@ -177,4 +194,134 @@ bool(cra_blockdq_pop_front)(CraBlockdq *deque, void *retval)
     cra_mutex_unlock(&deque->mutex);
 
     return ret;
-}
\ No newline at end of file
+}
+
+// 唤醒等待的线程，n个元素只需要调用一次
+static inline void
+cra_blockdq_wakeup(cra_cond_t *cond, size_t n)
+{
+    if (n == 1)
+        cra_cond_signal(cond);
+    else if (n > 1)
+        cra_cond_broadcast(cond);
+}
+
+size_t(cra_blockdq_push_back_n)(CraBlockdq *deque, void *vals, size_t n, void *retdrops, size_t *retndrop)
+{
+    size_t         m;
+    size_t         npushed = 0;
+    size_t         nsignal = 0;
+    size_t         ndrop = 0;
+    unsigned char *src = (unsigned char *)vals;
+    unsigned char *drop = (unsigned char *)retdrops;
+
+    assert(deque);
+    assert(vals || n == 0);
+
+    cra_mutex_lock(&deque->mutex);
+    while (npushed < n && !deque->en_colsed)
+    {
+        m = deque->max_capacity - deque->deque.count;
+        if (m == 0)
+        {
+            switch (deque->full_policy)
+            {
+                case CRA_BLOCKDQ_FULL_WAIT:
+                    // 先唤醒消费者，否则可能都在等待
+                    cra_blockdq_wakeup(&deque->not_empty, nsignal);
+                    nsignal = 0;
+                    cra_cond_wait(&deque->not_full, &deque->mutex);
+                    continue;
+                case CRA_BLOCKDQ_FULL_DROP_NEWEST:
+                    (cra_deque_pop_back)(&deque->deque, drop);
+                    break;
+                case CRA_BLOCKDQ_FULL_DROP_OLDEST:
+                    (cra_deque_pop_front)(&deque->deque, drop);
+                    break;
+                case CRA_BLOCKDQ_FULL_RETURN_FALSE:
+                    goto end;
+                default:
+                    assert_always(false && "Invalid full policy");
+            }
+            // 与逐个push_back一致，丢弃一个放入一个
+            if (drop)
+                drop += deque->deque.itemsize;
+            ++ndrop;
+            m = 1;
+        }
+        m = CRA_MIN(m, n - npushed);
+        if (!(cra_deque_push_back_n)(&deque->deque, src, m))
+            break;
+        src += m * deque->deque.itemsize;
+        npushed += m;
+        nsignal += m;
+    }
+end:
+    cra_blockdq_wakeup(&deque->not_empty, nsignal);
+    cra_mutex_unlock(&deque->mutex);
+
+    if (retndrop)
+        *retndrop = ndrop;
+    return npushed;
+}
+
+size_t(cra_blockdq_pop_front_n)(CraBlockdq *deque, void *retvals, size_t max, int timeout_ms)
+{
+    size_t        n;
+    unsigned long now, deadline;
+
+    assert(retvals);
+    assert(deque);
+
+    cra_mutex_lock(&deque->mutex);
+    if (timeout_ms < 0)
+    {
+        while (!deque->de_colsed && deque->deque.count == 0)
+            cra_cond_wait(&deque->not_empty, &deque->mutex);
+    }
+    else if (timeout_ms > 0 && !deque->de_colsed && deque->deque.count == 0)
+    {
+        deadline = cra_tick_ms() + (unsigned long)timeout_ms;
+        while (!deque->de_colsed && deque->deque.count == 0)
+        {
+            now = cra_tick_ms();
+            if (now >= deadline)
+                break;
+            cra_cond_wait_timeout(&deque->not_empty, &deque->mutex, (int)(deadline - now));
+        }
+    }
+    n = CRA_MIN(max, deque->deque.count);
+    if (n > 0)
+    {
+        (cra_deque_pop_front_n)(&deque->deque, retvals, n);
+        cra_blockdq_wakeup(&deque->not_full, n);
+    }
+    cra_mutex_unlock(&deque->mutex);
+
+    return n;
+}
+
+size_t
+cra_blockdq_drain(CraBlockdq *deque, CraDeque *retdeque)
+{
+    size_t   n;
+    CraDeque tmp;
+
+    assert(deque);
+    assert(retdeque);
+    assert(retdeque->count == 0);
+    assert(retdeque->itemsize == deque->deque.itemsize);
+
+    cra_mutex_lock(&deque->mutex);
+    n = deque->deque.count;
+    if (n > 0)
+    {
+        tmp = deque->deque;
+        deque->deque = *retdeque;
+        *retdeque = tmp;
+        cra_blockdq_wakeup(&deque->not_full, n);
+    }
+    cra_mutex_unlock(&deque->mutex);
+
+    return n;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file cra_cdict.c
+ * @author Cracal
+ * @brief 并发字典(分片+读写锁)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "threads/cra_cdict.h"
+#include "cra_malloc.h"
+
+// 用混合后hash的高位选分片，分片内的字典(CRA_DICT_FLAG_POW2)用的是低位
+// 同一个hash再传给分片内字典的_with_hash函数，key只hash一次
+static inline CraCDictShard *
+cra_cdict_shard(CraConcurrentDict *cdict, cra_hash_t hash)
+{
+    if (cdict->nshards == 1)
+        return cdict->shards;
+    return &cdict->shards[cra_hash_mix(hash) >> cdict->shard_shift];
+}
+
+bool(cra_cdict_init_with_size)(CraConcurrentDict *cdict,
+                               size_t             key_size,
+                               size_t             val_size,
+                               size_t             key_align,
+                               size_t             val_align,
+                               size_t             init_capacity,
+                               size_t             nshards,
+                               cra_hash_fn        hash_key,
+                               cra_cmp_fn         compare_key)
+{
+    size_t         i, n;
+    unsigned int   bits;
+    CraCDictShard *shard;
+
+    assert(cdict);
+    assert(nshards > 0);
+    assert(hash_key);
+    assert(compare_key);
+
+    // 分片数取2的幂
+    for (n = 1, bits = 0; n < nshards; n <<= 1, ++bits)
+        ;
+
+    // 分片按缓存行对齐，cra_malloc只保证max_align_t对齐
+    cdict->shards = cra_aligned_malloc(sizeof(CraCDictShard) * n, alignof(CraCDictShard));
+    if (!cdict->shards)
+        return false;
+
+    for (i = 0; i < n; ++i)
+    {
+        shard = &cdict->shards[i];
+        // 不能用CRA_DICT_FLAG_INCR: 它的get也会修改字典，读锁下不安全
+        if (!(cra_dict_init_with_flags)(&shard->dict, key_size, val_size, key_align, val_align, init_capacity / n,
+                                        CRA_DICT_FLAG_POW2, hash_key, compare_key))
+        {
+            while (i-- > 0)
+            {
+                cra_dict_uninit(&cdict->shards[i].dict);
+                cra_rwlock_destroy(&cdict->shards[i].lock);
+            }
+            cra_aligned_free(cdict->shards);
+            return false;
+        }
+        cra_rwlock_init(&shard->lock);
+    }
+
+    cdict->nshards = n;
+    cdict->shard_shift = (unsigned int)(sizeof(cra_uhash_t) * 8 - bits);
+    cdict->key_size = key_size;
+    cdict->val_size = val_size;
+    cdict->hash_key = hash_key;
+    return true;
+}
+
+void
+cra_cdict_uninit(CraConcurrentDict *cdict)
+{
+    assert(cdict);
+    assert(cdict->shards);
+
+    for (size_t i = 0; i < cdict->nshards; ++i)
+    {
+        cra_dict_uninit(&cdict->shards[i].dict);
+        cra_rwlock_destroy(&cdict->shards[i].lock);
+    }
+    cra_aligned_free(cdict->shards);
+    bzero(cdict, sizeof(*cdict));
+}
+
+void
+cra_cdict_clear(CraConcurrentDict *cdict)
+{
+    CraCDictShard *shard;
+
+    assert(cdict);
+    assert(cdict->shards);
+
+    for (size_t i = 0; i < cdict->nshards; ++i)
+    {
+        shard = &cdict->shards[i];
+        cra_rwlock_wrlock(&shard->lock);
+        cra_dict_clear(&shard->dict);
+        cra_rwlock_wrunlock(&shard->lock);
+    }
+}
+
+ssize_t
+cra_cdict_count(CraConcurrentDict *cdict)
+{
+    ssize_t        count = 0;
+    CraCDictShard *shard;
+
+    assert(cdict);
+    assert(cdict->shards);
+
+    for (size_t i = 0; i < cdict->nshards; ++i)
+    {
+        shard = &cdict->shards[i];
+        cra_rwlock_rdlock(&shard->lock);
+        count += shard->dict.count;
+        cra_rwlock_rdunlock(&shard->lock);
+    }
+    return count;
+}
+
+bool(cra_cdict_put_and_return_kv)(CraConcurrentDict *cdict,
+                                  void              *key,
+                                  void              *val,
+                                  void              *retoldkey,
+                                  void              *retoldval,
+                                  bool               add)
+{
+    bool           ret;
+    cra_hash_t     hash;
+    CraCDictShard *shard;
+
+    assert(cdict);
+    assert(cdict->shards);
+    assert(key);
+    assert(val);
+
+    hash = cdict->hash_key(key);
+    shard = cra_cdict_shard(cdict, hash);
+    cra_rwlock_wrlock(&shard->lock);
+    ret = (cra_dict_put_and_return_kv_with_hash)(&shard->dict, key, hash, val, retoldkey, retoldval, add);
+    cra_rwlock_wrunlock(&shard->lock);
+    return ret;
+}
+
+bool(cra_cdict_pop_kv)(CraConcurrentDict *cdict, const void *key, void *retkey, void *retval)
+{
+    bool           ret;
+    cra_hash_t     hash;
+    CraCDictShard *shard;
+
+    assert(cdict);
+    assert(cdict->shards);
+    assert(key);
+
+    hash = cdict->hash_key(key);
+    shard = cra_cdict_shard(cdict, hash);
+    cra_rwlock_wrlock(&shard->lock);
+    ret = (cra_dict_pop_kv_with_hash)(&shard->dict, key, hash, retkey, retval);
+    cra_rwlock_wrunlock(&shard->lock);
+    return ret;
+}
+
+static inline bool
+cra_cdict_get_with_hash(CraConcurrentDict *cdict, CraCDictShard *shard, const void *key, cra_hash_t hash, void *retval)
+{
+    void *pval;
+
+    cra_rwlock_rdlock(&shard->lock);
+    pval = (cra_dict_get_ref_with_hash)(&shard->dict, key, hash);
+    if (pval && retval)
+        memcpy(retval, pval, cdict->val_size);
+    cra_rwlock_rdunlock(&shard->lock);
+    return pval != NULL;
+}
+
+bool(cra_cdict_get)(CraConcurrentDict *cdict, const void *key, void *retval)
+{
+    cra_hash_t hash;
+
+    assert(cdict);
+    assert(cdict->shards);
+    assert(key);
+
+    hash = cdict->hash_key(key);
+    return cra_cdict_get_with_hash(cdict, cra_cdict_shard(cdict, hash), key, hash, retval);
+}
+
+bool(cra_cdict_compute_if_absent)(CraConcurrentDict   *cdict,
+                                  void                *key,
+                                  void                *retval,
+                                  cra_cdict_compute_fn compute,
+                                  void                *arg)
+{
+    bool           ret;
+    cra_hash_t     hash;
+    CraCDictShard *shard;
+
+    assert(cdict);
+    assert(cdict->shards);
+    assert(key);
+    assert(retval);
+    assert(compute);
+
+    hash = cdict->hash_key(key);
+    shard = cra_cdict_shard(cdict, hash);
+
+    // 大多数情况下key已存在，先只加读锁
+    if (cra_cdict_get_with_hash(cdict, shard, key, hash, retval))
+        return true;
+
+    cra_rwlock_wrlock(&shard->lock);
+    // 加写锁前可能已被其他线程插入
+    if ((cra_dict_get_with_hash)(&shard->dict, key, hash, retval))
+        ret = true;
+    else if ((ret = compute(key, retval, arg)))
+        ret = (cra_dict_put_and_return_kv_with_hash)(&shard->dict, key, hash, retval, NULL, NULL, true);
+    cra_rwlock_wrunlock(&shard->lock);
+    return ret;
+}
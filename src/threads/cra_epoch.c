@@ -0,0 +1,204 @@
+/**
+ * @file cra_epoch.c
+ * @author Cracal
+ * @brief 基于纪元的内存回收(EBR)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "threads/cra_epoch.h"
+#include "cra_malloc.h"
+
+struct CraEpochRetired
+{
+    void             *ptr;
+    cra_epoch_free_fn free_fn;
+    CraEpochRetired  *next;
+};
+
+// 返回释放的个数
+static size_t
+cra_epoch_free_list(CraEpochRetired *list)
+{
+    size_t           n;
+    CraEpochRetired *next;
+
+    for (n = 0; list; list = next, ++n)
+    {
+        next = list->next;
+        list->free_fn(list->ptr);
+        cra_free(list);
+    }
+    return n;
+}
+
+void
+cra_epoch_init(CraEpoch *epoch)
+{
+    assert(epoch);
+
+    cra_atomic_store64(&epoch->epoch, 0, CRA_MO_RELAXED);
+    cra_atomic_store_ptr(&epoch->records, NULL, CRA_MO_RELAXED);
+    cra_mutex_init(&epoch->lock);
+    epoch->nretired = 0;
+    for (int i = 0; i < CRA_EPOCH_NLISTS; ++i)
+        epoch->retired[i] = NULL;
+}
+
+void
+cra_epoch_uninit(CraEpoch *epoch)
+{
+    CraEpochRecord *rec, *next;
+
+    assert(epoch);
+
+    for (int i = 0; i < CRA_EPOCH_NLISTS; ++i)
+    {
+        cra_epoch_free_list(epoch->retired[i]);
+        epoch->retired[i] = NULL;
+    }
+    epoch->nretired = 0;
+
+    for (rec = cra_atomic_load_ptr(&epoch->records, CRA_MO_ACQUIRE); rec; rec = next)
+    {
+        assert(cra_atomic_load64(&rec->state, CRA_MO_RELAXED) == 0);
+        next = rec->next;
+        cra_aligned_free(rec);
+    }
+    cra_atomic_store_ptr(&epoch->records, NULL, CRA_MO_RELAXED);
+    cra_mutex_destroy(&epoch->lock);
+}
+
+CraEpochRecord *
+cra_epoch_register(CraEpoch *epoch)
+{
+    int32_t         unused;
+    void           *head;
+    CraEpochRecord *rec;
+
+    assert(epoch);
+
+    // 先复用已注销的记录
+    for (rec = cra_atomic_load_ptr(&epoch->records, CRA_MO_ACQUIRE); rec; rec = rec->next)
+    {
+        unused = 0;
+        if (cra_atomic_load32(&rec->in_use, CRA_MO_RELAXED) == 0 &&
+            cra_atomic_cas_strong32(&rec->in_use, &unused, 1, CRA_MO_ACQUIRE, CRA_MO_RELAXED))
+            return rec;
+    }
+
+    // 记录按缓存行对齐，cra_alloc只保证max_align_t对齐
+    rec = cra_aligned_malloc(sizeof(CraEpochRecord), alignof(CraEpochRecord));
+    if (!rec)
+        return NULL;
+    cra_atomic_store64(&rec->state, 0, CRA_MO_RELAXED);
+    cra_atomic_store32(&rec->in_use, 1, CRA_MO_RELAXED);
+    rec->nest = 0;
+    rec->domain = epoch;
+
+    head = cra_atomic_load_ptr(&epoch->records, CRA_MO_RELAXED);
+    do
+        rec->next = (CraEpochRecord *)head;
+    while (!cra_atomic_cas_weak_ptr(&epoch->records, &head, rec, CRA_MO_RELEASE, CRA_MO_RELAXED));
+    return rec;
+}
+
+void
+cra_epoch_unregister(CraEpochRecord *rec)
+{
+    assert(rec);
+    assert(rec->nest == 0);
+    assert(cra_atomic_load32(&rec->in_use, CRA_MO_RELAXED) == 1);
+
+    cra_atomic_store32(&rec->in_use, 0, CRA_MO_RELEASE);
+}
+
+// 需要持有epoch->lock
+static bool
+cra_epoch_try_advance_nolock(CraEpoch *epoch)
+{
+    int64_t          curr, state;
+    CraEpochRecord  *rec;
+    CraEpochRetired *list;
+
+    curr = cra_atomic_load64(&epoch->epoch, CRA_MO_RELAXED);
+    // 与cra_epoch_enter中的fence配对:
+    // 要么这里看到读者公告的纪元，要么读者看到已摘除的指针
+    cra_atomic_thread_fence(CRA_MO_SEQ_CST);
+
+    // 所有在临界区内的读者都已进入当前纪元才能推进
+    for (rec = cra_atomic_load_ptr(&epoch->records, CRA_MO_ACQUIRE); rec; rec = rec->next)
+    {
+        state = cra_atomic_load64(&rec->state, CRA_MO_ACQUIRE);
+        if ((state & 1) && (state >> 1) != curr)
+            return false;
+    }
+
+    cra_atomic_store64(&epoch->epoch, curr + 1, CRA_MO_RELEASE);
+
+    // 纪元curr-1时retire的内存，不可能再被curr+1时的任何读者持有
+    list = epoch->retired[(curr + 2) % CRA_EPOCH_NLISTS];
+    epoch->retired[(curr + 2) % CRA_EPOCH_NLISTS] = NULL;
+    epoch->nretired -= cra_epoch_free_list(list);
+    return true;
+}
+
+void
+cra_epoch_retire(CraEpoch *epoch, void *ptr, cra_epoch_free_fn free_fn)
+{
+    int64_t          curr;
+    CraEpochRetired *retired;
+
+    assert(epoch);
+    assert(free_fn);
+
+    if (!ptr)
+        return;
+
+    retired = cra_alloc(CraEpochRetired);
+    cra_mutex_lock(&epoch->lock);
+    if (!retired)
+    {
+        // 内存不足时只能等待读者离开后直接释放
+        cra_mutex_unlock(&epoch->lock);
+        cra_epoch_synchronize(epoch);
+        free_fn(ptr);
+        return;
+    }
+    curr = cra_atomic_load64(&epoch->epoch, CRA_MO_RELAXED);
+    retired->ptr = ptr;
+    retired->free_fn = free_fn;
+    retired->next = epoch->retired[curr % CRA_EPOCH_NLISTS];
+    epoch->retired[curr % CRA_EPOCH_NLISTS] = retired;
+    ++epoch->nretired;
+    cra_epoch_try_advance_nolock(epoch);
+    cra_mutex_unlock(&epoch->lock);
+}
+
+bool
+cra_epoch_try_advance(CraEpoch *epoch)
+{
+    bool ret;
+
+    assert(epoch);
+
+    cra_mutex_lock(&epoch->lock);
+    ret = cra_epoch_try_advance_nolock(epoch);
+    cra_mutex_unlock(&epoch->lock);
+    return ret;
+}
+
+void
+cra_epoch_synchronize(CraEpoch *epoch)
+{
+    assert(epoch);
+
+    // 推进两次后，调用前retire的内存都已释放
+    for (int i = 0; i < CRA_EPOCH_NLISTS - 1; ++i)
+    {
+        while (!cra_epoch_try_advance(epoch))
+            cra_msleep(1);
+    }
+}
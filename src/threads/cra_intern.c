@@ -0,0 +1,309 @@
+/**
+ * @file cra_intern.c
+ * @author Cracal
+ * @brief 字符串驻留(线程安全)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "threads/cra_intern.h"
+#include "cra_atomic.h"
+#include "cra_malloc.h"
+
+#define CRA_INTERN_INIT_CAPACITY 64
+
+#define CRA_INTERN_ALIGN_UP(n, a) (((n) + ((a) - 1)) & ~((a) - 1))
+
+struct CraInternChunk
+{
+    CraInternChunk *next;
+    size_t          size; // data的字节数
+    size_t          used;
+    size_t          data[]; // 按size_t对齐
+};
+
+// 用hash的高位选分片，分片内用低位选槽
+static inline CraInternShard *
+cra_intern_shard(CraIntern *intern, cra_uhash_t hash)
+{
+    if (intern->nshards == 1)
+        return intern->shards;
+    return &intern->shards[hash >> intern->shard_shift];
+}
+
+static inline CraInternChunk *
+cra_intern_new_chunk(size_t size)
+{
+    CraInternChunk *chunk = cra_malloc(sizeof(CraInternChunk) + size);
+    if (chunk)
+    {
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = 0;
+    }
+    return chunk;
+}
+
+// 复制到arena中: [size_t len | 字符串 | '\0']
+static const char *
+cra_intern_copy(CraInternShard *shard, const char *str, size_t len)
+{
+    unsigned char  *p;
+    CraInternChunk *chunk = shard->chunks;
+    size_t          needed = CRA_INTERN_ALIGN_UP(sizeof(size_t) + len + 1, sizeof(size_t));
+
+    if (!chunk || chunk->size - chunk->used < needed)
+    {
+        if (needed > CRA_INTERN_CHUNK_SIZE / 4)
+        {
+            // 大字符串单独一块，挂在当前块后面，当前块剩下的空间继续使用
+            chunk = cra_intern_new_chunk(needed);
+            if (!chunk)
+                return NULL;
+            if (shard->chunks)
+            {
+                chunk->next = shard->chunks->next;
+                shard->chunks->next = chunk;
+            }
+            else
+            {
+                shard->chunks = chunk;
+            }
+        }
+        else
+        {
+            chunk = cra_intern_new_chunk(CRA_INTERN_CHUNK_SIZE);
+            if (!chunk)
+                return NULL;
+            chunk->next = shard->chunks;
+            shard->chunks = chunk;
+        }
+    }
+
+    p = (unsigned char *)chunk->data + chunk->used;
+    chunk->used += needed;
+    memcpy(p, &len, sizeof(size_t));
+    p += sizeof(size_t);
+    memcpy(p, str, len);
+    p[len] = '\0';
+    return (const char *)p;
+}
+
+// 找到内容相同的槽，没有时返回应该插入的空槽
+// 负载不超过1/2，总能找到空槽
+static inline CraInternSlot *
+cra_intern_find(CraInternShard *shard, cra_uhash_t hash, const char *str, size_t len)
+{
+    CraInternSlot *slot;
+    size_t         mask = shard->capacity - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        slot = &shard->slots[i];
+        if (!slot->str)
+            return slot;
+        if (slot->hash == hash && cra_intern_len(slot->str) == len && memcmp(slot->str, str, len) == 0)
+            return slot;
+    }
+}
+
+static bool
+cra_intern_grow(CraInternShard *shard)
+{
+    CraInternSlot *slots, *slot;
+    size_t         capacity = shard->capacity * 2;
+    size_t         mask = capacity - 1;
+
+    slots = cra_calloc(capacity, sizeof(CraInternSlot));
+    if (!slots)
+        return false;
+
+    for (size_t i = 0; i < shard->capacity; ++i)
+    {
+        slot = &shard->slots[i];
+        if (!slot->str)
+            continue;
+        size_t j = slot->hash & mask;
+        while (slots[j].str)
+            j = (j + 1) & mask;
+        slots[j] = *slot;
+    }
+
+    cra_free(shard->slots);
+    shard->slots = slots;
+    shard->capacity = capacity;
+    return true;
+}
+
+bool
+cra_intern_init(CraIntern *intern, size_t nshards)
+{
+    size_t          i, n;
+    unsigned int    bits;
+    CraInternShard *shard;
+
+    assert(intern);
+    assert(nshards > 0);
+
+    // 分片数取2的幂
+    for (n = 1, bits = 0; n < nshards; n <<= 1, ++bits)
+        ;
+
+    // 分片按缓存行对齐，cra_malloc只保证max_align_t对齐
+    intern->shards = cra_aligned_malloc(sizeof(CraInternShard) * n, alignof(CraInternShard));
+    if (!intern->shards)
+        return false;
+
+    for (i = 0; i < n; ++i)
+    {
+        shard = &intern->shards[i];
+        shard->slots = cra_calloc(CRA_INTERN_INIT_CAPACITY, sizeof(CraInternSlot));
+        if (!shard->slots)
+        {
+            while (i-- > 0)
+            {
+                cra_free(intern->shards[i].slots);
+                cra_rwlock_destroy(&intern->shards[i].lock);
+            }
+            cra_aligned_free(intern->shards);
+            return false;
+        }
+        shard->capacity = CRA_INTERN_INIT_CAPACITY;
+        shard->count = 0;
+        shard->chunks = NULL;
+        cra_rwlock_init(&shard->lock);
+    }
+
+    intern->nshards = n;
+    intern->shard_shift = (unsigned int)(sizeof(cra_uhash_t) * 8 - bits);
+    return true;
+}
+
+void
+cra_intern_uninit(CraIntern *intern)
+{
+    CraInternShard *shard;
+    CraInternChunk *chunk, *next;
+
+    assert(intern);
+    assert(intern->shards);
+
+    for (size_t i = 0; i < intern->nshards; ++i)
+    {
+        shard = &intern->shards[i];
+        for (chunk = shard->chunks; chunk; chunk = next)
+        {
+            next = chunk->next;
+            cra_free(chunk);
+        }
+        cra_free(shard->slots);
+        cra_rwlock_destroy(&shard->lock);
+    }
+    cra_aligned_free(intern->shards);
+    bzero(intern, sizeof(*intern));
+}
+
+const char *
+cra_intern(CraIntern *intern, const char *str, size_t len)
+{
+    cra_uhash_t     hash;
+    const char     *ret;
+    CraInternSlot  *slot;
+    CraInternShard *shard;
+
+    assert(intern);
+    assert(intern->shards);
+    assert(str || len == 0);
+
+    hash = (cra_uhash_t)cra_hash_bytes(str, len);
+    shard = cra_intern_shard(intern, hash);
+
+    // 大多数时候已经驻留过，读锁下就能找到
+    cra_rwlock_rdlock(&shard->lock);
+    ret = cra_intern_find(shard, hash, str, len)->str;
+    cra_rwlock_rdunlock(&shard->lock);
+    if (ret)
+        return ret;
+
+    cra_rwlock_wrlock(&shard->lock);
+    // 释放读锁后可能已经被别的线程驻留了
+    slot = cra_intern_find(shard, hash, str, len);
+    ret = slot->str;
+    if (ret)
+        goto done;
+    if ((shard->count + 1) * 2 > shard->capacity)
+    {
+        if (!cra_intern_grow(shard))
+            goto done;
+        slot = cra_intern_find(shard, hash, str, len);
+    }
+    ret = cra_intern_copy(shard, str, len);
+    if (ret)
+    {
+        slot->hash = hash;
+        slot->str = ret;
+        ++shard->count;
+    }
+done:
+    cra_rwlock_wrunlock(&shard->lock);
+    return ret;
+}
+
+size_t
+cra_intern_count(CraIntern *intern)
+{
+    size_t          count = 0;
+    CraInternShard *shard;
+
+    assert(intern);
+    assert(intern->shards);
+
+    for (size_t i = 0; i < intern->nshards; ++i)
+    {
+        shard = &intern->shards[i];
+        cra_rwlock_rdlock(&shard->lock);
+        count += shard->count;
+        cra_rwlock_rdunlock(&shard->lock);
+    }
+    return count;
+}
+
+// ====================================== global ======================================
+
+static CraIntern         s_intern;
+static cra_atomic_ptr_t  s_intern_ptr = NULL;
+static cra_atomic_flag_t s_intern_lock = CRA_ATOMIC_FLAG_INIT;
+#define LOCK()   while (cra_atomic_flag_test_and_set(&s_intern_lock, CRA_MO_ACQUIRE))
+#define UNLOCK() cra_atomic_flag_clear(&s_intern_lock, CRA_MO_RELEASE)
+
+CraIntern *
+cra_intern_global(void)
+{
+    CraIntern *intern = (CraIntern *)cra_atomic_load_ptr(&s_intern_ptr, CRA_MO_ACQUIRE);
+    if (intern)
+        return intern;
+
+    LOCK();
+    intern = (CraIntern *)cra_atomic_load_ptr(&s_intern_ptr, CRA_MO_RELAXED);
+    if (!intern && cra_intern_init(&s_intern, CRA_INTERN_DEFAULT_SHARDS))
+    {
+        intern = &s_intern;
+        cra_atomic_store_ptr(&s_intern_ptr, intern, CRA_MO_RELEASE);
+    }
+    UNLOCK();
+    return intern;
+}
+
+void
+cra_intern_global_release(void)
+{
+    LOCK();
+    if (cra_atomic_load_ptr(&s_intern_ptr, CRA_MO_RELAXED))
+    {
+        cra_atomic_store_ptr(&s_intern_ptr, NULL, CRA_MO_RELAXED);
+        cra_intern_uninit(&s_intern);
+    }
+    UNLOCK();
+}
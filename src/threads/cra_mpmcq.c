@@ -0,0 +1,319 @@
+/**
+ * @file cra_mpmcq.c
+ * @author Cracal
+ * @brief 有界无锁多生产者多消费者队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "threads/cra_mpmcq.h"
+#include "cra_malloc.h"
+
+// 格子: { seq; val }
+// seq == pos:            位置pos可以写入
+// seq == pos + 1:        位置pos已写入，可以读取
+// seq == pos + capacity: 已读取，留给下一圈的位置pos + capacity写入
+#define CRA_MPMCQ_VAL_OFFSET     sizeof(cra_atomic_int64_t)
+#define CRA_MPMCQ_CELL(que, pos) ((que)->cells + ((size_t)(pos) & (que)->mask) * (que)->cellsize)
+#define CRA_MPMCQ_SEQ(cell)      ((cra_atomic_int64_t *)(cell))
+#define CRA_MPMCQ_VAL(cell)      ((cell) + CRA_MPMCQ_VAL_OFFSET)
+
+bool(cra_mpmcq_init)(CraMpmcq *que, size_t itemsize, size_t capacity, CraBlockdqFull_e full_policy)
+{
+    size_t cap;
+
+    assert(que);
+    assert(itemsize > 0);
+    assert(capacity > 0 && capacity <= ((size_t)1 << (sizeof(size_t) * 8 - 2)));
+    assert(full_policy >= CRA_BLOCKDQ_FULL_WAIT && full_policy <= CRA_BLOCKDQ_FULL_RETURN_FALSE);
+
+    for (cap = 2; cap < capacity; cap <<= 1)
+        ;
+
+    que->itemsize = itemsize;
+    // 每个格子按seq对齐
+    que->cellsize = (CRA_MPMCQ_VAL_OFFSET + itemsize + sizeof(cra_atomic_int64_t) - 1) & ~(sizeof(cra_atomic_int64_t) - 1);
+    que->mask = cap - 1;
+    que->cells = (unsigned char *)cra_malloc(que->cellsize * cap);
+    if (!que->cells)
+        return false;
+    for (size_t i = 0; i < cap; i++)
+        cra_atomic_store64(CRA_MPMCQ_SEQ(que->cells + i * que->cellsize), (int64_t)i, CRA_MO_RELAXED);
+
+    que->full_policy = full_policy;
+    cra_atomic_store32(&que->closed, 0, CRA_MO_RELAXED);
+    cra_atomic_store64(&que->enqueue_pos, 0, CRA_MO_RELAXED);
+    cra_atomic_store64(&que->dequeue_pos, 0, CRA_MO_RELAXED);
+    cra_evcount_init(&que->not_empty);
+    cra_evcount_init(&que->not_full);
+    return true;
+}
+
+void
+cra_mpmcq_uninit(CraMpmcq *que)
+{
+    assert(que);
+
+    cra_evcount_uninit(&que->not_empty);
+    cra_evcount_uninit(&que->not_full);
+    cra_free(que->cells);
+    que->cells = NULL;
+}
+
+void
+cra_mpmcq_shutdown(CraMpmcq *que, int how)
+{
+    int32_t closed;
+
+    assert(que);
+    assert(how & CRA_BLOCKDQ_CLOSE_ALL);
+
+    closed = cra_atomic_load32(&que->closed, CRA_MO_RELAXED);
+    while (!cra_atomic_cas_weak32(&que->closed, &closed, closed | how, CRA_MO_SEQ_CST, CRA_MO_RELAXED))
+        ;
+    if (how & CRA_BLOCKDQ_CLOSE_ENQUEUE)
+        cra_evcount_notify(&que->not_full, true);
+    if (how & CRA_BLOCKDQ_CLOSE_DEQUEUE)
+        cra_evcount_notify(&que->not_empty, true);
+}
+
+static inline bool
+cra_mpmcq_is_closed(CraMpmcq *que, int how)
+{
+    return !!(cra_atomic_load32(&que->closed, CRA_MO_ACQUIRE) & how);
+}
+
+static inline bool
+cra_mpmcq_is_full(CraMpmcq *que)
+{
+    int64_t        pos = cra_atomic_load64(&que->enqueue_pos, CRA_MO_RELAXED);
+    unsigned char *cell = CRA_MPMCQ_CELL(que, pos);
+    return cra_atomic_load64(CRA_MPMCQ_SEQ(cell), CRA_MO_ACQUIRE) < pos;
+}
+
+static inline bool
+cra_mpmcq_is_empty(CraMpmcq *que)
+{
+    int64_t        pos = cra_atomic_load64(&que->dequeue_pos, CRA_MO_RELAXED);
+    unsigned char *cell = CRA_MPMCQ_CELL(que, pos);
+    return cra_atomic_load64(CRA_MPMCQ_SEQ(cell), CRA_MO_ACQUIRE) < pos + 1;
+}
+
+static bool
+cra_mpmcq_enqueue(CraMpmcq *que, void *val)
+{
+    int64_t        pos, dif;
+    unsigned char *cell;
+
+    pos = cra_atomic_load64(&que->enqueue_pos, CRA_MO_RELAXED);
+    for (;;)
+    {
+        cell = CRA_MPMCQ_CELL(que, pos);
+        dif = cra_atomic_load64(CRA_MPMCQ_SEQ(cell), CRA_MO_ACQUIRE) - pos;
+        if (dif == 0)
+        {
+            if (cra_atomic_cas_weak64(&que->enqueue_pos, &pos, pos + 1, CRA_MO_RELAXED, CRA_MO_RELAXED))
+                break;
+        }
+        else if (dif < 0)
+        {
+            return false; // 满
+        }
+        else
+        {
+            pos = cra_atomic_load64(&que->enqueue_pos, CRA_MO_RELAXED);
+        }
+    }
+    memcpy(CRA_MPMCQ_VAL(cell), val, que->itemsize);
+    cra_atomic_store64(CRA_MPMCQ_SEQ(cell), pos + 1, CRA_MO_RELEASE);
+    return true;
+}
+
+static bool
+cra_mpmcq_dequeue(CraMpmcq *que, void *retval)
+{
+    int64_t        pos, dif;
+    unsigned char *cell;
+
+    pos = cra_atomic_load64(&que->dequeue_pos, CRA_MO_RELAXED);
+    for (;;)
+    {
+        cell = CRA_MPMCQ_CELL(que, pos);
+        dif = cra_atomic_load64(CRA_MPMCQ_SEQ(cell), CRA_MO_ACQUIRE) - (pos + 1);
+        if (dif == 0)
+        {
+            if (cra_atomic_cas_weak64(&que->dequeue_pos, &pos, pos + 1, CRA_MO_RELAXED, CRA_MO_RELAXED))
+                break;
+        }
+        else if (dif < 0)
+        {
+            return false; // 空
+        }
+        else
+        {
+            pos = cra_atomic_load64(&que->dequeue_pos, CRA_MO_RELAXED);
+        }
+    }
+    if (retval)
+        memcpy(retval, CRA_MPMCQ_VAL(cell), que->itemsize);
+    cra_atomic_store64(CRA_MPMCQ_SEQ(cell), pos + (int64_t)que->mask + 1, CRA_MO_RELEASE);
+    return true;
+}
+
+// 取出最早的元素，并把val写入它空出的格子
+// 队列满时，队头的格子正是下一个入队位置的格子；在归还格子之前其他生产者不能写入它
+// returns:
+//      1:  已替换
+//      0:  没有取出元素(队列空或元素还没写完)
+//      -1: 已取出元素，但队列已不满，val还需要正常入队
+static int
+cra_mpmcq_replace_oldest(CraMpmcq *que, void *val, void *retdrop)
+{
+    int64_t        pos, tail, dif;
+    unsigned char *cell;
+
+    pos = cra_atomic_load64(&que->dequeue_pos, CRA_MO_RELAXED);
+    for (;;)
+    {
+        cell = CRA_MPMCQ_CELL(que, pos);
+        dif = cra_atomic_load64(CRA_MPMCQ_SEQ(cell), CRA_MO_ACQUIRE) - (pos + 1);
+        if (dif == 0)
+        {
+            if (cra_atomic_cas_weak64(&que->dequeue_pos, &pos, pos + 1, CRA_MO_RELAXED, CRA_MO_RELAXED))
+                break;
+        }
+        else if (dif < 0)
+        {
+            return 0;
+        }
+        else
+        {
+            pos = cra_atomic_load64(&que->dequeue_pos, CRA_MO_RELAXED);
+        }
+    }
+    if (retdrop)
+        memcpy(retdrop, CRA_MPMCQ_VAL(cell), que->itemsize);
+
+    // 失败时cas会修改tail，不能再用它
+    pos += (int64_t)que->mask + 1;
+    tail = pos;
+    if (cra_atomic_cas_strong64(&que->enqueue_pos, &tail, pos + 1, CRA_MO_RELAXED, CRA_MO_RELAXED))
+    {
+        memcpy(CRA_MPMCQ_VAL(cell), val, que->itemsize);
+        cra_atomic_store64(CRA_MPMCQ_SEQ(cell), pos + 1, CRA_MO_RELEASE);
+        return 1;
+    }
+    cra_atomic_store64(CRA_MPMCQ_SEQ(cell), pos, CRA_MO_RELEASE);
+    return -1;
+}
+
+// 只有可能挂起生产者时才需要通知not_full
+#define CRA_MPMCQ_NOTIFY_NOT_FULL(que)                                                            \
+    do                                                                                            \
+    {                                                                                             \
+        if ((que)->full_policy == CRA_BLOCKDQ_FULL_WAIT ||                                        \
+            (que)->full_policy == CRA_BLOCKDQ_FULL_DROP_OLDEST)                                   \
+            cra_evcount_notify(&(que)->not_full, false);                                          \
+    } while (0)
+
+bool(cra_mpmcq_try_push)(CraMpmcq *que, void *val)
+{
+    assert(que);
+    assert(val);
+
+    if (cra_mpmcq_is_closed(que, CRA_BLOCKDQ_CLOSE_ENQUEUE) || !cra_mpmcq_enqueue(que, val))
+        return false;
+    cra_evcount_notify(&que->not_empty, false);
+    return true;
+}
+
+bool(cra_mpmcq_push)(CraMpmcq *que, void *val, void *retdrop)
+{
+    int64_t key;
+    bool    dropped = false;
+
+    assert(que);
+    assert(val);
+
+    for (;;)
+    {
+        if (cra_mpmcq_is_closed(que, CRA_BLOCKDQ_CLOSE_ENQUEUE))
+            return false;
+        if (cra_mpmcq_enqueue(que, val))
+            break;
+
+        switch (dropped ? CRA_BLOCKDQ_FULL_WAIT : que->full_policy)
+        {
+            case CRA_BLOCKDQ_FULL_WAIT:
+                key = cra_evcount_prepare_wait(&que->not_full);
+                // 再检查一次，避免错过通知
+                if (cra_mpmcq_is_closed(que, CRA_BLOCKDQ_CLOSE_ENQUEUE) || !cra_mpmcq_is_full(que))
+                    cra_evcount_cancel_wait(&que->not_full);
+                else
+                    cra_evcount_wait(&que->not_full, key);
+                break;
+            case CRA_BLOCKDQ_FULL_DROP_OLDEST:
+                // 每次push最多丢弃一个元素；已丢弃但仍放不下时等待空位
+                switch (cra_mpmcq_replace_oldest(que, val, retdrop))
+                {
+                    case 1:
+                        goto end;
+                    case -1:
+                        dropped = true;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+            case CRA_BLOCKDQ_FULL_DROP_NEWEST:
+                if (retdrop)
+                    memcpy(retdrop, val, que->itemsize);
+                return true;
+            case CRA_BLOCKDQ_FULL_RETURN_FALSE:
+                return false;
+            default:
+                assert_always(false && "Invalid full policy");
+        }
+    }
+end:
+    cra_evcount_notify(&que->not_empty, false);
+    return true;
+}
+
+bool(cra_mpmcq_try_pop)(CraMpmcq *que, void *retval)
+{
+    assert(que);
+    assert(retval);
+
+    if (!cra_mpmcq_dequeue(que, retval))
+        return false;
+    CRA_MPMCQ_NOTIFY_NOT_FULL(que);
+    return true;
+}
+
+bool(cra_mpmcq_pop)(CraMpmcq *que, void *retval)
+{
+    int64_t key;
+
+    assert(que);
+    assert(retval);
+
+    for (;;)
+    {
+        if (cra_mpmcq_dequeue(que, retval))
+            break;
+        if (cra_mpmcq_is_closed(que, CRA_BLOCKDQ_CLOSE_DEQUEUE))
+            return false;
+
+        key = cra_evcount_prepare_wait(&que->not_empty);
+        // 再检查一次，避免错过通知
+        if (cra_mpmcq_is_closed(que, CRA_BLOCKDQ_CLOSE_DEQUEUE) || !cra_mpmcq_is_empty(que))
+            cra_evcount_cancel_wait(&que->not_empty);
+        else
+            cra_evcount_wait(&que->not_empty, key);
+    }
+    CRA_MPMCQ_NOTIFY_NOT_FULL(que);
+    return true;
+}
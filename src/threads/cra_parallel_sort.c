@@ -0,0 +1,294 @@
+/**
+ * @file cra_parallel_sort.c
+ * @author Cracal
+ * @brief 并行排序
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "threads/cra_parallel_sort.h"
+#include "threads/cra_cdl.h"
+#include "cra_malloc.h"
+
+// 分块和分桶的个数只由元素个数决定，所以结果与线程数无关
+#define CRA_PSORT_MAX_PARTS  256 // 桶号用uint8_t保存
+#define CRA_PSORT_PART_ITEMS (1 << 15)
+#define CRA_PSORT_OVERSAMPLE 16
+
+// ====================================== parallel for ======================================
+
+// 调用线程和线程池中的若干helper从next中领取任务下标
+// helper可能在所有任务都完成之后才开始运行，所以job用引用计数，最后一个持有者释放
+typedef struct
+{
+    cra_atomic_int32_t refcnt;
+    cra_atomic_int32_t next;
+    int32_t            ntasks;
+    void             (*fn)(void *ctx, int32_t index);
+    void              *ctx;
+    CraCDL             done;
+} CraPsortJob;
+
+static void
+cra_psort_job_run(CraPsortJob *job)
+{
+    int32_t i;
+    while ((i = cra_atomic_inc32(&job->next, CRA_MO_RELAXED)) < job->ntasks)
+    {
+        job->fn(job->ctx, i);
+        cra_cdl_count_down(&job->done);
+    }
+}
+
+static void
+cra_psort_job_unref(CraPsortJob *job)
+{
+    if (cra_atomic_dec32(&job->refcnt, CRA_MO_ACQ_REL) == 1)
+    {
+        cra_cdl_uninit(&job->done);
+        cra_free(job);
+    }
+}
+
+static void
+cra_psort_helper(void *arg)
+{
+    CraPsortJob *job = (CraPsortJob *)arg;
+    cra_psort_job_run(job);
+    cra_psort_job_unref(job);
+}
+
+static void
+cra_psort_parallel_for(CraThrdPool *pool, int32_t ntasks, void (*fn)(void *, int32_t), void *ctx)
+{
+    int32_t      nhelpers;
+    CraPsortJob *job;
+
+    job = cra_malloc(sizeof(CraPsortJob));
+    if (!job)
+    {
+        // 没有内存时在当前线程完成
+        for (int32_t i = 0; i < ntasks; ++i)
+            fn(ctx, i);
+        return;
+    }
+
+    nhelpers = CRA_MIN(pool->nworker, ntasks - 1);
+    cra_atomic_store32(&job->refcnt, 1 + nhelpers, CRA_MO_RELAXED);
+    cra_atomic_store32(&job->next, 0, CRA_MO_RELAXED);
+    job->ntasks = ntasks;
+    job->fn = fn;
+    job->ctx = ctx;
+    cra_cdl_init(&job->done, ntasks);
+
+    // 不能阻塞提交：在工作线程中调用且队列已满时，等待空位可能永远等不到
+    // 队列满了就不再提交，剩下的任务由调用线程完成
+    for (int32_t i = 0; i < nhelpers; ++i)
+    {
+        if (!cra_thrdpool_try_add_task1(pool, cra_psort_helper, job))
+        {
+            cra_atomic_sub32(&job->refcnt, nhelpers - i, CRA_MO_RELAXED);
+            break;
+        }
+    }
+
+    cra_psort_job_run(job);
+    cra_cdl_wait(&job->done);
+    cra_psort_job_unref(job);
+}
+
+// ====================================== sample sort ======================================
+
+typedef struct
+{
+    unsigned char     *array;
+    unsigned char     *buf; // 与array一样大
+    uint8_t           *ids; // 每个元素所属的桶
+    size_t             count;
+    size_t             itemsize;
+    cra_cmp_fn         compare;
+    int32_t            nparts;
+    int32_t            nbuckets;
+    unsigned char     *splitters;                   // nbuckets - 1 个分割点
+    size_t           (*counts)[CRA_PSORT_MAX_PARTS]; // [part][bucket]
+    size_t             bucket_start[CRA_PSORT_MAX_PARTS + 1];
+    cra_atomic_int32_t failed;
+} CraPsortCtx;
+
+static inline size_t
+cra_psort_part_begin(CraPsortCtx *ctx, int32_t part)
+{
+    return ctx->count / (size_t)ctx->nparts * (size_t)part;
+}
+
+static inline size_t
+cra_psort_part_end(CraPsortCtx *ctx, int32_t part)
+{
+    return part == ctx->nparts - 1 ? ctx->count : cra_psort_part_begin(ctx, part + 1);
+}
+
+// 第一个大于val的分割点的下标，即val所在的桶
+static inline uint8_t
+cra_psort_bucket_of(CraPsortCtx *ctx, const void *val)
+{
+    size_t left = 0, right = (size_t)ctx->nbuckets - 1, mid;
+    while (left < right)
+    {
+        mid = left + ((right - left) >> 1);
+        if (ctx->compare(val, ctx->splitters + mid * ctx->itemsize) < 0)
+            right = mid;
+        else
+            left = mid + 1;
+    }
+    return (uint8_t)left;
+}
+
+static void
+cra_psort_classify(void *arg, int32_t part)
+{
+    CraPsortCtx *ctx = (CraPsortCtx *)arg;
+    size_t      *counts = ctx->counts[part];
+    size_t       end = cra_psort_part_end(ctx, part);
+
+    for (size_t i = cra_psort_part_begin(ctx, part); i < end; ++i)
+    {
+        uint8_t b = cra_psort_bucket_of(ctx, ctx->array + i * ctx->itemsize);
+        ctx->ids[i] = b;
+        ++counts[b];
+    }
+}
+
+// counts[part][bucket]已经换算成该块在buf中的起始位置
+static void
+cra_psort_scatter(void *arg, int32_t part)
+{
+    CraPsortCtx *ctx = (CraPsortCtx *)arg;
+    size_t      *offsets = ctx->counts[part];
+    size_t       end = cra_psort_part_end(ctx, part);
+
+    for (size_t i = cra_psort_part_begin(ctx, part); i < end; ++i)
+    {
+        memcpy(ctx->buf + offsets[ctx->ids[i]]++ * ctx->itemsize, ctx->array + i * ctx->itemsize, ctx->itemsize);
+    }
+}
+
+static void
+cra_psort_sort_bucket(void *arg, int32_t bucket)
+{
+    CraPsortCtx *ctx = (CraPsortCtx *)arg;
+    size_t       begin = ctx->bucket_start[bucket];
+    size_t       n = ctx->bucket_start[bucket + 1] - begin;
+    CraAList     view;
+
+    if (n == 0)
+        return;
+
+    // 在buf中排好后复制回array
+    view.array = ctx->buf + begin * ctx->itemsize;
+    view.count = n;
+    view.capacity = n;
+    view.itemsize = ctx->itemsize;
+    if (!(cra_alist_sort)(&view, ctx->compare))
+        cra_atomic_store32(&ctx->failed, 1, CRA_MO_RELAXED);
+    memcpy(ctx->array + begin * ctx->itemsize, view.array, n * ctx->itemsize);
+}
+
+// 等距取样，排序后每CRA_PSORT_OVERSAMPLE个取一个作为分割点
+static bool
+cra_psort_choose_splitters(CraPsortCtx *ctx)
+{
+    CraAList sample;
+    size_t   nsample = (size_t)ctx->nbuckets * CRA_PSORT_OVERSAMPLE;
+    size_t   stride = ctx->count / nsample;
+
+    if (!(cra_alist_init_with_size)(&sample, ctx->itemsize, nsample))
+        return false;
+    for (size_t i = 0; i < nsample; ++i)
+        (cra_alist_insert)(&sample, i, ctx->array + (i * stride + stride / 2) * ctx->itemsize);
+    if (!(cra_alist_sort)(&sample, ctx->compare))
+    {
+        cra_alist_uninit(&sample);
+        return false;
+    }
+    for (int32_t b = 0; b < ctx->nbuckets - 1; ++b)
+    {
+        memcpy(ctx->splitters + (size_t)b * ctx->itemsize,
+               CRA_ALIST_PVAL(&sample, (size_t)(b + 1) * CRA_PSORT_OVERSAMPLE), ctx->itemsize);
+    }
+    cra_alist_uninit(&sample);
+    return true;
+}
+
+bool(cra_alist_parallel_sort)(CraAList *list, cra_cmp_fn compare, CraThrdPool *pool)
+{
+    bool        ret = false;
+    size_t      sum;
+    CraPsortCtx ctx;
+
+    assert(list);
+    assert(compare);
+    assert(list->array);
+    assert(pool);
+
+    if (list->count < CRA_PARALLEL_SORT_THRESHOLD)
+        return (cra_alist_sort)(list, compare);
+
+    bzero(&ctx, sizeof(ctx));
+    ctx.array = list->array;
+    ctx.count = list->count;
+    ctx.itemsize = list->itemsize;
+    ctx.compare = compare;
+    ctx.nparts = (int32_t)CRA_MIN(list->count / CRA_PSORT_PART_ITEMS, CRA_PSORT_MAX_PARTS);
+    if (ctx.nparts < 2)
+        ctx.nparts = 2;
+    ctx.nbuckets = ctx.nparts;
+
+    ctx.buf = cra_malloc(ctx.count * ctx.itemsize);
+    ctx.ids = cra_malloc(ctx.count);
+    ctx.splitters = cra_malloc((size_t)(ctx.nbuckets - 1) * ctx.itemsize);
+    ctx.counts = cra_calloc((size_t)ctx.nparts, sizeof(*ctx.counts));
+    if (!ctx.buf || !ctx.ids || !ctx.splitters || !ctx.counts)
+        goto end;
+
+    if (!cra_psort_choose_splitters(&ctx))
+        goto end;
+
+    // 1. 每块统计每个桶的元素个数
+    cra_psort_parallel_for(pool, ctx.nparts, cra_psort_classify, &ctx);
+
+    // 2. 按(桶, 块)的顺序算出每块每个桶在buf中的起始位置，保证分配结果是确定的
+    sum = 0;
+    for (int32_t b = 0; b < ctx.nbuckets; ++b)
+    {
+        ctx.bucket_start[b] = sum;
+        for (int32_t p = 0; p < ctx.nparts; ++p)
+        {
+            size_t c = ctx.counts[p][b];
+            ctx.counts[p][b] = sum;
+            sum += c;
+        }
+    }
+    ctx.bucket_start[ctx.nbuckets] = sum;
+    assert(sum == ctx.count);
+
+    // 3. 分配到buf
+    cra_psort_parallel_for(pool, ctx.nparts, cra_psort_scatter, &ctx);
+
+    // 4. 各桶分别排序，复制回array
+    cra_psort_parallel_for(pool, ctx.nbuckets, cra_psort_sort_bucket, &ctx);
+
+    ret = cra_atomic_load32(&ctx.failed, CRA_MO_RELAXED) == 0;
+
+end:
+    if (ctx.buf)
+        cra_free(ctx.buf);
+    if (ctx.ids)
+        cra_free(ctx.ids);
+    if (ctx.splitters)
+        cra_free(ctx.splitters);
+    if (ctx.counts)
+        cra_free(ctx.counts);
+    return ret;
+}
@@ -0,0 +1,355 @@
+/**
+ * @file cra_rcudict.c
+ * @author Cracal
+ * @brief 读多写少的无锁读字典(RCU + 纪元回收)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "threads/cra_rcudict.h"
+#include "cra_malloc.h"
+
+#define CRA_RCUDICT_ALIGN_UP(n, a) (((n) + ((a) - 1)) & ~((a) - 1))
+
+#define CRA_RCUDICT_PKEY(dict, node) ((void *)((unsigned char *)(node) + (dict)->key_offset))
+#define CRA_RCUDICT_PVAL(dict, node) ((void *)((unsigned char *)(node) + (dict)->val_offset))
+
+#define CRA_RCUDICT_BUCKET(hash, capacity) (cra_hash_mix(hash) & ((capacity) - 1))
+
+static CraRcuDictTable *
+cra_rcudict_new_table(size_t capacity)
+{
+    CraRcuDictTable *table;
+
+    table = cra_malloc(sizeof(CraRcuDictTable) + sizeof(cra_atomic_ptr_t) * capacity);
+    if (!table)
+        return NULL;
+    table->capacity = capacity;
+    for (size_t i = 0; i < capacity; ++i)
+        cra_atomic_store_ptr(&table->buckets[i], NULL, CRA_MO_RELAXED);
+    return table;
+}
+
+// 连同表里的节点一起释放
+static void
+cra_rcudict_free_table(void *ptr)
+{
+    CraRcuDictNode  *node, *next;
+    CraRcuDictTable *table = (CraRcuDictTable *)ptr;
+
+    for (size_t i = 0; i < table->capacity; ++i)
+    {
+        for (node = cra_atomic_load_ptr(&table->buckets[i], CRA_MO_RELAXED); node; node = next)
+        {
+            next = cra_atomic_load_ptr(&node->next, CRA_MO_RELAXED);
+            cra_free(node);
+        }
+    }
+    cra_free(table);
+}
+
+static void
+cra_rcudict_free_node(void *node)
+{
+    cra_free(node);
+}
+
+static CraRcuDictNode *
+cra_rcudict_new_node(CraRcuDict *dict, cra_hash_t hash, const void *key, const void *val)
+{
+    CraRcuDictNode *node;
+
+    node = cra_malloc(dict->node_size);
+    if (!node)
+        return NULL;
+    node->hash = hash;
+    memcpy(CRA_RCUDICT_PKEY(dict, node), key, dict->key_size);
+    memcpy(CRA_RCUDICT_PVAL(dict, node), val, dict->val_size);
+    return node;
+}
+
+bool(cra_rcudict_init_with_size)(CraRcuDict *dict,
+                                 size_t      key_size,
+                                 size_t      val_size,
+                                 size_t      key_align,
+                                 size_t      val_align,
+                                 size_t      init_capacity,
+                                 cra_hash_fn hash_key,
+                                 cra_cmp_fn  compare_key)
+{
+    size_t           offset, capacity;
+    CraRcuDictTable *table;
+
+    assert(dict);
+    assert(key_size > 0);
+    assert(val_size > 0);
+    assert(key_align > 0);
+    assert(val_align > 0);
+    assert(key_size % key_align == 0);
+    assert(val_size % val_align == 0);
+    assert(hash_key);
+    assert(compare_key);
+
+    for (capacity = CRA_RCUDICT_DEFAULT_CAPACITY; capacity < init_capacity; capacity <<= 1)
+        ;
+    table = cra_rcudict_new_table(capacity);
+    if (!table)
+        return false;
+
+    offset = sizeof(CraRcuDictNode);
+
+    offset = CRA_RCUDICT_ALIGN_UP(offset, key_align);
+    dict->key_offset = offset;
+    offset += key_size;
+
+    offset = CRA_RCUDICT_ALIGN_UP(offset, val_align);
+    dict->val_offset = offset;
+    offset += val_size;
+
+    dict->node_size = offset;
+    dict->key_size = key_size;
+    dict->val_size = val_size;
+
+    dict->hash_key = hash_key;
+    dict->compare_key = compare_key;
+
+    cra_mutex_init(&dict->lock);
+    cra_atomic_store64(&dict->count, 0, CRA_MO_RELAXED);
+    cra_epoch_init(&dict->epoch);
+    cra_atomic_store_ptr(&dict->table, table, CRA_MO_RELEASE);
+    return true;
+}
+
+void
+cra_rcudict_uninit(CraRcuDict *dict)
+{
+    assert(dict);
+    assert(cra_atomic_load_ptr(&dict->table, CRA_MO_RELAXED));
+
+    cra_rcudict_free_table(cra_atomic_load_ptr(&dict->table, CRA_MO_RELAXED));
+    cra_epoch_uninit(&dict->epoch);
+    cra_mutex_destroy(&dict->lock);
+    bzero(dict, sizeof(*dict));
+}
+
+void
+cra_rcudict_clear(CraRcuDict *dict)
+{
+    CraRcuDictNode  *node, *next;
+    CraRcuDictTable *table, *newtable;
+
+    assert(dict);
+
+    cra_mutex_lock(&dict->lock);
+    table = cra_atomic_load_ptr(&dict->table, CRA_MO_RELAXED);
+    newtable = cra_rcudict_new_table(table->capacity);
+    if (newtable)
+    {
+        cra_atomic_store_ptr(&dict->table, newtable, CRA_MO_RELEASE);
+        cra_atomic_store64(&dict->count, 0, CRA_MO_RELAXED);
+        cra_epoch_retire(&dict->epoch, table, cra_rcudict_free_table);
+    }
+    else
+    {
+        // 内存不足，只能逐个摘除
+        for (size_t i = 0; i < table->capacity; ++i)
+        {
+            node = cra_atomic_load_ptr(&table->buckets[i], CRA_MO_RELAXED);
+            cra_atomic_store_ptr(&table->buckets[i], NULL, CRA_MO_RELEASE);
+            while (node)
+            {
+                next = cra_atomic_load_ptr(&node->next, CRA_MO_RELAXED);
+                cra_epoch_retire(&dict->epoch, node, cra_rcudict_free_node);
+                node = next;
+            }
+        }
+        cra_atomic_store64(&dict->count, 0, CRA_MO_RELAXED);
+    }
+    cra_mutex_unlock(&dict->lock);
+}
+
+// 需要持有写锁
+// 读者可能还在遍历旧表的链，所以不能改旧节点的next，只能复制出新表
+static bool
+cra_rcudict_grow(CraRcuDict *dict, CraRcuDictTable *table)
+{
+    size_t           b;
+    CraRcuDictNode  *node, *newnode;
+    CraRcuDictTable *newtable;
+
+    newtable = cra_rcudict_new_table(table->capacity << 1);
+    if (!newtable)
+        return false;
+
+    for (size_t i = 0; i < table->capacity; ++i)
+    {
+        for (node = cra_atomic_load_ptr(&table->buckets[i], CRA_MO_RELAXED); node;
+             node = cra_atomic_load_ptr(&node->next, CRA_MO_RELAXED))
+        {
+            newnode = cra_malloc(dict->node_size);
+            if (!newnode)
+            {
+                cra_rcudict_free_table(newtable);
+                return false;
+            }
+            memcpy(newnode, node, dict->node_size);
+            b = CRA_RCUDICT_BUCKET(newnode->hash, newtable->capacity);
+            cra_atomic_store_ptr(&newnode->next, cra_atomic_load_ptr(&newtable->buckets[b], CRA_MO_RELAXED),
+                                 CRA_MO_RELAXED);
+            cra_atomic_store_ptr(&newtable->buckets[b], newnode, CRA_MO_RELAXED);
+        }
+    }
+
+    // 新表及其节点对读者一次性可见
+    cra_atomic_store_ptr(&dict->table, newtable, CRA_MO_RELEASE);
+    cra_epoch_retire(&dict->epoch, table, cra_rcudict_free_table);
+    return true;
+}
+
+// 需要持有写锁
+// 返回指向目标节点的链接(桶或前驱的next)，找不到时返回NULL
+static cra_atomic_ptr_t *
+cra_rcudict_find_link(CraRcuDict *dict, CraRcuDictTable *table, const void *key, cra_hash_t hash)
+{
+    CraRcuDictNode   *node;
+    cra_atomic_ptr_t *link;
+
+    link = &table->buckets[CRA_RCUDICT_BUCKET(hash, table->capacity)];
+    while ((node = cra_atomic_load_ptr(link, CRA_MO_RELAXED)) != NULL)
+    {
+        if (node->hash == hash && dict->compare_key(CRA_RCUDICT_PKEY(dict, node), key) == 0)
+            return link;
+        link = &node->next;
+    }
+    return NULL;
+}
+
+bool(cra_rcudict_put_and_return_kv)(CraRcuDict *dict,
+                                    void       *key,
+                                    void       *val,
+                                    void       *retoldkey,
+                                    void       *retoldval,
+                                    bool        add)
+{
+    bool              ret = false;
+    cra_hash_t        hash;
+    CraRcuDictNode   *node, *oldnode;
+    CraRcuDictTable  *table;
+    cra_atomic_ptr_t *link;
+
+    assert(dict);
+    assert(key);
+    assert(val);
+
+    hash = dict->hash_key(key);
+
+    cra_mutex_lock(&dict->lock);
+    table = cra_atomic_load_ptr(&dict->table, CRA_MO_RELAXED);
+
+    link = cra_rcudict_find_link(dict, table, key, hash);
+    if (link)
+    {
+        if (add)
+            goto end;
+        // 替换整个节点，读者要么看到旧节点要么看到新节点
+        if (!(node = cra_rcudict_new_node(dict, hash, key, val)))
+            goto end;
+        oldnode = cra_atomic_load_ptr(link, CRA_MO_RELAXED);
+        cra_atomic_store_ptr(&node->next, cra_atomic_load_ptr(&oldnode->next, CRA_MO_RELAXED), CRA_MO_RELAXED);
+        cra_atomic_store_ptr(link, node, CRA_MO_RELEASE);
+        if (retoldkey)
+            memcpy(retoldkey, CRA_RCUDICT_PKEY(dict, oldnode), dict->key_size);
+        if (retoldval)
+            memcpy(retoldval, CRA_RCUDICT_PVAL(dict, oldnode), dict->val_size);
+        cra_epoch_retire(&dict->epoch, oldnode, cra_rcudict_free_node);
+        ret = true;
+        goto end;
+    }
+
+    // 负载因子为1时扩容，失败了也可以继续插入
+    if ((size_t)cra_atomic_load64(&dict->count, CRA_MO_RELAXED) >= table->capacity &&
+        cra_rcudict_grow(dict, table))
+        table = cra_atomic_load_ptr(&dict->table, CRA_MO_RELAXED);
+
+    if (!(node = cra_rcudict_new_node(dict, hash, key, val)))
+        goto end;
+    link = &table->buckets[CRA_RCUDICT_BUCKET(hash, table->capacity)];
+    cra_atomic_store_ptr(&node->next, cra_atomic_load_ptr(link, CRA_MO_RELAXED), CRA_MO_RELAXED);
+    // 节点内容先于指针对读者可见
+    cra_atomic_store_ptr(link, node, CRA_MO_RELEASE);
+    cra_atomic_add64(&dict->count, 1, CRA_MO_RELAXED);
+    ret = true;
+
+end:
+    cra_mutex_unlock(&dict->lock);
+    return ret;
+}
+
+bool(cra_rcudict_pop_kv)(CraRcuDict *dict, const void *key, void *retkey, void *retval)
+{
+    cra_hash_t        hash;
+    CraRcuDictNode   *node;
+    CraRcuDictTable  *table;
+    cra_atomic_ptr_t *link;
+
+    assert(dict);
+    assert(key);
+
+    hash = dict->hash_key(key);
+
+    cra_mutex_lock(&dict->lock);
+    table = cra_atomic_load_ptr(&dict->table, CRA_MO_RELAXED);
+    link = cra_rcudict_find_link(dict, table, key, hash);
+    if (!link)
+    {
+        cra_mutex_unlock(&dict->lock);
+        return false;
+    }
+    node = cra_atomic_load_ptr(link, CRA_MO_RELAXED);
+    // 摘除后，正在读该节点的读者仍可以通过它的next继续遍历
+    cra_atomic_store_ptr(link, cra_atomic_load_ptr(&node->next, CRA_MO_RELAXED), CRA_MO_RELEASE);
+    cra_atomic_sub64(&dict->count, 1, CRA_MO_RELAXED);
+    if (retkey)
+        memcpy(retkey, CRA_RCUDICT_PKEY(dict, node), dict->key_size);
+    if (retval)
+        memcpy(retval, CRA_RCUDICT_PVAL(dict, node), dict->val_size);
+    cra_epoch_retire(&dict->epoch, node, cra_rcudict_free_node);
+    cra_mutex_unlock(&dict->lock);
+    return true;
+}
+
+const void *(cra_rcudict_get_ref)(CraRcuDict *dict, const void *key)
+{
+    cra_hash_t       hash;
+    CraRcuDictNode  *node;
+    CraRcuDictTable *table;
+
+    assert(dict);
+    assert(key);
+
+    hash = dict->hash_key(key);
+    table = cra_atomic_load_ptr(&dict->table, CRA_MO_ACQUIRE);
+    node = cra_atomic_load_ptr(&table->buckets[CRA_RCUDICT_BUCKET(hash, table->capacity)], CRA_MO_ACQUIRE);
+    for (; node; node = cra_atomic_load_ptr(&node->next, CRA_MO_ACQUIRE))
+    {
+        if (node->hash == hash && dict->compare_key(CRA_RCUDICT_PKEY(dict, node), key) == 0)
+            return CRA_RCUDICT_PVAL(dict, node);
+    }
+    return NULL;
+}
+
+bool(cra_rcudict_get)(CraRcuDict *dict, CraEpochRecord *reader, const void *key, void *retval)
+{
+    const void *pval;
+
+    assert(reader);
+
+    cra_epoch_enter(reader);
+    pval = (cra_rcudict_get_ref)(dict, key);
+    if (pval && retval)
+        memcpy(retval, pval, dict->val_size);
+    cra_epoch_exit(reader);
+    return pval != NULL;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file cra_spscq.c
+ * @author Cracal
+ * @brief 单生产者单消费者环形队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "threads/cra_spscq.h"
+#include "cra_malloc.h"
+
+bool(cra_spscq_init_with_size)(CraSpscq *que, size_t itemsize, size_t capacity, bool blocking)
+{
+    size_t cap;
+
+    assert(que);
+    assert(itemsize > 0);
+    assert(capacity > 0 && capacity <= ((size_t)1 << (sizeof(size_t) * 8 - 2)));
+
+    for (cap = 2; cap < capacity; cap <<= 1)
+        ;
+
+    que->array = (unsigned char *)cra_malloc(itemsize * cap);
+    if (!que->array)
+        return false;
+    que->mask = cap - 1;
+    que->itemsize = itemsize;
+    que->blocking = blocking;
+    que->cached_head = 0;
+    que->cached_tail = 0;
+    cra_atomic_store64(&que->tail, 0, CRA_MO_RELAXED);
+    cra_atomic_store64(&que->head, 0, CRA_MO_RELAXED);
+    cra_atomic_store32(&que->closed, 0, CRA_MO_RELAXED);
+    cra_evcount_init(&que->not_empty);
+    cra_evcount_init(&que->not_full);
+    return true;
+}
+
+void
+cra_spscq_uninit(CraSpscq *que)
+{
+    assert(que);
+
+    cra_evcount_uninit(&que->not_empty);
+    cra_evcount_uninit(&que->not_full);
+    cra_free(que->array);
+    que->array = NULL;
+}
+
+void
+cra_spscq_shutdown(CraSpscq *que, int how)
+{
+    int32_t closed;
+
+    assert(que);
+    assert(how & CRA_BLOCKDQ_CLOSE_ALL);
+
+    closed = cra_atomic_load32(&que->closed, CRA_MO_RELAXED);
+    while (!cra_atomic_cas_weak32(&que->closed, &closed, closed | how, CRA_MO_SEQ_CST, CRA_MO_RELAXED))
+        ;
+    if (!que->blocking)
+        return;
+    if (how & CRA_BLOCKDQ_CLOSE_ENQUEUE)
+        cra_evcount_notify(&que->not_full, true);
+    if (how & CRA_BLOCKDQ_CLOSE_DEQUEUE)
+        cra_evcount_notify(&que->not_empty, true);
+}
+
+static inline bool
+cra_spscq_is_closed(CraSpscq *que, int how)
+{
+    return !!(cra_atomic_load32(&que->closed, CRA_MO_ACQUIRE) & how);
+}
+
+// [from, from + n)在环上可能分成两段
+static inline void
+cra_spscq_copy_in(CraSpscq *que, int64_t from, void *vals, size_t n)
+{
+    size_t idx = (size_t)from & que->mask;
+    size_t n1 = CRA_MIN(n, que->mask + 1 - idx);
+
+    memcpy(que->array + idx * que->itemsize, vals, n1 * que->itemsize);
+    if (n1 < n)
+        memcpy(que->array, (unsigned char *)vals + n1 * que->itemsize, (n - n1) * que->itemsize);
+}
+
+static inline void
+cra_spscq_copy_out(CraSpscq *que, int64_t from, void *retvals, size_t n)
+{
+    size_t idx = (size_t)from & que->mask;
+    size_t n1 = CRA_MIN(n, que->mask + 1 - idx);
+
+    memcpy(retvals, que->array + idx * que->itemsize, n1 * que->itemsize);
+    if (n1 < n)
+        memcpy((unsigned char *)retvals + n1 * que->itemsize, que->array, (n - n1) * que->itemsize);
+}
+
+size_t(cra_spscq_push_n)(CraSpscq *que, void *vals, size_t n)
+{
+    int64_t tail;
+    size_t  nfree;
+
+    assert(que);
+    assert(vals || n == 0);
+
+    if (cra_spscq_is_closed(que, CRA_BLOCKDQ_CLOSE_ENQUEUE))
+        return 0;
+
+    tail = cra_atomic_load64(&que->tail, CRA_MO_RELAXED);
+    nfree = que->mask + 1 - (size_t)(tail - que->cached_head);
+    if (nfree < n)
+    {
+        // 缓存的head不够用时才读消费者的缓存行
+        que->cached_head = cra_atomic_load64(&que->head, CRA_MO_ACQUIRE);
+        nfree = que->mask + 1 - (size_t)(tail - que->cached_head);
+        if (n > nfree)
+            n = nfree;
+    }
+    if (n == 0)
+        return 0;
+
+    cra_spscq_copy_in(que, tail, vals, n);
+    cra_atomic_store64(&que->tail, tail + (int64_t)n, CRA_MO_RELEASE);
+    if (que->blocking)
+        cra_evcount_notify(&que->not_empty, false);
+    return n;
+}
+
+size_t(cra_spscq_pop_n)(CraSpscq *que, void *retvals, size_t n)
+{
+    int64_t head;
+    size_t  nused;
+
+    assert(que);
+    assert(retvals || n == 0);
+
+    head = cra_atomic_load64(&que->head, CRA_MO_RELAXED);
+    nused = (size_t)(que->cached_tail - head);
+    if (nused < n)
+    {
+        // 缓存的tail不够用时才读生产者的缓存行
+        que->cached_tail = cra_atomic_load64(&que->tail, CRA_MO_ACQUIRE);
+        nused = (size_t)(que->cached_tail - head);
+        if (n > nused)
+            n = nused;
+    }
+    if (n == 0)
+        return 0;
+
+    cra_spscq_copy_out(que, head, retvals, n);
+    cra_atomic_store64(&que->head, head + (int64_t)n, CRA_MO_RELEASE);
+    if (que->blocking)
+        cra_evcount_notify(&que->not_full, false);
+    return n;
+}
+
+bool(cra_spscq_push)(CraSpscq *que, void *val)
+{
+    int64_t key;
+
+    assert(que);
+    assert(val);
+    assert(que->blocking);
+
+    for (;;)
+    {
+        if ((cra_spscq_push_n)(que, val, 1) == 1)
+            return true;
+        if (cra_spscq_is_closed(que, CRA_BLOCKDQ_CLOSE_ENQUEUE))
+            return false;
+
+        key = cra_evcount_prepare_wait(&que->not_full);
+        // 再检查一次，避免错过通知
+        if (cra_spscq_is_closed(que, CRA_BLOCKDQ_CLOSE_ENQUEUE) ||
+            cra_atomic_load64(&que->head, CRA_MO_ACQUIRE) != que->cached_head)
+            cra_evcount_cancel_wait(&que->not_full);
+        else
+            cra_evcount_wait(&que->not_full, key);
+    }
+}
+
+bool(cra_spscq_pop)(CraSpscq *que, void *retval)
+{
+    int64_t key;
+
+    assert(que);
+    assert(retval);
+    assert(que->blocking);
+
+    for (;;)
+    {
+        if ((cra_spscq_pop_n)(que, retval, 1) == 1)
+            return true;
+        if (cra_spscq_is_closed(que, CRA_BLOCKDQ_CLOSE_DEQUEUE))
+        {
+            // 关闭前放入的元素
+            return (cra_spscq_pop_n)(que, retval, 1) == 1;
+        }
+
+        key = cra_evcount_prepare_wait(&que->not_empty);
+        // 再检查一次，避免错过通知
+        if (cra_spscq_is_closed(que, CRA_BLOCKDQ_CLOSE_DEQUEUE) ||
+            cra_atomic_load64(&que->tail, CRA_MO_ACQUIRE) != que->cached_tail)
+            cra_evcount_cancel_wait(&que->not_empty);
+        else
+            cra_evcount_wait(&que->not_empty, key);
+    }
+}
@@ -171,6 +171,15 @@ cra_thrdpool_add_task1(CraThrdPool *pool, void (*excute1)(void *), void *arg)
     return (cra_blockdq_push_back)(pool->taskque, &task, NULL);
 }
 
+bool
+cra_thrdpool_try_add_task1(CraThrdPool *pool, void (*excute1)(void *), void *arg)
+{
+    assert(pool);
+    CraThrdPoolTask task = { .excute1 = excute1, .count = 1 };
+    task.user_data[1] = arg;
+    return (cra_blockdq_try_push_back)(pool->taskque, &task);
+}
+
 bool
 cra_thrdpool_add_task2(CraThrdPool *pool, void (*excute2)(void *, void *), void *arg1, void *arg2)
 {
@@ -10,11 +10,27 @@
  */
 #include "collections/cra_alist.h"
 #include "collections/cra_deque.h"
+#include "collections/cra_ringdq.h"
 #include "collections/cra_dict.h"
+#include "collections/cra_swissdict.h"
+#include "collections/cra_perfectdict.h"
+#include "collections/cra_btree.h"
+#include "collections/cra_strkey.h"
 #include "collections/cra_llist.h"
+#include "collections/cra_seglist.h"
 #include "cra_malloc.h"
 #include "cra_time.h"
 
+#if defined(CRA_ARCH_X86_64) && defined(CRA_COMPILER_MSVC)
+#include <intrin.h>
+#define bench_cycles() __rdtsc()
+#elif defined(CRA_ARCH_X86_64)
+#include <x86intrin.h>
+#define bench_cycles() __rdtsc()
+#else
+#define bench_cycles() 0ULL
+#endif
+
 static inline int
 rand_large(void)
 {
@@ -241,6 +257,112 @@ test_llist_performance(int sizes[])
     cra_llist_uninit(&list);
 }
 
+void
+test_llist_nodepool_performance(size_t n)
+{
+    int           val;
+    long long     sum;
+    CraLList      list;
+    CraMemPool    pool;
+    unsigned long start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+    printf("test llist malloc vs nodepool[%zu] (int):\n", n);
+
+    for (int k = 0; k < 2; k++)
+    {
+        const char *name = k == 0 ? "malloc  " : "nodepool";
+
+        if (k == 0)
+        {
+            assert_always(cra_llist_init(int, &list));
+        }
+        else
+        {
+            assert_always(cra_llist_nodepool_init(int, &pool, 4096));
+            assert_always(cra_llist_init_with_pool(int, &list, &pool));
+        }
+
+        start_ms = cra_tick_ms();
+        for (int i = 0; i < (int)n; i++)
+            cra_llist_append(&list, &i);
+        end_ms = cra_tick_ms();
+        printf("\t%s append:    %4lums.\n", name, end_ms - start_ms);
+
+        sum = 0;
+        start_ms = cra_tick_ms();
+        CRA_FOREACH(CRA_LLIST_ITERABLE_I, &list, vals)
+        {
+            sum += *(int *)vals.val_ref;
+        }
+        end_ms = cra_tick_ms();
+        printf("\t%s traverse:  %4lums. sum: %lld\n", name, end_ms - start_ms, sum);
+
+        start_ms = cra_tick_ms();
+        while (list.count > 0)
+            cra_llist_pop_front(&list, &val);
+        end_ms = cra_tick_ms();
+        printf("\t%s pop front: %4lums.\n", name, end_ms - start_ms);
+
+        start_ms = cra_tick_ms();
+        cra_llist_uninit(&list);
+        if (k == 1)
+            cra_mempool_uninit(&pool);
+        end_ms = cra_tick_ms();
+        printf("\t%s uninit:    %4lums.\n", name, end_ms - start_ms);
+    }
+}
+
+typedef struct
+{
+    int  key;
+    char payload[60];
+} LListItem64;
+
+typedef struct
+{
+    int  key;
+    char payload[252];
+} LListItem256;
+
+static int
+compare_llist_item(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+void
+test_llist_sort_performance(size_t n)
+{
+    CraLList      list;
+    LListItem256  item;
+    unsigned long start_ms, end_ms;
+    size_t        itemsizes[] = { sizeof(int), sizeof(LListItem64), sizeof(LListItem256) };
+
+    printf("\n=========================================================\n\n");
+    printf("test llist sort[%zu]:\n", n);
+
+    memset(&item, 0, sizeof(item));
+    for (size_t k = 0; k < sizeof(itemsizes) / sizeof(itemsizes[0]); k++)
+    {
+        assert_always((cra_llist_init_with_size)(&list, itemsizes[k], 0));
+        for (size_t i = 0; i < n; i++)
+        {
+            item.key = (int)(rand_large() % n);
+            assert_always((cra_llist_insert)(&list, list.count, &item));
+        }
+        start_ms = cra_tick_ms();
+        (cra_llist_sort)(&list, compare_llist_item);
+        end_ms = cra_tick_ms();
+        printf("\titemsize %3zu random: %4lums.\n", itemsizes[k], end_ms - start_ms);
+        start_ms = cra_tick_ms();
+        (cra_llist_sort)(&list, compare_llist_item);
+        end_ms = cra_tick_ms();
+        printf("\titemsize %3zu sorted: %4lums.\n", itemsizes[k], end_ms - start_ms);
+        cra_llist_uninit(&list);
+    }
+}
+
 void
 test_deque_performance(int sizes[])
 {
@@ -350,7 +472,7 @@ test_deque_performance(int sizes[])
 }
 
 void
-test_dict_performance(int sizes[])
+test_dict_performance(int sizes[], unsigned int flags)
 {
     size_t        val;
     CraDict       dict;
@@ -358,13 +480,14 @@ test_dict_performance(int sizes[])
     long long     sum;
     unsigned long start_ms, end_ms;
 
-    assert_always(cra_dict_init(int, size_t, &dict, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(cra_dict_init_with_flags(int, size_t, &dict, CRA_DICT_DEAFULT_CAPACITY, flags, cra_hash_int_p,
+                                           cra_cmp_int_p));
 
     printf("\n=========================================================\n\n");
 
     for (int i = 0; sizes[i] != 0; i++)
     {
-        printf("test dict[%d]:\n", sizes[i]);
+        printf("test dict%s[%d]:\n", (flags & CRA_DICT_FLAG_POW2) ? "(pow2)" : "", sizes[i]);
 
         // clear
         cra_dict_clear(&dict);
@@ -406,6 +529,908 @@ test_dict_performance(int sizes[])
     cra_dict_uninit(&dict);
 }
 
+void
+test_swissdict_performance(int sizes[])
+{
+    size_t        val;
+    CraSwissDict  dict;
+    int           nloop;
+    long long     sum;
+    unsigned long start_ms, end_ms;
+
+    assert_always(cra_swissdict_init(int, size_t, &dict, cra_hash_int_p, cra_cmp_int_p));
+
+    printf("\n=========================================================\n\n");
+
+    for (int i = 0; sizes[i] != 0; i++)
+    {
+        printf("test swissdict[%d]:\n", sizes[i]);
+
+        // clear
+        cra_swissdict_clear(&dict);
+
+        // insert
+        start_ms = cra_tick_ms();
+        for (int j = 0; j < sizes[i]; j++)
+            cra_swissdict_put(&dict, &(int){ rand_large() }, &(size_t){ j });
+        end_ms = cra_tick_ms();
+        printf("\tput:           %lums.\n", end_ms - start_ms);
+
+        // get
+        start_ms = cra_tick_ms();
+        for (int j = 0; j < sizes[i]; j++)
+            cra_swissdict_get(&dict, &(int){ rand_large() }, &val);
+        end_ms = cra_tick_ms();
+        printf("\tget:           %lums.\n", end_ms - start_ms);
+
+        // iter
+        sum = 0;
+        nloop = 0;
+        start_ms = cra_tick_ms();
+        CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, &dict, vals)
+        {
+            nloop++;
+            sum += *(size_t *)vals.val_ref;
+        }
+        end_ms = cra_tick_ms();
+        printf("\titer:          %lums. loop times: %d. sum: %lld\n", end_ms - start_ms, nloop, sum);
+
+        // remove random
+        start_ms = cra_tick_ms();
+        for (int j = 0; j < sizes[i]; j++)
+            cra_swissdict_remove(&dict, &(int){ rand_large() });
+        end_ms = cra_tick_ms();
+        printf("\tremove:        %lums.\n", end_ms - start_ms);
+    }
+
+    cra_swissdict_uninit(&dict);
+}
+
+void
+test_dict_rehash_performance(int sizes[])
+{
+    CraDict            dict;
+    unsigned long long start_us, end_us, max_us;
+    unsigned long      start_ms, end_ms;
+    unsigned int       flags[] = { CRA_DICT_FLAG_POW2, CRA_DICT_FLAG_POW2 | CRA_DICT_FLAG_INCR };
+
+    printf("\n=========================================================\n\n");
+
+    for (int i = 0; sizes[i] != 0; i++)
+    {
+        printf("test dict rehash[%d]:\n", sizes[i]);
+
+        for (size_t k = 0; k < CRA_NARRAY(flags); k++)
+        {
+            assert_always(cra_dict_init_with_flags(int, size_t, &dict, 0, flags[k], cra_hash_int_p, cra_cmp_int_p));
+
+            // 记录单次put的最大耗时(扩容停顿)
+            max_us = 0;
+            start_ms = cra_tick_ms();
+            for (int j = 0; j < sizes[i]; j++)
+            {
+                start_us = cra_tick_us();
+                cra_dict_put(&dict, &j, &(size_t){ j });
+                end_us = cra_tick_us();
+                if (end_us - start_us > max_us)
+                    max_us = end_us - start_us;
+            }
+            end_ms = cra_tick_ms();
+            printf("\t%s put: %lums. max pause: %lluus.\n", (flags[k] & CRA_DICT_FLAG_INCR) ? "incr" : "full",
+                   end_ms - start_ms, max_us);
+
+            cra_dict_uninit(&dict);
+        }
+    }
+}
+
+void
+test_dict_batch_performance(int sizes[])
+{
+    int           *keys, *queries;
+    size_t        *vals, **retvals, sum1, sum2;
+    size_t         batch = 1024;
+    size_t         n;
+    CraDict        dict;
+    unsigned long  start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+
+    retvals = cra_malloc(sizeof(size_t *) * batch);
+    for (int i = 0; sizes[i] != 0; i++)
+    {
+        printf("test dict batch[%d]:\n", sizes[i]);
+
+        n = (size_t)sizes[i];
+        keys = cra_malloc(sizeof(int) * n);
+        vals = cra_malloc(sizeof(size_t) * n);
+        queries = cra_malloc(sizeof(int) * n);
+        for (size_t j = 0; j < n; j++)
+        {
+            keys[j] = (int)rand_large();
+            vals[j] = j;
+        }
+        for (size_t j = 0; j < n; j++)
+            queries[j] = keys[rand_large() % n];
+
+        // 两种方式都预先扩容，只比较内存访问
+        assert_always(cra_dict_init_with_size(int, size_t, &dict, n * 100 / 72 + 1, cra_hash_int_p, cra_cmp_int_p));
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            cra_dict_put(&dict, &keys[j], &vals[j]);
+        end_ms = cra_tick_ms();
+        printf("\tput loop:      %lums.\n", end_ms - start_ms);
+
+        sum1 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            sum1 += *(size_t *)cra_dict_get_ref(&dict, &queries[j]);
+        end_ms = cra_tick_ms();
+        printf("\tget loop:      %lums.\n", end_ms - start_ms);
+        cra_dict_uninit(&dict);
+
+        assert_always(cra_dict_init_with_size(int, size_t, &dict, n * 100 / 72 + 1, cra_hash_int_p, cra_cmp_int_p));
+        start_ms = cra_tick_ms();
+        assert_always(cra_dict_put_many(&dict, keys, vals, n) == n);
+        end_ms = cra_tick_ms();
+        printf("\tput_many:      %lums.\n", end_ms - start_ms);
+
+        sum2 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j += batch)
+        {
+            size_t m = CRA_MIN(batch, n - j);
+            cra_dict_get_many(&dict, &queries[j], m, retvals);
+            for (size_t k = 0; k < m; k++)
+                sum2 += *retvals[k];
+        }
+        end_ms = cra_tick_ms();
+        printf("\tget_many:      %lums.\n", end_ms - start_ms);
+        assert_always(sum1 == sum2);
+        cra_dict_uninit(&dict);
+
+        cra_free(queries);
+        cra_free(vals);
+        cra_free(keys);
+    }
+    cra_free(retvals);
+}
+
+static void
+test_dict_freeze_performance(int sizes[])
+{
+    int           *keys;
+    size_t         n, sum1, sum2;
+    const char    *path = "collections_performance_dict.img";
+    CraDict        dict;
+    CraDictView    view;
+    unsigned long  start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+
+    for (int i = 0; sizes[i] != 0; i++)
+    {
+        printf("test dict freeze[%d]:\n", sizes[i]);
+
+        n = (size_t)sizes[i];
+        keys = cra_malloc(sizeof(int) * n);
+        for (size_t j = 0; j < n; j++)
+            keys[j] = (int)rand_large();
+
+        // 每次启动都重建字典的代价
+        assert_always(cra_dict_init(int, size_t, &dict, cra_hash_int_p, cra_cmp_int_p));
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            cra_dict_put(&dict, &keys[j], &j);
+        end_ms = cra_tick_ms();
+        printf("\tbuild:         %lums.\n", end_ms - start_ms);
+
+        start_ms = cra_tick_ms();
+        assert_always(cra_dict_freeze(&dict, path));
+        end_ms = cra_tick_ms();
+        printf("\tfreeze:        %lums.\n", end_ms - start_ms);
+
+        start_ms = cra_tick_ms();
+        assert_always(cra_dict_view_open(int, size_t, &view, path, cra_hash_int_p, cra_cmp_int_p));
+        end_ms = cra_tick_ms();
+        printf("\tview open:     %lums.\n", end_ms - start_ms);
+
+        sum1 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            sum1 += *(size_t *)cra_dict_get_ref(&dict, &keys[j]);
+        end_ms = cra_tick_ms();
+        printf("\tdict get:      %lums.\n", end_ms - start_ms);
+
+        // 第一次访问包含缺页的代价
+        sum2 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            sum2 += *(const size_t *)cra_dict_view_get_ref(&view, &keys[j]);
+        end_ms = cra_tick_ms();
+        printf("\tview get:      %lums.\n", end_ms - start_ms);
+        assert_always(sum1 == sum2);
+
+        cra_dict_view_close(&view);
+        cra_dict_uninit(&dict);
+        remove(path);
+        cra_free(keys);
+    }
+}
+
+static void
+test_perfectdict_performance(int sizes[])
+{
+    int           *keys, *queries;
+    size_t         n, sum1, sum2;
+    CraDict        dict;
+    CraPerfectDict pdict;
+    unsigned long  start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+
+    for (int i = 0; sizes[i] != 0; i++)
+    {
+        printf("test perfect dict[%d]:\n", sizes[i]);
+
+        n = (size_t)sizes[i];
+        keys = cra_malloc(sizeof(int) * n);
+        queries = cra_malloc(sizeof(int) * n);
+        assert_always(cra_dict_init_with_size(int, size_t, &dict, n * 100 / 72 + 1, cra_hash_int_p, cra_cmp_int_p));
+        for (size_t j = 0; j < n; j++)
+        {
+            keys[j] = (int)rand_large();
+            cra_dict_put(&dict, &keys[j], &j);
+        }
+        for (size_t j = 0; j < n; j++)
+            queries[j] = keys[rand_large() % n];
+
+        start_ms = cra_tick_ms();
+        assert_always(cra_perfectdict_init_from_dict(&pdict, &dict));
+        end_ms = cra_tick_ms();
+        printf("\tbuild:         %lums.\n", end_ms - start_ms);
+
+        sum1 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            sum1 += *(size_t *)cra_dict_get_ref(&dict, &queries[j]);
+        end_ms = cra_tick_ms();
+        printf("\tdict get:      %lums.\n", end_ms - start_ms);
+
+        sum2 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            sum2 += *(size_t *)cra_perfectdict_get_ref(&pdict, &queries[j]);
+        end_ms = cra_tick_ms();
+        printf("\tperfect get:   %lums.\n", end_ms - start_ms);
+        assert_always(sum1 == sum2);
+
+        cra_perfectdict_uninit(&pdict);
+        cra_dict_uninit(&dict);
+        cra_free(queries);
+        cra_free(keys);
+    }
+}
+
+static void
+test_dict_split_performance(size_t n)
+{
+    int           *keys, *queries;
+    size_t         val_sizes[] = { 16, 64, 256, 1024 };
+    size_t         found;
+    unsigned char  val[1024] = { 0 };
+    unsigned int   flags[] = { CRA_DICT_FLAG_NONE, CRA_DICT_FLAG_SPLIT };
+    const char    *names[] = { "interleaved", "split" };
+    CraDict        dict;
+    unsigned long  start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+
+    keys = cra_malloc(sizeof(int) * n);
+    queries = cra_malloc(sizeof(int) * n);
+    for (size_t j = 0; j < n; j++)
+        keys[j] = (int)rand_large();
+    // 一半命中，一半不命中
+    for (size_t j = 0; j < n; j++)
+        queries[j] = (j & 1) ? keys[rand_large() % n] : (int)rand_large();
+
+    for (int i = 0; i < (int)CRA_NARRAY(val_sizes); i++)
+    {
+        printf("test dict layout[%zu], val size %zu:\n", n, val_sizes[i]);
+        for (int f = 0; f < (int)CRA_NARRAY(flags); f++)
+        {
+            // val的大小在运行时才确定，直接调用函数
+            assert_always((cra_dict_init_with_flags)(&dict, sizeof(int), val_sizes[i], alignof(int), 8, n * 100 / 72 + 1,
+                                                     flags[f], (cra_hash_fn)cra_hash_int_p, (cra_cmp_fn)cra_cmp_int_p));
+            start_ms = cra_tick_ms();
+            for (size_t j = 0; j < n; j++)
+                (cra_dict_put_and_return_kv)(&dict, &keys[j], val, NULL, NULL, false);
+            end_ms = cra_tick_ms();
+            printf("\t%-12s put: %4lums.", names[f], end_ms - start_ms);
+
+            found = 0;
+            start_ms = cra_tick_ms();
+            for (size_t j = 0; j < n; j++)
+                found += (cra_dict_get_ref)(&dict, &queries[j]) != NULL;
+            end_ms = cra_tick_ms();
+            printf("  get: %4lums. (found %zu)\n", end_ms - start_ms, found);
+
+            cra_dict_uninit(&dict);
+        }
+    }
+
+    cra_free(queries);
+    cra_free(keys);
+}
+
+typedef struct
+{
+    int key;
+    int val;
+} BTreeKV;
+
+static int
+compare_btree_kv(const BTreeKV *a, const BTreeKV *b)
+{
+    return cra_cmp_int(a->key, b->key);
+}
+
+// 有序数组中第一个 >= key 的下标
+static size_t
+alist_lower_bound(CraAList *list, int key)
+{
+    size_t l = 0, r = list->count, mid;
+    while (l < r)
+    {
+        mid = l + ((r - l) >> 1);
+        if (((BTreeKV *)cra_alist_get_ref(list, mid))->key < key)
+            l = mid + 1;
+        else
+            r = mid;
+    }
+    return l;
+}
+
+static void
+test_btree_performance(int sizes[])
+{
+    int           *keys;
+    int            from, to;
+    size_t         n, idx, nranges, sum1, sum2;
+    BTreeKV        kv;
+    CraAList       list;
+    CraBTree       tree;
+    unsigned long  start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+
+    for (int i = 0; sizes[i] != 0; i++)
+    {
+        printf("test btree[%d]:\n", sizes[i]);
+
+        n = (size_t)sizes[i];
+        nranges = 1000;
+        keys = cra_malloc(sizeof(int) * n);
+        for (size_t j = 0; j < n; j++)
+            keys[j] = (int)(rand_large() & 0x7fffffff);
+
+        assert_always(cra_alist_init(BTreeKV, &list));
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+        {
+            kv.key = keys[j];
+            kv.val = (int)j;
+            cra_alist_add_sort(&list, compare_btree_kv, &kv);
+        }
+        end_ms = cra_tick_ms();
+        printf("\talist add_sort: %lums.\n", end_ms - start_ms);
+
+        assert_always(cra_btree_init(int, int, &tree, cra_cmp_int_p));
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            cra_btree_put(&tree, &keys[j], &(int){ (int)j });
+        end_ms = cra_tick_ms();
+        printf("\tbtree put:      %lums. (height %zd)\n", end_ms - start_ms, tree.height);
+
+        // 每次扫描约1%的元素
+        sum1 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < nranges; j++)
+        {
+            from = keys[j % n];
+            to = from + (int)(0x7fffffff / 100);
+            for (idx = alist_lower_bound(&list, from); idx < list.count; idx++)
+            {
+                BTreeKV *p = (BTreeKV *)cra_alist_get_ref(&list, idx);
+                if (p->key >= to)
+                    break;
+                sum1 += (size_t)p->key;
+            }
+        }
+        end_ms = cra_tick_ms();
+        printf("\talist range:    %lums.\n", end_ms - start_ms);
+
+        sum2 = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < nranges; j++)
+        {
+            from = keys[j % n];
+            to = from + (int)(0x7fffffff / 100);
+            CRA_BTREE_FOREACH_RANGE(&tree, &from, &to, it)
+            {
+                sum2 += (size_t) * (int *)it.key_ref;
+            }
+        }
+        end_ms = cra_tick_ms();
+        printf("\tbtree range:    %lums.\n", end_ms - start_ms);
+        // 有重复的key时alist中会有多个
+        assert_always(sum1 >= sum2);
+
+        cra_btree_uninit(&tree);
+        cra_alist_uninit(&list);
+        cra_free(keys);
+    }
+}
+
+// 原来的BKDR字符串hash，作为对比
+static cra_hash_t
+hash_bkdr_n(const char *val, size_t len)
+{
+    cra_hash_t hash = 13747;
+    for (const char *end = val + len; val < end; ++val)
+        hash = hash * 131 + (*val);
+    return hash;
+}
+
+static void
+test_hash_performance(void)
+{
+    char              *data;
+    size_t             lens[] = { 8, 16, 32, 64, 256, 1024, 4096 };
+    size_t             total = 64 * 1024 * 1024;
+    size_t             rounds;
+    cra_hash_t         sum;
+    unsigned long long start_us, end_us, start_cycles, end_cycles;
+
+    printf("\n=========================================================\n\n");
+    printf("test hash throughput (cycles are TSC ticks, 0 if not available):\n");
+
+    data = cra_malloc(4096 + 8);
+    for (size_t i = 0; i < 4096 + 8; i++)
+        data[i] = (char)('a' + rand() % 26);
+
+    for (int i = 0; i < (int)CRA_NARRAY(lens); i++)
+    {
+        rounds = total / lens[i];
+        // 每次hash不同的位置，避免编译器把循环提出去
+        sum = 0;
+        start_us = cra_tick_us();
+        start_cycles = bench_cycles();
+        for (size_t j = 0; j < rounds; j++)
+            sum += hash_bkdr_n(data + (j & 7), lens[i]);
+        end_cycles = bench_cycles();
+        end_us = cra_tick_us();
+        printf("\tlen %4zu bkdr:   %7.3f bytes/cycle, %6.2f GB/s (%zd)\n", lens[i],
+               (double)total / (double)(end_cycles - start_cycles + 1), (double)total / (end_us - start_us + 1) / 1000,
+               sum & 1);
+
+        sum = 0;
+        start_us = cra_tick_us();
+        start_cycles = bench_cycles();
+        for (size_t j = 0; j < rounds; j++)
+            sum += cra_hash_bytes(data + (j & 7), lens[i]);
+        end_cycles = bench_cycles();
+        end_us = cra_tick_us();
+        printf("\tlen %4zu wyhash: %7.3f bytes/cycle, %6.2f GB/s (%zd)\n", lens[i],
+               (double)total / (double)(end_cycles - start_cycles + 1), (double)total / (end_us - start_us + 1) / 1000,
+               sum & 1);
+    }
+
+    cra_free(data);
+}
+
+// 同样的内容另外复制一份，查找时不能只比较指针
+static char **
+make_str_keys(size_t n, size_t len)
+{
+    char **strs = cra_malloc(sizeof(char *) * n * 2);
+    for (size_t i = 0; i < n; i++)
+    {
+        strs[i] = cra_malloc(len + 1);
+        // 共同的前缀，不同的后缀
+        memset(strs[i], 'k', len);
+        snprintf(strs[i] + len - 12, 13, "%012zu", i * 7919);
+        strs[n + i] = cra_malloc(len + 1);
+        memcpy(strs[n + i], strs[i], len + 1);
+    }
+    return strs;
+}
+
+static void
+test_strkey_performance(size_t n)
+{
+    char         **strs;
+    size_t         lens[] = { 16, 32, 256 }; // 16: 内联存放
+    size_t         found;
+    CraStrKey      key;
+    CraStrKey     *queries;
+    CraDict        dict;
+    unsigned long  start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+
+    queries = cra_malloc(sizeof(CraStrKey) * n);
+    for (int i = 0; i < (int)CRA_NARRAY(lens); i++)
+    {
+        printf("test string key[%zu], key length %zu:\n", n, lens[i]);
+        strs = make_str_keys(n, lens[i]);
+
+        assert_always(cra_dict_init(char *, size_t, &dict, cra_hash_string1_p, cra_cmp_string_p));
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            cra_dict_put(&dict, &strs[j], &j);
+        end_ms = cra_tick_ms();
+        printf("\tchar *    put: %4lums.", end_ms - start_ms);
+        found = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            found += cra_dict_get_ref(&dict, &strs[n + (j * 31) % n]) != NULL;
+        end_ms = cra_tick_ms();
+        printf("  get: %4lums. (found %zu)\n", end_ms - start_ms, found);
+        cra_dict_uninit(&dict);
+
+        assert_always(cra_dict_init(CraStrKey, size_t, &dict, cra_hash_strkey_p, cra_cmp_strkey_p));
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+        {
+            cra_strkey_init(&key, strs[j], lens[i]);
+            cra_dict_put(&dict, &key, &j);
+        }
+        end_ms = cra_tick_ms();
+        // 包括复制字符串的时间
+        printf("\tCraStrKey put: %4lums.", end_ms - start_ms);
+        // 查找时需要先构造key(算一次hash)，计入时间
+        found = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+        {
+            cra_strkey_view(&key, strs[n + (j * 31) % n], lens[i]);
+            found += cra_dict_get_ref(&dict, &key) != NULL;
+        }
+        end_ms = cra_tick_ms();
+        printf("  get: %4lums. (found %zu)\n", end_ms - start_ms, found);
+        // key已经构造好(hash已缓存)，比如同一个key查多个字典
+        for (size_t j = 0; j < n; j++)
+            cra_strkey_view(&queries[j], strs[n + (j * 31) % n], lens[i]);
+        found = 0;
+        start_ms = cra_tick_ms();
+        for (size_t j = 0; j < n; j++)
+            found += cra_dict_get_ref(&dict, &queries[j]) != NULL;
+        end_ms = cra_tick_ms();
+        printf("\tCraStrKey get with cached hash: %4lums. (found %zu)\n", end_ms - start_ms, found);
+        CRA_FOREACH(CRA_DICT_ITERABLE_I, &dict, kv)
+        {
+            cra_strkey_uninit((CraStrKey *)kv.key_ref);
+        }
+        cra_dict_uninit(&dict);
+
+        for (size_t j = 0; j < n * 2; j++)
+            cra_free(strs[j]);
+        cra_free(strs);
+    }
+    cra_free(queries);
+}
+
+static void
+test_sort_performance(int n)
+{
+    const char   *names[] = { "sorted", "reversed", "random", "many duplicates" };
+    int          *data;
+    CraAList      list;
+    unsigned long start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+    printf("test alist sort[%d]:\n", n);
+
+    data = cra_malloc(sizeof(int) * n);
+    assert_always(cra_alist_init_with_size(int, &list, n));
+    for (int p = 0; p < (int)CRA_NARRAY(names); p++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            switch (p)
+            {
+                case 0:
+                    data[i] = i;
+                    break;
+                case 1:
+                    data[i] = n - i;
+                    break;
+                case 2:
+                    data[i] = rand_large();
+                    break;
+                default:
+                    data[i] = rand() % 16;
+                    break;
+            }
+        }
+        printf("\t%s:\n", names[p]);
+
+        memcpy(list.array, data, sizeof(int) * n);
+        list.count = n;
+        start_ms = cra_tick_ms();
+        cra_alist_sort(&list, (cra_cmp_fn)cra_cmp_int_p);
+        end_ms = cra_tick_ms();
+        printf("\t\tpdqsort:    %4lums.\n", end_ms - start_ms);
+
+        memcpy(list.array, data, sizeof(int) * n);
+        start_ms = cra_tick_ms();
+        cra_alist_radix_sort(&list, CRA_RADIX_KEY_INT);
+        end_ms = cra_tick_ms();
+        printf("\t\tradix sort: %4lums.\n", end_ms - start_ms);
+
+        memcpy(list.array, data, sizeof(int) * n);
+        start_ms = cra_tick_ms();
+        qsort(list.array, n, sizeof(int), (int (*)(const void *, const void *))cra_cmp_int_p);
+        end_ms = cra_tick_ms();
+        printf("\t\tqsort:      %4lums.\n", end_ms - start_ms);
+    }
+    cra_alist_uninit(&list);
+    cra_free(data);
+}
+
+static void
+test_seglist_performance(size_t n)
+{
+    int64_t            val;
+    long long          sum;
+    CraAList           list;
+    CraSegList         seglist;
+    unsigned long      start_ms, end_ms;
+    unsigned long long t, worst;
+
+    printf("\n=========================================================\n\n");
+    printf("test seglist vs alist[%zu] (int64_t):\n", n);
+
+    // append: alist扩容时会复制整个数组，seglist只添加一段
+    assert_always(cra_alist_init(int64_t, &list));
+    worst = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+    {
+        val = (int64_t)i;
+        t = cra_tick_us();
+        cra_alist_append(&list, &val);
+        t = cra_tick_us() - t;
+        if (t > worst)
+            worst = t;
+    }
+    end_ms = cra_tick_ms();
+    printf("	alist   append:      %4lums. worst single append: %lluus\n", end_ms - start_ms, worst);
+
+    assert_always(cra_seglist_init(int64_t, &seglist));
+    worst = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+    {
+        val = (int64_t)i;
+        t = cra_tick_us();
+        cra_seglist_append(&seglist, &val);
+        t = cra_tick_us() - t;
+        if (t > worst)
+            worst = t;
+    }
+    end_ms = cra_tick_ms();
+    printf("	seglist append:      %4lums. worst single append: %lluus\n", end_ms - start_ms, worst);
+
+    // 随机访问
+    sum = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+        sum += *(int64_t *)cra_alist_get_ref(&list, (size_t)rand_large() % n);
+    end_ms = cra_tick_ms();
+    printf("	alist   random get:  %4lums. sum: %lld\n", end_ms - start_ms, sum);
+    sum = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+        sum += *(int64_t *)cra_seglist_get_ref(&seglist, (size_t)rand_large() % n);
+    end_ms = cra_tick_ms();
+    printf("	seglist random get:  %4lums. sum: %lld\n", end_ms - start_ms, sum);
+
+    // 遍历
+    sum = 0;
+    start_ms = cra_tick_ms();
+    CRA_FOREACH(CRA_ALIST_ITERABLE_I, &list, v)
+    {
+        sum += *(int64_t *)v.val_ref;
+    }
+    end_ms = cra_tick_ms();
+    printf("	alist   iter:        %4lums. sum: %lld\n", end_ms - start_ms, sum);
+    sum = 0;
+    start_ms = cra_tick_ms();
+    CRA_FOREACH(CRA_SEGLIST_ITERABLE_I, &seglist, v)
+    {
+        sum += *(int64_t *)v.val_ref;
+    }
+    end_ms = cra_tick_ms();
+    printf("	seglist iter:        %4lums. sum: %lld\n", end_ms - start_ms, sum);
+
+    cra_alist_uninit(&list);
+    cra_seglist_uninit(&seglist);
+}
+
+typedef struct
+{
+    int64_t id;
+    int64_t ts;
+    double  value;
+    int64_t flags;
+} BatchRec;
+
+static void
+test_batch_performance(size_t n, size_t batch)
+{
+    BatchRec     *recs;
+    CraAList      list;
+    CraDeque      deque;
+    unsigned long start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+    printf("test batch ops[%zu records, batch %zu] (%zu bytes/record):\n", n, batch, sizeof(BatchRec));
+
+    recs = cra_malloc(sizeof(BatchRec) * batch);
+    for (size_t i = 0; i < batch; i++)
+        recs[i] = (BatchRec){ (int64_t)i, (int64_t)i * 10, (double)i, 0 };
+
+    assert_always(cra_alist_init(BatchRec, &list));
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i += batch)
+    {
+        for (size_t j = 0; j < batch; j++)
+            cra_alist_append(&list, recs + j);
+    }
+    end_ms = cra_tick_ms();
+    printf("\talist append x %-4zu:      %4lums.\n", batch, end_ms - start_ms);
+    cra_alist_clear(&list);
+    assert_always(cra_alist_reserve(&list, 0));
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i += batch)
+        cra_alist_extend(&list, recs, batch);
+    end_ms = cra_tick_ms();
+    printf("\talist extend:              %4lums.\n", end_ms - start_ms);
+    start_ms = cra_tick_ms();
+    while (list.count >= batch)
+    {
+        for (size_t j = 0; j < batch; j++)
+            cra_alist_pop_back(&list, recs + j);
+    }
+    end_ms = cra_tick_ms();
+    printf("\talist pop_back x %-4zu:    %4lums.\n", batch, end_ms - start_ms);
+    assert_always(cra_alist_extend(&list, recs, batch));
+    cra_alist_uninit(&list);
+
+    assert_always(cra_deque_init(BatchRec, &deque));
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i += batch)
+    {
+        for (size_t j = 0; j < batch; j++)
+            cra_deque_push_back(&deque, recs + j);
+    }
+    end_ms = cra_tick_ms();
+    printf("\tdeque push_back x %-4zu:   %4lums.\n", batch, end_ms - start_ms);
+    start_ms = cra_tick_ms();
+    while (deque.count >= batch)
+    {
+        for (size_t j = 0; j < batch; j++)
+            cra_deque_pop_front(&deque, recs + j);
+    }
+    end_ms = cra_tick_ms();
+    printf("\tdeque pop_front x %-4zu:   %4lums.\n", batch, end_ms - start_ms);
+    cra_deque_uninit(&deque);
+
+    assert_always(cra_deque_init(BatchRec, &deque));
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i += batch)
+        cra_deque_push_back_n(&deque, recs, batch);
+    end_ms = cra_tick_ms();
+    printf("\tdeque push_back_n:         %4lums.\n", end_ms - start_ms);
+    start_ms = cra_tick_ms();
+    while (deque.count >= batch)
+        cra_deque_pop_front_n(&deque, recs, batch);
+    end_ms = cra_tick_ms();
+    printf("\tdeque pop_front_n:         %4lums.\n", end_ms - start_ms);
+    cra_deque_uninit(&deque);
+
+    cra_free(recs);
+}
+
+static void
+test_ringdq_performance(size_t n)
+{
+    int           val;
+    long long     sum;
+    CraDeque      deque;
+    CraRingdq     ringdq;
+    CraRingdqSpan spans[2];
+    size_t        nspans;
+    unsigned long start_ms, end_ms;
+
+    printf("\n=========================================================\n\n");
+    printf("test ringdq vs deque[%zu] (int):\n", n);
+
+    assert_always(cra_deque_init(int, &deque));
+    assert_always(cra_ringdq_init(int, &ringdq));
+
+    // FIFO: 保持队列中有1024个元素
+    start_ms = cra_tick_ms();
+    for (int i = 0; i < (int)n; i++)
+    {
+        cra_deque_push_back(&deque, &i);
+        if (deque.count > 1024)
+            cra_deque_pop_front(&deque, &val);
+    }
+    end_ms = cra_tick_ms();
+    printf("\tdeque  fifo:        %4lums.\n", end_ms - start_ms);
+    start_ms = cra_tick_ms();
+    for (int i = 0; i < (int)n; i++)
+    {
+        cra_ringdq_push_back(&ringdq, &i);
+        if (ringdq.count > 1024)
+            cra_ringdq_pop_front(&ringdq, &val);
+    }
+    end_ms = cra_tick_ms();
+    printf("\tringdq fifo:        %4lums.\n", end_ms - start_ms);
+
+    cra_deque_clear(&deque);
+    cra_ringdq_clear(&ringdq);
+    for (int i = 0; i < (int)n; i++)
+    {
+        cra_deque_push_back(&deque, &i);
+        cra_ringdq_push_back(&ringdq, &i);
+    }
+
+    // 随机访问
+    sum = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+        sum += *(int *)cra_deque_get_ref(&deque, (size_t)rand_large() % n);
+    end_ms = cra_tick_ms();
+    printf("\tdeque  random get:  %4lums. sum: %lld\n", end_ms - start_ms, sum);
+    sum = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+        sum += *(int *)cra_ringdq_get_ref(&ringdq, (size_t)rand_large() % n);
+    end_ms = cra_tick_ms();
+    printf("\tringdq random get:  %4lums. sum: %lld\n", end_ms - start_ms, sum);
+
+    // 遍历
+    sum = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+        sum += *(int *)cra_deque_get_ref(&deque, i);
+    end_ms = cra_tick_ms();
+    printf("\tdeque  index scan:  %4lums. sum: %lld\n", end_ms - start_ms, sum);
+    sum = 0;
+    start_ms = cra_tick_ms();
+    for (size_t i = 0; i < n; i++)
+        sum += *(int *)cra_ringdq_get_ref(&ringdq, i);
+    end_ms = cra_tick_ms();
+    printf("\tringdq index scan:  %4lums. sum: %lld\n", end_ms - start_ms, sum);
+    sum = 0;
+    start_ms = cra_tick_ms();
+    nspans = cra_ringdq_peek_spans(&ringdq, ringdq.count, spans);
+    for (size_t s = 0; s < nspans; s++)
+    {
+        for (size_t i = 0; i < spans[s].count; i++)
+            sum += ((int *)spans[s].array)[i];
+    }
+    end_ms = cra_tick_ms();
+    printf("\tringdq span scan:   %4lums. sum: %lld\n", end_ms - start_ms, sum);
+
+    cra_deque_uninit(&deque);
+    cra_ringdq_uninit(&ringdq);
+}
+
 int
 main(void)
 {
@@ -416,9 +1441,30 @@ main(void)
 
     test_alist_performance(sizes);
     test_llist_performance(sizes);
+    test_llist_nodepool_performance(10000000);
+    test_llist_sort_performance(1000000);
     test_deque_performance(sizes);
+    test_ringdq_performance(10000000);
     sizes[3] = 1000000;
-    test_dict_performance(sizes);
+    test_dict_performance(sizes, CRA_DICT_FLAG_NONE);
+    test_dict_performance(sizes, CRA_DICT_FLAG_POW2);
+    test_dict_rehash_performance(sizes);
+    test_hash_performance();
+    test_strkey_performance(1000000);
+    test_seglist_performance(10000000);
+    test_sort_performance(1000000);
+    test_batch_performance(10000000, 512);
+    test_batch_performance(10000000, 4096);
+    //                    百万     千万(一亿需要约6GB内存)
+    int batch_sizes[] = { 1000000, 10000000, 0 };
+    test_dict_batch_performance(batch_sizes);
+    test_dict_freeze_performance(batch_sizes);
+    test_perfectdict_performance(sizes);
+    test_dict_split_performance(500000);
+    test_swissdict_performance(sizes);
+    // alist的add_sort是O(n^2)，不测百万以上
+    int btree_sizes[] = { 1000, 10000, 100000, 0 };
+    test_btree_performance(btree_sizes);
 
     cra_memory_leak_report();
     return 0;
@@ -404,6 +404,252 @@ test_sort(void)
     cra_alist_uninit(&list);
 }
 
+static size_t s_ncmp;
+
+static int
+compare_int_counted(const int *a, const int *b)
+{
+    ++s_ncmp;
+    return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+typedef struct
+{
+    int  key;
+    int  seq;
+    char pad[4];
+} Rec12;
+
+static int
+compare_rec12(const Rec12 *a, const Rec12 *b)
+{
+    return a->key < b->key ? -1 : (a->key > b->key ? 1 : 0);
+}
+
+static void
+fill_pattern(CraAList *list, int pattern, int n)
+{
+    cra_alist_clear(list);
+    for (int i = 0; i < n; i++)
+    {
+        int v;
+        switch (pattern)
+        {
+            case 0: // 有序
+                v = i;
+                break;
+            case 1: // 逆序
+                v = n - i;
+                break;
+            case 2: // 全部相同
+                v = 7;
+                break;
+            case 3: // 少量不同值
+                v = rand() % 4;
+                break;
+            case 4: // 先升后降
+                v = i < n / 2 ? i : n - i;
+                break;
+            case 5: // 有序但末尾有少量乱序
+                v = i < n - 5 ? i : rand();
+                break;
+            default: // 随机(包括负数)
+                v = rand() - RAND_MAX / 2;
+                break;
+        }
+        assert_always(cra_alist_append(list, &v));
+    }
+}
+
+void
+test_sort_patterns(void)
+{
+    int       sizes[] = { 0, 1, 2, 3, 23, 24, 25, 127, 128, 129, 1000, 100000 };
+    long long sum1, sum2;
+    CraAList  list;
+
+    assert_always(cra_alist_init(int, &list));
+    for (int p = 0; p <= 6; p++)
+    {
+        for (size_t k = 0; k < CRA_NARRAY(sizes); k++)
+        {
+            int n = sizes[k];
+            fill_pattern(&list, p, n);
+            sum1 = 0;
+            for (int i = 0; i < n; i++)
+                sum1 += *(int *)cra_alist_get_ref(&list, i);
+
+            s_ncmp = 0;
+            assert_always(cra_alist_sort(&list, compare_int_counted));
+            // 有序/逆序/全相同的输入是线性的
+            if (n == 100000 && (p == 0 || p == 1 || p == 2))
+                assert_always(s_ncmp < (size_t)n * 4);
+
+            sum2 = 0;
+            for (int i = 0; i < n; i++)
+            {
+                sum2 += *(int *)cra_alist_get_ref(&list, i);
+                if (i > 0)
+                    assert_always(*(int *)cra_alist_get_ref(&list, i - 1) <= *(int *)cra_alist_get_ref(&list, i));
+            }
+            assert_always(sum1 == sum2);
+        }
+    }
+    cra_alist_uninit(&list);
+
+    // 非4/8字节的元素
+    assert_always(cra_alist_init(Rec12, &list));
+    for (int i = 0; i < 50000; i++)
+    {
+        Rec12 r = { .key = rand() % 1000, .seq = i };
+        assert_always(cra_alist_append(&list, &r));
+    }
+    assert_always(cra_alist_sort(&list, compare_rec12));
+    for (size_t i = 1; i < list.count; i++)
+        assert_always(((Rec12 *)cra_alist_get_ref(&list, i - 1))->key <= ((Rec12 *)cra_alist_get_ref(&list, i))->key);
+    cra_alist_uninit(&list);
+}
+
+void
+test_radix_sort(void)
+{
+    CraAList list, expect;
+
+    // int
+    assert_always(cra_alist_init(int, &list));
+    assert_always(cra_alist_init(int, &expect));
+    for (int p = 0; p <= 6; p++)
+    {
+        fill_pattern(&list, p, 20000);
+        cra_alist_clear(&expect);
+        for (size_t i = 0; i < list.count; i++)
+            assert_always(cra_alist_append(&expect, (int *)cra_alist_get_ref(&list, i)));
+        assert_always(cra_alist_sort(&expect, compare_int_counted));
+        assert_always(cra_alist_radix_sort(&list, CRA_RADIX_KEY_INT));
+        assert_always(memcmp(list.array, expect.array, list.count * sizeof(int)) == 0);
+    }
+    cra_alist_uninit(&list);
+    cra_alist_uninit(&expect);
+
+    // uint8_t / uint64_t
+    assert_always(cra_alist_init(uint8_t, &list));
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_alist_append(&list, &(uint8_t){ (uint8_t)(rand() & 0xff) }));
+    assert_always(cra_alist_radix_sort(&list, CRA_RADIX_KEY_UINT));
+    for (size_t i = 1; i < list.count; i++)
+        assert_always(list.array[i - 1] <= list.array[i]);
+    cra_alist_uninit(&list);
+
+    assert_always(cra_alist_init(uint64_t, &list));
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_alist_append(&list, &(uint64_t){ ((uint64_t)rand() << 40) ^ (uint64_t)rand() }));
+    assert_always(cra_alist_append(&list, &(uint64_t){ UINT64_MAX }));
+    assert_always(cra_alist_append(&list, &(uint64_t){ 0 }));
+    assert_always(cra_alist_radix_sort(&list, CRA_RADIX_KEY_UINT));
+    for (size_t i = 1; i < list.count; i++)
+        assert_always(*(uint64_t *)cra_alist_get_ref(&list, i - 1) <= *(uint64_t *)cra_alist_get_ref(&list, i));
+    assert_always(*(uint64_t *)cra_alist_get_ref(&list, list.count - 1) == UINT64_MAX);
+    cra_alist_uninit(&list);
+
+    // int64_t 正负混合
+    assert_always(cra_alist_init(int64_t, &list));
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_alist_append(&list, &(int64_t){ ((int64_t)rand() - RAND_MAX / 2) * 1000003 }));
+    assert_always(cra_alist_append(&list, &(int64_t){ INT64_MIN }));
+    assert_always(cra_alist_append(&list, &(int64_t){ INT64_MAX }));
+    assert_always(cra_alist_radix_sort(&list, CRA_RADIX_KEY_INT));
+    for (size_t i = 1; i < list.count; i++)
+        assert_always(*(int64_t *)cra_alist_get_ref(&list, i - 1) <= *(int64_t *)cra_alist_get_ref(&list, i));
+    assert_always(*(int64_t *)cra_alist_get_ref(&list, 0) == INT64_MIN);
+    cra_alist_uninit(&list);
+
+    // float/double
+    assert_always(cra_alist_init(float, &list));
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_alist_append(&list, &(float){ (float)(rand() - RAND_MAX / 2) / 1000.0f }));
+    assert_always(cra_alist_append(&list, &(float){ -0.0f }));
+    assert_always(cra_alist_append(&list, &(float){ 1e30f }));
+    assert_always(cra_alist_append(&list, &(float){ -1e30f }));
+    assert_always(cra_alist_radix_sort(&list, CRA_RADIX_KEY_FLOAT));
+    for (size_t i = 1; i < list.count; i++)
+        assert_always(*(float *)cra_alist_get_ref(&list, i - 1) <= *(float *)cra_alist_get_ref(&list, i));
+    assert_always(*(float *)cra_alist_get_ref(&list, 0) == -1e30f);
+    cra_alist_uninit(&list);
+
+    assert_always(cra_alist_init(double, &list));
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_alist_append(&list, &(double){ (double)(rand() - RAND_MAX / 2) * 1.5e-3 }));
+    assert_always(cra_alist_radix_sort(&list, CRA_RADIX_KEY_FLOAT));
+    for (size_t i = 1; i < list.count; i++)
+        assert_always(*(double *)cra_alist_get_ref(&list, i - 1) <= *(double *)cra_alist_get_ref(&list, i));
+    cra_alist_uninit(&list);
+
+    // 按结构体字段排序，稳定
+    assert_always(cra_alist_init(Rec12, &list));
+    for (int i = 0; i < 50000; i++)
+    {
+        Rec12 r = { .key = rand() % 1000 - 500, .seq = i };
+        assert_always(cra_alist_append(&list, &r));
+    }
+    assert_always(cra_alist_radix_sort_by(&list, CRA_RADIX_KEY_INT, Rec12, key));
+    for (size_t i = 1; i < list.count; i++)
+    {
+        Rec12 *a = cra_alist_get_ref(&list, i - 1);
+        Rec12 *b = cra_alist_get_ref(&list, i);
+        assert_always(a->key < b->key || (a->key == b->key && a->seq < b->seq));
+    }
+    cra_alist_uninit(&list);
+}
+
+void
+test_range(void)
+{
+    int      vals[1000], out[1000], val;
+    CraAList list;
+
+    for (int i = 0; i < 1000; i++)
+        vals[i] = i;
+    assert_always(cra_alist_init(int, &list));
+
+    assert_always(cra_alist_extend(&list, vals, 0) && list.count == 0);
+    assert_always(!cra_alist_insert_range(&list, 1, vals, 10));
+    // 一次扩容就够
+    assert_always(cra_alist_extend(&list, vals, 1000));
+    assert_always(list.count == 1000 && list.capacity >= 1000);
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_alist_get(&list, i, &val) && val == i);
+
+    // [0, 100) [0, 10) [100, 1000) [0, 5)
+    assert_always(cra_alist_insert_range(&list, 100, vals, 10));
+    assert_always(cra_alist_extend(&list, vals, 5));
+    assert_always(list.count == 1015);
+    for (int i = 0; i < 1015; i++)
+    {
+        int expect = i < 100 ? i : (i < 110 ? i - 100 : (i < 1010 ? i - 10 : i - 1010));
+        assert_always(cra_alist_get(&list, i, &val) && val == expect);
+    }
+
+    assert_always(!cra_alist_pop_range(&list, 1000, 16, out));
+    assert_always(!cra_alist_remove_range(&list, 1016, 0));
+    assert_always(list.count == 1015);
+    assert_always(cra_alist_pop_range(&list, 100, 10, out));
+    for (int i = 0; i < 10; i++)
+        assert_always(out[i] == i);
+    assert_always(cra_alist_remove_range(&list, 1000, 5));
+    assert_always(cra_alist_pop_range(&list, 0, 3, out));
+    assert_always(out[0] == 0 && out[1] == 1 && out[2] == 2);
+    assert_always(list.count == 997);
+    for (int i = 0; i < 997; i++)
+        assert_always(cra_alist_get(&list, i, &val) && val == i + 3);
+
+    // prepend range
+    assert_always(cra_alist_insert_range(&list, 0, vals, 3));
+    assert_always(cra_alist_pop_range(&list, 0, 1000, out));
+    assert_always(list.count == 0 && memcmp(out, vals, sizeof(vals)) == 0);
+
+    cra_alist_uninit(&list);
+}
+
 void
 test_foreach(void)
 {
@@ -548,10 +794,13 @@ main(void)
     test_new_delete();
     test_add();
     test_remove();
+    test_range();
     test_set();
     test_get();
     test_reverse();
     test_sort();
+    test_sort_patterns();
+    test_radix_sort();
     test_foreach();
     test_test();
 
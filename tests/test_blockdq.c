@@ -0,0 +1,218 @@
+/**
+ * @file test_blockdq.c
+ * @author Cracal
+ * @brief test blocking double-ended queue
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "threads/cra_blockdq.h"
+#include "threads/cra_thread.h"
+#include "cra_time.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+
+void
+test_push_pop_n(void)
+{
+    int        vals[100], rets[100];
+    size_t     ndrop;
+    CraBlockdq deque;
+
+    for (int i = 0; i < 100; i++)
+        vals[i] = i;
+
+    assert_always(cra_blockdq_init(int, &deque, CRA_BLOCKDQ_INFINITE, CRA_BLOCKDQ_FULL_WAIT));
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 100, NULL, &ndrop) == 100);
+    assert_always(ndrop == 0);
+    assert_always(deque.deque.count == 100);
+
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 30, -1) == 30);
+    for (int i = 0; i < 30; i++)
+        assert_always(rets[i] == i);
+    // 不足max时取出全部
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 100, -1) == 70);
+    for (int i = 0; i < 70; i++)
+        assert_always(rets[i] == i + 30);
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 100, 0) == 0);
+
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&deque);
+}
+
+void
+test_push_n_full(void)
+{
+    int        vals[10], rets[10], drops[10];
+    size_t     ndrop;
+    CraBlockdq deque;
+
+    for (int i = 0; i < 10; i++)
+        vals[i] = i + 1;
+
+    // 与逐个push_back一致
+    assert_always(cra_blockdq_init(int, &deque, 4, CRA_BLOCKDQ_FULL_DROP_OLDEST));
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 6, drops, &ndrop) == 6);
+    assert_always(ndrop == 2 && drops[0] == 1 && drops[1] == 2);
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 10, 0) == 4);
+    for (int i = 0; i < 4; i++)
+        assert_always(rets[i] == i + 3);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&deque);
+
+    assert_always(cra_blockdq_init(int, &deque, 4, CRA_BLOCKDQ_FULL_DROP_NEWEST));
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 6, drops, &ndrop) == 6);
+    assert_always(ndrop == 2 && drops[0] == 4 && drops[1] == 5);
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 10, 0) == 4);
+    assert_always(rets[0] == 1 && rets[1] == 2 && rets[2] == 3 && rets[3] == 6);
+    // retdrops可以为NULL
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 10, NULL, &ndrop) == 10);
+    assert_always(ndrop == 6);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&deque);
+
+    assert_always(cra_blockdq_init(int, &deque, 4, CRA_BLOCKDQ_FULL_RETURN_FALSE));
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 3, NULL, NULL) == 3);
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 3, NULL, NULL) == 1);
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 3, NULL, NULL) == 0);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ENQUEUE);
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 3, NULL, NULL) == 0);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_DEQUEUE);
+    // 关闭出队后仍然可以取出剩余的元素
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 10, -1) == 4);
+    assert_always(cra_blockdq_pop_front_n(&deque, rets, 10, -1) == 0);
+    cra_blockdq_uninit(&deque);
+}
+
+void
+test_try_push(void)
+{
+    int        val, ret;
+    CraBlockdq deque;
+
+    // 满了就返回false，不等待也不丢弃
+    assert_always(cra_blockdq_init(int, &deque, 2, CRA_BLOCKDQ_FULL_WAIT));
+    for (val = 1; val <= 2; val++)
+        assert_always(cra_blockdq_try_push_back(&deque, &val));
+    assert_always(!cra_blockdq_try_push_back(&deque, &val));
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&deque);
+
+    assert_always(cra_blockdq_init(int, &deque, 2, CRA_BLOCKDQ_FULL_DROP_OLDEST));
+    for (val = 1; val <= 3; val++)
+        assert_always(cra_blockdq_try_push_back(&deque, &val) == (val <= 2));
+    assert_always(cra_blockdq_pop_front(&deque, &ret) && ret == 1);
+    assert_always(cra_blockdq_pop_front(&deque, &ret) && ret == 2);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ENQUEUE);
+    assert_always(!cra_blockdq_try_push_back(&deque, &val));
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_DEQUEUE);
+    cra_blockdq_uninit(&deque);
+}
+
+void
+test_pop_n_timeout(void)
+{
+    int           val;
+    unsigned long start;
+    CraBlockdq    deque;
+
+    assert_always(cra_blockdq_init(int, &deque, 8, CRA_BLOCKDQ_FULL_WAIT));
+    start = cra_tick_ms();
+    assert_always(cra_blockdq_pop_front_n(&deque, &val, 1, 50) == 0);
+    assert_always(cra_tick_ms() - start >= 50);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&deque);
+}
+
+void
+test_drain(void)
+{
+    int        vals[1000], val;
+    CraDeque   out;
+    CraBlockdq deque;
+
+    for (int i = 0; i < 1000; i++)
+        vals[i] = i;
+
+    assert_always(cra_blockdq_init(int, &deque, CRA_BLOCKDQ_INFINITE, CRA_BLOCKDQ_FULL_WAIT));
+    assert_always(cra_deque_init(int, &out));
+    assert_always(cra_blockdq_drain(&deque, &out) == 0);
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 1000, NULL, NULL) == 1000);
+    assert_always(cra_blockdq_drain(&deque, &out) == 1000);
+    assert_always(out.count == 1000 && deque.deque.count == 0);
+    for (int i = 0; i < 1000; i++)
+    {
+        assert_always(cra_deque_pop_front(&out, &val));
+        assert_always(val == i);
+    }
+    // 交换后的存储可以继续使用
+    assert_always(cra_blockdq_push_back_n(&deque, vals, 10, NULL, NULL) == 10);
+    assert_always(cra_blockdq_drain(&deque, &out) == 10);
+    assert_always(out.count == 10);
+
+    cra_deque_uninit(&out);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&deque);
+}
+
+#define NITEMS 200000
+#define NBATCH 37
+
+static CRA_THRD_FUNC(producer_func)
+{
+    int         vals[NBATCH];
+    int         next = 0;
+    size_t      n;
+    CraBlockdq *deque = (CraBlockdq *)arg;
+
+    while (next < NITEMS)
+    {
+        n = (size_t)CRA_MIN(NBATCH, NITEMS - next);
+        for (size_t i = 0; i < n; i++)
+            vals[i] = next + (int)i;
+        assert_always(cra_blockdq_push_back_n(deque, vals, n, NULL, NULL) == n);
+        next += (int)n;
+    }
+    cra_blockdq_shutdown(deque, CRA_BLOCKDQ_CLOSE_ENQUEUE);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+void
+test_threads(void)
+{
+    int        rets[64];
+    int        expect = 0;
+    size_t     n;
+    cra_thrd_t thrd;
+    CraBlockdq deque;
+
+    // 容量小于批量，生产者需要在push_back_n中途等待
+    assert_always(cra_blockdq_init(int, &deque, 16, CRA_BLOCKDQ_FULL_WAIT));
+    assert_always(cra_thrd_create(&thrd, producer_func, &deque));
+    while (expect < NITEMS)
+    {
+        n = cra_blockdq_pop_front_n(&deque, rets, 64, -1);
+        assert_always(n > 0);
+        for (size_t i = 0; i < n; i++)
+            assert_always(rets[i] == expect++);
+    }
+    cra_thrd_join(thrd);
+    cra_blockdq_shutdown(&deque, CRA_BLOCKDQ_CLOSE_DEQUEUE);
+    cra_blockdq_uninit(&deque);
+}
+
+int
+main(void)
+{
+    test_push_pop_n();
+    test_push_n_full();
+    test_try_push();
+    test_pop_n_timeout();
+    test_drain();
+    test_threads();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,400 @@
+/**
+ * @file test_btree.c
+ * @author Cracal
+ * @brief test ordered dictionary(B+ tree)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_btree.h"
+#include "serialize/cra_json.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include <time.h>
+
+// 检查树中的key严格递增，且与present一致
+static void
+check_tree(CraBTree *tree, bool *present, int *vals, int n)
+{
+    ssize_t count = 0;
+    int     prev = -1;
+
+    CRA_FOREACH(CRA_BTREE_ITERABLE_I, tree, kv)
+    {
+        int key = *(int *)kv.key_ref;
+        assert_always(key > prev);
+        assert_always(key < n && present[key]);
+        assert_always(*(int *)kv.val_ref == vals[key]);
+        prev = key;
+        ++count;
+    }
+    assert_always(count == tree->count);
+
+    prev = n;
+    count = 0;
+    CRA_FOREACH_REVERSE(CRA_BTREE_ITERABLE_I, tree, kv)
+    {
+        int key = *(int *)kv.key_ref;
+        assert_always(key < prev);
+        prev = key;
+        ++count;
+    }
+    assert_always(count == tree->count);
+}
+
+void
+test_put_pop(void)
+{
+    int      key, val;
+    int      n = 20000;
+    bool    *present;
+    int     *vals;
+    ssize_t  count = 0;
+    CraBTree tree;
+
+    present = cra_calloc(n, sizeof(bool));
+    vals = cra_malloc(sizeof(int) * n);
+
+    assert_always(cra_btree_init(int, int, &tree, cra_cmp_int_p));
+    assert_always(tree.count == 0 && tree.height == 1);
+    assert_always(!cra_btree_get(&tree, &(int){ 1 }, &val));
+    assert_always(!cra_btree_remove(&tree, &(int){ 1 }));
+
+    srand((unsigned int)time(NULL));
+    for (int round = 0; round < 4; round++)
+    {
+        // 随机插入
+        for (int i = 0; i < n; i++)
+        {
+            key = rand() % n;
+            val = rand();
+            if (present[key])
+            {
+                assert_always(!cra_btree_add(&tree, &key, &val));
+                assert_always(cra_btree_put(&tree, &key, &val));
+            }
+            else
+            {
+                assert_always(cra_btree_add(&tree, &key, &val));
+                present[key] = true;
+                ++count;
+            }
+            vals[key] = val;
+        }
+        assert_always(tree.count == count);
+        assert_always(tree.height > 1);
+        check_tree(&tree, present, vals, n);
+
+        // 随机删除
+        for (int i = 0; i < n; i++)
+        {
+            key = rand() % n;
+            if (present[key])
+            {
+                assert_always(cra_btree_pop(&tree, &key, &val) && val == vals[key]);
+                present[key] = false;
+                --count;
+            }
+            else
+            {
+                assert_always(!cra_btree_remove(&tree, &key));
+            }
+        }
+        assert_always(tree.count == count);
+        check_tree(&tree, present, vals, n);
+        for (int i = 0; i < n; i++)
+        {
+            assert_always(cra_btree_get(&tree, &i, &val) == present[i]);
+            if (present[i])
+                assert_always(val == vals[i]);
+        }
+    }
+
+    // 全部删除
+    for (int i = 0; i < n; i++)
+    {
+        if (present[i])
+            assert_always(cra_btree_remove(&tree, &i));
+    }
+    assert_always(tree.count == 0 && tree.height == 1);
+    assert_always(tree.first == tree.root && tree.last == tree.root);
+    check_tree(&tree, present, vals, n);
+
+    cra_btree_uninit(&tree);
+    cra_free(present);
+    cra_free(vals);
+}
+
+void
+test_put_and_return(void)
+{
+    int      key, val, oldkey, oldval;
+    CraBTree tree;
+
+    assert_always(cra_btree_init(int, int, &tree, cra_cmp_int_p));
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_btree_put(&tree, &i, &i));
+
+    key = 500;
+    val = -500;
+    assert_always(cra_btree_put_and_return_kv(&tree, &key, &val, &oldkey, &oldval));
+    assert_always(oldkey == 500 && oldval == 500);
+    val = -5000;
+    assert_always(cra_btree_put_and_return_v(&tree, &key, &val, &oldval));
+    assert_always(oldval == -500);
+    assert_always(*(int *)cra_btree_get_ref(&tree, &key) == -5000);
+    assert_always(cra_btree_pop_kv(&tree, &key, &oldkey, &oldval));
+    assert_always(oldkey == 500 && oldval == -5000);
+    assert_always(tree.count == 999);
+
+    cra_btree_clear(&tree);
+    assert_always(tree.count == 0 && tree.height == 1);
+    assert_always(!cra_btree_get_ref(&tree, &key));
+    CRA_FOREACH(CRA_BTREE_ITERABLE_I, &tree, kv)
+    {
+        assert_always(false);
+    }
+    // 清空后可以继续使用
+    for (int i = 1000; i > 0; i--)
+        assert_always(cra_btree_add(&tree, &i, &i));
+    assert_always(tree.count == 1000);
+    assert_always(*(int *)cra_btree_get_ref(&tree, &(int){ 1 }) == 1);
+
+    cra_btree_uninit(&tree);
+}
+
+void
+test_bound(void)
+{
+    int         key, expect;
+    CraPair     kv;
+    CraIterator it;
+    CraBTree    tree;
+
+    assert_always(cra_btree_init(int, int, &tree, cra_cmp_int_p));
+
+    key = 10;
+    assert_always(!cra_btree_lower_bound(&tree, &key, &it));
+    assert_always(!cra_iterable_next(CRA_BTREE_ITERABLE_I, &it, &kv));
+    assert_always(!cra_iterable_prev(CRA_BTREE_ITERABLE_I, &it, &kv));
+
+    // 0, 10, 20, ..., 99990
+    for (int i = 0; i < 10000; i++)
+    {
+        key = i * 10;
+        assert_always(cra_btree_add(&tree, &key, &i));
+    }
+
+    for (key = -5; key < 100010; key += 5)
+    {
+        expect = key <= 0 ? 0 : (key + 9) / 10 * 10;
+        if (cra_btree_lower_bound(&tree, &key, &it))
+        {
+            assert_always(cra_iterable_next(CRA_BTREE_ITERABLE_I, &it, &kv));
+            assert_always(*(int *)kv.key_ref == expect);
+            // 退回去再向前是前一个元素
+            assert_always(cra_iterable_prev(CRA_BTREE_ITERABLE_I, &it, &kv) && *(int *)kv.key_ref == expect);
+            if (expect > 0)
+                assert_always(cra_iterable_prev(CRA_BTREE_ITERABLE_I, &it, &kv) &&
+                              *(int *)kv.key_ref == expect - 10);
+            else
+                assert_always(!cra_iterable_prev(CRA_BTREE_ITERABLE_I, &it, &kv));
+        }
+        else
+        {
+            assert_always(key > 99990);
+            assert_always(!cra_iterable_next(CRA_BTREE_ITERABLE_I, &it, &kv));
+            assert_always(cra_iterable_prev(CRA_BTREE_ITERABLE_I, &it, &kv) && *(int *)kv.key_ref == 99990);
+        }
+
+        expect = key < 0 ? 0 : (key / 10 + 1) * 10;
+        if (cra_btree_upper_bound(&tree, &key, &it))
+        {
+            assert_always(cra_iterable_next(CRA_BTREE_ITERABLE_I, &it, &kv));
+            assert_always(*(int *)kv.key_ref == expect);
+        }
+        else
+        {
+            assert_always(key >= 99990);
+        }
+    }
+
+    cra_btree_uninit(&tree);
+}
+
+void
+test_foreach_range(void)
+{
+    int      from, to, expect;
+    CraBTree tree;
+
+    assert_always(cra_btree_init(int, double, &tree, cra_cmp_int_p));
+    for (int i = 0; i < 5000; i++)
+        assert_always(cra_btree_add(&tree, &(int){ i * 2 }, &(double){ i * 0.5 }));
+
+    for (int i = 0; i < 100; i++)
+    {
+        from = rand() % 11000 - 500;
+        to = from + rand() % 3000;
+        expect = from <= 0 ? 0 : (from + 1) / 2 * 2;
+        CRA_BTREE_FOREACH_RANGE(&tree, &from, &to, kv)
+        {
+            assert_always(*(int *)kv.key_ref == expect);
+            assert_always(*(double *)kv.val_ref == expect * 0.25);
+            expect += 2;
+        }
+        // 不能漏掉 < to 的元素
+        assert_always(expect >= to || expect >= 10000);
+    }
+
+    // 空范围
+    from = 100;
+    to = 100;
+    CRA_BTREE_FOREACH_RANGE(&tree, &from, &to, kv)
+    {
+        assert_always(false);
+    }
+
+    cra_btree_uninit(&tree);
+}
+
+typedef struct
+{
+    char name[24];
+} Name;
+
+static int
+compare_name(const Name *a, const Name *b)
+{
+    return strcmp(a->name, b->name);
+}
+
+void
+test_struct_key(void)
+{
+    Name     name;
+    int      count = 0;
+    CraBTree tree;
+
+    assert_always(cra_btree_init(Name, int, &tree, compare_name));
+    // key较大时节点容纳的key较少
+    assert_always(tree.leaf_capacity < 512 / (sizeof(int) * 2));
+    for (int i = 0; i < 3000; i++)
+    {
+        snprintf(name.name, sizeof(name.name), "name-%05d", i);
+        assert_always(cra_btree_add(&tree, &name, &i));
+    }
+    CRA_FOREACH(CRA_BTREE_ITERABLE_I, &tree, kv)
+    {
+        assert_always(*(int *)kv.val_ref == count);
+        ++count;
+    }
+    assert_always(count == 3000);
+    cra_btree_uninit(&tree);
+}
+
+void
+test_interfaces(void)
+{
+    int                          key, val;
+    CraBTree                     tree;
+    CRA_BTREE_INITIALIZABLE_PARAM_DEF(param, int, int, cra_cmp_int_p);
+
+    assert_always(cra_initializable_init(CRA_BTREE_INITIALIZABLE_I, &tree, 0, &param));
+    for (int i = 100; i > 0; i--)
+    {
+        key = i;
+        val = i * i;
+        assert_always(cra_appendable_append(CRA_BTREE_APPENDABLE_I, &tree, &(CraPair){ &val, &key }));
+        // 已存在时append失败
+        assert_always(!cra_appendable_append(CRA_BTREE_APPENDABLE_I, &tree, &(CraPair){ &val, &key }));
+    }
+    assert_always(tree.count == 100);
+    key = 1;
+    CRA_FOREACH(CRA_BTREE_ITERABLE_I, &tree, kv)
+    {
+        assert_always(*(int *)kv.key_ref == key);
+        assert_always(*(int *)kv.val_ref == key * key);
+        ++key;
+    }
+    cra_initializable_uninit(CRA_BTREE_INITIALIZABLE_I, &tree);
+}
+
+void
+test_json(void)
+{
+    struct T
+    {
+        CraBTree  tree; // BTree<int32_t, int32_t>
+        CraBTree *ptree;
+    };
+
+    CRA_TYPE_META_BEGIN(metaii)
+    CRA_TYPE_META_ELEMENT_INT(int32_t) // key
+    CRA_TYPE_META_ELEMENT_INT(int32_t) // val
+    CRA_TYPE_META_END();
+
+    CRA_BTREE_INITIALIZABLE_PARAM_DEF(param, int32_t, int32_t, cra_cmp_int32_p);
+
+    CRA_TYPE_META_BEGIN(meta)
+    CRA_TYPE_META_MEMBER_DICT(struct T, tree, 1, false, metaii, CRA_BTREE_ITERABLE_I, CRA_BTREE_APPENDABLE_I,
+                              CRA_BTREE_INITIALIZABLE_I, &param)
+    CRA_TYPE_META_MEMBER_DICT(struct T, ptree, 2, true, metaii, CRA_BTREE_ITERABLE_I, CRA_BTREE_APPENDABLE_I,
+                              CRA_BTREE_INITIALIZABLE_I, &param)
+    CRA_TYPE_META_END();
+
+    char     buffer[8192];
+    size_t   length;
+    int32_t  key, val;
+    struct T in, out;
+
+    in.ptree = cra_alloc(CraBTree);
+    cra_btree_init(int32_t, int32_t, &in.tree, cra_cmp_int32_p);
+    cra_btree_init(int32_t, int32_t, in.ptree, cra_cmp_int32_p);
+    for (int32_t i = 0; i < 200; i++)
+    {
+        key = (i * 37) % 200;
+        val = -i;
+        cra_btree_add(&in.tree, &key, &val);
+        if (i % 3 == 0)
+            cra_btree_add(in.ptree, &key, &val);
+    }
+
+    length = sizeof(buffer);
+    assert_always(cra_json_stringify(buffer, &length, false, CRA_SERI_STRUCT(in, false, meta, NULL, NULL)));
+    assert_always(cra_json_parse(buffer, length, CRA_SERI_STRUCT(out, false, meta, NULL, NULL)));
+    assert_always(out.tree.count == in.tree.count);
+    assert_always(out.ptree->count == in.ptree->count);
+    CRA_FOREACH(CRA_BTREE_ITERABLE_I, &in.tree, kv)
+    {
+        assert_always(cra_btree_get(&out.tree, (int32_t *)kv.key_ref, &val) && val == *(int32_t *)kv.val_ref);
+    }
+    CRA_FOREACH(CRA_BTREE_ITERABLE_I, in.ptree, kv)
+    {
+        assert_always(cra_btree_get(out.ptree, (int32_t *)kv.key_ref, &val) && val == *(int32_t *)kv.val_ref);
+    }
+
+    cra_btree_uninit(&in.tree);
+    cra_btree_uninit(in.ptree);
+    cra_btree_uninit(&out.tree);
+    cra_btree_uninit(out.ptree);
+    cra_dealloc(in.ptree);
+    cra_dealloc(out.ptree);
+}
+
+int
+main(void)
+{
+    test_put_pop();
+    test_put_and_return();
+    test_bound();
+    test_foreach_range();
+    test_struct_key();
+    test_interfaces();
+    test_json();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file test_cdict.c
+ * @author Cracal
+ * @brief test concurrent dictionary
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cra_assert.h"
+#include "cra_atomic.h"
+#include "cra_malloc.h"
+#include "threads/cra_cdict.h"
+#include "threads/cra_thread.h"
+
+#define NTHREADS 8
+#define NKEYS    20000
+
+static void
+test_new_delete(void)
+{
+    CraConcurrentDict cdict;
+
+    assert_always(cra_cdict_init(int, float, &cdict, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(cdict.shards);
+    assert_always(cdict.nshards == CRA_CDICT_DEFAULT_SHARDS);
+    assert_always(cdict.key_size == sizeof(int));
+    assert_always(cdict.val_size == sizeof(float));
+    assert_always(cra_cdict_count(&cdict) == 0);
+    cra_cdict_uninit(&cdict);
+    assert_always(memcmp(&cdict, &(CraConcurrentDict){ 0 }, sizeof(CraConcurrentDict)) == 0);
+
+    assert_always(cra_cdict_init_with_size(int, double, &cdict, 1000, 5, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(cdict.nshards == 8);
+    // 每个分片从缓存行边界开始
+    for (size_t i = 0; i < cdict.nshards; i++)
+        assert_always(((uintptr_t)&cdict.shards[i] & (CRA_CACHELINE_SIZE - 1)) == 0);
+    cra_cdict_uninit(&cdict);
+
+    assert_always(cra_cdict_init_with_size(int, double, &cdict, 0, 1, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(cdict.nshards == 1);
+    cra_cdict_uninit(&cdict);
+}
+
+static bool
+compute_square(const int *key, int *retval, cra_atomic_int32_t *ncalls)
+{
+    cra_atomic_inc32(ncalls, CRA_MO_RELAXED);
+    if (*key < 0)
+        return false;
+    *retval = *key * *key;
+    return true;
+}
+
+static void
+test_ops(void)
+{
+    int                val;
+    cra_atomic_int32_t ncalls;
+    CraConcurrentDict  cdict;
+
+    cra_cdict_init(int, int, &cdict, cra_hash_int_p, cra_cmp_int_p);
+
+    assert_always(!cra_cdict_remove(&cdict, &(int){ 0 }));
+    assert_always(!cra_cdict_get(&cdict, &(int){ 0 }, &val));
+
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_cdict_add(&cdict, &i, &(int){ i + 1 }));
+    assert_always(cra_cdict_count(&cdict) == 1000);
+    assert_always(!cra_cdict_add(&cdict, &(int){ 3 }, &(int){ 0 }));
+    assert_always(cra_cdict_put_and_return_v(&cdict, &(int){ 3 }, &(int){ 30 }, &val) && val == 4);
+    assert_always(cra_cdict_get(&cdict, &(int){ 3 }, &val) && val == 30);
+    assert_always(cra_cdict_put(&cdict, &(int){ 3 }, &(int){ 4 }));
+
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_cdict_get(&cdict, &i, &val) && val == i + 1);
+    for (int i = 0; i < 1000; i += 2)
+        assert_always(cra_cdict_pop(&cdict, &i, &val) && val == i + 1);
+    assert_always(cra_cdict_count(&cdict) == 500);
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_cdict_get(&cdict, &i, &val) == (i % 2 == 1));
+
+    cra_atomic_store32(&ncalls, 0, CRA_MO_RELAXED);
+    assert_always(cra_cdict_compute_if_absent(&cdict, &(int){ 1 }, &val, compute_square, &ncalls) && val == 2);
+    assert_always(cra_atomic_load32(&ncalls, CRA_MO_RELAXED) == 0);
+    assert_always(cra_cdict_compute_if_absent(&cdict, &(int){ 10 }, &val, compute_square, &ncalls) && val == 100);
+    assert_always(cra_atomic_load32(&ncalls, CRA_MO_RELAXED) == 1);
+    assert_always(cra_cdict_get(&cdict, &(int){ 10 }, &val) && val == 100);
+    assert_always(!cra_cdict_compute_if_absent(&cdict, &(int){ -1 }, &val, compute_square, &ncalls));
+    assert_always(cra_atomic_load32(&ncalls, CRA_MO_RELAXED) == 2);
+    assert_always(!cra_cdict_get(&cdict, &(int){ -1 }, &val));
+
+    cra_cdict_clear(&cdict);
+    assert_always(cra_cdict_count(&cdict) == 0);
+    assert_always(!cra_cdict_get(&cdict, &(int){ 1 }, &val));
+
+    cra_cdict_uninit(&cdict);
+}
+
+typedef struct
+{
+    int                id;
+    cra_atomic_int32_t ncalls;
+    CraConcurrentDict *cdict;
+} ThrdArg;
+
+static CRA_THRD_FUNC(thrd_put_func)
+{
+    int      val;
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    // 每个线程写自己的key，同时读其他线程的key
+    for (int i = targ->id; i < NKEYS; i += NTHREADS)
+    {
+        assert_always(cra_cdict_add(targ->cdict, &i, &(int){ i * 2 }));
+        if (cra_cdict_get(targ->cdict, &(int){ NKEYS - i - 1 }, &val))
+            assert_always(val == (NKEYS - i - 1) * 2);
+    }
+    for (int i = targ->id; i < NKEYS; i += NTHREADS * 2)
+        assert_always(cra_cdict_remove(targ->cdict, &i));
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_compute_func)
+{
+    int      val;
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    // 所有线程竞争同一组key
+    for (int i = 0; i < NKEYS; i++)
+    {
+        assert_always(cra_cdict_compute_if_absent(targ->cdict, &i, &val, compute_square, &targ->ncalls));
+        assert_always(val == i * i);
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static void
+test_threads(void)
+{
+    int               val, ncalls;
+    cra_thrd_t        thrds[NTHREADS];
+    ThrdArg           args[NTHREADS];
+    CraConcurrentDict cdict;
+
+    cra_cdict_init_with_size(int, int, &cdict, 0, 16, cra_hash_int_p, cra_cmp_int_p);
+
+    for (int i = 0; i < NTHREADS; i++)
+    {
+        args[i] = (ThrdArg){ .id = i, .ncalls = 0, .cdict = &cdict };
+        assert_always(cra_thrd_create(&thrds[i], thrd_put_func, &args[i]));
+    }
+    for (int i = 0; i < NTHREADS; i++)
+        cra_thrd_join(thrds[i]);
+
+    assert_always(cra_cdict_count(&cdict) == NKEYS / 2);
+    for (int i = 0; i < NKEYS; i++)
+    {
+        if ((i % (NTHREADS * 2)) < NTHREADS)
+            assert_always(!cra_cdict_get(&cdict, &i, &val));
+        else
+            assert_always(cra_cdict_get(&cdict, &i, &val) && val == i * 2);
+    }
+
+    cra_cdict_clear(&cdict);
+
+    for (int i = 0; i < NTHREADS; i++)
+        assert_always(cra_thrd_create(&thrds[i], thrd_compute_func, &args[i]));
+    ncalls = 0;
+    for (int i = 0; i < NTHREADS; i++)
+    {
+        cra_thrd_join(thrds[i]);
+        ncalls += cra_atomic_load32(&args[i].ncalls, CRA_MO_RELAXED);
+    }
+    // 每个key只计算了一次
+    assert_always(ncalls == NKEYS);
+    assert_always(cra_cdict_count(&cdict) == NKEYS);
+
+    cra_cdict_uninit(&cdict);
+}
+
+int
+main(void)
+{
+    test_new_delete();
+    test_ops();
+    test_threads();
+
+    cra_memory_leak_report();
+    return 0;
+}
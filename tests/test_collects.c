@@ -1,5 +1,6 @@
 #include "collections/cra_collects.h"
 #include "threads/cra_thrdpool.h"
+#include "cra_malloc.h"
 #include "cra_assert.h"
 #include <time.h>
 
@@ -123,6 +124,135 @@ test_hash(void)
 #undef ITEM
 }
 
+void
+test_hash_bytes(void)
+{
+    char  buf[300];
+    char *s = "the quick brown fox jumps over the lazy dog";
+
+    // 与字符串hash一致
+    assert_always(cra_hash_bytes(s, strlen(s)) == cra_hash_string1(s));
+    assert_always(cra_hash_bytes("", 0) == cra_hash_string1(""));
+    assert_always(cra_hash_string1(s) != cra_hash_string2(s));
+    // _n遇到'\0'或len个字符时结束
+    for (size_t i = 0; i <= strlen(s); i++)
+    {
+        memcpy(buf, s, i);
+        buf[i] = '\0';
+        assert_always(cra_hash_string1_n(s, i) == cra_hash_string1(buf));
+        assert_always(cra_hash_string2_n(s, i) == cra_hash_string2(buf));
+        assert_always(cra_hash_string1_n(buf, i + 10) == cra_hash_string1(buf));
+    }
+
+    // 每种长度都要走到(0, 1~3, 4~16, 17~48, >48)，且结果与对齐无关
+    char data[200];
+    for (size_t len = 0; len < sizeof(data); len++)
+    {
+        for (size_t i = 0; i < len; i++)
+            data[i] = (char)(i * 31 + len);
+        cra_hash_t hash = cra_hash_bytes(data, len);
+        for (size_t off = 0; off < 8; off++)
+        {
+            memcpy(buf + off, data, len);
+            assert_always(cra_hash_bytes(buf + off, len) == hash);
+        }
+        if (len > 0)
+            assert_always(hash != cra_hash_bytes(data, len - 1));
+    }
+}
+
+static int
+compare_uint64(const void *a, const void *b)
+{
+    return cra_cmp_uint64_p((const uint64_t *)a, (const uint64_t *)b);
+}
+
+// 统计排序后相邻相等的个数
+static size_t
+count_collisions(uint64_t *hashes, size_t n, uint64_t mask)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++)
+        hashes[i] &= mask;
+    qsort(hashes, n, sizeof(uint64_t), compare_uint64);
+    for (size_t i = 1; i < n; i++)
+        count += hashes[i] == hashes[i - 1];
+    return count;
+}
+
+void
+test_hash_quality(void)
+{
+    // avalanche: 翻转输入的任一位，输出的每一位都应该以约50%的概率翻转
+    size_t   lens[] = { 3, 8, 16, 24, 64 };
+    size_t   trials = 1000;
+    size_t   nbits = sizeof(cra_hash_t) * 8;
+    uint8_t  key[64];
+    uint32_t *flips;
+
+    flips = cra_malloc(sizeof(uint32_t) * 64 * 8 * nbits);
+    for (size_t l = 0; l < CRA_NARRAY(lens); l++)
+    {
+        size_t len = lens[l];
+        bzero(flips, sizeof(uint32_t) * len * 8 * nbits);
+        for (size_t t = 0; t < trials; t++)
+        {
+            for (size_t i = 0; i < len; i++)
+                key[i] = (uint8_t)rand();
+            uint64_t h0 = (uint64_t)cra_hash_bytes(key, len);
+            for (size_t in = 0; in < len * 8; in++)
+            {
+                key[in >> 3] ^= (uint8_t)(1u << (in & 7));
+                uint64_t diff = h0 ^ (uint64_t)cra_hash_bytes(key, len);
+                key[in >> 3] ^= (uint8_t)(1u << (in & 7));
+                for (size_t out = 0; out < nbits; out++)
+                    flips[in * nbits + out] += (uint32_t)((diff >> out) & 1);
+            }
+        }
+        // 1000次试验的标准差约0.016，0.1约为6个标准差
+        double worst = 0.0;
+        for (size_t i = 0; i < len * 8 * nbits; i++)
+            worst = CRA_MAX(worst, fabs((double)flips[i] / trials - 0.5));
+        assert_always(worst < 0.1);
+    }
+    cra_free(flips);
+
+    // collisions: 相似的key
+    char      buf[32];
+    size_t    n = 1000000;
+    size_t    c64, c32;
+    uint64_t *hashes = cra_malloc(sizeof(uint64_t) * n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int len = snprintf(buf, sizeof(buf), "key-%zu", i);
+        hashes[i] = (uint64_t)cra_hash_bytes(buf, (size_t)len);
+    }
+    c64 = count_collisions(hashes, n, UINT64_MAX);
+    // 低32位: 期望约n^2/2^33 = 116个
+    c32 = count_collisions(hashes, n, UINT32_MAX);
+    assert_always(sizeof(cra_hash_t) < 8 || c64 == 0);
+    assert_always(c32 < 200);
+
+    // 稀疏的key: 只有一位是1，或全是0但长度不同
+    size_t m = 0;
+    bzero(key, sizeof(key));
+    for (size_t len = 1; len <= sizeof(key); len++)
+    {
+        for (size_t bit = 0; bit < len * 8; bit++)
+        {
+            key[bit >> 3] = (uint8_t)(1u << (bit & 7));
+            hashes[m++] = (uint64_t)cra_hash_bytes(key, len);
+            key[bit >> 3] = 0;
+        }
+        hashes[m++] = (uint64_t)cra_hash_bytes(key, len);
+    }
+    c64 = count_collisions(hashes, m, UINT64_MAX);
+    assert_always(sizeof(cra_hash_t) < 8 || c64 == 0);
+
+    cra_free(hashes);
+}
+
 static void
 test_str_hashcode(void)
 {
@@ -159,6 +289,8 @@ main(void)
 {
     test_compare();
     test_hash();
+    test_hash_bytes();
+    test_hash_quality();
     test_hash_str_dyn_init_hashcode();
     return 0;
 }
@@ -287,6 +287,74 @@ test_push(void)
     cra_dealloc(deque);
 }
 
+void
+test_push_pop_n(void)
+{
+    int       vals[1000], out[1000], v;
+    int       expect = 0, next = 0, n;
+    CraDeque *deque = cra_alloc(CraDeque);
+    assert_always(cra_deque_init(int, deque));
+
+    assert_always(cra_deque_push_back_n(deque, vals, 0) && deque->count == 0);
+    assert_always(cra_deque_pop_front_n(deque, out, 0));
+    assert_always(!cra_deque_pop_front_n(deque, out, 1));
+
+    srand((unsigned int)time(NULL));
+    for (int i = 0; i < 1000; i++)
+    {
+        // 批量加入
+        n = rand() % 1000;
+        for (int j = 0; j < n; j++)
+            vals[j] = next++;
+        assert_always(cra_deque_push_back_n(deque, vals, n));
+        // 与单个操作混用
+        if (i % 3 == 0)
+        {
+            assert_always(cra_deque_push_back(deque, &next));
+            ++next;
+        }
+        if (i % 5 == 0 && deque->count > 0)
+        {
+            assert_always(cra_deque_pop_front(deque, &v) && v == expect);
+            ++expect;
+        }
+        assert_always(deque->count == (size_t)(next - expect));
+
+        n = deque->count == 0 ? 0 : rand() % (int)deque->count;
+        n = CRA_MIN(n, 1000);
+        assert_always(cra_deque_pop_front_n(deque, out, n));
+        for (int j = 0; j < n; j++)
+            assert_always(out[j] == expect++);
+        if (deque->count > 0)
+            assert_always(*(int *)cra_deque_peek_front_ref(deque) == expect);
+        if (deque->count > 0)
+            assert_always(*(int *)cra_deque_peek_back_ref(deque) == next - 1);
+    }
+
+    assert_always(!cra_deque_pop_front_n(deque, out, deque->count + 1));
+    while (deque->count > 0)
+    {
+        n = (int)CRA_MIN(deque->count, 1000);
+        assert_always(cra_deque_pop_front_n(deque, out, n));
+        for (int j = 0; j < n; j++)
+            assert_always(out[j] == expect++);
+    }
+    assert_always(expect == next);
+
+    // push_front之后push_back_n
+    for (int j = 0; j < 1000; j++)
+        vals[j] = j;
+    for (int j = 99; j >= 0; j--)
+        assert_always(cra_deque_push_front(deque, &j));
+    assert_always(cra_deque_push_back_n(deque, vals + 100, 900));
+    assert_always(cra_deque_remove_front_n(deque, 50));
+    assert_always(cra_deque_pop_front_n(deque, out, 950));
+    assert_always(memcmp(out, vals + 50, 950 * sizeof(int)) == 0 && deque->count == 0);
+
+    cra_deque_uninit(deque);
+    cra_dealloc(deque);
+}
+
 void
 test_pop_at(void)
 {
@@ -718,6 +786,7 @@ main(void)
     test_push();
     test_pop_at();
     test_pop();
+    test_push_pop_n();
     test_set();
     test_get();
     test_peek();
@@ -220,6 +220,373 @@ test_foreach(void)
     cra_dealloc(dict);
 }
 
+void
+test_pow2(void)
+{
+    int      val;
+    CraDict *dict = cra_alloc(CraDict);
+
+    assert_always(cra_dict_init_with_flags(int, int, dict, 100, CRA_DICT_FLAG_POW2, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(dict->flags == CRA_DICT_FLAG_POW2);
+    assert_always(dict->capacity == 128);
+
+    // 整数的hash是恒等映射，步长为容量的key不混合会落在同一个桶
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_dict_add(dict, &(int){ i * 1024 }, &i));
+    assert_always(dict->count == 10000);
+    assert_always((dict->capacity & (dict->capacity - 1)) == 0);
+    assert_always(dict->capacity < 10000 * 2);
+
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_dict_get(dict, &(int){ i * 1024 }, &val) && val == i);
+    assert_always(!cra_dict_get(dict, &(int){ 1 }, &val));
+
+    for (int i = 0; i < 10000; i += 2)
+        assert_always(cra_dict_pop(dict, &(int){ i * 1024 }, &val) && val == i);
+    assert_always(dict->count == 5000);
+
+    assert_always(cra_dict_reserve(dict, 0));
+    assert_always((dict->capacity & (dict->capacity - 1)) == 0);
+    for (int i = 1; i < 10000; i += 2)
+        assert_always(cra_dict_get(dict, &(int){ i * 1024 }, &val) && val == i);
+
+    cra_dict_uninit(dict);
+
+    CRA_DICT_INITIALIZABLE_PARAM_DEF(param, int, int, cra_hash_int_p, cra_cmp_int_p);
+    param.flags = CRA_DICT_FLAG_POW2;
+    assert_always(cra_initializable_init(CRA_DICT_INITIALIZABLE_I, dict, 0, &param));
+    assert_always(dict->capacity == 8);
+    for (int i = 0; i < 100; i++)
+        assert_always(cra_dict_add(dict, &i, &i));
+    for (int i = 0; i < 100; i++)
+        assert_always(cra_dict_get(dict, &i, &val) && val == i);
+    cra_initializable_uninit(CRA_DICT_INITIALIZABLE_I, dict);
+
+    cra_dealloc(dict);
+}
+
+void
+test_incr(void)
+{
+    int      key, val, i;
+    bool     rehashed;
+    CraDict *dict = cra_alloc(CraDict);
+
+    for (unsigned int flags = CRA_DICT_FLAG_INCR; flags <= (CRA_DICT_FLAG_INCR | CRA_DICT_FLAG_POW2); flags++)
+    {
+        assert_always(cra_dict_init_with_flags(int, int, dict, 0, flags, cra_hash_int_p, cra_cmp_int_p));
+
+        rehashed = false;
+        for (i = 0; i < 100000; i++)
+        {
+            assert_always(cra_dict_add(dict, &i, &(int){ i + 1 }));
+            if (dict->old_buckets)
+            {
+                rehashed = true;
+                // 迁移期间新旧桶中的key都能找到
+                assert_always(cra_dict_get(dict, &(int){ 0 }, &val) && val == 1);
+                assert_always(cra_dict_get(dict, &i, &val) && val == i + 1);
+                assert_always(!cra_dict_add(dict, &(int){ i / 2 }, &val));
+            }
+        }
+        assert_always(rehashed);
+        assert_always(dict->count == 100000);
+
+        // 迁移期间迭代顺序不变
+        i = 0;
+        CRA_FOREACH(CRA_DICT_ITERABLE_I, dict, vals)
+        {
+            memcpy(&key, vals.key_ref, sizeof(key));
+            memcpy(&val, vals.val_ref, sizeof(val));
+            assert_always(key == i && val == i + 1);
+            i++;
+        }
+        assert_always(i == 100000);
+
+        for (i = 0; i < 100000; i += 3)
+            assert_always(cra_dict_pop(dict, &i, &val) && val == i + 1);
+        for (i = 0; i < 100000; i++)
+        {
+            if (i % 3 == 0)
+                assert_always(!cra_dict_get(dict, &i, &val));
+            else
+                assert_always(cra_dict_get(dict, &i, &val) && val == i + 1);
+        }
+        assert_always(!dict->old_buckets);
+
+        // 迁移中途reserve/clear
+        for (i = 100000; dict->old_buckets == NULL; i++)
+            assert_always(cra_dict_add(dict, &i, &(int){ i + 1 }));
+        assert_always(cra_dict_reserve(dict, 0));
+        assert_always(!dict->old_buckets);
+        assert_always(cra_dict_get(dict, &(int){ i - 1 }, &val) && val == i);
+        for (; dict->old_buckets == NULL; i++)
+            assert_always(cra_dict_add(dict, &i, &(int){ i + 1 }));
+        cra_dict_clear(dict);
+        assert_always(!dict->old_buckets);
+        assert_always(!cra_dict_get(dict, &(int){ 1 }, &val));
+        CRA_FOREACH(CRA_DICT_ITERABLE_I, dict, vals) assert_always(false);
+
+        cra_dict_uninit(dict);
+    }
+
+    cra_dealloc(dict);
+}
+
+void
+test_many(void)
+{
+    int      i, n;
+    int     *keys, *vals, **retvals;
+    CraDict *dict = cra_alloc(CraDict);
+
+    n = 5000;
+    keys = cra_malloc(sizeof(int) * n);
+    vals = cra_malloc(sizeof(int) * n);
+    retvals = cra_malloc(sizeof(int *) * n);
+
+    unsigned int flags[] = { CRA_DICT_FLAG_NONE, CRA_DICT_FLAG_POW2, CRA_DICT_FLAG_INCR };
+    for (size_t k = 0; k < CRA_NARRAY(flags); k++)
+    {
+        assert_always(cra_dict_init_with_flags(int, int, dict, 0, flags[k], cra_hash_int_p, cra_cmp_int_p));
+
+        // 后一半key和前一半重复，覆盖旧值
+        for (i = 0; i < n; i++)
+        {
+            keys[i] = i % (n / 2);
+            vals[i] = i;
+        }
+        assert_always(cra_dict_put_many(dict, keys, vals, n) == (size_t)n);
+        assert_always(dict->count == n / 2);
+        assert_always(cra_dict_put_many(dict, keys, vals, 0) == 0);
+
+        // 查找一半存在一半不存在的key，长度不是批大小的整数倍
+        for (i = 0; i < n - 1; i++)
+            keys[i] = i;
+        assert_always(cra_dict_get_many(dict, keys, n - 1, retvals) == (size_t)(n / 2));
+        for (i = 0; i < n - 1; i++)
+        {
+            if (i < n / 2)
+                assert_always(retvals[i] && *retvals[i] == i + n / 2);
+            else
+                assert_always(retvals[i] == NULL);
+        }
+
+        // 和逐个get结果一致
+        for (i = 0; i < n / 2; i++)
+            assert_always(cra_dict_get_ref(dict, &i) == retvals[i]);
+
+        cra_dict_uninit(dict);
+    }
+
+    // 渐进式扩容迁移中的批量查找
+    assert_always(cra_dict_init_with_flags(int, int, dict, 0, CRA_DICT_FLAG_INCR, cra_hash_int_p, cra_cmp_int_p));
+    for (i = 0; dict->old_buckets == NULL || i < 100; i++)
+        assert_always(cra_dict_add(dict, &i, &i));
+    for (int j = 0; j < i; j++)
+        keys[j] = j;
+    assert_always(cra_dict_get_many(dict, keys, (size_t)i, retvals) == (size_t)i);
+    for (int j = 0; j < i; j++)
+        assert_always(*retvals[j] == j);
+    cra_dict_uninit(dict);
+
+    cra_free(retvals);
+    cra_free(vals);
+    cra_free(keys);
+    cra_dealloc(dict);
+}
+
+void
+test_with_hash(void)
+{
+    int         val;
+    cra_hash_t  hash;
+    char       *key, *oldkey;
+    const char *keys[] = { "apple", "banana", "cherry", "date", "elderberry" };
+    const char *text = "banana split with cherry";
+    CraStrSlice slice;
+    CraDict    *dict = cra_alloc(CraDict);
+
+    assert_always(cra_hash_string1_n("hello world", 5) == cra_hash_string1("hello"));
+    assert_always(cra_hash_string2_n("hello world", 5) == cra_hash_string2("hello"));
+    assert_always(cra_hash_string1_n("hello", 100) == cra_hash_string1("hello"));
+    assert_always(cra_hash_str_slice1_p(&(CraStrSlice){ "", 0 }) == cra_hash_string1(""));
+
+    assert_always(cra_dict_init(char *, int, dict, cra_hash_string1_p, cra_cmp_string_p));
+
+    for (int i = 0; i < (int)CRA_NARRAY(keys); i++)
+    {
+        key = (char *)keys[i];
+        hash = cra_hash_string1(key);
+        assert_always(cra_dict_add_with_hash(dict, &key, hash, &i));
+        assert_always(!cra_dict_add_with_hash(dict, &key, hash, &i));
+    }
+    key = (char *)keys[1];
+    assert_always(cra_dict_put_with_hash(dict, &key, cra_hash_string1(key), &(int){ 10 }));
+    assert_always(cra_dict_put_and_return_kv_with_hash(dict, &key, cra_hash_string1(key), &(int){ 1 }, &oldkey, &val));
+    assert_always(oldkey == keys[1] && val == 10);
+
+    for (int i = 0; i < (int)CRA_NARRAY(keys); i++)
+    {
+        key = (char *)keys[i];
+        assert_always(cra_dict_get_with_hash(dict, &key, cra_hash_string1(key), &val) && val == i);
+        assert_always(*(int *)cra_dict_get_ref_with_hash(dict, &key, cra_hash_string1(key)) == i);
+    }
+
+    // 直接用字符串片段查找
+    slice = (CraStrSlice){ text, 6 };
+    assert_always(cra_dict_get_as(dict, &slice, cra_hash_str_slice1_p(&slice), cra_cmp_str_slice_p, &val) &&
+                  val == 1);
+    slice = (CraStrSlice){ text + 18, 6 };
+    assert_always(*(int *)cra_dict_get_ref_as(dict, &slice, cra_hash_str_slice1_p(&slice), cra_cmp_str_slice_p) ==
+                  2);
+    // 前缀不算相等
+    slice = (CraStrSlice){ text, 3 };
+    assert_always(!cra_dict_get_ref_as(dict, &slice, cra_hash_str_slice1_p(&slice), cra_cmp_str_slice_p));
+    slice = (CraStrSlice){ text, 7 };
+    assert_always(!cra_dict_get_ref_as(dict, &slice, cra_hash_str_slice1_p(&slice), cra_cmp_str_slice_p));
+
+    key = (char *)keys[3];
+    assert_always(cra_dict_pop_with_hash(dict, &key, cra_hash_string1(key), &val) && val == 3);
+    assert_always(!cra_dict_remove_with_hash(dict, &key, cra_hash_string1(key)));
+    key = (char *)keys[4];
+    assert_always(cra_dict_pop_kv_with_hash(dict, &key, cra_hash_string1(key), &oldkey, &val));
+    assert_always(oldkey == keys[4] && val == 4);
+    assert_always(dict->count == 3);
+
+    cra_dict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+typedef struct
+{
+    int  id;
+    char data[252];
+} BigVal;
+
+void
+test_split(void)
+{
+    BigVal       val, *pval, *vals[100];
+    size_t       count;
+    int          keys[100];
+    unsigned int flags[] = { CRA_DICT_FLAG_SPLIT, CRA_DICT_FLAG_SPLIT | CRA_DICT_FLAG_POW2 | CRA_DICT_FLAG_INCR };
+    CraDict     *dict = cra_alloc(CraDict);
+
+    for (int f = 0; f < (int)CRA_NARRAY(flags); f++)
+    {
+        assert_always(cra_dict_init_with_flags(int, BigVal, dict, 0, flags[f], cra_hash_int_p, cra_cmp_int_p));
+        assert_always(dict->vals);
+        // entry中只有hash、next和key: 8 + 8 + 4，对齐到8
+        assert_always(dict->entry_size == 24);
+
+        for (int i = 0; i < 5000; i++)
+        {
+            val.id = i;
+            val.data[251] = (char)i;
+            assert_always(cra_dict_add(dict, &i, &val));
+        }
+        assert_always(dict->count == 5000);
+        for (int i = 0; i < 5000; i += 2)
+            assert_always(cra_dict_pop(dict, &i, &val) && val.id == i && val.data[251] == (char)i);
+        val.id = -1;
+        assert_always(cra_dict_put(dict, &(int){ 1 }, &val));
+        assert_always(cra_dict_get(dict, &(int){ 1 }, &val) && val.id == -1);
+        ((BigVal *)cra_dict_get_ref(dict, &(int){ 1 }))->id = 1;
+
+        // 重新添加会复用空出的entry
+        for (int i = 0; i < 5000; i += 2)
+            assert_always(cra_dict_add(dict, &i, &(BigVal){ .id = i }));
+        assert_always(cra_dict_reserve(dict, 0));
+        for (int i = 0; i < 5000; i++)
+            assert_always((pval = cra_dict_get_ref(dict, &i)) && pval->id == i);
+
+        count = 0;
+        CRA_FOREACH(CRA_DICT_ITERABLE_I, dict, kv)
+        {
+            assert_always(*(int *)kv.key_ref == ((BigVal *)kv.val_ref)->id);
+            ++count;
+        }
+        assert_always(count == 5000);
+
+        for (int i = 0; i < 100; i++)
+            keys[i] = i * 60;
+        assert_always(cra_dict_get_many(dict, keys, 100, vals) == 84);
+        for (int i = 0; i < 100; i++)
+            assert_always(keys[i] < 5000 ? vals[i]->id == keys[i] : vals[i] == NULL);
+
+        cra_dict_uninit(dict);
+    }
+
+    cra_dealloc(dict);
+}
+
+void
+test_freeze(void)
+{
+    double       val;
+    const char  *path = "test_dict_freeze.img";
+    CraDictView  view;
+    unsigned int flags[] = { CRA_DICT_FLAG_NONE, CRA_DICT_FLAG_POW2, CRA_DICT_FLAG_POW2 | CRA_DICT_FLAG_INCR,
+                             CRA_DICT_FLAG_SPLIT };
+    CraDict     *dict = cra_alloc(CraDict);
+    FILE        *fp;
+
+    for (int f = 0; f < (int)CRA_NARRAY(flags); f++)
+    {
+        assert_always(cra_dict_init_with_flags(int, double, dict, 0, flags[f], cra_hash_int_p, cra_cmp_int_p));
+
+        // 空字典
+        assert_always(cra_dict_freeze(dict, path));
+        assert_always(cra_dict_view_open(int, double, &view, path, cra_hash_int_p, cra_cmp_int_p));
+        assert_always(view.count == 0);
+        assert_always(!cra_dict_view_get(&view, &(int){ 1 }, &val));
+        cra_dict_view_close(&view);
+
+        // 有空洞(删除过)，渐进式扩容的字典还在迁移中
+        for (int i = 0; i < 1000; i++)
+            assert_always(cra_dict_add(dict, &i, &(double){ i * 0.5 }));
+        for (int i = 0; i < 1000; i += 3)
+            assert_always(cra_dict_remove(dict, &i));
+        assert_always(cra_dict_freeze(dict, path));
+
+        // key/val大小对不上
+        assert_always(!cra_dict_view_open(int, float, &view, path, cra_hash_int_p, cra_cmp_int_p));
+        assert_always(!cra_dict_view_open(char, double, &view, path, cra_hash_int_p, cra_cmp_int_p));
+
+        assert_always(cra_dict_view_open(int, double, &view, path, cra_hash_int_p, cra_cmp_int_p));
+        assert_always(view.count == dict->count);
+        for (int i = 0; i < 1000; i++)
+        {
+            assert_always(cra_dict_view_get(&view, &i, &val) == (i % 3 != 0));
+            if (i % 3 != 0)
+            {
+                assert_always(val == i * 0.5);
+                assert_always(*(const double *)cra_dict_view_get_ref_with_hash(&view, &i, cra_hash_int_p(&i)) == val);
+            }
+        }
+        assert_always(!cra_dict_view_get_ref(&view, &(int){ 1000 }));
+
+        // 冻结后修改字典不影响镜像
+        cra_dict_clear(dict);
+        assert_always(*(const double *)cra_dict_view_get_ref(&view, &(int){ 1 }) == 0.5);
+        cra_dict_view_close(&view);
+
+        cra_dict_uninit(dict);
+    }
+
+    // 不是镜像的文件
+    fp = fopen(path, "wb");
+    assert_always(fp);
+    fputs("not a dict image", fp);
+    fclose(fp);
+    assert_always(!cra_dict_view_open(int, double, &view, path, cra_hash_int_p, cra_cmp_int_p));
+    remove(path);
+    assert_always(!cra_dict_view_open(int, double, &view, path, cra_hash_int_p, cra_cmp_int_p));
+
+    cra_dealloc(dict);
+}
+
 void
 test_test(void)
 {
@@ -287,6 +654,12 @@ main(void)
     test_remove();
     test_get();
     test_foreach();
+    test_pow2();
+    test_incr();
+    test_many();
+    test_with_hash();
+    test_split();
+    test_freeze();
     test_test();
 
     cra_memory_leak_report();
@@ -0,0 +1,222 @@
+/**
+ * @file test_ilist.c
+ * @author Cracal
+ * @brief test intrusive linked list
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_ilist.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+
+typedef struct
+{
+    int          id;
+    CraIListNode node; // 不在第一个位置
+    CraIListNode node2;
+} Item;
+
+#define NITEMS 100
+
+static void
+check_list(CraIList *list, int *expect, int n)
+{
+    int           i;
+    CraIListNode *node;
+
+    assert_always((int)list->count == n);
+    i = 0;
+    for (node = cra_ilist_front(list); node; node = cra_ilist_next(list, node))
+        assert_always(CRA_ILIST_ENTRY(node, Item, node)->id == expect[i++]);
+    assert_always(i == n);
+    for (node = cra_ilist_back(list); node; node = cra_ilist_prev(list, node))
+        assert_always(CRA_ILIST_ENTRY(node, Item, node)->id == expect[--i]);
+    assert_always(i == 0);
+}
+
+void
+test_push_pop(void)
+{
+    Item          items[NITEMS];
+    int           expect[NITEMS];
+    CraIList      list;
+    CraIListNode *node;
+
+    cra_ilist_init(Item, &list, node);
+    assert_always(cra_ilist_is_empty(&list));
+    assert_always(!cra_ilist_front(&list) && !cra_ilist_back(&list));
+    assert_always(!cra_ilist_pop_front(&list) && !cra_ilist_pop_back(&list));
+
+    for (int i = 0; i < NITEMS; i++)
+    {
+        items[i].id = i;
+        cra_ilist_node_init(&items[i].node);
+        assert_always(!cra_ilist_node_is_linked(&items[i].node));
+    }
+
+    // 49 ... 1 0 50 51 ... 99
+    for (int i = 0; i < NITEMS / 2; i++)
+        cra_ilist_push_front(&list, &items[i].node);
+    for (int i = NITEMS / 2; i < NITEMS; i++)
+        cra_ilist_push_back(&list, &items[i].node);
+    for (int i = 0; i < NITEMS; i++)
+    {
+        expect[i] = i < NITEMS / 2 ? NITEMS / 2 - 1 - i : i;
+        assert_always(cra_ilist_node_is_linked(&items[i].node));
+    }
+    check_list(&list, expect, NITEMS);
+
+    node = cra_ilist_pop_front(&list);
+    assert_always(node == &items[NITEMS / 2 - 1].node && !cra_ilist_node_is_linked(node));
+    node = cra_ilist_pop_back(&list);
+    assert_always(node == &items[NITEMS - 1].node && !cra_ilist_node_is_linked(node));
+    check_list(&list, expect + 1, NITEMS - 2);
+
+    cra_ilist_clear(&list);
+    assert_always(cra_ilist_is_empty(&list));
+    for (int i = 0; i < NITEMS; i++)
+        assert_always(!cra_ilist_node_is_linked(&items[i].node));
+}
+
+void
+test_insert_remove(void)
+{
+    Item     items[10];
+    int      expect[10];
+    CraIList list;
+
+    cra_ilist_init(Item, &list, node);
+    for (int i = 0; i < 10; i++)
+    {
+        items[i].id = i;
+        cra_ilist_node_init(&items[i].node);
+    }
+
+    // 0 2 4 6 8
+    for (int i = 0; i < 10; i += 2)
+        cra_ilist_push_back(&list, &items[i].node);
+    // 0 1 2 3 4 5 6 7 8 9
+    for (int i = 1; i < 10; i += 2)
+    {
+        if (i < 9)
+            cra_ilist_insert_before(&list, &items[i + 1].node, &items[i].node);
+        else
+            cra_ilist_insert_after(&list, &items[i - 1].node, &items[i].node);
+    }
+    for (int i = 0; i < 10; i++)
+        expect[i] = i;
+    check_list(&list, expect, 10);
+
+    // 通过指针删除: 1 3 5 7 9
+    for (int i = 0; i < 10; i += 2)
+        cra_ilist_remove(&list, &items[i].node);
+    for (int i = 0; i < 5; i++)
+        expect[i] = i * 2 + 1;
+    check_list(&list, expect, 5);
+
+    cra_ilist_clear(&list);
+}
+
+void
+test_move_and_two_lists(void)
+{
+    Item     items[10];
+    int      expect[10];
+    CraIList list1, list2, all;
+
+    cra_ilist_init(Item, &list1, node);
+    cra_ilist_init(Item, &list2, node);
+    (cra_ilist_init)(&all, offsetof(Item, node2));
+
+    for (int i = 0; i < 10; i++)
+    {
+        items[i].id = i;
+        cra_ilist_node_init(&items[i].node);
+        cra_ilist_node_init(&items[i].node2);
+        cra_ilist_push_back(i < 6 ? &list1 : &list2, &items[i].node);
+        // 同一个元素同时在另一个链表中
+        cra_ilist_push_front(&all, &items[i].node2);
+    }
+
+    cra_ilist_move(&list1, &list2);
+    assert_always(list2.count == 0 && cra_ilist_is_empty(&list2));
+    for (int i = 0; i < 10; i++)
+        expect[i] = i;
+    check_list(&list1, expect, 10);
+    cra_ilist_move(&list2, &list1);
+    check_list(&list2, expect, 10);
+    cra_ilist_move(&list2, &list1);
+    check_list(&list2, expect, 10);
+
+    int i = 9;
+    for (CraIListNode *node = cra_ilist_front(&all); node; node = cra_ilist_next(&all, node))
+        assert_always(CRA_ILIST_ENTRY(node, Item, node2)->id == i--);
+
+    cra_ilist_clear(&list2);
+    cra_ilist_clear(&all);
+}
+
+void
+test_foreach(void)
+{
+    int      i;
+    Item     items[10];
+    CraIList list;
+
+    cra_ilist_init(Item, &list, node);
+    CRA_FOREACH(CRA_ILIST_ITERABLE_I, &list, vals) assert_always(false);
+    CRA_FOREACH_REVERSE(CRA_ILIST_ITERABLE_I, &list, vals) assert_always(false);
+
+    for (i = 0; i < 10; i++)
+    {
+        items[i].id = i;
+        cra_ilist_node_init(&items[i].node);
+        cra_ilist_push_back(&list, &items[i].node);
+    }
+
+    // val_ref是结构体的地址
+    i = 0;
+    CRA_FOREACH(CRA_ILIST_ITERABLE_I, &list, vals)
+    {
+        assert_always(vals.val_ref == &items[i]);
+        assert_always(((Item *)vals.val_ref)->id == i++);
+    }
+    assert_always(i == 10);
+    CRA_FOREACH_REVERSE(CRA_ILIST_ITERABLE_I, &list, vals)
+    {
+        assert_always(((Item *)vals.val_ref)->id == --i);
+    }
+    assert_always(i == 0);
+
+    // 迭代时删除
+    CRA_FOREACH(CRA_ILIST_ITERABLE_I, &list, vals)
+    {
+        Item *item = (Item *)vals.val_ref;
+        if (item->id % 2 == 0)
+            cra_ilist_remove(&list, &item->node);
+    }
+    assert_always(list.count == 5);
+    i = 1;
+    CRA_FOREACH(CRA_ILIST_ITERABLE_I, &list, vals)
+    {
+        assert_always(((Item *)vals.val_ref)->id == i);
+        i += 2;
+    }
+
+    cra_ilist_clear(&list);
+}
+
+int
+main(void)
+{
+    test_push_pop();
+    test_insert_remove();
+    test_move_and_two_lists();
+    test_foreach();
+
+    cra_memory_leak_report();
+    return 0;
+}
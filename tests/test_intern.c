@@ -0,0 +1,268 @@
+/**
+ * @file test_intern.c
+ * @author Cracal
+ * @brief test string interning
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include "serialize/cra_bin_ser.h"
+#include "serialize/cra_json.h"
+#include "threads/cra_intern.h"
+#include "threads/cra_thread.h"
+
+#define NTHREADS 8
+#define NKEYS    20000
+
+void
+test_intern(void)
+{
+    char        buf[100];
+    const char *a, *b, *c, *e;
+    CraIntern   intern;
+
+    assert_always(cra_intern_init(&intern, 3));
+    assert_always(intern.nshards == 4);
+    for (size_t i = 0; i < intern.nshards; i++)
+        assert_always(((uintptr_t)&intern.shards[i] & (CRA_CACHELINE_SIZE - 1)) == 0);
+
+    a = cra_intern_cstr(&intern, "hello");
+    assert_always(a && strcmp(a, "hello") == 0);
+    assert_always(cra_intern_len(a) == 5);
+
+    // 内容相同就是同一个指针
+    strcpy(buf, "hello");
+    b = cra_intern_cstr(&intern, buf);
+    assert_always(a == b);
+    assert_always(buf != b);
+    // 只取前len个字节
+    c = cra_intern(&intern, "hello, world", 5);
+    assert_always(a == c);
+    c = cra_intern(&intern, "hello, world", 4);
+    assert_always(a != c && strcmp(c, "hell") == 0 && cra_intern_len(c) == 4);
+    // 空串
+    e = cra_intern(&intern, "", 0);
+    assert_always(e && e[0] == '\0' && cra_intern_len(e) == 0);
+    assert_always(e == cra_intern(&intern, "abc", 0));
+    // 中间有'\0'
+    c = cra_intern(&intern, "a\0b", 3);
+    assert_always(cra_intern_len(c) == 3 && memcmp(c, "a\0b", 4) == 0);
+    assert_always(c != cra_intern(&intern, "a\0c", 3));
+    assert_always(cra_intern_count(&intern) == 5);
+
+    // 扩容后之前的指针不变
+    for (int i = 0; i < 10000; i++)
+    {
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        assert_always(cra_intern_cstr(&intern, buf));
+    }
+    assert_always(cra_intern_count(&intern) == 10005);
+    assert_always(a == cra_intern_cstr(&intern, "hello"));
+    for (int i = 0; i < 10000; i++)
+    {
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        b = cra_intern_cstr(&intern, buf);
+        assert_always(strcmp(b, buf) == 0);
+        assert_always(b == cra_intern_cstr(&intern, buf));
+    }
+    assert_always(cra_intern_count(&intern) == 10005);
+
+    cra_intern_uninit(&intern);
+}
+
+void
+test_long(void)
+{
+    char       *big;
+    const char *a, *b, *s;
+    CraIntern   intern;
+
+    assert_always(cra_intern_init(&intern, 1));
+    s = cra_intern_cstr(&intern, "short");
+
+    // 大字符串单独占一块
+    big = cra_malloc(CRA_INTERN_CHUNK_SIZE * 2);
+    memset(big, 'z', CRA_INTERN_CHUNK_SIZE * 2);
+    a = cra_intern(&intern, big, CRA_INTERN_CHUNK_SIZE * 2);
+    assert_always(cra_intern_len(a) == CRA_INTERN_CHUNK_SIZE * 2 && a[CRA_INTERN_CHUNK_SIZE * 2] == '\0');
+    assert_always(memcmp(a, big, CRA_INTERN_CHUNK_SIZE * 2) == 0);
+    b = cra_intern(&intern, big, CRA_INTERN_CHUNK_SIZE);
+    assert_always(a != b && cra_intern_len(b) == CRA_INTERN_CHUNK_SIZE);
+    assert_always(a == cra_intern(&intern, big, CRA_INTERN_CHUNK_SIZE * 2));
+    cra_free(big);
+
+    // 之前的块还在用
+    b = cra_intern_cstr(&intern, "short2");
+    assert_always(b - s > 0 && b - s < 32);
+    assert_always(s == cra_intern_cstr(&intern, "short"));
+
+    cra_intern_uninit(&intern);
+}
+
+typedef struct
+{
+    int        id;
+    CraIntern *intern;
+    const char *results[NKEYS];
+} ThrdArg;
+
+static CRA_THRD_FUNC(thrd_intern_func)
+{
+    char     buf[32];
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    // 所有线程以不同的顺序驻留同一组字符串
+    for (int i = 0; i < NKEYS; i++)
+    {
+        int k = (i + targ->id * (NKEYS / NTHREADS)) % NKEYS;
+        snprintf(buf, sizeof(buf), "str-%d", k);
+        targ->results[k] = cra_intern_cstr(targ->intern, buf);
+        assert_always(targ->results[k] && strcmp(targ->results[k], buf) == 0);
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+void
+test_threads(void)
+{
+    cra_thrd_t thrds[NTHREADS];
+    ThrdArg   *args;
+    CraIntern  intern;
+
+    assert_always(cra_intern_init(&intern, CRA_INTERN_DEFAULT_SHARDS));
+    args = cra_malloc(sizeof(ThrdArg) * NTHREADS);
+    for (int i = 0; i < NTHREADS; i++)
+    {
+        args[i].id = i;
+        args[i].intern = &intern;
+        assert_always(cra_thrd_create(&thrds[i], thrd_intern_func, &args[i]));
+    }
+    for (int i = 0; i < NTHREADS; i++)
+        cra_thrd_join(thrds[i]);
+
+    // 每个字符串只保存了一份
+    assert_always(cra_intern_count(&intern) == NKEYS);
+    for (int k = 0; k < NKEYS; k++)
+    {
+        for (int i = 1; i < NTHREADS; i++)
+            assert_always(args[i].results[k] == args[0].results[k]);
+    }
+
+    cra_free(args);
+    cra_intern_uninit(&intern);
+}
+
+void
+test_global(void)
+{
+    const char *a, *b;
+    CraIntern  *intern;
+
+    intern = cra_intern_global();
+    assert_always(intern && intern == cra_intern_global());
+    a = cra_intern_cstr(intern, "global");
+    b = cra_intern_cstr(cra_intern_global(), "global");
+    assert_always(a == b);
+    cra_intern_global_release();
+
+    // 可以重新初始化
+    intern = cra_intern_global();
+    assert_always(intern && cra_intern_count(intern) == 0);
+    cra_intern_global_release();
+    cra_intern_global_release();
+}
+
+typedef struct
+{
+    char *name;
+    char *tag;
+    char  arr[16];
+} Rec;
+
+CRA_TYPE_META_BEGIN(rec_meta)
+CRA_TYPE_META_MEMBER_STRING(Rec, name, 1, true)
+CRA_TYPE_META_MEMBER_STRING(Rec, tag, 2, true)
+CRA_TYPE_META_MEMBER_STRING(Rec, arr, 3, false)
+CRA_TYPE_META_END();
+
+void
+test_json(void)
+{
+    char      json1[] = "{\"name\": \"tom\", \"tag\": \"a\\nb\\u4e2d\", \"arr\": \"x\"}";
+    char      json2[] = "{\"name\": \"tom\", \"tag\": \"tom\", \"arr\": \"y\"}";
+    char      json3[] = "{\"name\": \"bob\", \"tag\": \"bad\\q\", \"arr\": \"z\"}";
+    Rec       r1, r2, r3;
+    CraSerErr err;
+    CraIntern intern;
+
+    assert_always(cra_intern_init(&intern, 4));
+
+    assert_always(cra_json_parse_with_intern(json1, sizeof(json1), CRA_SERI_STRUCT(r1, false, rec_meta, NULL, NULL),
+                                             &intern, &err));
+    assert_always(strcmp(r1.name, "tom") == 0);
+    assert_always(strcmp(r1.tag, "a\nb\xe4\xb8\xad") == 0 && cra_intern_len(r1.tag) == strlen(r1.tag));
+    assert_always(strcmp(r1.arr, "x") == 0);
+    assert_always(r1.tag == cra_intern_cstr(&intern, "a\nb\xe4\xb8\xad"));
+
+    assert_always(cra_json_parse_with_intern(json2, sizeof(json2), CRA_SERI_STRUCT(r2, false, rec_meta, NULL, NULL),
+                                             &intern, &err));
+    // 相同内容的字段共享指针
+    assert_always(r1.name == r2.name);
+    assert_always(r2.name == r2.tag);
+    assert_always(strcmp(r2.arr, "y") == 0);
+    assert_always(cra_intern_count(&intern) == 2);
+
+    // 失败时也不泄漏
+    assert_always(!cra_json_parse_with_intern(json3, sizeof(json3), CRA_SERI_STRUCT(r3, false, rec_meta, NULL, NULL),
+                                              &intern, &err));
+    assert_always(err.err == CRA_SER_ERR_INVALID_VAL);
+
+    // 不驻留时和以前一样
+    assert_always(cra_json_parse(json2, sizeof(json2), CRA_SERI_STRUCT(r3, false, rec_meta, NULL, NULL)));
+    assert_always(r3.name != r2.name && strcmp(r3.name, r2.name) == 0);
+    cra_free(r3.name);
+    cra_free(r3.tag);
+
+    cra_intern_uninit(&intern);
+}
+
+void
+test_bin(void)
+{
+    unsigned char buf[256];
+    size_t        len = sizeof(buf);
+    Rec           in = { .name = "tom", .tag = "", .arr = "x" }, r1, r2;
+    CraIntern     intern;
+
+    assert_always(cra_intern_init(&intern, 4));
+
+    assert_always(cra_bin_serialize(buf, &len, CRA_SERI_STRUCT(in, false, rec_meta, NULL, NULL)));
+    assert_always(cra_bin_deserialize_with_intern(buf, len, CRA_SERI_STRUCT(r1, false, rec_meta, NULL, NULL), &intern,
+                                                  NULL));
+    assert_always(cra_bin_deserialize_with_intern(buf, len, CRA_SERI_STRUCT(r2, false, rec_meta, NULL, NULL), &intern,
+                                                  NULL));
+    assert_always(strcmp(r1.name, "tom") == 0 && strcmp(r1.tag, "") == 0 && strcmp(r1.arr, "x") == 0);
+    assert_always(r1.name == r2.name && r1.tag == r2.tag);
+    assert_always(r1.name == cra_intern_cstr(&intern, "tom"));
+    assert_always(cra_intern_count(&intern) == 2);
+
+    cra_intern_uninit(&intern);
+}
+
+int
+main(void)
+{
+    test_intern();
+    test_long();
+    test_threads();
+    test_global();
+    test_json();
+    test_bin();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -657,6 +657,174 @@ test_test(void)
     cra_dealloc(list);
 }
 
+void
+test_nodepool(void)
+{
+    int           val;
+    CraMemPool    pool;
+    CraLList      list1, list2;
+    CraLListNode *node;
+    unsigned char *prev;
+
+    assert_always(cra_llist_nodepool_init(int, &pool, 64));
+    assert_always(pool.item_size == CRA_LLIST_NODE_SIZE(sizeof(int)) && pool.item_size % sizeof(void *) == 0);
+    assert_always(cra_llist_init_with_pool(int, &list1, &pool));
+    assert_always(cra_llist_init_with_pool(int, &list2, &pool));
+
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_llist_append(i % 2 == 0 ? &list1 : &list2, &i));
+    assert_always(list1.count == 500 && list2.count == 500);
+    assert_always(pool.nfree == pool.blocks.count * pool.items_per_block - 1000);
+
+    // 同一块中连续申请的节点地址相邻
+    prev = NULL;
+    for (size_t i = 0; i < 32; i++)
+    {
+        node = cra_llist_get_node(&list1, i);
+        if (prev)
+            assert_always((unsigned char *)node == prev + 2 * pool.item_size);
+        prev = (unsigned char *)node;
+    }
+
+    // 删除的节点直接还给节点池，另一个链表可以使用
+    for (int i = 0; i < 500; i++)
+        assert_always(cra_llist_pop_front(&list1, &val) && val == i * 2);
+    assert_always(list1.nfreelist == 0 && list1.free_list == NULL);
+    assert_always(pool.nfree == pool.blocks.count * pool.items_per_block - 500);
+    for (int i = 1000; i < 1500; i++)
+        assert_always(cra_llist_append(&list2, &i));
+    assert_always(pool.nfree == pool.blocks.count * pool.items_per_block - 1000);
+
+    assert_always(cra_llist_sort(&list2, cra_cmp_int_p));
+    assert_always(cra_llist_reserve(&list2, 100) && list2.nfreelist == 0);
+    cra_llist_reverse(&list2);
+    val = 1499;
+    CRA_FOREACH(CRA_LLIST_ITERABLE_I, &list2, vals)
+    {
+        assert_always(*(int *)vals.val_ref == val);
+        val -= val > 999 ? 1 : 2;
+    }
+
+    cra_llist_clear(&list2);
+    assert_always(list2.count == 0 && list2.nfreelist == 0);
+    assert_always(pool.nfree == pool.blocks.count * pool.items_per_block);
+    assert_always(cra_llist_append(&list2, &val));
+
+    cra_llist_uninit(&list1);
+    cra_llist_uninit(&list2);
+    assert_always(cra_mempool_trim(&pool) && pool.blocks.count == 1);
+    cra_mempool_uninit(&pool);
+}
+
+typedef struct
+{
+    int key;
+    int seq;
+} SortItem;
+
+static int
+compare_sort_item(const SortItem *a, const SortItem *b)
+{
+    return a->key - b->key;
+}
+
+typedef enum
+{
+    SORT_RANDOM,   // 大量重复的key
+    SORT_SORTED,   // 已有序
+    SORT_REVERSED, // 逆序，每3个相等
+    SORT_SAWTOOTH, // 升序段和带重复key的降序段交替
+} SortPattern_e;
+
+static int
+sort_item_key(SortPattern_e pattern, int i, int n)
+{
+    switch (pattern)
+    {
+        case SORT_RANDOM:
+            return rand() % 10;
+        case SORT_SORTED:
+            return i / 3;
+        case SORT_REVERSED:
+            return (n - i) / 3;
+        case SORT_SAWTOOTH:
+            return (i / 50) % 2 == 0 ? i % 50 : (50 - i % 50) / 2;
+    }
+    return 0;
+}
+
+static void
+test_sort_stable_with(bool (*sort)(CraLList *, cra_cmp_fn))
+{
+    int           n;
+    SortItem      item, prev;
+    CraLList      list;
+    CraLListNode *first;
+
+    // 包含非2的幂和最小有序段附近的长度、跨越多个排序块的随机链表，
+    // 以及很大的已有序/逆序链表(快排会递归很深)
+    struct
+    {
+        int           n;
+        SortPattern_e pattern;
+    } cases[] = {
+        { 0, SORT_RANDOM },        { 1, SORT_RANDOM },        { 2, SORT_RANDOM },         { 3, SORT_RANDOM },
+        { 7, SORT_RANDOM },        { 31, SORT_RANDOM },       { 32, SORT_RANDOM },        { 33, SORT_RANDOM },
+        { 100, SORT_RANDOM },      { 1000, SORT_RANDOM },     { 10000, SORT_RANDOM },     { 1000, SORT_SAWTOOTH },
+        { 200000, SORT_SORTED },   { 200000, SORT_REVERSED },
+    };
+
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+    {
+        n = cases[k].n;
+        assert_always(cra_llist_init(SortItem, &list));
+        for (int i = 0; i < n; i++)
+        {
+            item.key = sort_item_key(cases[k].pattern, i, n);
+            item.seq = i;
+            assert_always(cra_llist_append(&list, &item));
+        }
+        first = list.head;
+
+        assert_always(sort(&list, (cra_cmp_fn)compare_sort_item));
+        assert_always(list.count == (size_t)n);
+
+        // 有序且稳定
+        prev.key = -1;
+        prev.seq = -1;
+        CRA_FOREACH(CRA_LLIST_ITERABLE_I, &list, vals)
+        {
+            item = *(SortItem *)vals.val_ref;
+            assert_always(item.key > prev.key || (item.key == prev.key && item.seq > prev.seq));
+            prev = item;
+        }
+        // prev指针正确
+        n = (int)list.count;
+        CRA_FOREACH_REVERSE(CRA_LLIST_ITERABLE_I, &list, vals)
+        {
+            item = *(SortItem *)vals.val_ref;
+            assert_always(item.key <= prev.key);
+            prev = item;
+            n--;
+        }
+        assert_always(n == 0);
+        // 节点没有被复制，原来的第一个节点仍然是seq为0的元素
+        if (first)
+            assert_always(((SortItem *)first->val)->seq == 0);
+
+        cra_llist_uninit(&list);
+    }
+}
+
+void
+test_sort_stable(void)
+{
+    // 原地的链表归并排序
+    test_sort_stable_with(cra_llist_sort);
+    // 借助节点指针数组的排序
+    test_sort_stable_with(cra_llist_sort_buffered);
+}
+
 int
 main(void)
 {
@@ -668,8 +836,10 @@ main(void)
     test_get();
     test_reverse();
     test_sort();
+    test_sort_stable();
     test_foreach();
     test_test();
+    test_nodepool();
 
     cra_memory_leak_report();
     return 0;
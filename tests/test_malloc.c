@@ -98,6 +98,24 @@ test_malloc_free_dbg2(void)
     __cra_memory_leak_report();
 }
 
+void
+test_aligned(void)
+{
+    size_t align[] = { 1, 8, 64, 4096 };
+
+    for (size_t i = 0; i < sizeof(align) / sizeof(align[0]); i++)
+    {
+        char *p = (char *)cra_aligned_malloc(100, align[i]);
+        assert_always(p != NULL);
+        assert_always(((uintptr_t)p & (align[i] - 1)) == 0);
+        memset(p, 0xff, 100);
+        cra_aligned_free(p);
+    }
+    cra_aligned_free(NULL);
+
+    cra_memory_leak_report();
+}
+
 #if 1 // custom
 
 static void *
@@ -156,6 +174,7 @@ main(void)
     test_normal();
     test_malloc_free_dbg1(true);
     test_malloc_free_dbg2();
+    test_aligned();
     test_custom();
 
     return 0;
@@ -74,10 +74,89 @@ test_mempool(void)
     cra_mempool_uninit(&pool);
 }
 
+void
+test_mempool_trim(void)
+{
+    int       *p[10];
+    CraMemPool pool;
+
+    assert_always(cra_mempool_init(&pool, sizeof(int), 4, 1));
+
+    // 同一块中按地址从低到高分配
+    for (int i = 0; i < 10; i++)
+        p[i] = (int *)cra_mempool_alloc(&pool);
+    for (int i = 1; i < 4; i++)
+        assert_always((char *)p[i] == (char *)p[i - 1] + pool.item_stride);
+    assert_always(pool.blocks.count == 3);
+
+    // 有对象在使用
+    assert_always(!cra_mempool_trim(&pool) && pool.blocks.count == 3);
+
+    for (int i = 0; i < 10; i++)
+        cra_mempool_dealloc(&pool, p[i]);
+    assert_always(cra_mempool_trim(&pool));
+    assert_always(pool.blocks.count == 1 && pool.nfree == 4);
+
+    for (int i = 0; i < 4; i++)
+        p[i] = (int *)cra_mempool_alloc(&pool);
+    for (int i = 0; i < 4; i++)
+        cra_mempool_dealloc(&pool, p[i]);
+
+    cra_mempool_uninit(&pool);
+}
+
+void
+test_mempool_release_unused(void)
+{
+    int       *p[12];
+    CraMemPool pool;
+
+    assert_always(cra_mempool_init(&pool, sizeof(int), 4, 1));
+    assert_always(pool.item_stride >= sizeof(void *));
+
+    for (int i = 0; i < 12; i++)
+        p[i] = (int *)cra_mempool_alloc(&pool);
+    assert_always(pool.blocks.count == 3 && pool.nfree == 0);
+    assert_always(cra_mempool_release_unused(&pool) == 0);
+
+    // 第二块全部空闲，第一、三块各有一个对象在使用
+    for (int i = 1; i < 12; i++)
+    {
+        if (i != 8)
+            cra_mempool_dealloc(&pool, p[i]);
+    }
+    assert_always(cra_mempool_release_unused(&pool) == 1);
+    assert_always(pool.blocks.count == 2 && pool.nfree == 6);
+
+    // 剩下的空闲对象都还能用，而且不会分配到已释放的块
+    for (int i = 1; i < 7; i++)
+    {
+        p[i] = (int *)cra_mempool_alloc(&pool);
+        *p[i] = i;
+    }
+    assert_always(pool.blocks.count == 2 && pool.nfree == 0);
+    for (int i = 1; i < 7; i++)
+        cra_mempool_dealloc(&pool, p[i]);
+
+    cra_mempool_dealloc(&pool, p[0]);
+    cra_mempool_dealloc(&pool, p[8]);
+    assert_always(cra_mempool_release_unused(&pool) == 2);
+    assert_always(pool.blocks.count == 0 && pool.nfree == 0);
+
+    // 没有块时alloc会重新创建
+    p[0] = (int *)cra_mempool_alloc(&pool);
+    assert_always(p[0] != NULL && *p[0] == 0 && pool.blocks.count == 1);
+    cra_mempool_dealloc(&pool, p[0]);
+
+    cra_mempool_uninit(&pool);
+}
+
 int
 main(void)
 {
     test_mempool();
+    test_mempool_trim();
+    test_mempool_release_unused();
 
     cra_memory_leak_report();
     return 0;
@@ -0,0 +1,351 @@
+/**
+ * @file test_mpmcq.c
+ * @author Cracal
+ * @brief test bounded MPMC queue
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "threads/cra_mpmcq.h"
+#include "threads/cra_thread.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+
+#define cra_mpmcq_is_closed_for_test(que) (cra_atomic_load32(&(que)->closed, CRA_MO_ACQUIRE) != 0)
+
+void
+test_init(void)
+{
+    int      val;
+    CraMpmcq que;
+
+    assert_always(cra_mpmcq_init(int, &que, 5, CRA_BLOCKDQ_FULL_RETURN_FALSE));
+    assert_always(cra_mpmcq_capacity(&que) == 8);
+    assert_always(cra_mpmcq_count(&que) == 0);
+    assert_always(!cra_mpmcq_try_pop(&que, &val));
+    cra_mpmcq_uninit(&que);
+
+    assert_always(cra_mpmcq_init(int, &que, 1, CRA_BLOCKDQ_FULL_RETURN_FALSE));
+    assert_always(cra_mpmcq_capacity(&que) == 2);
+    cra_mpmcq_uninit(&que);
+}
+
+void
+test_fifo(void)
+{
+    int      val;
+    CraMpmcq que;
+
+    assert_always(cra_mpmcq_init(int, &que, 8, CRA_BLOCKDQ_FULL_RETURN_FALSE));
+
+    // 多绕几圈
+    for (int round = 0; round < 10; round++)
+    {
+        for (int i = 0; i < 8; i++)
+            assert_always(cra_mpmcq_try_push(&que, &(int){ round * 8 + i }));
+        assert_always(cra_mpmcq_count(&que) == 8);
+        assert_always(!cra_mpmcq_try_push(&que, &(int){ -1 }));
+        for (int i = 0; i < 5; i++)
+            assert_always(cra_mpmcq_pop(&que, &val) && val == round * 8 + i);
+        for (int i = 5; i < 8; i++)
+            assert_always(cra_mpmcq_try_pop(&que, &val) && val == round * 8 + i);
+        assert_always(!cra_mpmcq_try_pop(&que, &val));
+    }
+
+    cra_mpmcq_uninit(&que);
+}
+
+void
+test_full_policy(void)
+{
+    int      val, drop;
+    CraMpmcq que;
+
+    // return false
+    assert_always(cra_mpmcq_init(int, &que, 4, CRA_BLOCKDQ_FULL_RETURN_FALSE));
+    for (int i = 0; i < 4; i++)
+        assert_always(cra_mpmcq_push(&que, &i, NULL));
+    assert_always(!cra_mpmcq_push(&que, &(int){ 4 }, &drop));
+    for (int i = 0; i < 4; i++)
+        assert_always(cra_mpmcq_try_pop(&que, &val) && val == i);
+    cra_mpmcq_uninit(&que);
+
+    // drop oldest: 队列中保留最新的4个
+    assert_always(cra_mpmcq_init(int, &que, 4, CRA_BLOCKDQ_FULL_DROP_OLDEST));
+    for (int i = 0; i < 4; i++)
+        assert_always(cra_mpmcq_push(&que, &i, &drop));
+    for (int i = 4; i < 10; i++)
+    {
+        drop = -1;
+        assert_always(cra_mpmcq_push(&que, &i, &drop));
+        assert_always(drop == i - 4);
+        assert_always(cra_mpmcq_count(&que) == 4);
+    }
+    assert_always(cra_mpmcq_push(&que, &(int){ 10 }, NULL));
+    for (int i = 7; i <= 10; i++)
+        assert_always(cra_mpmcq_try_pop(&que, &val) && val == i);
+    assert_always(!cra_mpmcq_try_pop(&que, &val));
+    cra_mpmcq_uninit(&que);
+
+    // drop newest: 队列中保留最早的4个，丢弃新来的
+    assert_always(cra_mpmcq_init(int, &que, 4, CRA_BLOCKDQ_FULL_DROP_NEWEST));
+    for (int i = 0; i < 4; i++)
+        assert_always(cra_mpmcq_push(&que, &i, &drop));
+    for (int i = 4; i < 10; i++)
+    {
+        drop = -1;
+        assert_always(cra_mpmcq_push(&que, &i, &drop));
+        assert_always(drop == i);
+    }
+    for (int i = 0; i < 4; i++)
+        assert_always(cra_mpmcq_try_pop(&que, &val) && val == i);
+    cra_mpmcq_uninit(&que);
+}
+
+void
+test_shutdown(void)
+{
+    int      val;
+    CraMpmcq que;
+
+    assert_always(cra_mpmcq_init(int, &que, 4, CRA_BLOCKDQ_FULL_WAIT));
+    assert_always(cra_mpmcq_push(&que, &(int){ 1 }, NULL));
+    assert_always(cra_mpmcq_push(&que, &(int){ 2 }, NULL));
+
+    cra_mpmcq_shutdown(&que, CRA_BLOCKDQ_CLOSE_ENQUEUE);
+    assert_always(!cra_mpmcq_push(&que, &(int){ 3 }, NULL));
+    assert_always(!cra_mpmcq_try_push(&que, &(int){ 3 }));
+    assert_always(cra_mpmcq_pop(&que, &val) && val == 1);
+
+    // 关闭出队后仍然可以取出剩余的元素
+    cra_mpmcq_shutdown(&que, CRA_BLOCKDQ_CLOSE_DEQUEUE);
+    assert_always(cra_mpmcq_pop(&que, &val) && val == 2);
+    assert_always(!cra_mpmcq_pop(&que, &val));
+
+    cra_mpmcq_uninit(&que);
+}
+
+#define NPRODUCERS         4
+#define NCONSUMERS         4
+#define ITEMS_PER_PRODUCER 100000
+
+typedef struct
+{
+    CraMpmcq *que;
+    int       id;
+    long long sum;
+    int       count;
+    char     *seen;
+} ThrdArg;
+
+static CRA_THRD_FUNC(producer_func)
+{
+    int      val;
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    for (int i = 0; i < ITEMS_PER_PRODUCER; i++)
+    {
+        val = targ->id * ITEMS_PER_PRODUCER + i;
+        assert_always(cra_mpmcq_push(targ->que, &val, NULL));
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(consumer_func)
+{
+    int      val;
+    int      last[NPRODUCERS];
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    for (int i = 0; i < NPRODUCERS; i++)
+        last[i] = -1;
+    while (cra_mpmcq_pop(targ->que, &val))
+    {
+        // 同一个生产者的元素按顺序出队
+        assert_always(val % ITEMS_PER_PRODUCER > last[val / ITEMS_PER_PRODUCER]);
+        last[val / ITEMS_PER_PRODUCER] = val % ITEMS_PER_PRODUCER;
+        assert_always(targ->seen[val] == 0);
+        targ->seen[val] = 1;
+        targ->sum += val;
+        targ->count++;
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static void
+test_threads_with_capacity(size_t capacity)
+{
+    int        count;
+    long long  sum;
+    char      *seen;
+    CraMpmcq   que;
+    cra_thrd_t producers[NPRODUCERS], consumers[NCONSUMERS];
+    ThrdArg    pargs[NPRODUCERS], cargs[NCONSUMERS];
+
+    seen = (char *)cra_calloc(NPRODUCERS * ITEMS_PER_PRODUCER, sizeof(char));
+    assert_always(cra_mpmcq_init(int, &que, capacity, CRA_BLOCKDQ_FULL_WAIT));
+
+    for (int i = 0; i < NCONSUMERS; i++)
+    {
+        cargs[i] = (ThrdArg){ .que = &que, .id = i, .sum = 0, .count = 0, .seen = seen };
+        assert_always(cra_thrd_create(&consumers[i], consumer_func, &cargs[i]));
+    }
+    for (int i = 0; i < NPRODUCERS; i++)
+    {
+        pargs[i] = (ThrdArg){ .que = &que, .id = i };
+        assert_always(cra_thrd_create(&producers[i], producer_func, &pargs[i]));
+    }
+    for (int i = 0; i < NPRODUCERS; i++)
+        cra_thrd_join(producers[i]);
+    // 消费者取完剩余的元素后退出
+    cra_mpmcq_shutdown(&que, CRA_BLOCKDQ_CLOSE_ALL);
+    for (int i = 0; i < NCONSUMERS; i++)
+        cra_thrd_join(consumers[i]);
+
+    sum = 0;
+    count = 0;
+    for (int i = 0; i < NCONSUMERS; i++)
+    {
+        sum += cargs[i].sum;
+        count += cargs[i].count;
+    }
+    assert_always(count == NPRODUCERS * ITEMS_PER_PRODUCER);
+    assert_always(sum == (long long)count * (count - 1) / 2);
+    assert_always(cra_mpmcq_count(&que) == 0);
+
+    cra_mpmcq_uninit(&que);
+    cra_free(seen);
+}
+
+void
+test_threads(void)
+{
+    // 容量很小时生产者/消费者会频繁挂起
+    test_threads_with_capacity(2);
+    test_threads_with_capacity(1024);
+}
+
+static CRA_THRD_FUNC(drop_producer_func)
+{
+    int      val, drop;
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    for (int i = 0; i < ITEMS_PER_PRODUCER; i++)
+    {
+        val = targ->id * ITEMS_PER_PRODUCER + i;
+        drop = -1;
+        assert_always(cra_mpmcq_push(targ->que, &val, &drop));
+        if (drop != -1)
+        {
+            // 每个元素只会被丢弃或取出一次
+            assert_always(__atomic_fetch_add(&targ->seen[drop], 1, __ATOMIC_RELAXED) == 0);
+            targ->count++;
+        }
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(try_consumer_func)
+{
+    int      val;
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    while (!cra_mpmcq_is_closed_for_test(targ->que))
+    {
+        if (cra_mpmcq_try_pop(targ->que, &val))
+        {
+            assert_always(__atomic_fetch_add(&targ->seen[val], 1, __ATOMIC_RELAXED) == 0);
+            targ->count++;
+        }
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+void
+test_drop_oldest_threads(void)
+{
+    int        val, count;
+    char      *seen;
+    CraMpmcq   que;
+    cra_thrd_t producers[NPRODUCERS], consumers[NCONSUMERS];
+    ThrdArg    pargs[NPRODUCERS], cargs[NCONSUMERS];
+
+    seen = (char *)cra_calloc(NPRODUCERS * ITEMS_PER_PRODUCER, sizeof(char));
+    assert_always(cra_mpmcq_init(int, &que, 4, CRA_BLOCKDQ_FULL_DROP_OLDEST));
+
+    for (int i = 0; i < NCONSUMERS; i++)
+    {
+        cargs[i] = (ThrdArg){ .que = &que, .id = i, .count = 0, .seen = seen };
+        assert_always(cra_thrd_create(&consumers[i], try_consumer_func, &cargs[i]));
+    }
+    for (int i = 0; i < NPRODUCERS; i++)
+    {
+        pargs[i] = (ThrdArg){ .que = &que, .id = i, .count = 0, .seen = seen };
+        assert_always(cra_thrd_create(&producers[i], drop_producer_func, &pargs[i]));
+    }
+    for (int i = 0; i < NPRODUCERS; i++)
+        cra_thrd_join(producers[i]);
+    cra_mpmcq_shutdown(&que, CRA_BLOCKDQ_CLOSE_ALL);
+    for (int i = 0; i < NCONSUMERS; i++)
+        cra_thrd_join(consumers[i]);
+
+    // 取出 + 丢弃 + 剩余 == 放入
+    count = 0;
+    for (int i = 0; i < NPRODUCERS; i++)
+        count += pargs[i].count;
+    for (int i = 0; i < NCONSUMERS; i++)
+        count += cargs[i].count;
+    while (cra_mpmcq_try_pop(&que, &val))
+    {
+        assert_always(seen[val]++ == 0);
+        count++;
+    }
+    assert_always(count == NPRODUCERS * ITEMS_PER_PRODUCER);
+
+    cra_mpmcq_uninit(&que);
+    cra_free(seen);
+}
+
+static CRA_THRD_FUNC(blocked_consumer_func)
+{
+    int      val;
+    ThrdArg *targ = (ThrdArg *)arg;
+
+    targ->count = cra_mpmcq_pop(targ->que, &val) ? 1 : 0;
+    return (cra_thrd_ret_t){ 0 };
+}
+
+void
+test_shutdown_wakeup(void)
+{
+    CraMpmcq   que;
+    cra_thrd_t thrd;
+    ThrdArg    targ;
+
+    // 挂起的消费者被shutdown唤醒
+    assert_always(cra_mpmcq_init(int, &que, 4, CRA_BLOCKDQ_FULL_WAIT));
+    targ = (ThrdArg){ .que = &que, .count = -1 };
+    assert_always(cra_thrd_create(&thrd, blocked_consumer_func, &targ));
+    cra_msleep(50);
+    cra_mpmcq_shutdown(&que, CRA_BLOCKDQ_CLOSE_DEQUEUE);
+    cra_thrd_join(thrd);
+    assert_always(targ.count == 0);
+    cra_mpmcq_uninit(&que);
+}
+
+int
+main(void)
+{
+    test_init();
+    test_fifo();
+    test_full_policy();
+    test_shutdown();
+    test_threads();
+    test_drop_oldest_threads();
+    test_shutdown_wakeup();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file test_parallel_sort.c
+ * @author Cracal
+ * @brief test parallel sort
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include "threads/cra_parallel_sort.h"
+#include <time.h>
+
+#define N 500000
+
+typedef struct
+{
+    int key;
+    int seq;
+} Item;
+
+static int
+compare_item(const Item *a, const Item *b)
+{
+    return a->key < b->key ? -1 : (a->key > b->key ? 1 : 0);
+}
+
+static void
+fill(CraAList *list, int pattern, int n)
+{
+    Item item;
+
+    cra_alist_clear(list);
+    for (int i = 0; i < n; i++)
+    {
+        switch (pattern)
+        {
+            case 0:
+                item.key = i;
+                break;
+            case 1:
+                item.key = n - i;
+                break;
+            case 2:
+                item.key = 42;
+                break;
+            case 3:
+                item.key = rand() % 10;
+                break;
+            default:
+                item.key = rand() - RAND_MAX / 2;
+                break;
+        }
+        item.seq = i;
+        assert_always(cra_alist_append(list, &item));
+    }
+}
+
+static void
+check_sorted(CraAList *list, int n)
+{
+    long long seqsum = 0;
+
+    assert_always((int)list->count == n);
+    for (int i = 0; i < n; i++)
+    {
+        Item *item = cra_alist_get_ref(list, i);
+        seqsum += item->seq;
+        if (i > 0)
+            assert_always(((Item *)cra_alist_get_ref(list, i - 1))->key <= item->key);
+    }
+    // 是原数组的一个排列
+    assert_always(seqsum == (long long)n * (n - 1) / 2);
+}
+
+void
+test_patterns(void)
+{
+    int         sizes[] = { 0, 1, 100, CRA_PARALLEL_SORT_THRESHOLD - 1, CRA_PARALLEL_SORT_THRESHOLD, N };
+    CraAList    list;
+    CraThrdPool pool;
+
+    cra_thrdpool_init(&pool, 4, CRA_THRDPOOL_INFINITE_TASKS, CRA_THRDPOOL_FULL_WAIT);
+    assert_always(cra_alist_init(Item, &list));
+
+    for (int p = 0; p <= 4; p++)
+    {
+        for (size_t k = 0; k < CRA_NARRAY(sizes); k++)
+        {
+            fill(&list, p, sizes[k]);
+            assert_always(cra_alist_parallel_sort(&list, compare_item, &pool));
+            check_sorted(&list, sizes[k]);
+        }
+    }
+
+    cra_alist_uninit(&list);
+    cra_thrdpool_uninit(&pool, true);
+}
+
+void
+test_deterministic(void)
+{
+    CraAList    data, list, expect;
+    CraThrdPool pool1, pool8;
+
+    cra_thrdpool_init(&pool1, 1, CRA_THRDPOOL_INFINITE_TASKS, CRA_THRDPOOL_FULL_WAIT);
+    cra_thrdpool_init(&pool8, 8, 2, CRA_THRDPOOL_FULL_RETURN_FALSE);
+    assert_always(cra_alist_init(Item, &data));
+    assert_always(cra_alist_init(Item, &list));
+    assert_always(cra_alist_init(Item, &expect));
+
+    // 重复的key很多，不稳定排序下相同key的顺序也必须一致
+    fill(&data, 3, N);
+    assert_always(cra_alist_reserve(&list, N) && cra_alist_reserve(&expect, N));
+    memcpy(expect.array, data.array, N * sizeof(Item));
+    expect.count = N;
+    assert_always(cra_alist_parallel_sort(&expect, compare_item, &pool1));
+
+    for (int i = 0; i < 3; i++)
+    {
+        memcpy(list.array, data.array, N * sizeof(Item));
+        list.count = N;
+        // 任务队列很小，有的helper会提交失败
+        assert_always(cra_alist_parallel_sort(&list, compare_item, &pool8));
+        assert_always(memcmp(list.array, expect.array, N * sizeof(Item)) == 0);
+    }
+
+    cra_alist_uninit(&data);
+    cra_alist_uninit(&list);
+    cra_alist_uninit(&expect);
+    cra_thrdpool_uninit(&pool1, true);
+    cra_thrdpool_uninit(&pool8, true);
+}
+
+static void
+sort_in_task(void *arg1, void *arg2)
+{
+    CraAList *list = (CraAList *)arg1;
+    assert_always(cra_alist_parallel_sort(list, compare_item, (CraThrdPool *)arg2));
+}
+
+void
+test_from_worker(void)
+{
+    CraAList    list;
+    CraThrdPool pool;
+
+    // 只有一个工作线程且正在执行排序时，调用线程自己完成所有任务，不会死锁
+    cra_thrdpool_init(&pool, 1, CRA_THRDPOOL_INFINITE_TASKS, CRA_THRDPOOL_FULL_WAIT);
+    assert_always(cra_alist_init(Item, &list));
+    fill(&list, 4, N);
+
+    assert_always(cra_thrdpool_add_task2(&pool, sort_in_task, &list, &pool));
+    cra_thrdpool_uninit(&pool, true);
+    check_sorted(&list, N);
+
+    cra_alist_uninit(&list);
+}
+
+static void
+noop_task(void *arg)
+{
+    CRA_UNUSED(arg);
+}
+
+void
+test_from_worker_full_queue(void)
+{
+    CraAList    list;
+    CraThrdPool pool;
+
+    // 唯一的工作线程在排序，而有界队列被另一个任务占满，阻塞提交helper会永远等下去
+    cra_thrdpool_init(&pool, 1, 1, CRA_THRDPOOL_FULL_WAIT);
+    assert_always(cra_alist_init(Item, &list));
+    fill(&list, 4, N);
+
+    assert_always(cra_thrdpool_add_task2(&pool, sort_in_task, &list, &pool));
+    assert_always(cra_thrdpool_add_task1(&pool, noop_task, NULL));
+    cra_thrdpool_uninit(&pool, true);
+    check_sorted(&list, N);
+
+    cra_alist_uninit(&list);
+}
+
+int
+main(void)
+{
+    srand((unsigned int)time(NULL));
+
+    test_patterns();
+    test_deterministic();
+    test_from_worker();
+    test_from_worker_full_queue();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_perfectdict.c
+ * @author Cracal
+ * @brief test perfect hash dictionary
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_perfectdict.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+
+void
+test_from_arrays(void)
+{
+    int            keys[1000];
+    double         vals[1000], val;
+    CraPerfectDict dict;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        keys[i] = i * 7 - 3000;
+        vals[i] = i * 0.5;
+    }
+
+    assert_always(cra_perfectdict_init_from_arrays(int, double, &dict, keys, vals, 1000, cra_hash_int_p,
+                                                   cra_cmp_int_p));
+    assert_always(dict.count == 1000);
+    assert_always(dict.key_size == sizeof(int));
+    assert_always(dict.val_size == sizeof(double));
+    assert_always(dict.val_offset % alignof(double) == 0);
+    for (int i = 0; i < 1000; i++)
+    {
+        assert_always(cra_perfectdict_get(&dict, &keys[i], &val) && val == vals[i]);
+        assert_always(*(double *)cra_perfectdict_get_ref_with_hash(&dict, &keys[i], cra_hash_int_p(&keys[i])) ==
+                      vals[i]);
+    }
+    for (int i = -3000; i < 4000; i++)
+    {
+        if ((i + 3000) % 7 != 0)
+            assert_always(!cra_perfectdict_get_ref(&dict, &i));
+    }
+
+    // val可以修改
+    *(double *)cra_perfectdict_get_ref(&dict, &keys[10]) = -1.0;
+    assert_always(cra_perfectdict_get(&dict, &keys[10], &val) && val == -1.0);
+    cra_perfectdict_uninit(&dict);
+
+    // 空
+    assert_always(cra_perfectdict_init_from_arrays(int, double, &dict, keys, vals, 0, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(dict.count == 0);
+    assert_always(!cra_perfectdict_get(&dict, &keys[0], &val));
+    cra_perfectdict_uninit(&dict);
+
+    // 只有一个
+    assert_always(cra_perfectdict_init_from_arrays(int, double, &dict, keys, vals, 1, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(cra_perfectdict_get(&dict, &keys[0], &val) && val == vals[0]);
+    assert_always(!cra_perfectdict_get(&dict, &keys[1], &val));
+    cra_perfectdict_uninit(&dict);
+
+    // 重复的key
+    keys[500] = keys[20];
+    assert_always(!cra_perfectdict_init_from_arrays(int, double, &dict, keys, vals, 1000, cra_hash_int_p,
+                                                    cra_cmp_int_p));
+}
+
+void
+test_from_dict(void)
+{
+    char          *key;
+    int            val;
+    size_t         count;
+    char           buf[20];
+    char          *strs[2000];
+    CraDict        src;
+    CraPerfectDict dict;
+
+    assert_always(cra_dict_init(char *, int, &src, cra_hash_string1_p, cra_cmp_string_p));
+    for (int i = 0; i < 2000; i++)
+    {
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        strs[i] = cra_malloc(strlen(buf) + 1);
+        strcpy(strs[i], buf);
+        assert_always(cra_dict_add(&src, &strs[i], &i));
+    }
+    for (int i = 0; i < 2000; i += 5)
+        assert_always(cra_dict_remove(&src, &strs[i]));
+
+    assert_always(cra_perfectdict_init_from_dict(&dict, &src));
+    assert_always(dict.count == src.count);
+    for (int i = 0; i < 2000; i++)
+    {
+        // 用另一份字符串查找
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        key = buf;
+        assert_always(cra_perfectdict_get(&dict, &key, &val) == (i % 5 != 0));
+        if (i % 5 != 0)
+            assert_always(val == i);
+    }
+
+    count = 0;
+    CRA_FOREACH(CRA_PERFECTDICT_ITERABLE_I, &dict, kv)
+    {
+        assert_always(*(int *)cra_dict_get_ref(&src, (char **)kv.key_ref) == *(int *)kv.val_ref);
+        ++count;
+    }
+    assert_always(count == (size_t)dict.count);
+    count = 0;
+    CRA_FOREACH_REVERSE(CRA_PERFECTDICT_ITERABLE_I, &dict, kv)
+    {
+        ++count;
+    }
+    assert_always(count == (size_t)dict.count);
+
+    cra_perfectdict_uninit(&dict);
+    cra_dict_uninit(&src);
+    for (int i = 0; i < 2000; i++)
+        cra_free(strs[i]);
+}
+
+void
+test_large(void)
+{
+    int           *keys;
+    int           *vals;
+    int            n = 100000;
+    CraPerfectDict dict;
+
+    keys = cra_malloc(sizeof(int) * n);
+    vals = cra_malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = i * 13;
+        vals[i] = i;
+    }
+    assert_always(cra_perfectdict_init_from_arrays(int, int, &dict, keys, vals, n, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(dict.nbuckets * 4 >= dict.count);
+    for (int i = 0; i < n; i++)
+        assert_always(*(int *)cra_perfectdict_get_ref(&dict, &keys[i]) == i);
+    for (int i = 0; i < n; i++)
+        assert_always(!cra_perfectdict_get_ref(&dict, &(int){ i * 13 + 1 }));
+    cra_perfectdict_uninit(&dict);
+
+    cra_free(keys);
+    cra_free(vals);
+}
+
+int
+main(void)
+{
+    test_from_arrays();
+    test_from_dict();
+    test_large();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file test_rcudict.c
+ * @author Cracal
+ * @brief test rcu dictionary & epoch
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cra_assert.h"
+#include "cra_atomic.h"
+#include "cra_malloc.h"
+#include "threads/cra_rcudict.h"
+#include "threads/cra_thread.h"
+
+#define NREADERS 4
+#define NKEYS    2000
+
+static cra_atomic_int32_t g_nfreed;
+
+static void
+count_free(void *ptr)
+{
+    cra_atomic_inc32(&g_nfreed, CRA_MO_RELAXED);
+    cra_free(ptr);
+}
+
+static void
+test_epoch(void)
+{
+    CraEpoch        epoch;
+    CraEpochRecord *rec1, *rec2;
+
+    cra_epoch_init(&epoch);
+    cra_atomic_store32(&g_nfreed, 0, CRA_MO_RELAXED);
+
+    rec1 = cra_epoch_register(&epoch);
+    rec2 = cra_epoch_register(&epoch);
+    assert_always(rec1 && rec2 && rec1 != rec2);
+    assert_always(((uintptr_t)rec1 & (CRA_CACHELINE_SIZE - 1)) == 0);
+    assert_always(((uintptr_t)rec2 & (CRA_CACHELINE_SIZE - 1)) == 0);
+
+    // 没有读者时很快就能回收
+    cra_epoch_retire(&epoch, cra_malloc(8), count_free);
+    cra_epoch_synchronize(&epoch);
+    assert_always(cra_atomic_load32(&g_nfreed, CRA_MO_RELAXED) == 1);
+
+    // 读者停留在临界区内时不能回收
+    cra_epoch_enter(rec1);
+    cra_epoch_enter(rec1); // 嵌套
+    cra_epoch_exit(rec1);
+    cra_epoch_retire(&epoch, cra_malloc(8), count_free);
+    for (int i = 0; i < 10; i++)
+        cra_epoch_try_advance(&epoch);
+    assert_always(cra_atomic_load32(&g_nfreed, CRA_MO_RELAXED) == 1);
+    assert_always(epoch.nretired == 1);
+
+    // 不在临界区内的读者不影响回收
+    cra_epoch_enter(rec2);
+    cra_epoch_exit(rec2);
+    cra_epoch_exit(rec1);
+    cra_epoch_synchronize(&epoch);
+    assert_always(cra_atomic_load32(&g_nfreed, CRA_MO_RELAXED) == 2);
+    assert_always(epoch.nretired == 0);
+
+    // 注销的记录会被复用
+    cra_epoch_unregister(rec2);
+    assert_always(cra_epoch_register(&epoch) == rec2);
+
+    // uninit释放剩余的
+    cra_epoch_enter(rec1);
+    cra_epoch_retire(&epoch, cra_malloc(8), count_free);
+    cra_epoch_exit(rec1);
+    cra_epoch_uninit(&epoch);
+    assert_always(cra_atomic_load32(&g_nfreed, CRA_MO_RELAXED) == 3);
+}
+
+static void
+test_new_delete(void)
+{
+    CraRcuDict dict;
+
+    assert_always(cra_rcudict_init(int, double, &dict, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(dict.key_size == sizeof(int));
+    assert_always(dict.val_size == sizeof(double));
+    assert_always(dict.val_offset % alignof(double) == 0);
+    assert_always(cra_rcudict_count(&dict) == 0);
+    assert_always(((CraRcuDictTable *)cra_atomic_load_ptr(&dict.table, CRA_MO_RELAXED))->capacity ==
+                  CRA_RCUDICT_DEFAULT_CAPACITY);
+    cra_rcudict_uninit(&dict);
+
+    assert_always(cra_rcudict_init_with_size(int, char, &dict, 100, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(((CraRcuDictTable *)cra_atomic_load_ptr(&dict.table, CRA_MO_RELAXED))->capacity == 128);
+    cra_rcudict_uninit(&dict);
+}
+
+static void
+test_ops(void)
+{
+    int             val;
+    const int      *pval;
+    CraRcuDict      dict;
+    CraEpochRecord *reader;
+
+    cra_rcudict_init(int, int, &dict, cra_hash_int_p, cra_cmp_int_p);
+    reader = cra_rcudict_register_reader(&dict);
+
+    assert_always(!cra_rcudict_remove(&dict, &(int){ 0 }));
+    assert_always(!cra_rcudict_get(&dict, reader, &(int){ 0 }, &val));
+
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_rcudict_add(&dict, &i, &(int){ i + 1 }));
+    assert_always(cra_rcudict_count(&dict) == 1000);
+    assert_always(!cra_rcudict_add(&dict, &(int){ 3 }, &(int){ 0 }));
+
+    // 在临界区内拿到的引用，被put替换后依然有效
+    cra_rcudict_read_lock(reader);
+    pval = cra_rcudict_get_ref(&dict, &(int){ 3 });
+    assert_always(pval && *pval == 4);
+    assert_always(cra_rcudict_put_and_return_v(&dict, &(int){ 3 }, &(int){ 30 }, &val) && val == 4);
+    assert_always(*pval == 4);
+    assert_always(*(int *)cra_rcudict_get_ref(&dict, &(int){ 3 }) == 30);
+    cra_rcudict_read_unlock(reader);
+    assert_always(cra_rcudict_put(&dict, &(int){ 3 }, &(int){ 4 }));
+    assert_always(cra_rcudict_count(&dict) == 1000);
+
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_rcudict_get(&dict, reader, &i, &val) && val == i + 1);
+    for (int i = 0; i < 1000; i += 2)
+        assert_always(cra_rcudict_pop(&dict, &i, &val) && val == i + 1);
+    assert_always(cra_rcudict_count(&dict) == 500);
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_rcudict_get(&dict, reader, &i, &val) == (i % 2 == 1));
+
+    cra_rcudict_clear(&dict);
+    assert_always(cra_rcudict_count(&dict) == 0);
+    assert_always(!cra_rcudict_get(&dict, reader, &(int){ 1 }, &val));
+    assert_always(cra_rcudict_add(&dict, &(int){ 1 }, &(int){ 1 }));
+
+    cra_rcudict_unregister_reader(&dict, reader);
+    cra_rcudict_uninit(&dict);
+}
+
+typedef struct
+{
+    cra_atomic_int32_t *stop;
+    CraRcuDict         *dict;
+} ThrdArg;
+
+static CRA_THRD_FUNC(thrd_reader_func)
+{
+    int             val;
+    ThrdArg        *targ = (ThrdArg *)arg;
+    CraEpochRecord *reader = cra_rcudict_register_reader(targ->dict);
+
+    assert_always(reader);
+    while (cra_atomic_load32(targ->stop, CRA_MO_RELAXED) == 0)
+    {
+        // 每轮让出一次CPU，避免CPU少时饿死写者
+        cra_msleep(0);
+        for (int i = 0; i < NKEYS; i += 7)
+        {
+            // 读到的val要么不存在，要么是完整的
+            if (cra_rcudict_get(targ->dict, reader, &i, &val))
+                assert_always(val == i * 2 || val == i * 3);
+        }
+    }
+    cra_rcudict_unregister_reader(targ->dict, reader);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static void
+test_threads(void)
+{
+    int                val;
+    cra_thrd_t         thrds[NREADERS];
+    cra_atomic_int32_t stop;
+    CraRcuDict         dict;
+    CraEpochRecord    *reader;
+    ThrdArg            arg = { .stop = &stop, .dict = &dict };
+
+    cra_rcudict_init(int, int, &dict, cra_hash_int_p, cra_cmp_int_p);
+    cra_atomic_store32(&stop, 0, CRA_MO_RELAXED);
+
+    for (int i = 0; i < NREADERS; i++)
+        assert_always(cra_thrd_create(&thrds[i], thrd_reader_func, &arg));
+
+    // 单写者: 插入(多次扩容)、更新、删除
+    for (int i = 0; i < NKEYS; i++)
+        assert_always(cra_rcudict_add(&dict, &i, &(int){ i * 2 }));
+    for (int i = 0; i < NKEYS; i += 2)
+        assert_always(cra_rcudict_put(&dict, &i, &(int){ i * 3 }));
+    for (int i = 0; i < NKEYS; i += 3)
+        assert_always(cra_rcudict_remove(&dict, &i));
+    cra_rcudict_clear(&dict);
+    for (int i = 0; i < NKEYS; i++)
+        assert_always(cra_rcudict_add(&dict, &i, &(int){ i * 2 }));
+
+    cra_atomic_store32(&stop, 1, CRA_MO_RELAXED);
+    for (int i = 0; i < NREADERS; i++)
+        cra_thrd_join(thrds[i]);
+
+    reader = cra_rcudict_register_reader(&dict);
+    assert_always(cra_rcudict_count(&dict) == NKEYS);
+    for (int i = 0; i < NKEYS; i++)
+        assert_always(cra_rcudict_get(&dict, reader, &i, &val) && val == i * 2);
+    cra_rcudict_unregister_reader(&dict, reader);
+
+    cra_rcudict_uninit(&dict);
+}
+
+int
+main(void)
+{
+    test_epoch();
+    test_new_delete();
+    test_ops();
+    test_threads();
+
+    cra_memory_leak_report();
+    return 0;
+}
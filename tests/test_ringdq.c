@@ -0,0 +1,238 @@
+/**
+ * @file test_ringdq.c
+ * @author Cracal
+ * @brief test ring double-ended queue
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_ringdq.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include <time.h>
+
+void
+test_init(void)
+{
+    CraRingdq dq;
+
+    assert_always(cra_ringdq_init_with_size(int, &dq, 5));
+    assert_always(dq.capacity == CRA_RINGDQ_DEFAULT_CAPACITY && dq.mask == dq.capacity - 1);
+    assert_always(dq.count == 0 && dq.itemsize == sizeof(int));
+    cra_ringdq_uninit(&dq);
+    assert_always(dq.array == NULL && dq.count == 0);
+
+    assert_always(cra_ringdq_init_with_size(int, &dq, 1000));
+    assert_always(dq.capacity == 1024);
+    cra_ringdq_uninit(&dq);
+
+    CRA_RINGDQ_INITIALIZABLE_PARAM_DEF(param, int);
+    assert_always(cra_initializable_init(CRA_RINGDQ_INITIALIZABLE_I, &dq, 100, &param));
+    assert_always(dq.itemsize == sizeof(int) && dq.capacity == 128);
+    cra_initializable_uninit(CRA_RINGDQ_INITIALIZABLE_I, &dq);
+}
+
+void
+test_push_pop(void)
+{
+    int       val;
+    CraRingdq dq;
+
+    assert_always(cra_ringdq_init(int, &dq));
+    assert_always(!cra_ringdq_pop_front(&dq, &val) && !cra_ringdq_pop_back(&dq, &val));
+    assert_always(!cra_ringdq_peek_front_ref(&dq) && !cra_ringdq_get_ref(&dq, 0));
+
+    // 绕回后再扩容
+    for (int i = 0; i < 6; i++)
+        assert_always(cra_ringdq_push_back(&dq, &i));
+    for (int i = 0; i < 4; i++)
+        assert_always(cra_ringdq_pop_front(&dq, &val) && val == i);
+    for (int i = 6; i < 100; i++)
+        assert_always(cra_ringdq_push_back(&dq, &i));
+    for (int i = 3; i >= 0; i--)
+        assert_always(cra_ringdq_push_front(&dq, &i));
+    assert_always(dq.count == 100 && dq.capacity == 128);
+    for (int i = 0; i < 100; i++)
+        assert_always(cra_ringdq_get(&dq, i, &val) && val == i);
+    assert_always(!cra_ringdq_get(&dq, 100, &val));
+
+    assert_always(cra_ringdq_peek_front(&dq, &val) && val == 0);
+    assert_always(cra_ringdq_peek_back(&dq, &val) && val == 99);
+    assert_always(*(int *)cra_ringdq_peek_back_ref(&dq) == 99);
+
+    assert_always(cra_ringdq_set(&dq, 20, &(int){ -20 }));
+    assert_always(cra_ringdq_get_and_set(&dq, 20, &(int){ 20 }, &val) && val == -20);
+    assert_always(!cra_ringdq_set(&dq, 100, &val));
+
+    for (int i = 99; i >= 50; i--)
+        assert_always(cra_ringdq_pop_back(&dq, &val) && val == i);
+    for (int i = 0; i < 50; i++)
+        assert_always(cra_ringdq_pop_front(&dq, &val) && val == i);
+    assert_always(dq.count == 0);
+    assert_always(!cra_ringdq_remove_front(&dq) && !cra_ringdq_remove_back(&dq));
+
+    cra_ringdq_uninit(&dq);
+}
+
+void
+test_insert_pop_at(void)
+{
+    int       idx, val, n = 0;
+    int       check[2000];
+    CraRingdq dq;
+
+    srand((unsigned int)time(NULL));
+    assert_always(cra_ringdq_init(int, &dq));
+    assert_always(!cra_ringdq_insert(&dq, 1, &val));
+
+    for (int round = 0; round < 10; round++)
+    {
+        // head移到中间，让元素绕回
+        for (int i = 0; i < round * 7; i++)
+        {
+            assert_always(cra_ringdq_push_back(&dq, &i) && cra_ringdq_remove_front(&dq));
+        }
+        for (int i = 0; i < 2000; i++)
+        {
+            idx = rand() % (n + 1);
+            assert_always(cra_ringdq_insert(&dq, idx, &i));
+            memmove(check + idx + 1, check + idx, (n - idx) * sizeof(int));
+            check[idx] = i;
+            ++n;
+        }
+        for (int i = 0; i < n; i++)
+            assert_always(cra_ringdq_get(&dq, i, &val) && val == check[i]);
+
+        while (n > 0)
+        {
+            idx = rand() % n;
+            if (n % 5 == 0)
+            {
+                assert_always(cra_ringdq_remove_at(&dq, idx));
+            }
+            else
+            {
+                assert_always(cra_ringdq_pop_at(&dq, idx, &val) && val == check[idx]);
+            }
+            memmove(check + idx, check + idx + 1, (n - idx - 1) * sizeof(int));
+            --n;
+            if (n > 0)
+            {
+                assert_always(*(int *)cra_ringdq_peek_front_ref(&dq) == check[0]);
+                assert_always(*(int *)cra_ringdq_peek_back_ref(&dq) == check[n - 1]);
+            }
+        }
+        assert_always(dq.count == 0 && !cra_ringdq_pop_at(&dq, 0, &val));
+    }
+
+    cra_ringdq_uninit(&dq);
+}
+
+void
+test_batch_and_spans(void)
+{
+    int           vals[1000], out[1000];
+    int           expect = 0, next = 0, n, k;
+    size_t        nspans;
+    CraRingdqSpan spans[2];
+    CraRingdq     dq;
+
+    assert_always(cra_ringdq_init(int, &dq));
+    assert_always(cra_ringdq_peek_spans(&dq, 10, spans) == 0);
+    assert_always(cra_ringdq_push_back_n(&dq, vals, 0) && cra_ringdq_pop_front_n(&dq, out, 0));
+    assert_always(!cra_ringdq_pop_front_n(&dq, out, 1));
+
+    for (int i = 0; i < 1000; i++)
+    {
+        n = rand() % 1000;
+        for (int j = 0; j < n; j++)
+            vals[j] = next++;
+        assert_always(cra_ringdq_push_back_n(&dq, vals, n));
+        assert_always(dq.count == (size_t)(next - expect));
+
+        // 在原处处理头部的元素
+        n = rand() % 1000;
+        nspans = cra_ringdq_peek_spans(&dq, n, spans);
+        assert_always(nspans <= 2);
+        k = 0;
+        for (size_t s = 0; s < nspans; s++)
+        {
+            for (size_t j = 0; j < spans[s].count; j++)
+                assert_always(((int *)spans[s].array)[j] == expect + k++);
+        }
+        assert_always(k == CRA_MIN(n, (int)dq.count));
+        if (i % 2 == 0)
+        {
+            assert_always(cra_ringdq_remove_front_n(&dq, k));
+            expect += k;
+        }
+        else
+        {
+            assert_always(cra_ringdq_pop_front_n(&dq, out, k));
+            for (int j = 0; j < k; j++)
+                assert_always(out[j] == expect++);
+        }
+    }
+    assert_always(!cra_ringdq_pop_front_n(&dq, out, dq.count + 1));
+
+    // 缩小容量
+    assert_always(cra_ringdq_reserve(&dq, 0));
+    assert_always(dq.capacity >= dq.count && dq.capacity >> 1 < CRA_MAX(dq.count, CRA_RINGDQ_DEFAULT_CAPACITY));
+    for (size_t i = 0; i < dq.count; i++)
+        assert_always(*(int *)cra_ringdq_get_ref(&dq, i) == expect + (int)i);
+
+    cra_ringdq_uninit(&dq);
+}
+
+void
+test_reverse_foreach(void)
+{
+    int       i, val;
+    CraRingdq dq;
+
+    assert_always(cra_ringdq_init(int, &dq));
+    assert_always(cra_ringdq_reverse(&dq));
+    CRA_FOREACH(CRA_RINGDQ_ITERABLE_I, &dq, vals) assert_always(false);
+
+    for (i = 0; i < 5; i++)
+        assert_always(cra_ringdq_push_back(&dq, &i));
+    for (i = -1; i > -5; i--)
+        assert_always(cra_ringdq_push_front(&dq, &i));
+    // -4 -3 -2 -1 0 1 2 3 4
+    i = -4;
+    CRA_FOREACH(CRA_RINGDQ_ITERABLE_I, &dq, vals)
+    {
+        memcpy(&val, vals.val_ref, sizeof(int));
+        assert_always(val == i++);
+    }
+    assert_always(i == 5);
+
+    assert_always(cra_ringdq_reverse(&dq));
+    i = -4;
+    CRA_FOREACH_REVERSE(CRA_RINGDQ_ITERABLE_I, &dq, vals)
+    {
+        memcpy(&val, vals.val_ref, sizeof(int));
+        assert_always(val == i++);
+    }
+    assert_always(i == 5);
+
+    assert_always(cra_appendable_append(CRA_RINGDQ_APPENDABLE_I, &dq, &(CraPair){ .val_ref = &i }));
+    assert_always(cra_ringdq_peek_back(&dq, &val) && val == 5);
+
+    cra_ringdq_uninit(&dq);
+}
+
+int
+main(void)
+{
+    test_init();
+    test_push_pop();
+    test_insert_pop_at();
+    test_batch_and_spans();
+    test_reverse_foreach();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_seglist.c
+ * @author Cracal
+ * @brief test segmented list
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_alist.h"
+#include "collections/cra_seglist.h"
+#include "serialize/cra_json.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include <time.h>
+
+void
+test_init(void)
+{
+    CraSegList list;
+
+    assert_always(cra_seglist_init_with_size(int, &list, 5));
+    assert_always(list.seg_items == 8 && list.seg_mask == 7 && list.seg_shift == 3);
+    assert_always(list.count == 0 && list.nsegments == 0 && cra_seglist_capacity(&list) == 0);
+    assert_always(list.itemsize == sizeof(int));
+    cra_seglist_uninit(&list);
+    assert_always(list.segments == NULL && list.count == 0);
+
+    assert_always(cra_seglist_init(int, &list));
+    assert_always(list.seg_items * sizeof(int) == CRA_SEGLIST_SEGMENT_BYTES);
+    cra_seglist_uninit(&list);
+
+    // 比一段还大的元素
+    assert_always((cra_seglist_init_with_size)(&list, CRA_SEGLIST_SEGMENT_BYTES * 2, 0));
+    assert_always(list.seg_items == 1 && list.seg_shift == 0);
+    cra_seglist_uninit(&list);
+
+    CRA_SEGLIST_INITIALIZABLE_PARAM_DEF(param, int);
+    assert_always(cra_initializable_init(CRA_SEGLIST_INITIALIZABLE_I, &list, 100000, &param));
+    assert_always(list.itemsize == sizeof(int) && cra_seglist_capacity(&list) >= 100000);
+    cra_initializable_uninit(CRA_SEGLIST_INITIALIZABLE_I, &list);
+}
+
+void
+test_append_stable(void)
+{
+    int        *refs[100];
+    int         val;
+    CraSegList  list;
+
+    assert_always(cra_seglist_init_with_size(int, &list, 16));
+
+    for (int i = 0; i < 100; i++)
+    {
+        assert_always(cra_seglist_append(&list, &i));
+        refs[i] = cra_seglist_get_ref(&list, i);
+    }
+    for (int i = 100; i < 10000; i++)
+        assert_always(cra_seglist_append(&list, &i));
+    assert_always(list.count == 10000);
+    assert_always(list.nsegments == 10000 / 16);
+
+    // 扩容后地址不变
+    for (int i = 0; i < 100; i++)
+        assert_always(refs[i] == cra_seglist_get_ref(&list, i) && *refs[i] == i);
+    for (int i = 0; i < 10000; i++)
+        assert_always(cra_seglist_get(&list, i, &val) && val == i);
+    assert_always(!cra_seglist_get(&list, 10000, &val));
+    assert_always(!cra_seglist_get_ref(&list, 10000));
+
+    assert_always(cra_seglist_set(&list, 20, &(int){ -20 }));
+    assert_always(cra_seglist_get_and_set(&list, 20, &(int){ 20 }, &val) && val == -20);
+    assert_always(!cra_seglist_set(&list, 10000, &val));
+
+    for (int i = 9999; i >= 0; i--)
+        assert_always(cra_seglist_pop_back(&list, &val) && val == i);
+    assert_always(list.count == 0 && !cra_seglist_pop_back(&list, &val));
+    // 段还在
+    assert_always(cra_seglist_capacity(&list) == 10000);
+    assert_always(cra_seglist_reserve(&list, 0));
+    assert_always(list.nsegments == 0);
+
+    cra_seglist_uninit(&list);
+}
+
+void
+test_insert_pop(void)
+{
+    int        val;
+    CraAList   expect;
+    CraSegList list;
+
+    srand((unsigned int)time(NULL));
+    assert_always(cra_alist_init(int, &expect));
+    // 段很小，插入删除会跨很多段
+    assert_always(cra_seglist_init_with_size(int, &list, 4));
+
+    for (int i = 0; i < 3000; i++)
+    {
+        size_t index = (size_t)rand() % (expect.count + 1);
+        assert_always(cra_alist_insert(&expect, index, &i));
+        assert_always(cra_seglist_insert(&list, index, &i));
+    }
+    assert_always(!cra_seglist_insert(&list, list.count + 1, &val));
+    assert_always(cra_seglist_prepend(&list, &(int){ -1 }) && cra_alist_prepend(&expect, &(int){ -1 }));
+    assert_always(list.count == expect.count);
+    for (size_t i = 0; i < list.count; i++)
+        assert_always(*(int *)cra_seglist_get_ref(&list, i) == *(int *)cra_alist_get_ref(&expect, i));
+
+    while (expect.count > 0)
+    {
+        int    v1, v2;
+        size_t index = (size_t)rand() % expect.count;
+        assert_always(cra_alist_pop_at(&expect, index, &v1));
+        assert_always(cra_seglist_pop_at(&list, index, &v2));
+        assert_always(v1 == v2);
+        if (expect.count % 100 == 0)
+        {
+            assert_always(list.count == expect.count);
+            for (size_t i = 0; i < list.count; i++)
+                assert_always(*(int *)cra_seglist_get_ref(&list, i) == *(int *)cra_alist_get_ref(&expect, i));
+        }
+    }
+    assert_always(list.count == 0 && !cra_seglist_remove_front(&list));
+
+    cra_alist_uninit(&expect);
+    cra_seglist_uninit(&list);
+}
+
+void
+test_foreach(void)
+{
+    int        i;
+    CraSegList list;
+
+    assert_always(cra_seglist_init_with_size(int, &list, 8));
+    for (i = 0; i < 100; i++)
+        assert_always(cra_seglist_append(&list, &i));
+
+    i = 0;
+    CRA_FOREACH(CRA_SEGLIST_ITERABLE_I, &list, v)
+    {
+        assert_always(*(int *)v.val_ref == i);
+        i++;
+    }
+    assert_always(i == 100);
+    CRA_FOREACH_REVERSE(CRA_SEGLIST_ITERABLE_I, &list, v)
+    {
+        i--;
+        assert_always(*(int *)v.val_ref == i);
+    }
+    assert_always(i == 0);
+
+    cra_seglist_uninit(&list);
+}
+
+void
+test_json(void)
+{
+    char        buf[1024];
+    size_t      len = sizeof(buf);
+    int         val;
+    CraSegList *in, *out = NULL;
+
+    CRA_TYPE_META_BEGIN(meta)
+    CRA_TYPE_META_ELEMENT_INT(int)
+    CRA_TYPE_META_END();
+    CRA_SEGLIST_INITIALIZABLE_PARAM_DEF(param, int);
+
+    in = cra_alloc(CraSegList);
+    assert_always(cra_seglist_init_with_size(int, in, 4));
+    for (int i = 0; i < 30; i++)
+        assert_always(cra_seglist_append(in, &i));
+
+    assert_always(cra_json_stringify(buf, &len, false,
+                                     CRA_SERI_LIST(in, true, meta, CRA_SEGLIST_ITERABLE_I, CRA_SEGLIST_APPENDABLE_I,
+                                                   CRA_SEGLIST_INITIALIZABLE_I, &param)));
+    assert_always(cra_json_parse(buf, len,
+                                 CRA_SERI_LIST(out, true, meta, CRA_SEGLIST_ITERABLE_I, CRA_SEGLIST_APPENDABLE_I,
+                                               CRA_SEGLIST_INITIALIZABLE_I, &param)));
+    assert_always(out && out->count == 30);
+    for (int i = 0; i < 30; i++)
+        assert_always(cra_seglist_get(out, i, &val) && val == i);
+
+    cra_seglist_uninit(in);
+    cra_dealloc(in);
+    cra_seglist_uninit(out);
+    cra_dealloc(out);
+}
+
+int
+main(void)
+{
+    test_init();
+    test_append_stable();
+    test_insert_pop();
+    test_foreach();
+    test_json();
+
+    cra_memory_leak_report();
+    return 0;
+}
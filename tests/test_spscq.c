@@ -0,0 +1,213 @@
+/**
+ * @file test_spscq.c
+ * @author Cracal
+ * @brief test single-producer single-consumer queue
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "threads/cra_spscq.h"
+#include "threads/cra_thread.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+
+typedef struct
+{
+    int  id;
+    char name[8]; // itemsize不是2的幂
+} Item;
+
+void
+test_push_pop(void)
+{
+    Item     item;
+    CraSpscq que;
+
+    assert_always(cra_spscq_init(Item, &que, 5));
+    assert_always(cra_spscq_capacity(&que) == 8);
+    assert_always(!cra_spscq_try_pop(&que, &item));
+
+    // 多绕几圈
+    for (int round = 0; round < 10; round++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            item.id = round * 8 + i;
+            snprintf(item.name, sizeof(item.name), "%d", item.id);
+            assert_always(cra_spscq_try_push(&que, &item));
+        }
+        assert_always(cra_spscq_count(&que) == 8);
+        assert_always(!cra_spscq_try_push(&que, &item));
+        for (int i = 0; i < 8; i++)
+        {
+            char name[8];
+            snprintf(name, sizeof(name), "%d", round * 8 + i);
+            assert_always(cra_spscq_try_pop(&que, &item));
+            assert_always(item.id == round * 8 + i && strcmp(item.name, name) == 0);
+        }
+        assert_always(!cra_spscq_try_pop(&que, &item));
+    }
+
+    cra_spscq_uninit(&que);
+}
+
+void
+test_push_pop_n(void)
+{
+    int      vals[20], rets[20];
+    int      next_in, next_out;
+    size_t   n;
+    CraSpscq que;
+
+    assert_always(cra_spscq_init(int, &que, 16));
+
+    next_in = next_out = 0;
+    for (int round = 0; round < 50; round++)
+    {
+        // 每次放入/取出的个数不同，经常跨过数组末尾
+        for (int i = 0; i < 20; i++)
+            vals[i] = next_in + i;
+        n = cra_spscq_push_n(&que, vals, (size_t)(round % 20));
+        assert_always(n <= (size_t)(round % 20));
+        next_in += (int)n;
+        assert_always(cra_spscq_count(&que) == (size_t)(next_in - next_out));
+
+        n = cra_spscq_pop_n(&que, rets, (size_t)(round % 7));
+        for (size_t i = 0; i < n; i++)
+            assert_always(rets[i] == next_out++);
+    }
+
+    // 满了只放入能放下的部分
+    n = cra_spscq_pop_n(&que, rets, 20);
+    for (size_t i = 0; i < n; i++)
+        assert_always(rets[i] == next_out++);
+    assert_always(cra_spscq_count(&que) == 0);
+    for (int i = 0; i < 20; i++)
+        vals[i] = i;
+    assert_always(cra_spscq_push_n(&que, vals, 20) == 16);
+    assert_always(cra_spscq_push_n(&que, vals, 1) == 0);
+    assert_always(cra_spscq_pop_n(&que, rets, 20) == 16);
+    for (int i = 0; i < 16; i++)
+        assert_always(rets[i] == i);
+
+    cra_spscq_uninit(&que);
+}
+
+void
+test_shutdown(void)
+{
+    int      val;
+    CraSpscq que;
+
+    assert_always(cra_spscq_init_with_size(int, &que, 4, true));
+    assert_always(cra_spscq_push(&que, &(int){ 1 }));
+    assert_always(cra_spscq_push(&que, &(int){ 2 }));
+
+    cra_spscq_shutdown(&que, CRA_BLOCKDQ_CLOSE_ENQUEUE);
+    assert_always(!cra_spscq_push(&que, &(int){ 3 }));
+    assert_always(!cra_spscq_try_push(&que, &(int){ 3 }));
+    assert_always(cra_spscq_pop(&que, &val) && val == 1);
+
+    // 关闭出队后仍然可以取出剩余的元素
+    cra_spscq_shutdown(&que, CRA_BLOCKDQ_CLOSE_DEQUEUE);
+    assert_always(cra_spscq_pop(&que, &val) && val == 2);
+    assert_always(!cra_spscq_pop(&que, &val));
+
+    cra_spscq_uninit(&que);
+}
+
+#define NITEMS 100000
+#define BATCH  37
+
+static CRA_THRD_FUNC(producer_func)
+{
+    int       vals[BATCH];
+    int       next = 0;
+    size_t    n;
+    CraSpscq *que = (CraSpscq *)arg;
+
+    if (que->blocking)
+    {
+        for (int i = 0; i < NITEMS; i++)
+            assert_always(cra_spscq_push(que, &i));
+    }
+    else
+    {
+        while (next < NITEMS)
+        {
+            n = (size_t)CRA_MIN(BATCH, NITEMS - next);
+            for (size_t i = 0; i < n; i++)
+                vals[i] = next + (int)i;
+            n = cra_spscq_push_n(que, vals, n);
+            next += (int)n;
+            if (n == 0)
+                cra_thrd_yield();
+        }
+    }
+    cra_spscq_shutdown(que, CRA_BLOCKDQ_CLOSE_ALL);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static void
+consume(CraSpscq *que)
+{
+    int    vals[BATCH];
+    int    next = 0;
+    size_t n;
+
+    if (que->blocking)
+    {
+        while (cra_spscq_pop(que, &vals[0]))
+            assert_always(vals[0] == next++);
+    }
+    else
+    {
+        for (;;)
+        {
+            n = cra_spscq_pop_n(que, vals, BATCH);
+            for (size_t i = 0; i < n; i++)
+                assert_always(vals[i] == next++);
+            if (n > 0)
+                continue;
+            if (cra_atomic_load32(&que->closed, CRA_MO_ACQUIRE) && cra_spscq_count(que) == 0)
+                break;
+            cra_thrd_yield();
+        }
+    }
+    assert_always(next == NITEMS);
+}
+
+void
+test_threads(void)
+{
+    CraSpscq   que;
+    cra_thrd_t thrd;
+
+    // 不阻塞，批量
+    assert_always(cra_spscq_init(int, &que, 64));
+    assert_always(cra_thrd_create(&thrd, producer_func, &que));
+    consume(&que);
+    cra_thrd_join(thrd);
+    cra_spscq_uninit(&que);
+
+    // 阻塞，容量很小时会频繁挂起
+    assert_always(cra_spscq_init_with_size(int, &que, 2, true));
+    assert_always(cra_thrd_create(&thrd, producer_func, &que));
+    consume(&que);
+    cra_thrd_join(thrd);
+    cra_spscq_uninit(&que);
+}
+
+int
+main(void)
+{
+    test_push_pop();
+    test_push_pop_n();
+    test_shutdown();
+    test_threads();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file test_strkey.c
+ * @author Cracal
+ * @brief test string key
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_strkey.h"
+#include "collections/cra_dict.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+
+void
+test_init(void)
+{
+    CraStrKey a, b, v;
+    char      buf[100];
+
+    // 内联
+    assert_always(cra_strkey_init_cstr(&a, "hello"));
+    assert_always(a.len == 5);
+    assert_always(strcmp(cra_strkey_str(&a), "hello") == 0);
+    assert_always(cra_strkey_str(&a) == a.small);
+    assert_always(a.hash == cra_hash_string1("hello"));
+
+    // 最长的内联
+    memset(buf, 'x', CRA_STRKEY_INLINE_MAX);
+    buf[CRA_STRKEY_INLINE_MAX] = '\0';
+    assert_always(cra_strkey_init_cstr(&b, buf));
+    assert_always(cra_strkey_str(&b) == b.small);
+    assert_always(strcmp(cra_strkey_str(&b), buf) == 0);
+    cra_strkey_uninit(&b);
+
+    // 堆上
+    memset(buf, 'y', sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    assert_always(cra_strkey_init(&b, buf, 50));
+    assert_always(b.len == 50);
+    assert_always(cra_strkey_str(&b) != b.small);
+    assert_always(strncmp(cra_strkey_str(&b), buf, 50) == 0 && cra_strkey_str(&b)[50] == '\0');
+    assert_always(b.hash == cra_hash_string1_n(buf, 50));
+
+    // view
+    cra_strkey_view(&v, buf, 50);
+    assert_always(cra_strkey_str(&v) == buf);
+    assert_always(cra_cmp_strkey_p(&v, &b) == 0);
+    cra_strkey_view_cstr(&v, "hello");
+    assert_always(cra_cmp_strkey_p(&v, &a) == 0);
+
+    // 比较
+    assert_always(cra_cmp_strkey_p(&a, &b) != 0);
+    assert_always(cra_cmp_strkey_p(&a, &b) == -cra_cmp_strkey_p(&b, &a));
+    cra_strkey_view(&v, buf, 49);
+    assert_always(cra_cmp_strkey_p(&v, &b) != 0);
+    cra_strkey_view(&v, "", 0);
+    assert_always(v.len == 0 && cra_strkey_str(&v)[0] == '\0');
+    assert_always(cra_cmp_strkey_p(&v, &a) != 0);
+
+    cra_strkey_uninit(&a);
+    cra_strkey_uninit(&b);
+}
+
+void
+test_dict(void)
+{
+    char      buf[300];
+    int       val;
+    CraStrKey key, oldkey;
+    CraDict   dict;
+
+    assert_always(cra_dict_init(CraStrKey, int, &dict, cra_hash_strkey_p, cra_cmp_strkey_p));
+    for (int i = 0; i < 2000; i++)
+    {
+        // 一半短一半长
+        if (i & 1)
+            snprintf(buf, sizeof(buf), "k%d", i);
+        else
+            snprintf(buf, sizeof(buf), "a-rather-long-key-with-a-common-prefix-%d", i);
+        assert_always(cra_strkey_init_cstr(&key, buf));
+        assert_always(cra_dict_add(&dict, &key, &i));
+    }
+    assert_always(dict.count == 2000);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        if (i & 1)
+            snprintf(buf, sizeof(buf), "k%d", i);
+        else
+            snprintf(buf, sizeof(buf), "a-rather-long-key-with-a-common-prefix-%d", i);
+        // 查找不用复制
+        cra_strkey_view_cstr(&key, buf);
+        assert_always(cra_dict_get(&dict, &key, &val) && val == i);
+    }
+    cra_strkey_view_cstr(&key, "k0");
+    assert_always(!cra_dict_get(&dict, &key, &val));
+
+    // 删除时取回字典中的key并释放
+    cra_strkey_view_cstr(&key, "a-rather-long-key-with-a-common-prefix-10");
+    assert_always(cra_dict_pop_kv(&dict, &key, &oldkey, &val) && val == 10);
+    assert_always(strcmp(cra_strkey_str(&oldkey), "a-rather-long-key-with-a-common-prefix-10") == 0);
+    cra_strkey_uninit(&oldkey);
+
+    CRA_FOREACH(CRA_DICT_ITERABLE_I, &dict, kv)
+    {
+        cra_strkey_uninit((CraStrKey *)kv.key_ref);
+    }
+    cra_dict_uninit(&dict);
+}
+
+int
+main(void)
+{
+    test_init();
+    test_dict();
+
+    cra_memory_leak_report();
+    return 0;
+}
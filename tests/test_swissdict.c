@@ -0,0 +1,319 @@
+/**
+ * @file test_swissdict.c
+ * @author Cracal
+ * @brief test swiss dictionary
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "collections/cra_swissdict.h"
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include <time.h>
+
+void
+test_new_delete(void)
+{
+    CraSwissDict *dict1, dict2;
+
+    dict1 = cra_alloc(CraSwissDict);
+    assert_always(dict1 != NULL);
+    assert_always(cra_swissdict_init(int, float, dict1, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(dict1->ctrl);
+    assert_always(dict1->slots);
+    assert_always(dict1->count == 0);
+    assert_always(dict1->capacity == CRA_SWISSDICT_DEFAULT_CAPACITY);
+    assert_always(dict1->key_size == sizeof(int));
+    assert_always(dict1->val_size == sizeof(float));
+    assert_always(dict1->val_offset % sizeof(float) == 0);
+    assert_always(dict1->slot_size >= dict1->val_offset + dict1->val_size);
+
+    assert_always(cra_swissdict_init_with_size(char, int64_t, &dict2, 100, cra_hash_int8_p, cra_cmp_int8_p));
+    assert_always(dict2.ctrl);
+    assert_always(dict2.slots);
+    assert_always(dict2.count == 0);
+    assert_always(dict2.capacity >= 100);
+    assert_always((dict2.capacity & (dict2.capacity - 1)) == 0);
+    assert_always(dict2.key_size == sizeof(char));
+    assert_always(dict2.val_size == sizeof(int64_t));
+    assert_always(dict2.val_offset % sizeof(int64_t) == 0);
+    assert_always(dict2.slot_size % sizeof(int64_t) == 0);
+
+    cra_swissdict_uninit(dict1);
+    assert_always(memcmp(dict1, &(CraSwissDict){ 0 }, sizeof(CraSwissDict)) == 0);
+    cra_swissdict_uninit(&dict2);
+    assert_always(memcmp(&dict2, &(CraSwissDict){ 0 }, sizeof(CraSwissDict)) == 0);
+    cra_dealloc(dict1);
+
+    CRA_SWISSDICT_INITIALIZABLE_PARAM_DEF(param, double, char[3], cra_hash_double_p, cra_cmp_double_p);
+    assert_always(cra_initializable_init(CRA_SWISSDICT_INITIALIZABLE_I, &dict2, 0, &param));
+    assert_always(dict2.ctrl);
+    assert_always(dict2.slots);
+    assert_always(dict2.count == 0);
+    assert_always(dict2.capacity == CRA_SWISSDICT_DEFAULT_CAPACITY);
+    assert_always(dict2.key_size == param.key_size);
+    assert_always(dict2.val_size == param.val_size);
+
+    cra_initializable_uninit(CRA_SWISSDICT_INITIALIZABLE_I, &dict2);
+    assert_always(memcmp(&dict2, &(CraSwissDict){ 0 }, sizeof(CraSwissDict)) == 0);
+}
+
+void
+test_add(void)
+{
+    int   key;
+    float val, *pval;
+
+    CraSwissDict *dict = cra_alloc(CraSwissDict);
+    cra_swissdict_init_with_size(int, float, dict, 1000, cra_hash_int_p, cra_cmp_int_p);
+
+    for (int i = 0; i < 1000; i++)
+        assert_always(cra_swissdict_add(dict, &i, &(float){ i + .5f }));
+    assert_always(dict->count == 1000);
+
+    int i = 0;
+    CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals)
+    {
+        memcpy(&key, vals.key_ref, sizeof(key));
+        memcpy(&val, vals.val_ref, sizeof(val));
+        assert_always(key >= 0 && key < 1000 && cra_cmp_float(val, key + .5f) == 0);
+        i++;
+    }
+    assert_always(i == 1000);
+
+    assert_always(!cra_swissdict_add(dict, &(int){ 3 }, &(float){ 3000.5f }));
+    assert_always(cra_swissdict_put(dict, &(int){ 3 }, &(float){ 30000.5f }));
+    assert_always(!!(pval = cra_swissdict_get_ref(dict, &(int){ 3 })) && cra_cmp_float(*pval, 30000.5f) == 0);
+    assert_always(cra_swissdict_put_and_return_v(dict, &(int){ 3 }, &(float){ 3.5f }, &val) &&
+                  cra_cmp_float(val, 30000.5f) == 0);
+    assert_always(dict->count == 1000);
+
+    CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals)
+    {
+        memcpy(&key, vals.key_ref, sizeof(key));
+        memcpy(&val, vals.val_ref, sizeof(val));
+        assert_always(cra_cmp_float(val, key + .5f) == 0);
+    }
+
+    cra_swissdict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+void
+test_remove(void)
+{
+    float         val;
+    CraSwissDict *dict = cra_alloc(CraSwissDict);
+    cra_swissdict_init(int, float, dict, cra_hash_int_p, cra_cmp_int_p);
+
+    assert_always(!cra_swissdict_remove(dict, &(int){ 0 }));
+
+    for (int i = 0; i < 1000; i++)
+        cra_swissdict_add(dict, &i, &(float){ i + .5f });
+
+    assert_always(cra_swissdict_pop(dict, &(int){ 30 }, &val) && val == 30.5f);
+    assert_always(!cra_swissdict_remove(dict, &(int){ 30 }));
+    assert_always(dict->count == 999);
+
+    for (int i = 0; i < 80; i++)
+    {
+        if (i == 30)
+            continue;
+        assert_always(cra_swissdict_remove(dict, &i));
+    }
+    assert_always(dict->count == 920);
+    for (int i = 80; i < 1000; i++)
+    {
+        assert_always(cra_swissdict_get(dict, &i, &val));
+        assert_always(cra_cmp_float(val, i + .5f) == 0);
+    }
+    for (int i = 0; i < 80; i++)
+        assert_always(!cra_swissdict_get(dict, &i, &val));
+
+    cra_swissdict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+void
+test_get(void)
+{
+    int           key;
+    float         val, *pval;
+    CraSwissDict *dict = cra_alloc(CraSwissDict);
+    cra_swissdict_init(int, float, dict, cra_hash_int_p, cra_cmp_int_p);
+
+    for (int i = -5000; i <= 5000; i++)
+        cra_swissdict_add(dict, &i, &(float){ i + .5f });
+
+    CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals)
+    {
+        memcpy(&key, vals.key_ref, sizeof(key));
+        memcpy(&val, vals.val_ref, sizeof(val));
+        assert_always(cra_cmp_float(val, key + .5f) == 0);
+    }
+
+    for (int i = -5000; i <= 5000; i++)
+    {
+        assert_always(cra_swissdict_get(dict, &i, &val));
+        assert_always(cra_cmp_float(val, i + .5f) == 0);
+        assert_always(!!(pval = cra_swissdict_get_ref(dict, &i)));
+        assert_always(cra_cmp_float(*pval, i + .5f) == 0);
+    }
+    assert_always(!cra_swissdict_get(dict, &(int){ 5001 }, &val));
+
+    cra_swissdict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+void
+test_foreach(void)
+{
+    int           key, count;
+    double        val;
+    CraSwissDict *dict = cra_alloc(CraSwissDict);
+    cra_swissdict_init(int, double, dict, cra_hash_int_p, cra_cmp_int_p);
+
+    // foreach(empty)
+    CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals) assert_always(false);
+    CRA_FOREACH_REVERSE(CRA_SWISSDICT_ITERABLE_I, dict, vals) assert_always(false);
+
+    for (int i = 0; i < 10; i++)
+        cra_swissdict_add(dict, &i, &(double){ i });
+
+    count = 0;
+    printf("foreach        : ");
+    CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals)
+    {
+        memcpy(&key, vals.key_ref, sizeof(key));
+        memcpy(&val, vals.val_ref, sizeof(val));
+        assert_always(cra_cmp_double(val, (double)key) == 0);
+        printf("{%d: %.2lf}  ", key, val);
+        count++;
+    }
+    printf("\n");
+    assert_always(count == 10);
+
+    count = 0;
+    printf("foreach reverse: ");
+    CRA_FOREACH_REVERSE(CRA_SWISSDICT_ITERABLE_I, dict, vals)
+    {
+        memcpy(&key, vals.key_ref, sizeof(key));
+        memcpy(&val, vals.val_ref, sizeof(val));
+        assert_always(cra_cmp_double(val, (double)key) == 0);
+        printf("{%d: %.2lf}  ", key, val);
+        count++;
+    }
+    printf("\n");
+    assert_always(count == 10);
+
+    cra_swissdict_clear(dict);
+
+    // foreach(empty)
+    CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals) assert_always(false);
+    CRA_FOREACH_REVERSE(CRA_SWISSDICT_ITERABLE_I, dict, vals) assert_always(false);
+
+    cra_swissdict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+void
+test_reserve(void)
+{
+    int           val;
+    CraSwissDict *dict = cra_alloc(CraSwissDict);
+    cra_swissdict_init(int, int, dict, cra_hash_int_p, cra_cmp_int_p);
+
+    for (int i = 0; i < 100; i++)
+        cra_swissdict_add(dict, &i, &(int){ i * 2 });
+
+    assert_always(cra_swissdict_reserve(dict, 4096));
+    assert_always(dict->capacity == 4096);
+    assert_always(dict->count == 100);
+    for (int i = 0; i < 100; i++)
+        assert_always(cra_swissdict_get(dict, &i, &val) && val == i * 2);
+
+    // 不会缩小到装不下现有元素
+    assert_always(cra_swissdict_reserve(dict, 0));
+    assert_always(dict->capacity == 128);
+    for (int i = 0; i < 100; i++)
+        assert_always(cra_swissdict_get(dict, &i, &val) && val == i * 2);
+
+    cra_swissdict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+void
+test_test(void)
+{
+    CraSwissDict *dict = cra_alloc(CraSwissDict);
+    cra_swissdict_init(int, int, dict, cra_hash_int_p, cra_cmp_int_p);
+
+    int i, j, n, v;
+    srand((unsigned int)time(NULL));
+    for (i = 0; i < 20; i++)
+    {
+        n = (rand() + 1) % 1000000;
+        for (j = 0; j < n; j++)
+            cra_swissdict_put(dict, &j, &(int){ j + 100 });
+
+        n = (rand() + 1) % dict->count;
+        for (j = 0; j < n; j++)
+        {
+            cra_swissdict_pop(dict, &j, &v);
+            assert_always(v == j + 100);
+        }
+
+        for (; cra_swissdict_pop(dict, &j, &v); j++)
+            assert_always(v == j + 100);
+    }
+    assert_always(dict->count == 0);
+
+    int  idx, key, val;
+    int *check = (int *)cra_malloc(sizeof(int) * 100000);
+    bzero(check, sizeof(int) * 100000);
+    for (i = 0; i < 20; i++)
+    {
+        n = (rand() + 1) % 100000;
+        for (j = 0; j < n; j++)
+        {
+            idx = rand() % 100000;
+            cra_swissdict_put(dict, &idx, &j);
+            check[idx] = j;
+        }
+        CRA_FOREACH(CRA_SWISSDICT_ITERABLE_I, dict, vals)
+        {
+            memcpy(&key, vals.key_ref, sizeof(key));
+            memcpy(&val, vals.val_ref, sizeof(val));
+            assert_always(val == check[key]);
+        }
+
+        while (dict->count > 0)
+        {
+            idx = rand() % 100000;
+            if (cra_swissdict_pop(dict, &idx, &val))
+                assert_always(check[idx] == val);
+        }
+    }
+    assert_always(dict->count == 0);
+    cra_free(check);
+
+    cra_swissdict_uninit(dict);
+    cra_dealloc(dict);
+}
+
+int
+main(void)
+{
+    test_new_delete();
+    test_add();
+    test_remove();
+    test_get();
+    test_foreach();
+    test_reserve();
+    test_test();
+
+    cra_memory_leak_report();
+    return 0;
+}
@@ -0,0 +1,509 @@
+/**
+ * @file threads_performance.c
+ * @author Cracal
+ * @brief 多线程吞吐量测试
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cra_assert.h"
+#include "cra_malloc.h"
+#include "cra_time.h"
+#include "threads/cra_blockdq.h"
+#include "threads/cra_cdict.h"
+#include "threads/cra_mpmcq.h"
+#include "threads/cra_parallel_sort.h"
+#include "threads/cra_rcudict.h"
+#include "threads/cra_spscq.h"
+#include "threads/cra_thread.h"
+
+#define MAX_THREADS    64
+#define NKEYS          1000000
+#define OPS_PER_THREAD 500000
+#define PUT_PERCENT    10
+
+typedef struct
+{
+    unsigned int       seed;
+    cra_mutex_t       *mutex;
+    CraDict           *dict;
+    CraConcurrentDict *cdict;
+    CraRcuDict        *rcudict;
+} PerfArg;
+
+static inline unsigned int
+next_rand(unsigned int *seed)
+{
+    // xorshift32
+    unsigned int x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+static CRA_THRD_FUNC(thrd_locked_dict_func)
+{
+    int      key;
+    size_t   val;
+    PerfArg *parg = (PerfArg *)arg;
+
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        key = (int)(next_rand(&parg->seed) % NKEYS);
+        cra_mutex_lock(parg->mutex);
+        if (next_rand(&parg->seed) % 100 < PUT_PERCENT)
+            cra_dict_put(parg->dict, &key, &(size_t){ i });
+        else
+            cra_dict_get(parg->dict, &key, &val);
+        cra_mutex_unlock(parg->mutex);
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_cdict_func)
+{
+    int      key;
+    size_t   val;
+    PerfArg *parg = (PerfArg *)arg;
+
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        key = (int)(next_rand(&parg->seed) % NKEYS);
+        if (next_rand(&parg->seed) % 100 < PUT_PERCENT)
+            cra_cdict_put(parg->cdict, &key, &(size_t){ i });
+        else
+            cra_cdict_get(parg->cdict, &key, &val);
+    }
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_rcudict_func)
+{
+    int             key;
+    size_t          val;
+    PerfArg        *parg = (PerfArg *)arg;
+    CraEpochRecord *reader = cra_rcudict_register_reader(parg->rcudict);
+
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        key = (int)(next_rand(&parg->seed) % NKEYS);
+        if (next_rand(&parg->seed) % 100 < PUT_PERCENT)
+            cra_rcudict_put(parg->rcudict, &key, &(size_t){ i });
+        else
+            cra_rcudict_get(parg->rcudict, reader, &key, &val);
+    }
+    cra_rcudict_unregister_reader(parg->rcudict, reader);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static double
+run_threads(cra_thrd_start_fn func, PerfArg *arg, int nthreads)
+{
+    cra_thrd_t    thrds[MAX_THREADS];
+    PerfArg       args[MAX_THREADS];
+    unsigned long start_ms, end_ms;
+
+    start_ms = cra_tick_ms();
+    for (int i = 0; i < nthreads; i++)
+    {
+        args[i] = *arg;
+        args[i].seed = (unsigned int)i * 2654435761u + 1;
+        assert_always(cra_thrd_create(&thrds[i], func, &args[i]));
+    }
+    for (int i = 0; i < nthreads; i++)
+        cra_thrd_join(thrds[i]);
+    end_ms = cra_tick_ms();
+
+    // Mops/s
+    return (double)nthreads * OPS_PER_THREAD / (double)CRA_MAX(end_ms - start_ms, 1) / 1000.0;
+}
+
+void
+test_dict_threads_performance(void)
+{
+    CraDict           dict;
+    CraConcurrentDict cdict;
+    CraRcuDict        rcudict;
+    cra_mutex_t       mutex;
+    PerfArg           arg;
+
+    assert_always(cra_dict_init_with_size(int, size_t, &dict, NKEYS, cra_hash_int_p, cra_cmp_int_p));
+    assert_always(cra_cdict_init_with_size(int, size_t, &cdict, NKEYS, CRA_CDICT_DEFAULT_SHARDS, cra_hash_int_p,
+                                           cra_cmp_int_p));
+    assert_always(cra_rcudict_init_with_size(int, size_t, &rcudict, NKEYS, cra_hash_int_p, cra_cmp_int_p));
+    cra_mutex_init(&mutex);
+
+    for (int i = 0; i < NKEYS; i++)
+    {
+        cra_dict_put(&dict, &i, &(size_t){ i });
+        cra_cdict_put(&cdict, &i, &(size_t){ i });
+        cra_rcudict_put(&rcudict, &i, &(size_t){ i });
+    }
+
+    arg = (PerfArg){ .seed = 0, .mutex = &mutex, .dict = &dict, .cdict = &cdict, .rcudict = &rcudict };
+
+    printf("test dict threads[%d%% put]:\n", PUT_PERCENT);
+    printf("\tthreads  dict+mutex    cdict(%d shards)  rcudict\n", CRA_CDICT_DEFAULT_SHARDS);
+    for (int n = 1; n <= MAX_THREADS; n <<= 1)
+    {
+        printf("\t%-7d  %6.2lfMops/s  ", n, run_threads(thrd_locked_dict_func, &arg, n));
+        printf("%6.2lfMops/s       ", run_threads(thrd_cdict_func, &arg, n));
+        printf("%6.2lfMops/s\n", run_threads(thrd_rcudict_func, &arg, n));
+    }
+
+    cra_mutex_destroy(&mutex);
+    cra_rcudict_uninit(&rcudict);
+    cra_cdict_uninit(&cdict);
+    cra_dict_uninit(&dict);
+}
+
+#define PSORT_N 20000000
+
+void
+test_parallel_sort_performance(void)
+{
+    int           *data;
+    CraAList       list;
+    CraThrdPool    pool;
+    unsigned int   seed = 12345;
+    unsigned long  start_ms, end_ms, seq_ms;
+
+    data = cra_malloc(sizeof(int) * PSORT_N);
+    for (int i = 0; i < PSORT_N; i++)
+        data[i] = (int)next_rand(&seed);
+    assert_always(cra_alist_init_with_size(int, &list, PSORT_N));
+    list.count = PSORT_N;
+
+    printf("test parallel sort[%d random ints]:\n", PSORT_N);
+    memcpy(list.array, data, sizeof(int) * PSORT_N);
+    start_ms = cra_tick_ms();
+    cra_alist_sort(&list, cra_cmp_int_p);
+    end_ms = cra_tick_ms();
+    seq_ms = CRA_MAX(end_ms - start_ms, 1);
+    printf("\tcra_alist_sort:        %5lums.\n", seq_ms);
+
+    // 调用线程也参与排序
+    printf("\tpool threads  time     speedup\n");
+    for (int n = 1; n <= 16; n <<= 1)
+    {
+        cra_thrdpool_init(&pool, n, CRA_THRDPOOL_INFINITE_TASKS, CRA_THRDPOOL_FULL_WAIT);
+        memcpy(list.array, data, sizeof(int) * PSORT_N);
+        start_ms = cra_tick_ms();
+        assert_always(cra_alist_parallel_sort(&list, cra_cmp_int_p, &pool));
+        end_ms = cra_tick_ms();
+        printf("\t%-12d  %5lums.  %.2lfx\n", n, end_ms - start_ms,
+               (double)seq_ms / (double)CRA_MAX(end_ms - start_ms, 1));
+        cra_thrdpool_uninit(&pool, true);
+    }
+
+    cra_alist_uninit(&list);
+    cra_free(data);
+}
+
+#define QUEUE_ITEMS    4000000
+#define QUEUE_CAPACITY 1024
+
+typedef struct
+{
+    int         nitems;
+    CraBlockdq *blockdq;
+    CraMpmcq   *mpmcq;
+} QueueArg;
+
+static CRA_THRD_FUNC(thrd_blockdq_producer)
+{
+    QueueArg *qarg = (QueueArg *)arg;
+
+    for (int i = 0; i < qarg->nitems; i++)
+        cra_blockdq_push_back(qarg->blockdq, &i, NULL);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_blockdq_consumer)
+{
+    int       val;
+    QueueArg *qarg = (QueueArg *)arg;
+
+    while (cra_blockdq_pop_front(qarg->blockdq, &val))
+        ;
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_mpmcq_producer)
+{
+    QueueArg *qarg = (QueueArg *)arg;
+
+    for (int i = 0; i < qarg->nitems; i++)
+        cra_mpmcq_push(qarg->mpmcq, &i, NULL);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_mpmcq_consumer)
+{
+    int       val;
+    QueueArg *qarg = (QueueArg *)arg;
+
+    while (cra_mpmcq_pop(qarg->mpmcq, &val))
+        ;
+    return (cra_thrd_ret_t){ 0 };
+}
+
+// n个生产者，n个消费者；返回Mitems/s
+static double
+run_queue(bool lockfree, int n)
+{
+    CraBlockdq    blockdq;
+    CraMpmcq      mpmcq;
+    QueueArg      arg;
+    cra_thrd_t    producers[MAX_THREADS], consumers[MAX_THREADS];
+    unsigned long start_ms, end_ms;
+
+    if (lockfree)
+        assert_always(cra_mpmcq_init(int, &mpmcq, QUEUE_CAPACITY, CRA_BLOCKDQ_FULL_WAIT));
+    else
+        assert_always(cra_blockdq_init(int, &blockdq, QUEUE_CAPACITY, CRA_BLOCKDQ_FULL_WAIT));
+    arg = (QueueArg){ .nitems = QUEUE_ITEMS / n, .blockdq = &blockdq, .mpmcq = &mpmcq };
+
+    start_ms = cra_tick_ms();
+    for (int i = 0; i < n; i++)
+    {
+        assert_always(cra_thrd_create(&consumers[i], lockfree ? thrd_mpmcq_consumer : thrd_blockdq_consumer, &arg));
+        assert_always(cra_thrd_create(&producers[i], lockfree ? thrd_mpmcq_producer : thrd_blockdq_producer, &arg));
+    }
+    for (int i = 0; i < n; i++)
+        cra_thrd_join(producers[i]);
+    if (lockfree)
+        cra_mpmcq_shutdown(&mpmcq, CRA_BLOCKDQ_CLOSE_ALL);
+    else
+        cra_blockdq_shutdown(&blockdq, CRA_BLOCKDQ_CLOSE_ALL);
+    for (int i = 0; i < n; i++)
+        cra_thrd_join(consumers[i]);
+    end_ms = cra_tick_ms();
+
+    if (lockfree)
+        cra_mpmcq_uninit(&mpmcq);
+    else
+        cra_blockdq_uninit(&blockdq);
+    return (double)(arg.nitems * n) / (double)CRA_MAX(end_ms - start_ms, 1) / 1000.0;
+}
+
+void
+test_queue_threads_performance(void)
+{
+    printf("test queue threads[%d ints, capacity %d]:\n", QUEUE_ITEMS, QUEUE_CAPACITY);
+    printf("\tproducers/consumers  blockdq         mpmcq\n");
+    for (int n = 1; n <= 16; n <<= 1)
+    {
+        printf("\t%-19d  %6.2lfMitems/s  ", n, run_queue(false, n));
+        printf("%6.2lfMitems/s\n", run_queue(true, n));
+    }
+}
+
+#define SPSC_BATCH 64
+
+static CRA_THRD_FUNC(thrd_spscq_producer)
+{
+    CraSpscq *que = (CraSpscq *)arg;
+
+    for (int i = 0; i < QUEUE_ITEMS; i++)
+        cra_spscq_push(que, &i);
+    cra_spscq_shutdown(que, CRA_BLOCKDQ_CLOSE_ALL);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+static CRA_THRD_FUNC(thrd_spscq_batch_producer)
+{
+    int       vals[SPSC_BATCH];
+    int       next = 0;
+    size_t    n;
+    CraSpscq *que = (CraSpscq *)arg;
+
+    while (next < QUEUE_ITEMS)
+    {
+        n = (size_t)CRA_MIN(SPSC_BATCH, QUEUE_ITEMS - next);
+        for (size_t i = 0; i < n; i++)
+            vals[i] = next + (int)i;
+        n = cra_spscq_push_n(que, vals, n);
+        next += (int)n;
+        if (n == 0)
+            cra_thrd_yield();
+    }
+    cra_spscq_shutdown(que, CRA_BLOCKDQ_CLOSE_ALL);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+// 一个生产者，一个消费者(调用线程)；返回Mitems/s
+static double
+run_spsc_queue(int kind)
+{
+    int           val, vals[SPSC_BATCH];
+    long long     sum = 0;
+    size_t        n;
+    CraBlockdq    blockdq;
+    CraSpscq      spscq;
+    QueueArg      arg;
+    cra_thrd_t    producer;
+    unsigned long start_ms, end_ms;
+
+    start_ms = cra_tick_ms();
+    if (kind == 0)
+    {
+        assert_always(cra_blockdq_init(int, &blockdq, QUEUE_CAPACITY, CRA_BLOCKDQ_FULL_WAIT));
+        arg = (QueueArg){ .nitems = QUEUE_ITEMS, .blockdq = &blockdq };
+        assert_always(cra_thrd_create(&producer, thrd_blockdq_producer, &arg));
+        for (int i = 0; i < QUEUE_ITEMS; i++)
+        {
+            cra_blockdq_pop_front(&blockdq, &val);
+            sum += val;
+        }
+        cra_thrd_join(producer);
+        cra_blockdq_shutdown(&blockdq, CRA_BLOCKDQ_CLOSE_ALL);
+        cra_blockdq_uninit(&blockdq);
+    }
+    else if (kind == 1)
+    {
+        assert_always(cra_spscq_init_with_size(int, &spscq, QUEUE_CAPACITY, true));
+        assert_always(cra_thrd_create(&producer, thrd_spscq_producer, &spscq));
+        while (cra_spscq_pop(&spscq, &val))
+            sum += val;
+        cra_thrd_join(producer);
+        cra_spscq_uninit(&spscq);
+    }
+    else
+    {
+        assert_always(cra_spscq_init(int, &spscq, QUEUE_CAPACITY));
+        assert_always(cra_thrd_create(&producer, thrd_spscq_batch_producer, &spscq));
+        for (;;)
+        {
+            n = cra_spscq_pop_n(&spscq, vals, SPSC_BATCH);
+            for (size_t i = 0; i < n; i++)
+                sum += vals[i];
+            if (n > 0)
+                continue;
+            if (cra_atomic_load32(&spscq.closed, CRA_MO_ACQUIRE) && cra_spscq_count(&spscq) == 0)
+                break;
+            cra_thrd_yield();
+        }
+        cra_thrd_join(producer);
+        cra_spscq_uninit(&spscq);
+    }
+    end_ms = cra_tick_ms();
+
+    assert_always(sum == (long long)QUEUE_ITEMS * (QUEUE_ITEMS - 1) / 2);
+    return (double)QUEUE_ITEMS / (double)CRA_MAX(end_ms - start_ms, 1) / 1000.0;
+}
+
+void
+test_spsc_queue_performance(void)
+{
+    printf("test spsc queue[%d ints, capacity %d]:\n", QUEUE_ITEMS, QUEUE_CAPACITY);
+    printf("\tblockdq:                  %6.2lfMitems/s\n", run_spsc_queue(0));
+    printf("\tspscq (blocking):         %6.2lfMitems/s\n", run_spsc_queue(1));
+    printf("\tspscq (batch %d, yield):  %6.2lfMitems/s\n", SPSC_BATCH, run_spsc_queue(2));
+}
+
+static CRA_THRD_FUNC(thrd_blockdq_batch_producer)
+{
+    int       vals[SPSC_BATCH];
+    int       next = 0;
+    size_t    n;
+    QueueArg *qarg = (QueueArg *)arg;
+
+    while (next < qarg->nitems)
+    {
+        n = (size_t)CRA_MIN(SPSC_BATCH, qarg->nitems - next);
+        for (size_t i = 0; i < n; i++)
+            vals[i] = next + (int)i;
+        cra_blockdq_push_back_n(qarg->blockdq, vals, n, NULL, NULL);
+        next += (int)n;
+    }
+    cra_blockdq_shutdown(qarg->blockdq, CRA_BLOCKDQ_CLOSE_ENQUEUE);
+    return (cra_thrd_ret_t){ 0 };
+}
+
+// 一个生产者，一个消费者(调用线程)；返回Mitems/s
+// kind: 0 逐个; 1 push_back_n/pop_front_n; 2 push_back_n/drain
+static double
+run_blockdq_batch(int kind)
+{
+    int           val, vals[SPSC_BATCH];
+    int           got = 0;
+    long long     sum = 0;
+    size_t        n;
+    CraDeque      out;
+    CraBlockdq    blockdq;
+    QueueArg      arg;
+    cra_thrd_t    producer;
+    unsigned long start_ms, end_ms;
+
+    start_ms = cra_tick_ms();
+    assert_always(cra_blockdq_init(int, &blockdq, QUEUE_CAPACITY, CRA_BLOCKDQ_FULL_WAIT));
+    arg = (QueueArg){ .nitems = QUEUE_ITEMS, .blockdq = &blockdq };
+    assert_always(
+      cra_thrd_create(&producer, kind == 0 ? thrd_blockdq_producer : thrd_blockdq_batch_producer, &arg));
+    if (kind == 0)
+    {
+        for (; got < QUEUE_ITEMS; got++)
+        {
+            cra_blockdq_pop_front(&blockdq, &val);
+            sum += val;
+        }
+    }
+    else if (kind == 1)
+    {
+        while (got < QUEUE_ITEMS)
+        {
+            n = cra_blockdq_pop_front_n(&blockdq, vals, SPSC_BATCH, -1);
+            for (size_t i = 0; i < n; i++)
+                sum += vals[i];
+            got += (int)n;
+        }
+    }
+    else
+    {
+        assert_always(cra_deque_init(int, &out));
+        while (got < QUEUE_ITEMS)
+        {
+            // 没有元素时等一下，再一次取走全部
+            if (cra_blockdq_pop_front_n(&blockdq, &val, 1, -1) == 0)
+                break;
+            sum += val;
+            got += 1 + (int)cra_blockdq_drain(&blockdq, &out);
+            while (cra_deque_pop_front(&out, &val))
+                sum += val;
+        }
+        cra_deque_uninit(&out);
+    }
+    cra_thrd_join(producer);
+    cra_blockdq_shutdown(&blockdq, CRA_BLOCKDQ_CLOSE_ALL);
+    cra_blockdq_uninit(&blockdq);
+    end_ms = cra_tick_ms();
+
+    assert_always(sum == (long long)QUEUE_ITEMS * (QUEUE_ITEMS - 1) / 2);
+    return (double)QUEUE_ITEMS / (double)CRA_MAX(end_ms - start_ms, 1) / 1000.0;
+}
+
+void
+test_blockdq_batch_performance(void)
+{
+    printf("test blockdq batch[%d ints, capacity %d]:\n", QUEUE_ITEMS, QUEUE_CAPACITY);
+    printf("\tpush_back/pop_front:        %6.2lfMitems/s\n", run_blockdq_batch(0));
+    printf("\tpush_back_n/pop_front_n %d: %6.2lfMitems/s\n", SPSC_BATCH, run_blockdq_batch(1));
+    printf("\tpush_back_n/drain:          %6.2lfMitems/s\n", run_blockdq_batch(2));
+}
+
+int
+main(void)
+{
+    test_dict_threads_performance();
+    test_parallel_sort_performance();
+    test_queue_threads_performance();
+    test_spsc_queue_performance();
+    test_blockdq_batch_performance();
+
+    cra_memory_leak_report();
+    return 0;
+}